@@ -0,0 +1,92 @@
+/*=========================================================================
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "PluginMemoryUsage.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+// GetProcessMemoryInfo() is provided by kernel32, no need to link against
+// psapi.
+#ifndef PSAPI_VERSION
+#define PSAPI_VERSION 2
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#if defined(__linux__)
+#include <fstream>
+#include <sstream>
+#include <string>
+#endif
+
+//-----------------------------------------------------------------------------
+double GetPluginPeakMemoryUsage()
+{
+#if defined(__linux__)
+  // VmHWM, unlike ru_maxrss, is reset by ResetPluginPeakMemoryUsage()
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+    {
+    if (line.compare(0, 6, "VmHWM:") == 0)
+      {
+      std::istringstream value(line.substr(6));
+      double kilobytes = 0.;
+      if (value >> kilobytes)
+        {
+        return kilobytes / 1024.;
+        }
+      }
+    }
+#endif
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+    return 0.;
+    }
+  return static_cast<double>(counters.PeakWorkingSetSize) / (1024. * 1024.);
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+    return 0.;
+    }
+#if defined(__APPLE__)
+  // bytes
+  return static_cast<double>(usage.ru_maxrss) / (1024. * 1024.);
+#else
+  // kilobytes
+  return static_cast<double>(usage.ru_maxrss) / 1024.;
+#endif
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool ResetPluginPeakMemoryUsage()
+{
+#if defined(__linux__)
+  // Resets VmHWM since Linux 4.0. There is no equivalent for ru_maxrss or
+  // the Windows peak working set.
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  clearRefs << "5" << std::flush;
+  return clearRefs.good();
+#else
+  return false;
+#endif
+}
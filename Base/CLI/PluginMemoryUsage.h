@@ -0,0 +1,37 @@
+/*=========================================================================
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef PluginMemoryUsage_h
+#define PluginMemoryUsage_h
+
+#include "vtkSlicerBaseCLIExport.h"
+
+// Implemented in the SlicerBaseCLI library so that the system headers it
+// needs (e.g. windows.h) are not included in the modules. Modules using
+// these functions, directly or through the filter watchers, must link
+// against SlicerBaseCLI.
+
+//-----------------------------------------------------------------------------
+/// Return the high-water mark of the memory used by the module process, in
+/// megabytes, or 0 if it can't be determined.
+/// It is reported by the filter watchers when a filter ends.
+/// \sa ResetPluginPeakMemoryUsage()
+VTK_SLICER_BASE_CLI_EXPORT double GetPluginPeakMemoryUsage();
+
+//-----------------------------------------------------------------------------
+/// Reset the high-water mark returned by GetPluginPeakMemoryUsage() to the
+/// memory currently used, so that a process running the module several
+/// times reports the peak of each execution.
+/// Only supported on Linux 4.0 or newer, by writing to
+/// /proc/self/clear_refs. Return false elsewhere: executables then refuse
+/// to be kept running between executions (CLI server mode).
+VTK_SLICER_BASE_CLI_EXPORT bool ResetPluginPeakMemoryUsage();
+
+#endif
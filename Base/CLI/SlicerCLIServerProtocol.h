@@ -0,0 +1,123 @@
+/*=========================================================================
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef SlicerCLIServerProtocol_h
+#define SlicerCLIServerProtocol_h
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Messages exchanged between Slicer and an executable CLI started with the
+// "--slicer-cli-server" argument (see SEMCommandLineLibraryWrapper.cxx.in
+// and vtkSlicerCLIModuleLogic::SetServerModeEnabled()).
+//
+// Slicer writes one request per execution on the standard input of the
+// executable: the number of arguments followed by each argument as its
+// length and its characters, each number being followed by a newline.
+// The executable writes "<cli-server-ready/>" on its standard output when
+// it waits for its first request, and
+// "<cli-server-result>exit code</cli-server-result>" after each execution.
+
+//-----------------------------------------------------------------------------
+/// Tag written by the executable when it is ready for requests.
+inline const char* GetCLIServerReadyTag()
+{
+  return "<cli-server-ready/>";
+}
+
+//-----------------------------------------------------------------------------
+/// Write the request of an execution with \a arguments (without the
+/// executable).
+inline void WriteCLIServerRequest(std::ostream& stream,
+                                  const std::vector<std::string>& arguments)
+{
+  stream << arguments.size() << "\n";
+  for (std::vector<std::string>::const_iterator it = arguments.begin();
+       it != arguments.end(); ++it)
+    {
+    stream << it->size() << "\n" << *it;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// Read the next request into \a arguments.
+/// Return false at the end of the stream or if the request is malformed.
+inline bool ReadCLIServerRequest(std::istream& stream,
+                                 std::vector<std::string>& arguments)
+{
+  size_t numberOfArguments = 0;
+  if (!(stream >> numberOfArguments) || stream.get() != '\n')
+    {
+    return false;
+    }
+  arguments.clear();
+  for (size_t i = 0; i < numberOfArguments; ++i)
+    {
+    size_t length = 0;
+    if (!(stream >> length) || stream.get() != '\n')
+      {
+      return false;
+      }
+    std::string argument(length, '\0');
+    if (length > 0 && !stream.read(&argument[0], length))
+      {
+      return false;
+      }
+    arguments.push_back(argument);
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+/// Write the exit code of an execution.
+inline void WriteCLIServerResult(std::ostream& stream, int exitValue)
+{
+  stream << std::endl << "<cli-server-result>" << exitValue
+         << "</cli-server-result>" << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+/// Remove the result of an execution, and the line breaks around it, from
+/// the \a output of the executable.
+/// Return true and set \a exitValue if the execution is over.
+inline bool ExtractCLIServerResult(std::string& output, int& exitValue)
+{
+  const std::string startTag = "<cli-server-result>";
+  const std::string endTag = "</cli-server-result>";
+  std::string::size_type start = output.find(startTag);
+  if (start == std::string::npos)
+    {
+    return false;
+    }
+  std::string::size_type end = output.find(endTag, start + startTag.size());
+  if (end == std::string::npos)
+    {
+    return false;
+    }
+  exitValue = atoi(output.substr(start + startTag.size(),
+                                 end - start - startTag.size()).c_str());
+  end += endTag.size();
+  while (start > 0 && (output[start - 1] == '\n' || output[start - 1] == '\r'))
+    {
+    --start;
+    }
+  end = output.find_first_not_of(" \t\n\r", end);
+  if (end == std::string::npos)
+    {
+    end = output.size();
+    }
+  output.erase(start, end - start);
+  return true;
+}
+
+#endif
@@ -14,6 +14,8 @@
 // ModuleDescriptionParser includes
 #include <ModuleProcessInformation.h>
 
+#include "PluginMemoryUsage.h"
+
 // ITK includes
 #include <itkSimpleFilterWatcher.h>
 
@@ -184,6 +186,10 @@ virtual void EndFilter()
                 << this->GetTimeProbe().GetMean()
                 << "</filter-time>"
                 << std::endl;
+      std::cout << "<filter-memory>"
+                << GetPluginPeakMemoryUsage()
+                << "</filter-memory>"
+                << std::endl;
       std::cout << "</filter-end>";
       std::cout << std::flush;
       }
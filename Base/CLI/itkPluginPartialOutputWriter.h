@@ -0,0 +1,141 @@
+/*=========================================================================
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkPluginPartialOutputWriter_h
+#define itkPluginPartialOutputWriter_h
+
+// ModuleDescriptionParser includes
+#include <ModuleProcessInformation.h>
+
+// ITK includes
+#include <itkImageFileWriter.h>
+#include <itkRealTimeClock.h>
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace itk
+{
+
+/** \class PluginPartialOutputWriter
+ * \brief Publish intermediate versions of an output image while a module
+ * is running.
+ *
+ * Iterative modules (registration, bias field correction...) can call
+ * Write() with their current estimate of an output image. The image is
+ * written next to the output file, in a file named
+ * "partial<N>_<output file name>", that is reported on std::cout with a
+ * <filter-partial-output> tag. Slicer then loads the file into the output
+ * node while the module keeps running, and deletes it.
+ *
+ * Partial outputs are only published by modules run as executables: when
+ * the module runs in Slicer process (a ModuleProcessInformation is given)
+ * or when the output is not a file, Write() does nothing.
+ *
+ * Example of use:
+ *
+ * itk::PluginPartialOutputWriter<ImageType> partialWriter(outputVolume,
+ *                                                         CLPProcessInformation);
+ * ...
+ * // in an iteration observer
+ * partialWriter.Write(currentImage);
+ */
+template <class TImage>
+class PluginPartialOutputWriter
+{
+public:
+  /** \a minimumInterval is the minimum time in seconds between two
+   * published outputs, calls to Write() in between are ignored. */
+  PluginPartialOutputWriter(const std::string& outputFileName,
+                            ModuleProcessInformation *inf = 0,
+                            double minimumInterval = 1.0)
+  {
+    m_OutputFileName = outputFileName;
+    m_ProcessInformation = inf;
+    m_MinimumInterval = minimumInterval;
+    m_Count = 0;
+    m_LastWriteTime = 0.0;
+    m_Clock = RealTimeClock::New();
+  }
+
+  /** Return true if partial outputs can be published. */
+  bool IsEnabled() const
+  {
+    return m_ProcessInformation == 0
+      && !m_OutputFileName.empty()
+      // not a volume in Slicer memory
+      && m_OutputFileName.compare(0, 7, "slicer:") != 0
+      && m_OutputFileName.compare(0, 10, "slicershm:") != 0
+      && itksys::SystemTools::FileIsDirectory(
+        itksys::SystemTools::GetFilenamePath(m_OutputFileName).c_str());
+  }
+
+  /** Return true if the next call to Write() would publish its image.
+   * Modules can check it before computing an expensive partial output. */
+  bool IsReady() const
+  {
+    return this->IsEnabled()
+      && (m_Count == 0
+          || m_Clock->GetTimeInSeconds() - m_LastWriteTime >= m_MinimumInterval);
+  }
+
+  /** Write \a image as the current partial output. Returns true if it has
+   * been published. */
+  bool Write(const TImage* image)
+  {
+    if (!image || !this->IsReady())
+      {
+      return false;
+      }
+    double now = m_Clock->GetTimeInSeconds();
+
+    std::ostringstream partialFileName;
+    partialFileName << itksys::SystemTools::GetFilenamePath(m_OutputFileName)
+                    << "/partial" << ++m_Count << "_"
+                    << itksys::SystemTools::GetFilenameName(m_OutputFileName);
+
+    typedef ImageFileWriter<TImage> WriterType;
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetInput(image);
+    writer->SetFileName(partialFileName.str());
+    try
+      {
+      writer->Update();
+      }
+    catch (ExceptionObject& e)
+      {
+      std::cerr << "Failed to write partial output: " << e << std::endl;
+      return false;
+      }
+    m_LastWriteTime = now;
+
+    std::cout << "<filter-partial-output>"
+              << partialFileName.str()
+              << "</filter-partial-output>"
+              << std::endl;
+    std::cout << std::flush;
+    return true;
+  }
+
+protected:
+  std::string m_OutputFileName;
+  ModuleProcessInformation *m_ProcessInformation;
+  double m_MinimumInterval;
+  unsigned int m_Count;
+  double m_LastWriteTime;
+  RealTimeClock::Pointer m_Clock;
+};
+
+} // end namespace itk
+
+#endif
@@ -1,7 +1,9 @@
 
 #include <vtkPluginFilterWatcher.h>
+#include "PluginMemoryUsage.h"
 
 // VTK includes
+#include <vtkTimerLog.h>
 
 //-----------------------------------------------------------------------------
 class vtkPluginWatcherStart : public vtkCommand
@@ -18,6 +20,7 @@ public:
     if (event == vtkCommand::StartEvent && this->Watcher)
       {
       this->Watcher->SetSteps(0);
+      this->Watcher->SetStartTime(vtkTimerLog::GetUniversalTime());
       if (this->Watcher->GetProcessInformation())
         {
         this->Watcher->GetProcessInformation()->Progress = 0;
@@ -95,6 +98,14 @@ public:
                       ? this->Watcher->GetProcess()->GetClassName() : "None")
                   << "</filter-name>"
                   << std::endl;
+        std::cout << "<filter-time>"
+                  << vtkTimerLog::GetUniversalTime() - this->Watcher->GetStartTime()
+                  << "</filter-time>"
+                  << std::endl;
+        std::cout << "<filter-memory>"
+                  << GetPluginPeakMemoryUsage()
+                  << "</filter-memory>"
+                  << std::endl;
         std::cout << "</filter-end>";
         std::cout << std::flush;
         }
@@ -201,6 +212,7 @@ vtkPluginFilterWatcher
   this->Process->Register(0);
 
   this->Steps = 0;
+  this->StartTime = 0.0;
   this->Comment = comment;
 #if defined(_COMPILER_VERSION) && (_COMPILER_VERSION == 730)
   this->Quiet = true;
@@ -86,6 +86,10 @@ public:
   void SetSteps(int val) {Steps=val;};
   int GetSteps() {return Steps;};
 
+  /** Set/Get the time the filter started at, in seconds. */
+  void SetStartTime(double val) {StartTime=val;};
+  double GetStartTime() {return StartTime;};
+
   /** Get the start and fraction values. */
   double GetStart() {return this->Start;};
   double GetFraction() {return this->Fraction;};
@@ -106,6 +110,7 @@ protected:
 
 private:
   int Steps;
+  double StartTime;
   bool Quiet;
   std::string Comment;
   vtkAlgorithm *Process;
@@ -22,6 +22,7 @@
 #include "vtkSlicerApplicationLogic.h"
 #include "vtkMRMLCoreTestingMacros.h"
 #include "vtkSlicerConfigure.h"
+#include "vtkSlicerTask.h"
 
 // Slicer MRML includes
 #include "vtkMRMLScene.h"
@@ -29,10 +30,234 @@
 
 // VTK includes
 #include <vtkNew.h>
+#include <vtkObjectFactory.h>
+
+// ITK includes
+#include <itkMutexLock.h>
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+class vtkTestTaskLogic : public vtkMRMLAbstractLogic
+{
+public:
+  static vtkTestTaskLogic *New();
+  vtkTypeMacro(vtkTestTaskLogic, vtkMRMLAbstractLogic);
+
+  /// Record that the task identified by clientData was executed
+  void RunTask(void* clientData)
+    {
+    this->Lock->Lock();
+    this->ExecutedTasks.push_back(static_cast<int>(reinterpret_cast<size_t>(clientData)));
+    this->Lock->Unlock();
+    }
+
+  /// Keep the processing thread busy until ReleaseBlockingTask() is called
+  void RunBlockingTask(void* vtkNotUsed(clientData))
+    {
+    this->Lock->Lock();
+    this->BlockingTaskStarted = true;
+    this->Lock->Unlock();
+    while (!this->IsBlockingTaskReleased())
+      {
+      itksys::SystemTools::Delay(10);
+      }
+    }
+
+  bool IsBlockingTaskStarted()
+    {
+    this->Lock->Lock();
+    bool started = this->BlockingTaskStarted;
+    this->Lock->Unlock();
+    return started;
+    }
+
+  bool IsBlockingTaskReleased()
+    {
+    this->Lock->Lock();
+    bool released = this->BlockingTaskReleased;
+    this->Lock->Unlock();
+    return released;
+    }
+
+  void ReleaseBlockingTask()
+    {
+    this->Lock->Lock();
+    this->BlockingTaskReleased = true;
+    this->Lock->Unlock();
+    }
+
+  std::vector<int> GetExecutedTasks()
+    {
+    this->Lock->Lock();
+    std::vector<int> executedTasks = this->ExecutedTasks;
+    this->Lock->Unlock();
+    return executedTasks;
+    }
+
+protected:
+  vtkTestTaskLogic()
+    {
+    this->Lock = itk::MutexLock::New();
+    this->BlockingTaskStarted = false;
+    this->BlockingTaskReleased = false;
+    }
+
+  itk::MutexLock::Pointer Lock;
+  std::vector<int> ExecutedTasks;
+  bool BlockingTaskStarted;
+  bool BlockingTaskReleased;
+};
+
+vtkStandardNewMacro(vtkTestTaskLogic);
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkSlicerTask> CreateTestTask(vtkTestTaskLogic* logic, int taskId,
+  const char* moduleName, int priority, bool blocking = false)
+{
+  vtkSmartPointer<vtkSlicerTask> task = vtkSmartPointer<vtkSlicerTask>::New();
+  task->SetTypeToProcessing();
+  task->SetModuleName(moduleName);
+  task->SetPriority(priority);
+  task->SetTaskFunction(logic, blocking ?
+    (vtkSlicerTask::TaskFunctionPointer)&vtkTestTaskLogic::RunBlockingTask :
+    (vtkSlicerTask::TaskFunctionPointer)&vtkTestTaskLogic::RunTask,
+    reinterpret_cast<void*>(static_cast<size_t>(taskId)));
+  return task;
+}
+
+//-----------------------------------------------------------------------------
+bool WaitFor(vtkTestTaskLogic* logic, bool (vtkTestTaskLogic::*condition)())
+{
+  for (int i = 0; i < 1000; ++i)
+    {
+    if ((logic->*condition)())
+      {
+      return true;
+      }
+    itksys::SystemTools::Delay(10);
+    }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+bool WaitForCompletedTasks(vtkSlicerApplicationLogic* appLogic, int numberOfTasks)
+{
+  for (int i = 0; i < 1000; ++i)
+    {
+    if (appLogic->GetNumberOfCompletedProcessingTasks() >= numberOfTasks)
+      {
+      return true;
+      }
+    itksys::SystemTools::Delay(10);
+    }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+int TestTaskPriorityAndCancel()
+{
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  appLogic->SetNumberOfProcessingThreads(1);
+  CHECK_INT(appLogic->GetNumberOfProcessingThreads(), 1);
+  appLogic->CreateProcessingThread();
+
+  vtkNew<vtkTestTaskLogic> logic;
+  // occupy the only processing thread so that the next tasks stay queued
+  vtkSmartPointer<vtkSlicerTask> blockingTask = CreateTestTask(logic.GetPointer(), 0, "Test", 0, true);
+  CHECK_BOOL(appLogic->ScheduleTask(blockingTask) != 0, true);
+  CHECK_BOOL(WaitFor(logic.GetPointer(), &vtkTestTaskLogic::IsBlockingTaskStarted), true);
+
+  vtkSmartPointer<vtkSlicerTask> lowPriorityTask = CreateTestTask(logic.GetPointer(), 1, "Test", 0);
+  vtkSmartPointer<vtkSlicerTask> highPriorityTask = CreateTestTask(logic.GetPointer(), 2, "Test", 10);
+  vtkSmartPointer<vtkSlicerTask> cancelledTask = CreateTestTask(logic.GetPointer(), 3, "Test", 20);
+  vtkSmartPointer<vtkSlicerTask> lastTask = CreateTestTask(logic.GetPointer(), 4, "Test", 0);
+  appLogic->ScheduleTask(lowPriorityTask);
+  appLogic->ScheduleTask(highPriorityTask);
+  appLogic->ScheduleTask(cancelledTask);
+  appLogic->ScheduleTask(lastTask);
+  CHECK_INT(appLogic->GetProcessingTaskQueueSize(), 4);
+  CHECK_INT(appLogic->GetNumberOfRunningProcessingTasks(), 1);
+  // wait times only account for completed tasks
+  CHECK_INT(appLogic->GetNumberOfCompletedProcessingTasks(), 0);
+  CHECK_DOUBLE(appLogic->GetMaximumProcessingTaskWaitTime(), 0.0);
+
+  CHECK_BOOL(appLogic->CancelTask(cancelledTask), true);
+  CHECK_BOOL(appLogic->CancelTask(cancelledTask), false);
+  CHECK_INT(appLogic->GetProcessingTaskQueueSize(), 3);
+
+  logic->ReleaseBlockingTask();
+  CHECK_BOOL(WaitForCompletedTasks(appLogic.GetPointer(), 4), true);
+
+  // highest priority first, then in scheduling order
+  std::vector<int> executedTasks = logic->GetExecutedTasks();
+  CHECK_INT(static_cast<int>(executedTasks.size()), 3);
+  CHECK_INT(executedTasks[0], 2);
+  CHECK_INT(executedTasks[1], 1);
+  CHECK_INT(executedTasks[2], 4);
+
+  CHECK_INT(appLogic->GetProcessingTaskQueueSize(), 0);
+  CHECK_INT(appLogic->GetNumberOfRunningProcessingTasks(), 0);
+  CHECK_BOOL(appLogic->GetMaximumProcessingTaskWaitTime() >= appLogic->GetAverageProcessingTaskWaitTime(), true);
+  CHECK_BOOL(appLogic->GetMaximumProcessingTaskRunTime() >= appLogic->GetAverageProcessingTaskRunTime(), true);
+  CHECK_BOOL(appLogic->GetMaximumProcessingTaskRunTime() > 0.0, true);
+  appLogic->ResetProcessingTaskStatistics();
+  CHECK_INT(appLogic->GetNumberOfCompletedProcessingTasks(), 0);
+  CHECK_DOUBLE(appLogic->GetMaximumProcessingTaskRunTime(), 0.0);
+
+  appLogic->TerminateProcessingThread();
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestTaskConcurrencyLimit()
+{
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  appLogic->SetNumberOfProcessingThreads(2);
+  appLogic->SetMaximumNumberOfConcurrentTasks("Limited", 1);
+  CHECK_INT(appLogic->GetMaximumNumberOfConcurrentTasks("Limited"), 1);
+  CHECK_INT(appLogic->GetMaximumNumberOfConcurrentTasks("Unlimited"), 0);
+  appLogic->CreateProcessingThread();
+
+  vtkNew<vtkTestTaskLogic> logic;
+  vtkSmartPointer<vtkSlicerTask> blockingTask = CreateTestTask(logic.GetPointer(), 0, "Limited", 0, true);
+  appLogic->ScheduleTask(blockingTask);
+  CHECK_BOOL(WaitFor(logic.GetPointer(), &vtkTestTaskLogic::IsBlockingTaskStarted), true);
+
+  // the second thread is free but the module may only run one task at a time
+  vtkSmartPointer<vtkSlicerTask> limitedTask = CreateTestTask(logic.GetPointer(), 1, "Limited", 10);
+  vtkSmartPointer<vtkSlicerTask> unlimitedTask = CreateTestTask(logic.GetPointer(), 2, "Unlimited", 0);
+  appLogic->ScheduleTask(limitedTask);
+  appLogic->ScheduleTask(unlimitedTask);
+  CHECK_BOOL(WaitForCompletedTasks(appLogic.GetPointer(), 1), true);
+  std::vector<int> executedTasks = logic->GetExecutedTasks();
+  CHECK_INT(static_cast<int>(executedTasks.size()), 1);
+  CHECK_INT(executedTasks[0], 2);
+  CHECK_INT(appLogic->GetProcessingTaskQueueSize(), 1);
+
+  logic->ReleaseBlockingTask();
+  CHECK_BOOL(WaitForCompletedTasks(appLogic.GetPointer(), 3), true);
+  executedTasks = logic->GetExecutedTasks();
+  CHECK_INT(static_cast<int>(executedTasks.size()), 2);
+  CHECK_INT(executedTasks[1], 1);
+
+  appLogic->TerminateProcessingThread();
+  return EXIT_SUCCESS;
+}
+
+}
 
 //-----------------------------------------------------------------------------
 int vtkSlicerApplicationLogicTest1(int , char * [])
 {
+  CHECK_EXIT_SUCCESS(TestTaskPriorityAndCancel());
+  CHECK_EXIT_SUCCESS(TestTaskConcurrencyLimit());
+
   //-----------------------------------------------------------------------------
   // Test GetModuleShareDirectory(const std::string& moduleName, const std::string& filePath);
   //-----------------------------------------------------------------------------
@@ -34,6 +34,7 @@
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
+#include <vtkTimerLog.h>
 
 // ITKSYS includes
 #include <itksys/SystemTools.hxx>
@@ -47,12 +48,175 @@
 # include <sys/resource.h>
 #endif
 
+#include <list>
+#include <map>
 #include <queue>
 
 #include "vtkSlicerApplicationLogicRequests.h"
 
+namespace
+{
+/// Number of threads spawned by CreateProcessingThread() to serve the
+/// remote I/O queue, next to the processing threads.
+const int NumberOfNetworkingThreads = 1;
+}
+
+//----------------------------------------------------------------------------
+/// Queue of scheduled tasks, ordered by decreasing priority and, within the
+/// same priority, by scheduling order. It also keeps track of the running
+/// tasks and collects timing statistics. It is not thread-safe, access is
+/// protected by vtkSlicerApplicationLogic::ProcessingTaskQueueLock.
+class ProcessingTaskQueue
+{
+public:
+  struct ScheduledTask
+    {
+    vtkSmartPointer<vtkSlicerTask> Task;
+    int Type;
+    int Priority;
+    std::string ModuleName;
+    double ScheduledTime;
+    double WaitTime;
+    };
+
+  ProcessingTaskQueue()
+    {
+    this->NumberOfRunningTasks = 0;
+    this->ResetStatistics();
+    }
+
+  void ResetStatistics()
+    {
+    this->NumberOfCompletedTasks = 0;
+    this->TotalWaitTime = 0.0;
+    this->MaximumWaitTime = 0.0;
+    this->TotalRunTime = 0.0;
+    this->MaximumRunTime = 0.0;
+    }
+
+  void Push(vtkSlicerTask* task)
+    {
+    ScheduledTask scheduledTask;
+    scheduledTask.Task = task;
+    scheduledTask.Type = task->GetType();
+    scheduledTask.Priority = task->GetPriority();
+    scheduledTask.ModuleName = task->GetModuleName() ? task->GetModuleName() : "";
+    scheduledTask.ScheduledTime = vtkTimerLog::GetUniversalTime();
+    scheduledTask.WaitTime = 0.0;
+    // insert after all the tasks that have the same or higher priority
+    std::list<ScheduledTask>::iterator insertIt = this->Tasks.end();
+    while (insertIt != this->Tasks.begin())
+      {
+      std::list<ScheduledTask>::iterator previousIt = insertIt;
+      --previousIt;
+      if (previousIt->Priority >= scheduledTask.Priority)
+        {
+        break;
+        }
+      insertIt = previousIt;
+      }
+    this->Tasks.insert(insertIt, scheduledTask);
+    }
+
+  /// Remove the first task of the requested type that is allowed to run and
+  /// register it as running. Returns false if there is no such task.
+  bool StartNextTask(int taskType, ScheduledTask& startedTask)
+    {
+    for (std::list<ScheduledTask>::iterator taskIt = this->Tasks.begin(); taskIt != this->Tasks.end(); ++taskIt)
+      {
+      if (taskIt->Type != taskType)
+        {
+        continue;
+        }
+      if (!taskIt->ModuleName.empty())
+        {
+        std::map<std::string, int>::iterator limitIt = this->MaximumConcurrentTasks.find(taskIt->ModuleName);
+        if (limitIt != this->MaximumConcurrentTasks.end() && limitIt->second > 0
+          && this->RunningTasksPerModule[taskIt->ModuleName] >= limitIt->second)
+          {
+          // the module already runs as many tasks as it is allowed to
+          continue;
+          }
+        this->RunningTasksPerModule[taskIt->ModuleName]++;
+        }
+      startedTask = *taskIt;
+      this->Tasks.erase(taskIt);
+      if (startedTask.Type == vtkSlicerTask::Processing)
+        {
+        this->NumberOfRunningTasks++;
+        // accounted for when the task completes, like the run time
+        startedTask.WaitTime = vtkTimerLog::GetUniversalTime() - startedTask.ScheduledTime;
+        }
+      return true;
+      }
+    return false;
+    }
+
+  void TaskCompleted(const ScheduledTask& completedTask, double runTime)
+    {
+    if (!completedTask.ModuleName.empty())
+      {
+      this->RunningTasksPerModule[completedTask.ModuleName]--;
+      }
+    if (completedTask.Type != vtkSlicerTask::Processing)
+      {
+      return;
+      }
+    this->NumberOfRunningTasks--;
+    this->NumberOfCompletedTasks++;
+    this->TotalWaitTime += completedTask.WaitTime;
+    this->MaximumWaitTime = std::max(this->MaximumWaitTime, completedTask.WaitTime);
+    this->TotalRunTime += runTime;
+    this->MaximumRunTime = std::max(this->MaximumRunTime, runTime);
+    }
+
+  bool Remove(vtkSlicerTask* task)
+    {
+    for (std::list<ScheduledTask>::iterator taskIt = this->Tasks.begin(); taskIt != this->Tasks.end(); ++taskIt)
+      {
+      if (taskIt->Task.GetPointer() == task)
+        {
+        this->Tasks.erase(taskIt);
+        return true;
+        }
+      }
+    return false;
+    }
+
+  int GetNumberOfQueuedTasks(int taskType)
+    {
+    int numberOfTasks = 0;
+    for (std::list<ScheduledTask>::iterator taskIt = this->Tasks.begin(); taskIt != this->Tasks.end(); ++taskIt)
+      {
+      if (taskIt->Type == taskType)
+        {
+        numberOfTasks++;
+        }
+      }
+    return numberOfTasks;
+    }
+
+  std::list<ScheduledTask> Tasks;
+  std::map<std::string, int> MaximumConcurrentTasks;
+  std::map<std::string, int> RunningTasksPerModule;
+  int NumberOfRunningTasks;
+
+  int NumberOfCompletedTasks;
+  double TotalWaitTime;
+  double MaximumWaitTime;
+  double TotalRunTime;
+  double MaximumRunTime;
+};
+
 //----------------------------------------------------------------------------
-class ProcessingTaskQueue : public std::queue<vtkSmartPointer<vtkSlicerTask> > {};
+class ProcessingThreadInfo
+{
+public:
+  vtkSlicerApplicationLogic* ApplicationLogic;
+  int WorkerIndex;
+  int ThreadId;
+};
+
 class ModifiedQueue : public std::queue<vtkSmartPointer<vtkObject> > {};
 class ReadDataQueue : public std::queue<DataRequest*> {};
 class WriteDataQueue : public std::queue<DataRequest*> {};
@@ -64,7 +228,8 @@ vtkStandardNewMacro(vtkSlicerApplicationLogic);
 vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
 {
   this->ProcessingThreader = itk::MultiThreader::New();
-  this->ProcessingThreadId = -1;
+  this->NumberOfProcessingThreads = std::max(1, std::min(4,
+    static_cast<int>(itk::MultiThreader::GetGlobalDefaultNumberOfThreads())));
   this->ProcessingThreadActive = false;
   this->ProcessingThreadActiveLock = itk::MutexLock::New();
   this->ProcessingTaskQueueLock = itk::MutexLock::New();
@@ -94,17 +259,28 @@ vtkSlicerApplicationLogic::~vtkSlicerApplicationLogic()
   // Note that TerminateThread does not kill a thread, it only waits
   // for the thread to finish.  We need to signal the thread that we
   // want to terminate
-  if (this->ProcessingThreadId != -1 && this->ProcessingThreader)
+  if (!this->ProcessingThreads.empty() && this->ProcessingThreader)
     {
-    // Signal the processingThread that we are terminating.
+    // Signal the processing threads that we are terminating.
     this->ProcessingThreadActiveLock->Lock();
     this->ProcessingThreadActive = false;
     this->ProcessingThreadActiveLock->Unlock();
 
-    // Wait for the thread to finish and clean up the state of the threader
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
+    // Wait for the threads to finish and clean up the state of the threader
+    for (std::vector<ProcessingThreadInfo*>::iterator threadIt = this->ProcessingThreads.begin();
+      threadIt != this->ProcessingThreads.end(); ++threadIt)
+      {
+      this->ProcessingThreader->TerminateThread( (*threadIt)->ThreadId );
+      delete *threadIt;
+      }
+    this->ProcessingThreads.clear();
 
-    this->ProcessingThreadId = -1;
+    std::vector<int>::const_iterator idIterator;
+    for (idIterator = this->NetworkingThreadIDs.begin(); idIterator != this->NetworkingThreadIDs.end(); ++idIterator)
+      {
+      this->ProcessingThreader->TerminateThread( *idIterator );
+      }
+    this->NetworkingThreadIDs.clear();
     }
 
   delete this->InternalTaskQueue;
@@ -181,41 +357,29 @@ void vtkSlicerApplicationLogic::PrintSelf(ostream& os, vtkIndent indent)
   this->vtkObject::PrintSelf(os, indent);
 
   os << indent << "SlicerApplicationLogic:             " << this->GetClassName() << "\n";
+  os << indent << "NumberOfProcessingThreads:          " << this->NumberOfProcessingThreads << "\n";
 }
 
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::CreateProcessingThread()
 {
-  if (this->ProcessingThreadId == -1)
+  if (this->ProcessingThreads.empty())
     {
     this->ProcessingThreadActiveLock->Lock();
     this->ProcessingThreadActive = true;
     this->ProcessingThreadActiveLock->Unlock();
 
-    this->ProcessingThreadId
-      = this->ProcessingThreader
-      ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback,
-                    this);
-
-    // Start four network threads (TODO: make the number of threads a setting)
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    /*
-     * TODO: it looks like curl is not thread safe by default
-     * - maybe there's a setting that cmcurl can have
-     *   similar to the --enable-threading of the standard curl build
-     *
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    */
+    this->SpawnProcessingThreads();
+
+    // Start the network threads. Only one is started because curl is not
+    // thread safe by default (TODO: maybe there's a setting that cmcurl can
+    // have similar to the --enable-threading of the standard curl build)
+    for (int i = 0; i < NumberOfNetworkingThreads; ++i)
+      {
+      this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
+            ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
+                      this) );
+      }
 
     // Setup the communication channel back to the main thread
     this->ModifiedQueueActiveLock->Lock();
@@ -238,7 +402,7 @@ void vtkSlicerApplicationLogic::CreateProcessingThread()
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::TerminateProcessingThread()
 {
-  if (this->ProcessingThreadId != -1)
+  if (!this->ProcessingThreads.empty())
     {
     this->ModifiedQueueActiveLock->Lock();
     this->ModifiedQueueActive = false;
@@ -256,8 +420,13 @@ void vtkSlicerApplicationLogic::TerminateProcessingThread()
     this->ProcessingThreadActive = false;
     this->ProcessingThreadActiveLock->Unlock();
 
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
-    this->ProcessingThreadId = -1;
+    for (std::vector<ProcessingThreadInfo*>::iterator threadIt = this->ProcessingThreads.begin();
+      threadIt != this->ProcessingThreads.end(); ++threadIt)
+      {
+      this->ProcessingThreader->TerminateThread( (*threadIt)->ThreadId );
+      delete *threadIt;
+      }
+    this->ProcessingThreads.clear();
 
     std::vector<int>::const_iterator idIterator;
     idIterator = this->NetworkingThreadIDs.begin();
@@ -295,23 +464,22 @@ vtkSlicerApplicationLogic
   (void)ret; // unused variable
 #endif
 
-  // pull out the reference to the appLogic
-  vtkSlicerApplicationLogic *appLogic
-    = (vtkSlicerApplicationLogic*)
+  // pull out the reference to the appLogic and the index of this worker
+  ProcessingThreadInfo *threadInfo
+    = (ProcessingThreadInfo*)
     (((itk::MultiThreader::ThreadInfoStruct *)(arg))->UserData);
 
   // Tell the app to start processing any tasks slated for the
   // processing thread
-  appLogic->ProcessProcessingTasks();
+  threadInfo->ApplicationLogic->ProcessProcessingTasks(threadInfo->WorkerIndex);
 
   return ITK_THREAD_RETURN_VALUE;
 }
 
 //----------------------------------------------------------------------------
-void vtkSlicerApplicationLogic::ProcessProcessingTasks()
+void vtkSlicerApplicationLogic::ProcessProcessingTasks(int workerIndex)
 {
   int active = true;
-  vtkSmartPointer<vtkSlicerTask> task = 0;
 
   while (active)
     {
@@ -322,30 +490,29 @@ void vtkSlicerApplicationLogic::ProcessProcessingTasks()
 
     if (active)
       {
-      // pull a task off the queue
+      // pull the highest priority processing task off the queue,
+      // unless the number of workers was decreased below this one
+      ProcessingTaskQueue::ScheduledTask task;
+      bool taskStarted = false;
       this->ProcessingTaskQueueLock->Lock();
-      if ((*this->InternalTaskQueue).size() > 0)
+      if (workerIndex < this->NumberOfProcessingThreads)
         {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
-
-        // only handle processing tasks in this thread
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Processing )
-          {
-          (*this->InternalTaskQueue).pop();
-          }
-        else
-          {
-          task = NULL;
-          }
+        taskStarted = this->InternalTaskQueue->StartNextTask(vtkSlicerTask::Processing, task);
         }
       this->ProcessingTaskQueueLock->Unlock();
 
-      // process the task (should this be in a separate thread?)
-      if (task)
+      if (taskStarted)
         {
-        task->Execute();
-        task = 0;
+        double startTime = vtkTimerLog::GetUniversalTime();
+        task.Task->Execute();
+        double runTime = vtkTimerLog::GetUniversalTime() - startTime;
+        task.Task = 0;
+
+        this->ProcessingTaskQueueLock->Lock();
+        this->InternalTaskQueue->TaskCompleted(task, runTime);
+        this->ProcessingTaskQueueLock->Unlock();
+        // look for the next task without waiting
+        continue;
         }
       }
 
@@ -354,6 +521,83 @@ void vtkSlicerApplicationLogic::ProcessProcessingTasks()
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::SpawnProcessingThreads()
+{
+  this->ProcessingTaskQueueLock->Lock();
+  int numberOfThreads = this->NumberOfProcessingThreads;
+  this->ProcessingTaskQueueLock->Unlock();
+
+  while (static_cast<int>(this->ProcessingThreads.size()) < numberOfThreads)
+    {
+    ProcessingThreadInfo* threadInfo = new ProcessingThreadInfo;
+    threadInfo->ApplicationLogic = this;
+    threadInfo->WorkerIndex = static_cast<int>(this->ProcessingThreads.size());
+    threadInfo->ThreadId = this->ProcessingThreader
+      ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback,
+                    threadInfo);
+    if (threadInfo->ThreadId < 0)
+      {
+      vtkErrorMacro("SpawnProcessingThreads: failed to start processing thread");
+      delete threadInfo;
+      break;
+      }
+    this->ProcessingThreads.push_back(threadInfo);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::SetNumberOfProcessingThreads(int numberOfThreads)
+{
+  // leave room in the threader for the networking threads
+  numberOfThreads = std::max(1, std::min(numberOfThreads,
+    ITK_MAX_THREADS - NumberOfNetworkingThreads));
+  this->ProcessingTaskQueueLock->Lock();
+  bool modified = (this->NumberOfProcessingThreads != numberOfThreads);
+  this->NumberOfProcessingThreads = numberOfThreads;
+  this->ProcessingTaskQueueLock->Unlock();
+  if (!modified)
+    {
+    return;
+    }
+  if (!this->ProcessingThreads.empty())
+    {
+    this->SpawnProcessingThreads();
+    }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::GetNumberOfProcessingThreads()
+{
+  this->ProcessingTaskQueueLock->Lock();
+  int numberOfThreads = this->NumberOfProcessingThreads;
+  this->ProcessingTaskQueueLock->Unlock();
+  return numberOfThreads;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::SetMaximumNumberOfConcurrentTasks(const std::string& moduleName, int maximumNumberOfTasks)
+{
+  this->ProcessingTaskQueueLock->Lock();
+  this->InternalTaskQueue->MaximumConcurrentTasks[moduleName] = std::max(0, maximumNumberOfTasks);
+  this->ProcessingTaskQueueLock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::GetMaximumNumberOfConcurrentTasks(const std::string& moduleName)
+{
+  int maximumNumberOfTasks = 0;
+  this->ProcessingTaskQueueLock->Lock();
+  std::map<std::string, int>::iterator limitIt = this->InternalTaskQueue->MaximumConcurrentTasks.find(moduleName);
+  if (limitIt != this->InternalTaskQueue->MaximumConcurrentTasks.end())
+    {
+    maximumNumberOfTasks = limitIt->second;
+    }
+  this->ProcessingTaskQueueLock->Unlock();
+  return maximumNumberOfTasks;
+}
+
 ITK_THREAD_RETURN_TYPE
 vtkSlicerApplicationLogic
 ::NetworkingThreaderCallback( void *arg )
@@ -393,7 +637,6 @@ vtkSlicerApplicationLogic
 void vtkSlicerApplicationLogic::ProcessNetworkingTasks()
 {
   int active = true;
-  vtkSmartPointer<vtkSlicerTask> task = 0;
 
   while (active)
     {
@@ -404,28 +647,22 @@ void vtkSlicerApplicationLogic::ProcessNetworkingTasks()
 
     if (active)
       {
-      // pull a task off the queue
+      // pull a networking task off the queue
+      ProcessingTaskQueue::ScheduledTask task;
       this->ProcessingTaskQueueLock->Lock();
-      if ((*this->InternalTaskQueue).size() > 0)
-        {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Networking )
-          {
-          (*this->InternalTaskQueue).pop();
-          }
-        else
-          {
-          task = NULL;
-          }
-        }
+      bool taskStarted = this->InternalTaskQueue->StartNextTask(vtkSlicerTask::Networking, task);
       this->ProcessingTaskQueueLock->Unlock();
 
-      // process the task (should this be in a separate thread?)
-      if (task)
+      if (taskStarted)
         {
-        task->Execute();
-        task = 0;
+        double startTime = vtkTimerLog::GetUniversalTime();
+        task.Task->Execute();
+        double runTime = vtkTimerLog::GetUniversalTime() - startTime;
+        task.Task = 0;
+
+        this->ProcessingTaskQueueLock->Lock();
+        this->InternalTaskQueue->TaskCompleted(task, runTime);
+        this->ProcessingTaskQueueLock->Unlock();
         }
       }
 
@@ -447,11 +684,93 @@ int vtkSlicerApplicationLogic::ScheduleTask( vtkSlicerTask *task )
     }
 
   this->ProcessingTaskQueueLock->Lock();
-  (*this->InternalTaskQueue).push( task );
+  this->InternalTaskQueue->Push( task );
   this->ProcessingTaskQueueLock->Unlock();
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool vtkSlicerApplicationLogic::CancelTask( vtkSlicerTask *task )
+{
+  this->ProcessingTaskQueueLock->Lock();
+  bool removed = this->InternalTaskQueue->Remove( task );
+  this->ProcessingTaskQueueLock->Unlock();
+  return removed;
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::GetProcessingTaskQueueSize()
+{
+  this->ProcessingTaskQueueLock->Lock();
+  int queueSize = this->InternalTaskQueue->GetNumberOfQueuedTasks(vtkSlicerTask::Processing);
+  this->ProcessingTaskQueueLock->Unlock();
+  return queueSize;
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::GetNumberOfRunningProcessingTasks()
+{
+  this->ProcessingTaskQueueLock->Lock();
+  int numberOfTasks = this->InternalTaskQueue->NumberOfRunningTasks;
+  this->ProcessingTaskQueueLock->Unlock();
+  return numberOfTasks;
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::GetNumberOfCompletedProcessingTasks()
+{
+  this->ProcessingTaskQueueLock->Lock();
+  int numberOfTasks = this->InternalTaskQueue->NumberOfCompletedTasks;
+  this->ProcessingTaskQueueLock->Unlock();
+  return numberOfTasks;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerApplicationLogic::GetAverageProcessingTaskWaitTime()
+{
+  this->ProcessingTaskQueueLock->Lock();
+  double averageTime = this->InternalTaskQueue->NumberOfCompletedTasks > 0 ?
+    this->InternalTaskQueue->TotalWaitTime / this->InternalTaskQueue->NumberOfCompletedTasks : 0.0;
+  this->ProcessingTaskQueueLock->Unlock();
+  return averageTime;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerApplicationLogic::GetMaximumProcessingTaskWaitTime()
+{
+  this->ProcessingTaskQueueLock->Lock();
+  double maximumTime = this->InternalTaskQueue->MaximumWaitTime;
+  this->ProcessingTaskQueueLock->Unlock();
+  return maximumTime;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerApplicationLogic::GetAverageProcessingTaskRunTime()
+{
+  this->ProcessingTaskQueueLock->Lock();
+  double averageTime = this->InternalTaskQueue->NumberOfCompletedTasks > 0 ?
+    this->InternalTaskQueue->TotalRunTime / this->InternalTaskQueue->NumberOfCompletedTasks : 0.0;
+  this->ProcessingTaskQueueLock->Unlock();
+  return averageTime;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerApplicationLogic::GetMaximumProcessingTaskRunTime()
+{
+  this->ProcessingTaskQueueLock->Lock();
+  double maximumTime = this->InternalTaskQueue->MaximumRunTime;
+  this->ProcessingTaskQueueLock->Unlock();
+  return maximumTime;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::ResetProcessingTaskStatistics()
+{
+  this->ProcessingTaskQueueLock->Lock();
+  this->InternalTaskQueue->ResetStatistics();
+  this->ProcessingTaskQueueLock->Unlock();
+}
+
 //----------------------------------------------------------------------------
 vtkMTimeType vtkSlicerApplicationLogic::RequestModified(vtkObject *obj)
 {
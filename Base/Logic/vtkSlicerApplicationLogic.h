@@ -38,6 +38,7 @@ class vtkDataIOManagerLogic;
 class vtkSlicerTask;
 class ModifiedQueue;
 class ProcessingTaskQueue;
+class ProcessingThreadInfo;
 class ReadDataQueue;
 class ReadDataRequest;
 class WriteDataQueue;
@@ -69,11 +70,27 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   /// (display it in the Fiducials GUI)
   void PropagateFiducialListSelection();
 
-  /// Create a thread for processing
+  /// Create the threads for processing
   void CreateProcessingThread();
 
-  /// Shutdown the processing thread
+  /// Shutdown the processing threads.
+  /// Waits for the tasks that are being executed to complete.
   void TerminateProcessingThread();
+
+  /// Set the number of worker threads that execute processing tasks.
+  /// If the processing threads are already running then additional threads
+  /// are started immediately, while decreasing the number of threads takes
+  /// effect when the surplus threads complete their current task.
+  /// Default is the number of CPUs, at most 4.
+  void SetNumberOfProcessingThreads(int numberOfThreads);
+  int GetNumberOfProcessingThreads();
+
+  /// Set the maximum number of processing tasks scheduled by a module
+  /// (see vtkSlicerTask::SetModuleName) that may run at the same time.
+  /// 0 means that the number of concurrent tasks is only limited by the
+  /// number of processing threads. Default is 0.
+  void SetMaximumNumberOfConcurrentTasks(const std::string& moduleName, int maximumNumberOfTasks);
+  int GetMaximumNumberOfConcurrentTasks(const std::string& moduleName);
   /// List of events potentially fired by the application logic
   enum RequestEvents
     {
@@ -92,6 +109,25 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   /// main thread to run something in the processing thread.
   int ScheduleTask( vtkSlicerTask* );
 
+  /// Remove a task from the queue if it has not been started yet.
+  /// Returns true if the task was removed. The task function of a removed
+  /// task is not called, therefore the caller is responsible for releasing
+  /// the client data that it passed to the task.
+  bool CancelTask( vtkSlicerTask* );
+
+  /// Statistics of the processing tasks, for tuning the number of
+  /// processing threads and the concurrency limits. Times are in seconds.
+  /// Wait and run times are accumulated over the tasks that have completed
+  /// since the last ResetProcessingTaskStatistics() call.
+  int GetProcessingTaskQueueSize();
+  int GetNumberOfRunningProcessingTasks();
+  int GetNumberOfCompletedProcessingTasks();
+  double GetAverageProcessingTaskWaitTime();
+  double GetMaximumProcessingTaskWaitTime();
+  double GetAverageProcessingTaskRunTime();
+  double GetMaximumProcessingTaskRunTime();
+  void ResetProcessingTaskStatistics();
+
   /// Request a Modified call on an object.  This method allows a
   /// processing thread to request a Modified call on an object to be
   /// performed in the main thread.  This allows the call to Modified
@@ -217,8 +253,11 @@ protected:
   /// Callback used by a MultiThreader to start a networking thread
   static ITK_THREAD_RETURN_TYPE NetworkingThreaderCallback( void * );
 
-  /// Task processing loop that is run in the processing thread
-  void ProcessProcessingTasks();
+  /// Task processing loop that is run in each processing thread
+  void ProcessProcessingTasks(int workerIndex);
+
+  /// Start processing threads until there are NumberOfProcessingThreads.
+  void SpawnProcessingThreads();
 
   /// Networking Task processing loop that is run in a networking thread
   void ProcessNetworkingTasks();
@@ -244,7 +283,8 @@ private:
   itk::MutexLock::Pointer WriteDataQueueActiveLock;
   itk::MutexLock::Pointer WriteDataQueueLock;
   vtkTimeStamp RequestTimeStamp;
-  int ProcessingThreadId;
+  std::vector<ProcessingThreadInfo*> ProcessingThreads;
+  int NumberOfProcessingThreads;
   std::vector<int> NetworkingThreadIDs;
   int ProcessingThreadActive;
   int ModifiedQueueActive;
@@ -163,8 +163,10 @@ public:
     if (m_DeleteFile)
      {
       int removed;
-      // is it a shared memory location?
-      if (m_Filename.find("slicer:") != std::string::npos)
+      // is it a shared memory location? (shared memory segments of
+      // executable modules are removed by the CLI module logic)
+      if (m_Filename.find("slicer:") != std::string::npos
+        || m_Filename.find("slicershm:") != std::string::npos)
         {
         removed = 1;
         }
@@ -12,10 +12,13 @@ vtkSlicerTask::vtkSlicerTask()
   this->TaskObject = 0;
   this->TaskFunction = 0;
   this->Type = vtkSlicerTask::Undefined;
+  this->Priority = 0;
+  this->ModuleName = 0;
 }
 //----------------------------------------------------------------------------
 vtkSlicerTask::~vtkSlicerTask()
 {
+  this->SetModuleName(0);
 }
 
 //----------------------------------------------------------------------------
@@ -41,4 +44,7 @@ void vtkSlicerTask::Execute()
 void vtkSlicerTask::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "Type: " << this->GetTypeAsString() << "\n";
+  os << indent << "Priority: " << this->Priority << "\n";
+  os << indent << "ModuleName: " << (this->ModuleName ? this->ModuleName : "(none)") << "\n";
 }
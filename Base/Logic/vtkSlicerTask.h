@@ -38,6 +38,20 @@ public:
   void SetTypeToProcessing() {this->SetType(vtkSlicerTask::Processing);};
   void SetTypeToNetworking() {this->SetType(vtkSlicerTask::Networking);};
 
+  ///
+  /// Priority of the task. Among the queued tasks of the same type, the one
+  /// with the highest priority is executed first. Tasks of the same priority
+  /// are executed in the order they were scheduled. Default is 0.
+  vtkSetMacro (Priority, int);
+  vtkGetMacro (Priority, int);
+
+  ///
+  /// Name of the module that scheduled the task. It is used for limiting the
+  /// number of tasks of a module that may run at the same time.
+  /// \sa vtkSlicerApplicationLogic::SetMaximumNumberOfConcurrentTasks()
+  vtkSetStringMacro (ModuleName);
+  vtkGetStringMacro (ModuleName);
+
   const char* GetTypeAsString( ) {
     switch (this->Type)
       {
@@ -60,6 +74,8 @@ private:
   void *TaskClientData;
 
   int Type;
+  int Priority;
+  char* ModuleName;
 
 };
 #endif
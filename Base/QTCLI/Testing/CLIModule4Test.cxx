@@ -15,6 +15,12 @@
 
 // STD includes
 #include <fstream>
+#ifdef _WIN32
+# include <process.h>
+# define getpid _getpid
+#else
+# include <unistd.h>
+#endif
 
 // Use an anonymous namespace to keep class types and function names
 // from colliding when module is used as shared object module.  Every
@@ -71,5 +77,11 @@ int main(int argc, char * argv[])
     return EXIT_FAILURE;
     }
 
+  // Let tests check whether the executable is reused
+  if (!ProcessIdFile.empty() && !outputResult(getpid(), ProcessIdFile))
+    {
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
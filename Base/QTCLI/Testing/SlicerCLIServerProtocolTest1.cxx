@@ -0,0 +1,122 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// SlicerBaseCLI includes
+#include <SlicerCLIServerProtocol.h>
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+
+// STD includes
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+int TestRequest()
+{
+  std::vector<std::string> arguments;
+  arguments.push_back("--inputVolume");
+  arguments.push_back("/tmp/input volume.nrrd");
+  arguments.push_back("");
+  arguments.push_back("multi\nline\r\nargument");
+  arguments.push_back("12");
+  std::vector<std::string> noArguments;
+
+  // Successive requests are read back unchanged
+  std::stringstream stream;
+  WriteCLIServerRequest(stream, arguments);
+  WriteCLIServerRequest(stream, noArguments);
+  WriteCLIServerRequest(stream, arguments);
+
+  std::vector<std::string> readArguments;
+  CHECK_BOOL(ReadCLIServerRequest(stream, readArguments), true);
+  CHECK_BOOL(readArguments == arguments, true);
+  CHECK_BOOL(ReadCLIServerRequest(stream, readArguments), true);
+  CHECK_BOOL(readArguments.empty(), true);
+  CHECK_BOOL(ReadCLIServerRequest(stream, readArguments), true);
+  CHECK_BOOL(readArguments == arguments, true);
+
+  // End of the input
+  CHECK_BOOL(ReadCLIServerRequest(stream, readArguments), false);
+
+  // Truncated request
+  std::ostringstream request;
+  WriteCLIServerRequest(request, arguments);
+  std::string requestString = request.str();
+  std::istringstream truncatedStream(requestString.substr(0, requestString.size() - 1));
+  CHECK_BOOL(ReadCLIServerRequest(truncatedStream, readArguments), false);
+
+  // Malformed requests
+  std::istringstream malformedStream("2 \n3\nabc");
+  CHECK_BOOL(ReadCLIServerRequest(malformedStream, readArguments), false);
+  std::istringstream notNumberStream("--help\n");
+  CHECK_BOOL(ReadCLIServerRequest(notNumberStream, readArguments), false);
+
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestResult()
+{
+  int exitValue = -1;
+
+  // No result yet
+  std::string output = "<filter-start>\n";
+  CHECK_BOOL(ExtractCLIServerResult(output, exitValue), false);
+  CHECK_STD_STRING(output, "<filter-start>\n");
+  CHECK_INT(exitValue, -1);
+
+  // Incomplete result
+  output = "<filter-end/>\n<cli-server-result>1";
+  CHECK_BOOL(ExtractCLIServerResult(output, exitValue), false);
+  CHECK_STD_STRING(output, "<filter-end/>\n<cli-server-result>1");
+
+  // The result and the line breaks around it are removed
+  std::ostringstream result;
+  result << "<filter-end/>";
+  WriteCLIServerResult(result, 3);
+  output = result.str();
+  CHECK_BOOL(ExtractCLIServerResult(output, exitValue), true);
+  CHECK_INT(exitValue, 3);
+  CHECK_STD_STRING(output, "<filter-end/>");
+
+  // Output following the result is kept
+  output = "text\r\n<cli-server-result>0</cli-server-result>\n \nnext";
+  CHECK_BOOL(ExtractCLIServerResult(output, exitValue), true);
+  CHECK_INT(exitValue, 0);
+  CHECK_STD_STRING(output, "textnext");
+
+  // Result only
+  std::ostringstream failure;
+  WriteCLIServerResult(failure, EXIT_FAILURE);
+  output = failure.str();
+  CHECK_BOOL(ExtractCLIServerResult(output, exitValue), true);
+  CHECK_INT(exitValue, EXIT_FAILURE);
+  CHECK_STD_STRING(output, "");
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+// Check the messages exchanged with executable CLIs run in server mode.
+int SlicerCLIServerProtocolTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  CHECK_EXIT_SUCCESS(TestRequest());
+  CHECK_EXIT_SUCCESS(TestResult());
+  return EXIT_SUCCESS;
+}
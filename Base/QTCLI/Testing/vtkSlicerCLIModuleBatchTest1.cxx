@@ -0,0 +1,136 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Slicer includes
+#include "vtkSlicerCLIModuleBatch.h"
+
+// MRMLCLI includes
+#include <vtkMRMLCommandLineModuleNode.h>
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLScene.h>
+
+// SlicerExecutionModel includes
+#include <ModuleDescription.h>
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+#include <sstream>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+ModuleDescription CreateModuleDescription()
+{
+  ModuleParameter inputVolume;
+  inputVolume.SetTag("image");
+  inputVolume.SetName("inputVolume");
+  inputVolume.SetChannel("input");
+  inputVolume.SetIndex("0");
+
+  ModuleParameter outputVolume;
+  outputVolume.SetTag("image");
+  outputVolume.SetName("outputVolume");
+  outputVolume.SetChannel("output");
+  outputVolume.SetIndex("1");
+
+  ModuleParameter iterations;
+  iterations.SetTag("integer");
+  iterations.SetName("iterations");
+  iterations.SetLongFlag("iterations");
+  iterations.SetDefault("5");
+
+  ModuleParameterGroup group;
+  group.AddParameter(inputVolume);
+  group.AddParameter(outputVolume);
+  group.AddParameter(iterations);
+
+  ModuleDescription description;
+  description.SetTitle("BatchTest");
+  description.SetType("CommandLineModule");
+  description.AddParameterGroup(group);
+  return description;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCLIModuleBatchTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLCommandLineModuleNode> nodeClass;
+  scene->RegisterNodeClass(nodeClass.GetPointer());
+
+  vtkNew<vtkMRMLCommandLineModuleNode> templateNode;
+  templateNode->SetModuleDescription(CreateModuleDescription());
+  templateNode->SetParameterAsInt("iterations", 10);
+  scene->AddNode(templateNode.GetPointer());
+
+  vtkNew<vtkSlicerCLIModuleBatch> batch;
+
+  CHECK_NULL(batch->GetTemplateNode());
+  CHECK_BOOL(batch->IsCompleted(), false);
+  CHECK_DOUBLE(batch->GetProgress(), 0.);
+
+  batch->SetTemplateNode(templateNode.GetPointer());
+  CHECK_POINTER(batch->GetTemplateNode(), templateNode.GetPointer());
+  const int numberOfNodes = scene->GetNumberOfNodes();
+  for (int i = 0; i < 3; ++i)
+    {
+    std::stringstream input;
+    input << "/data/case" << i << ".nrrd";
+    std::stringstream output;
+    output << "/data/case" << i << "-filtered.nrrd";
+    CHECK_INT(batch->AddJob(), i);
+    CHECK_BOOL(batch->SetJobParameter(i, "inputVolume", input.str()), true);
+    CHECK_BOOL(batch->SetJobParameter(i, "outputVolume", output.str()), true);
+    }
+  CHECK_INT(batch->GetNumberOfJobs(), 3);
+  CHECK_INT(scene->GetNumberOfNodes(), numberOfNodes + 3);
+  CHECK_NULL(batch->GetJob(3));
+
+  // Jobs share the parameters of the template
+  vtkMRMLCommandLineModuleNode* job = batch->GetJob(1);
+  CHECK_NOT_NULL(job);
+  CHECK_BOOL(vtkSlicerCLIModuleBatch::IsBatchJob(job), true);
+  CHECK_BOOL(vtkSlicerCLIModuleBatch::IsBatchJob(templateNode.GetPointer()), false);
+  CHECK_INT(job->GetHideFromEditors(), 1);
+  CHECK_INT(job->GetSaveWithScene(), 0);
+  CHECK_STD_STRING(job->GetParameterAsString("iterations"), "10");
+  CHECK_STD_STRING(job->GetParameterAsString("inputVolume"), "/data/case1.nrrd");
+
+  // Aggregated status
+  CHECK_INT(batch->GetNumberOfJobsWithStatus(vtkMRMLCommandLineModuleNode::Idle), 3);
+  CHECK_INT(batch->GetNumberOfFinishedJobs(), 0);
+  batch->GetJob(0)->SetStatus(vtkMRMLCommandLineModuleNode::Completed);
+  batch->GetJob(2)->SetStatus(vtkMRMLCommandLineModuleNode::CompletedWithErrors);
+  CHECK_INT(batch->GetNumberOfFinishedJobs(), 2);
+  CHECK_BOOL(batch->IsCompleted(), false);
+  CHECK_DOUBLE(batch->GetProgress(), 2. / 3.);
+
+  // The batch is modified when a job is modified
+  vtkMTimeType batchMTime = batch->GetMTime();
+  job->SetStatus(vtkMRMLCommandLineModuleNode::Cancelled);
+  CHECK_BOOL(batch->GetMTime() > batchMTime, true);
+  CHECK_BOOL(batch->IsCompleted(), true);
+  CHECK_DOUBLE(batch->GetProgress(), 1.);
+
+  batch->RemoveAllJobs();
+  CHECK_INT(batch->GetNumberOfJobs(), 0);
+  CHECK_INT(scene->GetNumberOfNodes(), numberOfNodes);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,187 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Slicer includes
+#include "vtkSlicerApplicationLogic.h"
+#include "vtkSlicerCLIModuleLogic.h"
+
+// MRMLCLI includes
+#include <vtkMRMLCommandLineModuleNode.h>
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLScene.h>
+
+// SlicerExecutionModel includes
+#include <ModuleDescription.h>
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// ITKSYS includes
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+ModuleParameter CreateParameter(const std::string& tag, const std::string& name,
+                                const std::string& longFlag, const std::string& defaultValue)
+{
+  ModuleParameter parameter;
+  parameter.SetTag(tag);
+  parameter.SetName(name);
+  parameter.SetLongFlag(longFlag);
+  parameter.SetDefault(defaultValue);
+  return parameter;
+}
+
+//-----------------------------------------------------------------------------
+// Description of the CLIModule4Test executable
+ModuleDescription CreateModuleDescription(const std::string& executable)
+{
+  ModuleParameter operationType =
+    CreateParameter("string-enumeration", "OperationType", "operationtype", "Addition");
+  operationType.GetElements().push_back("Addition");
+  operationType.GetElements().push_back("Multiplication");
+
+  ModuleParameter outputFile;
+  outputFile.SetTag("file");
+  outputFile.SetName("OutputFile");
+  outputFile.SetChannel("output");
+  outputFile.SetIndex("0");
+
+  ModuleParameterGroup group;
+  group.AddParameter(CreateParameter("integer", "InputValue1", "inputvalue1", "1"));
+  group.AddParameter(CreateParameter("integer", "InputValue2", "inputvalue2", "1"));
+  group.AddParameter(operationType);
+  group.AddParameter(outputFile);
+
+  ModuleDescription description;
+  description.SetTitle("CLIModule4Test");
+  description.SetType("CommandLineModule");
+  description.SetTarget(executable);
+  description.AddParameterGroup(group);
+  return description;
+}
+
+//-----------------------------------------------------------------------------
+int ReadResult(const std::string& fileName)
+{
+  std::ifstream file(fileName.c_str());
+  int result = -1;
+  file >> result;
+  return result;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+// Run several executions of a CLI at the same time in different processing
+// threads and check that they don't interfere.
+int vtkSlicerCLIModuleLogicConcurrencyTest1(int argc, char * argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " /path/to/CLIModule4Test" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string temporaryPath = itksys::SystemTools::GetCurrentWorkingDirectory()
+    + "/vtkSlicerCLIModuleLogicConcurrencyTest1";
+  itksys::SystemTools::RemoveADirectory(temporaryPath.c_str());
+  CHECK_BOOL(itksys::SystemTools::MakeDirectory(temporaryPath.c_str()), true);
+
+  std::string autoLoadPath = "ITK_AUTOLOAD_PATH=" + temporaryPath;
+  itksys::SystemTools::PutEnv(const_cast<char*>(autoLoadPath.c_str()));
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLCommandLineModuleNode> nodeClass;
+  scene->RegisterNodeClass(nodeClass.GetPointer());
+
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  appLogic->SetMRMLScene(scene.GetPointer());
+  appLogic->SetTemporaryPath(temporaryPath.c_str());
+  appLogic->SetNumberOfProcessingThreads(4);
+  appLogic->CreateProcessingThread();
+
+  vtkNew<vtkSlicerCLIModuleLogic> logic;
+  logic->SetMRMLScene(scene.GetPointer());
+  logic->SetMRMLApplicationLogic(appLogic.GetPointer());
+  logic->SetDefaultModuleDescription(CreateModuleDescription(argv[1]));
+
+  const int numberOfNodes = 8;
+  std::vector<vtkSmartPointer<vtkMRMLCommandLineModuleNode> > nodes;
+  std::vector<std::string> outputFiles;
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    vtkSmartPointer<vtkMRMLCommandLineModuleNode> node;
+    node.TakeReference(logic->CreateNode());
+    scene->AddNode(node);
+    std::stringstream outputFile;
+    outputFile << temporaryPath << "/output" << i << ".txt";
+    node->SetParameterAsInt("InputValue1", i);
+    node->SetParameterAsInt("InputValue2", 100);
+    node->SetParameterAsString("OutputFile", outputFile.str());
+    nodes.push_back(node);
+    outputFiles.push_back(outputFile.str());
+    }
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    logic->Apply(nodes[i], false);
+    }
+
+  // Wait for the executions to complete
+  bool completed = false;
+  for (int wait = 0; wait < 3000 && !completed; ++wait)
+    {
+    appLogic->ProcessModified();
+    appLogic->ProcessReadData();
+    completed = true;
+    for (int i = 0; i < numberOfNodes; ++i)
+      {
+      completed = completed &&
+        (nodes[i]->GetStatus() & vtkMRMLCommandLineModuleNode::Completed);
+      }
+    if (!completed)
+      {
+      itksys::SystemTools::Delay(10);
+      }
+    }
+  CHECK_BOOL(completed, true);
+
+  // Each execution wrote its own result
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    CHECK_INT(nodes[i]->GetStatus(), vtkMRMLCommandLineModuleNode::Completed);
+    CHECK_INT(ReadResult(outputFiles[i]), i + 100);
+    }
+
+  // The environment changed around the start of the executables is restored
+  std::string restoredAutoLoadPath;
+  CHECK_BOOL(itksys::SystemTools::GetEnv("ITK_AUTOLOAD_PATH", restoredAutoLoadPath), true);
+  CHECK_STD_STRING(restoredAutoLoadPath, temporaryPath);
+
+  appLogic->TerminateProcessingThread();
+  appLogic->ProcessModified();
+  appLogic->ProcessReadData();
+  logic->SetMRMLApplicationLogic(0);
+  itksys::SystemTools::RemoveADirectory(temporaryPath.c_str());
+
+  return EXIT_SUCCESS;
+}
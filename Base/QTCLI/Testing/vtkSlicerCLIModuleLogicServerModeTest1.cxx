@@ -0,0 +1,201 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Slicer includes
+#include "vtkSlicerApplicationLogic.h"
+#include "vtkSlicerCLIModuleLogic.h"
+
+// MRMLCLI includes
+#include <vtkMRMLCommandLineModuleNode.h>
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLScene.h>
+
+// SlicerExecutionModel includes
+#include <ModuleDescription.h>
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// ITKSYS includes
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+ModuleParameter CreateParameter(const std::string& tag, const std::string& name,
+                                const std::string& longFlag, const std::string& defaultValue)
+{
+  ModuleParameter parameter;
+  parameter.SetTag(tag);
+  parameter.SetName(name);
+  parameter.SetLongFlag(longFlag);
+  parameter.SetDefault(defaultValue);
+  return parameter;
+}
+
+//-----------------------------------------------------------------------------
+// Description of the CLIModule4Test executable
+ModuleDescription CreateModuleDescription(const std::string& executable)
+{
+  ModuleParameter outputFile;
+  outputFile.SetTag("file");
+  outputFile.SetName("OutputFile");
+  outputFile.SetChannel("output");
+  outputFile.SetIndex("0");
+
+  ModuleParameter processIdFile =
+    CreateParameter("file", "ProcessIdFile", "processidfile", "");
+  processIdFile.SetChannel("output");
+
+  ModuleParameter allowServerMode =
+    CreateParameter("boolean", "AllowServerMode", "allowservermode", "true");
+  allowServerMode.SetHidden("true");
+
+  ModuleParameterGroup group;
+  group.AddParameter(CreateParameter("integer", "InputValue1", "inputvalue1", "1"));
+  group.AddParameter(CreateParameter("integer", "InputValue2", "inputvalue2", "1"));
+  group.AddParameter(outputFile);
+  group.AddParameter(processIdFile);
+  group.AddParameter(allowServerMode);
+
+  ModuleDescription description;
+  description.SetTitle("CLIModule4Test");
+  description.SetType("CommandLineModule");
+  description.SetTarget(executable);
+  description.AddParameterGroup(group);
+  return description;
+}
+
+//-----------------------------------------------------------------------------
+int ReadResult(const std::string& fileName)
+{
+  std::ifstream file(fileName.c_str());
+  int result = -1;
+  file >> result;
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+// Run the module once and return the id of the process that ran it,
+// or -1 if the execution failed.
+int Run(vtkSlicerApplicationLogic* appLogic, vtkSlicerCLIModuleLogic* logic,
+        vtkMRMLCommandLineModuleNode* node, const std::string& temporaryPath,
+        int inputValue)
+{
+  std::string outputFile = temporaryPath + "/output.txt";
+  std::string processIdFile = temporaryPath + "/pid.txt";
+  itksys::SystemTools::RemoveFile(outputFile.c_str());
+  itksys::SystemTools::RemoveFile(processIdFile.c_str());
+  node->SetParameterAsInt("InputValue1", inputValue);
+  node->SetParameterAsInt("InputValue2", 100);
+  node->SetParameterAsString("OutputFile", outputFile);
+  node->SetParameterAsString("ProcessIdFile", processIdFile);
+
+  logic->Apply(node, false);
+  bool completed = false;
+  for (int wait = 0; wait < 3000 && !completed; ++wait)
+    {
+    appLogic->ProcessModified();
+    appLogic->ProcessReadData();
+    completed = (node->GetStatus() & vtkMRMLCommandLineModuleNode::Completed);
+    if (!completed)
+      {
+      itksys::SystemTools::Delay(10);
+      }
+    }
+  if (node->GetStatus() != vtkMRMLCommandLineModuleNode::Completed
+      || ReadResult(outputFile) != inputValue + 100)
+    {
+    std::cerr << "Execution with input " << inputValue << " failed" << std::endl;
+    return -1;
+    }
+  return ReadResult(processIdFile);
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+// Run a CLI that allows server mode several times and check that its
+// executable is kept running between executions only if server mode is
+// enabled.
+int vtkSlicerCLIModuleLogicServerModeTest1(int argc, char * argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " /path/to/CLIModule4Test" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string temporaryPath = itksys::SystemTools::GetCurrentWorkingDirectory()
+    + "/vtkSlicerCLIModuleLogicServerModeTest1";
+  itksys::SystemTools::RemoveADirectory(temporaryPath.c_str());
+  CHECK_BOOL(itksys::SystemTools::MakeDirectory(temporaryPath.c_str()), true);
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLCommandLineModuleNode> nodeClass;
+  scene->RegisterNodeClass(nodeClass.GetPointer());
+
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  appLogic->SetMRMLScene(scene.GetPointer());
+  appLogic->SetTemporaryPath(temporaryPath.c_str());
+  appLogic->CreateProcessingThread();
+
+  vtkNew<vtkSlicerCLIModuleLogic> logic;
+  logic->SetMRMLScene(scene.GetPointer());
+  logic->SetMRMLApplicationLogic(appLogic.GetPointer());
+  logic->SetDefaultModuleDescription(CreateModuleDescription(argv[1]));
+
+  vtkSmartPointer<vtkMRMLCommandLineModuleNode> node;
+  node.TakeReference(logic->CreateNode());
+  scene->AddNode(node);
+
+  // Disabled by default: a process per execution
+  CHECK_INT(logic->GetServerModeEnabled(), 0);
+  int firstProcessId = Run(appLogic.GetPointer(), logic.GetPointer(), node, temporaryPath, 1);
+  int secondProcessId = Run(appLogic.GetPointer(), logic.GetPointer(), node, temporaryPath, 2);
+  CHECK_BOOL(firstProcessId > 0 && secondProcessId > 0, true);
+  CHECK_BOOL(firstProcessId != secondProcessId, true);
+
+  logic->SetServerModeEnabled(1);
+  firstProcessId = Run(appLogic.GetPointer(), logic.GetPointer(), node, temporaryPath, 3);
+  secondProcessId = Run(appLogic.GetPointer(), logic.GetPointer(), node, temporaryPath, 4);
+  CHECK_BOOL(firstProcessId > 0 && secondProcessId > 0, true);
+#if defined(__linux__)
+  // The executable started by the first execution runs the second one
+  CHECK_INT(secondProcessId, firstProcessId);
+#else
+  // Server mode is not supported, the executable is started each time
+  CHECK_BOOL(firstProcessId != secondProcessId, true);
+#endif
+
+  // Disabling server mode stops the servers
+  logic->SetServerModeEnabled(0);
+  int thirdProcessId = Run(appLogic.GetPointer(), logic.GetPointer(), node, temporaryPath, 5);
+  CHECK_BOOL(thirdProcessId > 0, true);
+  CHECK_BOOL(thirdProcessId != secondProcessId, true);
+
+  appLogic->TerminateProcessingThread();
+  appLogic->ProcessModified();
+  appLogic->ProcessReadData();
+  logic->SetMRMLApplicationLogic(0);
+  itksys::SystemTools::RemoveADirectory(temporaryPath.c_str());
+
+  return EXIT_SUCCESS;
+}
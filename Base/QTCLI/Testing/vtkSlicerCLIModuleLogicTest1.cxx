@@ -0,0 +1,104 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Slicer includes
+#include "vtkSlicerCLIModuleLogic.h"
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+
+// STD includes
+#include <map>
+#include <string>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+int TestGetTagValue()
+{
+  const std::string stage =
+    "<filter-start>\n"
+    "<filter-name>Smoothing</filter-name>\n"
+    "<filter-comment>Smoothing</filter-comment>\n"
+    "</filter-start>\n"
+    "<filter-end>\n"
+    "<filter-name>Smoothing</filter-name>\n"
+    "<filter-time>1.5</filter-time>\n"
+    "<filter-memory>12.25</filter-memory>\n"
+    "</filter-end>\n";
+
+  // The first element is returned
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::GetTagValue(stage, "filter-name"), "Smoothing");
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::GetTagValue(stage, "filter-time"), "1.5");
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::GetTagValue(stage, "filter-memory"), "12.25");
+
+  // Missing or unterminated elements
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::GetTagValue(stage, "filter-progress"), "");
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::GetTagValue(
+    "<filter-time>1.5", "filter-time"), "");
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::GetTagValue(
+    "<filter-time></filter-time>", "filter-time"), "");
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::GetTagValue("", "filter-time"), "");
+
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestFindPartialOutputNodeID()
+{
+  std::map<std::string, std::string> nodesToReload;
+  nodesToReload["vtkMRMLScalarVolumeNode1"] = "/tmp/slicer/1234_output.nrrd";
+  nodesToReload["vtkMRMLScalarVolumeNode2"] = "/tmp/slicer/1234_mask.nrrd";
+  nodesToReload["vtkMRMLCommandLineModuleNode1"] = "/tmp/slicer/1234_abc.params";
+
+  // Partial outputs are matched to the output written in the same directory
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::FindPartialOutputNodeID(
+    nodesToReload, "/tmp/slicer/partial1_1234_output.nrrd"), "vtkMRMLScalarVolumeNode1");
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::FindPartialOutputNodeID(
+    nodesToReload, "/tmp/slicer/partial27_1234_mask.nrrd"), "vtkMRMLScalarVolumeNode2");
+
+  // Other directory
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::FindPartialOutputNodeID(
+    nodesToReload, "/tmp/other/partial1_1234_output.nrrd"), "");
+  // Unknown output
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::FindPartialOutputNodeID(
+    nodesToReload, "/tmp/slicer/partial1_1234_input.nrrd"), "");
+  // Malformed partial output names
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::FindPartialOutputNodeID(
+    nodesToReload, "/tmp/slicer/1234_output.nrrd"), "");
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::FindPartialOutputNodeID(
+    nodesToReload, "/tmp/slicer/partial_1234_output.nrrd"), "");
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::FindPartialOutputNodeID(
+    nodesToReload, "/tmp/slicer/partialA_1234_output.nrrd"), "");
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::FindPartialOutputNodeID(
+    nodesToReload, "/tmp/slicer/partial1"), "");
+
+  // No output
+  std::map<std::string, std::string> noNodes;
+  CHECK_STD_STRING(vtkSlicerCLIModuleLogic::FindPartialOutputNodeID(
+    noNodes, "/tmp/slicer/partial1_1234_output.nrrd"), "");
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+// Check the parsing of the stage reports and partial outputs written by
+// executable CLIs.
+int vtkSlicerCLIModuleLogicTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  CHECK_EXIT_SUCCESS(TestGetTagValue());
+  CHECK_EXIT_SUCCESS(TestFindPartialOutputNodeID());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,193 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Qt includes
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+
+// CTK includes
+#include <ctkUtils.h>
+
+// Slicer includes
+#include "vtkSlicerCLIModuleResultCache.h"
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+
+// VTK includes
+#include <vtkNew.h>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+const std::string Key1 = vtkSlicerCLIModuleResultCache::ComputeDigest("key1");
+const std::string Key2 = vtkSlicerCLIModuleResultCache::ComputeDigest("key2");
+
+//-----------------------------------------------------------------------------
+bool WriteFile(const QString& fileName, const QByteArray& content)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+    return false;
+    }
+  return file.write(content) == content.size();
+}
+
+//-----------------------------------------------------------------------------
+QByteArray ReadFile(const QString& fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return QByteArray();
+    }
+  return file.readAll();
+}
+
+//-----------------------------------------------------------------------------
+int TestDigests(const QDir& testDir)
+{
+  // SHA-1 of "abc"
+  CHECK_STD_STRING(vtkSlicerCLIModuleResultCache::ComputeDigest("abc"),
+                   "a9993e364706816aba3e25717850c26c9cd0d89d");
+
+  QString inputFile = testDir.filePath("input.txt");
+  CHECK_BOOL(WriteFile(inputFile, "abc"), true);
+  CHECK_STD_STRING(vtkSlicerCLIModuleResultCache::ComputeFileDigest(inputFile.toStdString()),
+                   vtkSlicerCLIModuleResultCache::ComputeDigest("abc"));
+  CHECK_STD_STRING(vtkSlicerCLIModuleResultCache::ComputeFileDigest(
+                     testDir.filePath("missing.txt").toStdString()), "");
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestStoreAndRetrieve(const QDir& testDir)
+{
+  vtkNew<vtkSlicerCLIModuleResultCache> cache;
+  cache->SetCacheDirectory(testDir.filePath("cache").toLatin1());
+  CHECK_BOOL(cache->HasEntry(Key1), false);
+
+  QString outputFile = testDir.filePath("output.nrrd");
+  CHECK_BOOL(WriteFile(outputFile, "output data"), true);
+
+  vtkSlicerCLIModuleResultCache::FileNameMap files;
+  files["outputVolume.nrrd"] = outputFile.toStdString();
+  CHECK_BOOL(cache->RetrieveEntry(Key1, files), false);
+  CHECK_BOOL(cache->StoreEntry(Key1, files), true);
+  CHECK_BOOL(cache->HasEntry(Key1), true);
+  CHECK_DOUBLE(cache->GetCacheSize(), 11.);
+
+  // Retrieve overwrites the destination files
+  CHECK_BOOL(WriteFile(outputFile, "stale"), true);
+  CHECK_BOOL(cache->RetrieveEntry(Key1, files), true);
+  CHECK_BOOL(ReadFile(outputFile) == "output data", true);
+
+  // Missing file in the entry
+  vtkSlicerCLIModuleResultCache::FileNameMap missingFiles;
+  missingFiles["otherVolume.nrrd"] = outputFile.toStdString();
+  CHECK_BOOL(cache->RetrieveEntry(Key1, missingFiles), false);
+
+  cache->Clear();
+  CHECK_BOOL(cache->HasEntry(Key1), false);
+  CHECK_DOUBLE(cache->GetCacheSize(), 0.);
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestPrune(const QDir& testDir)
+{
+  vtkNew<vtkSlicerCLIModuleResultCache> cache;
+  cache->SetCacheDirectory(testDir.filePath("prunedcache").toLatin1());
+  CHECK_INT(cache->GetMaximumCacheSize(), 1024);
+
+  QString outputFile = testDir.filePath("output.nrrd");
+  CHECK_BOOL(WriteFile(outputFile, "output data"), true);
+  vtkSlicerCLIModuleResultCache::FileNameMap files;
+  files["outputVolume.nrrd"] = outputFile.toStdString();
+  CHECK_BOOL(cache->StoreEntry(Key1, files), true);
+  CHECK_BOOL(cache->StoreEntry(Key2, files), true);
+  CHECK_DOUBLE(cache->GetCacheSize(), 22.);
+
+  // No space left: all the entries are removed
+  cache->SetMaximumCacheSize(0);
+  cache->Prune();
+  CHECK_BOOL(cache->HasEntry(Key1), false);
+  CHECK_BOOL(cache->HasEntry(Key2), false);
+  CHECK_DOUBLE(cache->GetCacheSize(), 0.);
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestForeignFiles(const QDir& testDir)
+{
+  vtkNew<vtkSlicerCLIModuleResultCache> cache;
+  // The cache directory may be shared with other files, e.g. if it is set
+  // to the temporary directory
+  cache->SetCacheDirectory(testDir.absolutePath().toLatin1());
+  cache->SetMaximumCacheSize(0);
+
+  QString outputFile = testDir.filePath("output.nrrd");
+  CHECK_BOOL(WriteFile(outputFile, "output data"), true);
+  vtkSlicerCLIModuleResultCache::FileNameMap files;
+  files["outputVolume.nrrd"] = outputFile.toStdString();
+
+  // Keys must be digests
+  CHECK_BOOL(cache->StoreEntry("", files), false);
+  CHECK_BOOL(cache->StoreEntry("userData", files), false);
+  CHECK_BOOL(cache->HasEntry("userData"), false);
+
+  // Directories that are not named after a key or that are not marked as
+  // entries are not entries
+  CHECK_BOOL(testDir.mkdir("userData"), true);
+  CHECK_BOOL(WriteFile(testDir.filePath("userData/data.txt"), "user data"), true);
+  CHECK_BOOL(WriteFile(testDir.filePath("userData/.lastused"), ""), true);
+  CHECK_BOOL(testDir.mkdir(QString::fromStdString(Key1)), true);
+  CHECK_BOOL(WriteFile(testDir.filePath(QString::fromStdString(Key1) + "/data.txt"), "user data"), true);
+  CHECK_DOUBLE(cache->GetCacheSize(), 0.);
+
+  cache->Prune();
+  cache->Clear();
+  CHECK_BOOL(QFile::exists(testDir.filePath("userData/data.txt")), true);
+  CHECK_BOOL(QFile::exists(testDir.filePath(QString::fromStdString(Key1) + "/data.txt")), true);
+  CHECK_BOOL(QFile::exists(outputFile), true);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCLIModuleResultCacheTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  QDir tempDir = QDir::temp();
+  QString testDirName = QString("vtkSlicerCLIModuleResultCacheTest1-%1")
+    .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmsszzz"));
+  if (!tempDir.mkdir(testDirName))
+    {
+    std::cerr << "Failed to create test directory " << qPrintable(testDirName) << std::endl;
+    return EXIT_FAILURE;
+    }
+  QDir testDir(tempDir.filePath(testDirName));
+
+  int result = EXIT_SUCCESS;
+  if (TestDigests(testDir) != EXIT_SUCCESS
+      || TestStoreAndRetrieve(testDir) != EXIT_SUCCESS
+      || TestPrune(testDir) != EXIT_SUCCESS
+      || TestForeignFiles(testDir) != EXIT_SUCCESS)
+    {
+    result = EXIT_FAILURE;
+    }
+  ctk::removeDirRecursively(testDir.absolutePath());
+  return result;
+}
@@ -31,6 +31,7 @@
 #include "qMRMLNodeComboBox.h"
 #include "qSlicerCLIModuleWidget.h"
 #include "vtkSlicerCLIModuleLogic.h"
+#include "vtkSlicerCLIModuleResultCache.h"
 
 // SlicerExecutionModel includes
 #include <ModuleDescription.h>
@@ -106,6 +107,32 @@ vtkMRMLAbstractLogic* qSlicerCLIModule::createLogic()
     {
     logic->SetAllowInMemoryTransfer(0);
     }
+  // Executable CLIs can exchange volumes through shared memory instead of
+  // temporary files (opt-in)
+  else if (settings.value("Modules/AllowSharedMemoryTransfer", false).toBool())
+    {
+    logic->SetAllowSharedMemoryTransfer(1);
+    }
+
+  // Keep executable CLIs running between executions (opt-in, only for the
+  // modules that allow it)
+  if (settings.value("Modules/CLIServerModeEnabled", false).toBool())
+    {
+    logic->SetServerModeEnabled(1);
+    }
+
+  // Reuse the outputs of identical executions (opt-in)
+  if (settings.value("Modules/CLIResultCacheEnabled", false).toBool())
+    {
+    logic->SetResultCacheEnabled(1);
+    QString cacheDirectory = settings.value("Modules/CLIResultCacheDirectory").toString();
+    if (!cacheDirectory.isEmpty())
+      {
+      logic->GetResultCache()->SetCacheDirectory(cacheDirectory.toLatin1());
+      }
+    logic->GetResultCache()->SetMaximumCacheSize(
+      settings.value("Modules/CLIResultCacheSize", 1024).toInt());
+    }
 
   return logic;
 }
@@ -0,0 +1,265 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkSlicerCLIModuleBatch.h"
+
+// MRMLCLI includes
+#include <vtkMRMLCommandLineModuleNode.h>
+
+// MRML includes
+#include <vtkMRMLScene.h>
+
+// SlicerExecutionModel includes
+#include <ModuleDescription.h>
+#include <ModuleProcessInformation.h>
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <cstring>
+#include <sstream>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerCLIModuleBatch);
+
+//----------------------------------------------------------------------------
+vtkSlicerCLIModuleBatch::vtkSlicerCLIModuleBatch()
+{
+  this->TemplateNode = 0;
+  this->JobCallback = vtkCallbackCommand::New();
+  this->JobCallback->SetClientData(this);
+  this->JobCallback->SetCallback(vtkSlicerCLIModuleBatch::OnJobModified);
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCLIModuleBatch::~vtkSlicerCLIModuleBatch()
+{
+  this->RemoveAllJobs();
+  this->SetTemplateNode(0);
+  this->JobCallback->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleBatch::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "TemplateNode: "
+     << (this->TemplateNode ? this->TemplateNode->GetID() : "(none)") << "\n";
+  os << indent << "NumberOfJobs: " << this->GetNumberOfJobs() << "\n";
+  os << indent << "NumberOfFinishedJobs: " << this->GetNumberOfFinishedJobs() << "\n";
+  os << indent << "Progress: " << this->GetProgress() << "\n";
+}
+
+//----------------------------------------------------------------------------
+const char* vtkSlicerCLIModuleBatch::GetJobAttributeName()
+{
+  return "CLIBatchJob";
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIModuleBatch::IsBatchJob(vtkMRMLCommandLineModuleNode* node)
+{
+  const char* batchJob = node ?
+    node->GetAttribute(vtkSlicerCLIModuleBatch::GetJobAttributeName()) : 0;
+  return batchJob && strcmp(batchJob, "true") == 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleBatch::SetTemplateNode(vtkMRMLCommandLineModuleNode* node)
+{
+  if (node == this->TemplateNode)
+    {
+    return;
+    }
+  if (this->TemplateNode)
+    {
+    this->TemplateNode->UnRegister(this);
+    }
+  this->TemplateNode = node;
+  if (this->TemplateNode)
+    {
+    this->TemplateNode->Register(this);
+    }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLCommandLineModuleNode* vtkSlicerCLIModuleBatch::GetTemplateNode()const
+{
+  return this->TemplateNode;
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleBatch::AddJob()
+{
+  if (!this->TemplateNode || !this->TemplateNode->GetScene())
+    {
+    vtkErrorMacro("AddJob: a template node in a scene is required");
+    return -1;
+    }
+  vtkMRMLScene* scene = this->TemplateNode->GetScene();
+  vtkMRMLCommandLineModuleNode* job = vtkMRMLCommandLineModuleNode::SafeDownCast(
+    scene->CreateNodeByClass("vtkMRMLCommandLineModuleNode"));
+  job->Copy(this->TemplateNode);
+  // A job is run by the batch only.
+  job->SetAutoRun(false);
+
+  std::stringstream name;
+  name << (this->TemplateNode->GetName() ? this->TemplateNode->GetName() : "CLI")
+       << "_BatchJob" << this->Jobs.size();
+  job->SetName(scene->GetUniqueNameByString(name.str().c_str()));
+  job->SetAttribute(vtkSlicerCLIModuleBatch::GetJobAttributeName(), "true");
+  job->SetHideFromEditors(1);
+  job->SetSaveWithScene(0);
+  scene->AddNode(job);
+
+  job->AddObserver(vtkCommand::ModifiedEvent, this->JobCallback);
+  this->Jobs.push_back(job);
+  this->Modified();
+  return static_cast<int>(this->Jobs.size()) - 1;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIModuleBatch
+::SetJobParameter(int job, const char* name, const std::string& value)
+{
+  vtkMRMLCommandLineModuleNode* jobNode = this->GetJob(job);
+  if (!jobNode)
+    {
+    vtkErrorMacro("SetJobParameter: invalid job " << job);
+    return false;
+    }
+  return jobNode->SetParameterAsString(name, value);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleBatch::RemoveAllJobs()
+{
+  if (this->Jobs.empty())
+    {
+    return;
+    }
+  this->Cancel();
+  for (std::vector<vtkMRMLCommandLineModuleNode*>::iterator it = this->Jobs.begin();
+       it != this->Jobs.end(); ++it)
+    {
+    vtkMRMLCommandLineModuleNode* job = *it;
+    job->RemoveObservers(vtkCommand::ModifiedEvent, this->JobCallback);
+    if (job->GetScene())
+      {
+      job->GetScene()->RemoveNode(job);
+      }
+    job->Delete();
+    }
+  this->Jobs.clear();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleBatch::GetNumberOfJobs()const
+{
+  return static_cast<int>(this->Jobs.size());
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLCommandLineModuleNode* vtkSlicerCLIModuleBatch::GetJob(int job)const
+{
+  if (job < 0 || job >= this->GetNumberOfJobs())
+    {
+    return 0;
+    }
+  return this->Jobs[job];
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleBatch::GetNumberOfJobsWithStatus(int status)const
+{
+  int count = 0;
+  for (std::vector<vtkMRMLCommandLineModuleNode*>::const_iterator it = this->Jobs.begin();
+       it != this->Jobs.end(); ++it)
+    {
+    if ((*it)->GetStatus() == status)
+      {
+      ++count;
+      }
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleBatch::GetNumberOfFinishedJobs()const
+{
+  return this->GetNumberOfJobsWithStatus(vtkMRMLCommandLineModuleNode::Completed)
+    + this->GetNumberOfJobsWithStatus(vtkMRMLCommandLineModuleNode::CompletedWithErrors)
+    + this->GetNumberOfJobsWithStatus(vtkMRMLCommandLineModuleNode::Cancelled);
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIModuleBatch::IsCompleted()const
+{
+  return !this->Jobs.empty()
+    && this->GetNumberOfFinishedJobs() == this->GetNumberOfJobs();
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerCLIModuleBatch::GetProgress()const
+{
+  if (this->Jobs.empty())
+    {
+    return 0.;
+    }
+  double progress = 0.;
+  for (std::vector<vtkMRMLCommandLineModuleNode*>::const_iterator it = this->Jobs.begin();
+       it != this->Jobs.end(); ++it)
+    {
+    vtkMRMLCommandLineModuleNode* job = *it;
+    int status = job->GetStatus();
+    if (status == vtkMRMLCommandLineModuleNode::Completed
+        || status == vtkMRMLCommandLineModuleNode::CompletedWithErrors
+        || status == vtkMRMLCommandLineModuleNode::Cancelled)
+      {
+      progress += 1.;
+      }
+    else if (status == vtkMRMLCommandLineModuleNode::Running)
+      {
+      ModuleProcessInformation* info =
+        job->GetModuleDescription().GetProcessInformation();
+      progress += info->Progress < 0. ? 0. : (info->Progress > 1. ? 1. : info->Progress);
+      }
+    }
+  return progress / this->Jobs.size();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleBatch::Cancel()
+{
+  for (std::vector<vtkMRMLCommandLineModuleNode*>::iterator it = this->Jobs.begin();
+       it != this->Jobs.end(); ++it)
+    {
+    if ((*it)->IsBusy())
+      {
+      (*it)->Cancel();
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleBatch::OnJobModified(vtkObject* vtkNotUsed(caller),
+                                            unsigned long vtkNotUsed(eid),
+                                            void* clientData,
+                                            void* vtkNotUsed(callData))
+{
+  vtkSlicerCLIModuleBatch* self = reinterpret_cast<vtkSlicerCLIModuleBatch*>(clientData);
+  self->Modified();
+}
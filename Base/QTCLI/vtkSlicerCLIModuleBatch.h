@@ -0,0 +1,115 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkSlicerCLIModuleBatch_h
+#define __vtkSlicerCLIModuleBatch_h
+
+// VTK includes
+#include <vtkObject.h>
+
+// STL includes
+#include <string>
+#include <vector>
+
+#include "qSlicerBaseQTCLIExport.h"
+
+class vtkCallbackCommand;
+class vtkMRMLCommandLineModuleNode;
+
+/// \brief Set of executions of a CLI over many datasets.
+///
+/// A batch is made of jobs, each job being a copy of a template command
+/// line module node. The parameters of the template (e.g. thresholds,
+/// iterations) are shared by all the jobs while the image, geometry,
+/// transform, table, measurement and point file parameters of each job can
+/// be bound to file names with SetJobParameter(). Such parameters are
+/// passed as is to the CLI, the data is read from and written to the files
+/// directly, without being loaded into the scene.
+///
+/// The job nodes are added into the scene of the template node, hidden from
+/// editors and not saved with the scene; they are removed when the jobs are
+/// removed or when the batch is deleted.
+///
+/// The batch is run with vtkSlicerCLIModuleLogic::ApplyBatch(), each job
+/// being a separate task of the application logic, the jobs are run
+/// concurrently by the task worker threads.
+/// The batch invokes ModifiedEvent each time the status or the progress of
+/// a job changes.
+/// \sa vtkSlicerCLIModuleLogic::ApplyBatch()
+class Q_SLICER_BASE_QTCLI_EXPORT vtkSlicerCLIModuleBatch : public vtkObject
+{
+public:
+  static vtkSlicerCLIModuleBatch *New();
+  vtkTypeMacro(vtkSlicerCLIModuleBatch, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /// Name of the attribute set to "true" on the job nodes.
+  static const char* GetJobAttributeName();
+
+  /// Return true if \a node is a job of a batch.
+  static bool IsBatchJob(vtkMRMLCommandLineModuleNode* node);
+
+  /// Node whose parameters are copied into the new jobs. It must be in a
+  /// scene.
+  void SetTemplateNode(vtkMRMLCommandLineModuleNode* node);
+  vtkMRMLCommandLineModuleNode* GetTemplateNode()const;
+
+  /// Create a new job from the template node and return its index, or -1
+  /// if there is no template node.
+  int AddJob();
+
+  /// Bind the parameter \a name of a job to a value. For image, geometry,
+  /// transform, table, measurement and point file parameters the value is
+  /// a file name.
+  bool SetJobParameter(int job, const char* name, const std::string& value);
+
+  /// Remove all the jobs from the batch and from the scene.
+  /// Jobs that are running are cancelled first.
+  void RemoveAllJobs();
+
+  int GetNumberOfJobs()const;
+  vtkMRMLCommandLineModuleNode* GetJob(int job)const;
+
+  /// Number of jobs whose status is \a status.
+  /// \sa vtkMRMLCommandLineModuleNode::StatusType
+  int GetNumberOfJobsWithStatus(int status)const;
+
+  /// Number of jobs that are Completed, CompletedWithErrors or Cancelled.
+  int GetNumberOfFinishedJobs()const;
+
+  /// Return true if there is at least one job and all the jobs are finished.
+  bool IsCompleted()const;
+
+  /// Aggregated progress of the jobs between 0 and 1, finished jobs count
+  /// as fully progressed.
+  double GetProgress()const;
+
+  /// Cancel all the jobs that are still busy.
+  void Cancel();
+
+protected:
+  vtkSlicerCLIModuleBatch();
+  virtual ~vtkSlicerCLIModuleBatch();
+
+  static void OnJobModified(vtkObject* caller, unsigned long eid,
+                            void* clientData, void* callData);
+
+  vtkMRMLCommandLineModuleNode* TemplateNode;
+  std::vector<vtkMRMLCommandLineModuleNode*> Jobs;
+  vtkCallbackCommand* JobCallback;
+
+private:
+  vtkSlicerCLIModuleBatch(const vtkSlicerCLIModuleBatch&);
+  void operator=(const vtkSlicerCLIModuleBatch&);
+};
+
+#endif
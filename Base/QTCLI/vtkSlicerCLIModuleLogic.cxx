@@ -10,13 +10,18 @@
 
 =========================================================================auto=*/
 
+#include "vtkSlicerCLIModuleBatch.h"
 #include "vtkSlicerCLIModuleLogic.h"
+#include "vtkSlicerCLIModuleResultCache.h"
 
 #include "vtkSlicerTask.h"
 
 // SlicerExecutionModel includes
 #include <ModuleDescription.h>
 
+// SlicerBaseCLI includes
+#include <SlicerCLIServerProtocol.h>
+
 // MRML includes
 #include <vtkEventBroker.h>
 #include <vtkMRMLColorNode.h>
@@ -30,21 +35,34 @@
 #include <vtkMRMLStorageNode.h>
 #include <vtkMRMLModelStorageNode.h>
 #include <vtkMRMLTransformNode.h>
+#include <vtkMRMLVolumeNode.h>
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
 #include <vtkIntArray.h>
 #include <vtkMultiThreader.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkPointData.h>
 #include <vtkStringArray.h>
+#include <vtkTimeStamp.h>
 #include <vtksys/SystemTools.hxx>
 
+// ITK includes
+#include <itkSimpleFastMutexLock.h>
+
 // ITKSYS includes
 #include <itksys/Process.h>
 #include <itksys/SystemTools.hxx>
 #include <itksys/RegularExpression.hxx>
 
+#ifndef _WIN32
+// MRMLIDImageIO includes
+#include <itkSharedMemoryImageSegment.h>
+#endif
+
 // QT includes
 #include <QDebug>
 
@@ -55,12 +73,15 @@
 // STL includes
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <ctime>
 #include <set>
 
 #ifdef _WIN32
 #else
+#include <sys/socket.h>
 #include <sys/types.h>
+#include <fcntl.h>
 #include <unistd.h>
 #endif
 
@@ -81,6 +102,570 @@ struct DigitsToCharacters
 typedef std::pair<vtkSlicerCLIModuleLogic *, vtkMRMLCommandLineModuleNode *> LogicNodePair;
 class MRMLIDMap : public std::map<std::string, std::string> {};
 
+//----------------------------------------------------------------------------
+namespace
+{
+
+/// The environment of the executable CLIs is set by changing the
+/// environment of the Slicer process around their start (itksysProcess
+/// has no option to pass an environment to the child process). The lock
+/// serializes these windows between CLIs started concurrently, possibly
+/// by different logics.
+itk::SimpleFastMutexLock ChildEnvironmentLock;
+
+//----------------------------------------------------------------------------
+/// Return a number never returned before in the process, even if called
+/// from different threads.
+vtkMTimeType GetUniqueExecutionNumber()
+{
+  // vtkTimeStamp::Modified() increments a global counter atomically.
+  vtkTimeStamp stamp;
+  stamp.Modified();
+  return stamp.GetMTime();
+}
+
+//----------------------------------------------------------------------------
+/// Return a string unique to the execution of a module that can be
+/// used in temporary file names. To avoid confusing the Archetype
+/// reader, it doesn't contain digits.
+std::string GetUniqueExecutionTag()
+{
+  std::ostringstream tag;
+  tag << "X" << GetUniqueExecutionNumber();
+  std::string tagString = tag.str();
+  std::transform(tagString.begin(), tagString.end(),
+                 tagString.begin(), DigitsToCharacters());
+  return tagString;
+}
+
+//----------------------------------------------------------------------------
+/// Insert \a executionTag after the process id of the temporary file name
+/// \a fname built by ConstructTemporaryFileName() so that modules running
+/// at the same time don't share files. Node references (slicer:) and shared
+/// memory segments (slicershm:) are left untouched, they are unique already.
+std::string MakeTemporaryFileNameUnique(const std::string& fname,
+                                        const std::string& executionTag)
+{
+  if (fname.compare(0, 7, "slicer:") == 0 || fname.compare(0, 10, "slicershm:") == 0)
+    {
+    return fname;
+    }
+  std::string::size_type nameStart = fname.find_last_of("/\\");
+  nameStart = (nameStart == std::string::npos) ? 0 : nameStart + 1;
+  std::string::size_type pidEnd = fname.find('_', nameStart);
+  if (pidEnd == std::string::npos)
+    {
+    return fname;
+    }
+  return fname.substr(0, pidEnd + 1) + executionTag + fname.substr(pidEnd);
+}
+
+//----------------------------------------------------------------------------
+bool IsSharedMemoryFileName(const std::string& fname)
+{
+#ifndef _WIN32
+  return itk::SharedMemoryImageSegment::IsSharedMemoryFileName(fname);
+#else
+  (void)fname;
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool IsSharedMemoryTransferPossible(vtkMRMLNode* node)
+{
+#ifndef _WIN32
+  // Only plain volumes, the attributes of the other volume types
+  // (measurement frame, gradients...) are not stored in the segment.
+  if (!node)
+    {
+    return false;
+    }
+  std::string className = node->GetClassName();
+  return className == "vtkMRMLScalarVolumeNode"
+    || className == "vtkMRMLLabelMapVolumeNode"
+    || className == "vtkMRMLVectorVolumeNode";
+#else
+  (void)node;
+  return false;
+#endif
+}
+
+#ifndef _WIN32
+//----------------------------------------------------------------------------
+unsigned int GetSharedMemoryComponentType(int vtkScalarType)
+{
+  typedef itk::SharedMemoryImageHeader Header;
+  switch (vtkScalarType)
+    {
+    case VTK_UNSIGNED_CHAR: return Header::UCharComponent;
+    case VTK_CHAR:
+    case VTK_SIGNED_CHAR: return Header::CharComponent;
+    case VTK_UNSIGNED_SHORT: return Header::UShortComponent;
+    case VTK_SHORT: return Header::ShortComponent;
+    case VTK_UNSIGNED_INT: return Header::UIntComponent;
+    case VTK_INT: return Header::IntComponent;
+    case VTK_UNSIGNED_LONG:
+      return sizeof(unsigned long) == 8 ? Header::ULongLongComponent : Header::UIntComponent;
+    case VTK_LONG:
+      return sizeof(long) == 8 ? Header::LongLongComponent : Header::IntComponent;
+    case VTK_UNSIGNED_LONG_LONG: return Header::ULongLongComponent;
+    case VTK_LONG_LONG: return Header::LongLongComponent;
+    case VTK_FLOAT: return Header::FloatComponent;
+    case VTK_DOUBLE: return Header::DoubleComponent;
+    default: return Header::UnknownComponent;
+    }
+}
+
+//----------------------------------------------------------------------------
+int GetVTKScalarType(unsigned int sharedMemoryComponentType)
+{
+  typedef itk::SharedMemoryImageHeader Header;
+  switch (sharedMemoryComponentType)
+    {
+    case Header::UCharComponent: return VTK_UNSIGNED_CHAR;
+    case Header::CharComponent: return VTK_CHAR;
+    case Header::UShortComponent: return VTK_UNSIGNED_SHORT;
+    case Header::ShortComponent: return VTK_SHORT;
+    case Header::UIntComponent: return VTK_UNSIGNED_INT;
+    case Header::IntComponent: return VTK_INT;
+    case Header::ULongLongComponent: return VTK_UNSIGNED_LONG_LONG;
+    case Header::LongLongComponent: return VTK_LONG_LONG;
+    case Header::FloatComponent: return VTK_FLOAT;
+    case Header::DoubleComponent: return VTK_DOUBLE;
+    default: return VTK_VOID;
+    }
+}
+#endif
+
+//----------------------------------------------------------------------------
+/// Copy the voxels and the geometry of a volume into a new shared memory
+/// segment. Geometry is converted from RAS to LPS.
+bool WriteSharedMemoryImage(vtkMRMLVolumeNode* volumeNode, const std::string& fname)
+{
+#ifndef _WIN32
+  vtkImageData* imageData = volumeNode ? volumeNode->GetImageData() : 0;
+  if (!imageData || !imageData->GetPointData()->GetScalars())
+    {
+    return false;
+    }
+  itk::SharedMemoryImageHeader header;
+  memset(&header, 0, sizeof(header));
+  header.ComponentType = GetSharedMemoryComponentType(imageData->GetScalarType());
+  if (header.ComponentType == itk::SharedMemoryImageHeader::UnknownComponent)
+    {
+    return false;
+    }
+  header.NumberOfComponents = imageData->GetNumberOfScalarComponents();
+  header.Dimension = 3;
+  int dimensions[3] = {0, 0, 0};
+  imageData->GetDimensions(dimensions);
+  double directions[3][3];
+  volumeNode->GetIJKToRASDirections(directions);
+  const double rasToLps[3] = {-1.0, -1.0, 1.0};
+  for (int i = 0; i < 3; ++i)
+    {
+    header.Size[i] = dimensions[i];
+    header.Spacing[i] = volumeNode->GetSpacing()[i];
+    header.Origin[i] = rasToLps[i] * volumeNode->GetOrigin()[i];
+    for (int j = 0; j < 3; ++j)
+      {
+      header.Direction[i * 3 + j] = rasToLps[i] * directions[i][j];
+      }
+    }
+
+  itk::SharedMemoryImageSegment segment;
+  if (!segment.Create(fname, header))
+    {
+    return false;
+    }
+  memcpy(segment.GetData(), imageData->GetScalarPointer(),
+         static_cast<size_t>(segment.GetHeader()->DataSize));
+  return true;
+#else
+  (void)volumeNode;
+  (void)fname;
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+/// Replace the voxels and the geometry of a volume by a copy of the image
+/// stored in a shared memory segment. Geometry is converted from LPS to RAS.
+bool ReadSharedMemoryImage(vtkMRMLVolumeNode* volumeNode, const std::string& fname)
+{
+#ifndef _WIN32
+  itk::SharedMemoryImageSegment segment;
+  if (!volumeNode || !segment.Open(fname))
+    {
+    return false;
+    }
+  const itk::SharedMemoryImageHeader* header = segment.GetHeader();
+  int scalarType = GetVTKScalarType(header->ComponentType);
+  if (scalarType == VTK_VOID)
+    {
+    return false;
+    }
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(static_cast<int>(header->Size[0]),
+                           static_cast<int>(header->Size[1]),
+                           static_cast<int>(header->Size[2]));
+  imageData->AllocateScalars(scalarType, header->NumberOfComponents);
+  vtkIdType dataSize = imageData->GetPointData()->GetScalars()->GetDataSize()
+    * imageData->GetPointData()->GetScalars()->GetDataTypeSize();
+  if (static_cast<unsigned long long>(dataSize) != header->DataSize)
+    {
+    return false;
+    }
+  memcpy(imageData->GetScalarPointer(), segment.GetData(), static_cast<size_t>(dataSize));
+
+  double directions[3][3];
+  double origin[3];
+  const double lpsToRas[3] = {-1.0, -1.0, 1.0};
+  for (int i = 0; i < 3; ++i)
+    {
+    origin[i] = lpsToRas[i] * header->Origin[i];
+    for (int j = 0; j < 3; ++j)
+      {
+      directions[i][j] = lpsToRas[i] * header->Direction[i * 3 + j];
+      }
+    }
+  int wasModifying = volumeNode->StartModify();
+  volumeNode->SetIJKToRASDirections(directions);
+  volumeNode->SetSpacing(header->Spacing[0], header->Spacing[1], header->Spacing[2]);
+  volumeNode->SetOrigin(origin);
+  volumeNode->SetAndObserveImageData(imageData.GetPointer());
+  volumeNode->EndModify(wasModifying);
+  return true;
+#else
+  (void)volumeNode;
+  (void)fname;
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+void RemoveSharedMemoryImage(const std::string& fname)
+{
+#ifndef _WIN32
+  itk::SharedMemoryImageSegment::Remove(fname);
+#else
+  (void)fname;
+#endif
+}
+
+//----------------------------------------------------------------------------
+/// Compute the key of the results of an execution: a digest of the module,
+/// of its parameter values and of the content of its input files.
+/// \a outputFiles is filled with the names of the output files in the
+/// cache entry and their temporary file names.
+/// Returns an empty key if the execution can't be cached (e.g. outputs
+/// written to user files or inputs that are not files).
+std::string ComputeResultCacheKey(ModuleDescription& description,
+                                  const std::map<std::string, std::string>& nodesToWrite,
+                                  const std::map<std::string, std::string>& nodesToReload,
+                                  const std::string& returnParameterFile,
+                                  std::map<std::string, std::string>& outputFiles)
+{
+  std::ostringstream key;
+  key << description.GetTitle() << "\n"
+      << description.GetVersion() << "\n"
+      << description.GetTarget() << "\n";
+  // a rebuilt executable invalidates the cached results
+  if (itksys::SystemTools::FileExists(description.GetTarget().c_str(), true))
+    {
+    key << itksys::SystemTools::ModifiedTime(description.GetTarget().c_str()) << "\n";
+    }
+
+  std::vector<ModuleParameterGroup>::iterator pgit;
+  for (pgit = description.GetParameterGroups().begin();
+       pgit != description.GetParameterGroups().end(); ++pgit)
+    {
+    std::vector<ModuleParameter>::iterator pit;
+    for (pit = (*pgit).GetParameters().begin();
+         pit != (*pgit).GetParameters().end(); ++pit)
+      {
+      const std::string& tag = (*pit).GetTag();
+      const std::string& channel = (*pit).GetChannel();
+      if ((*pit).IsReturnParameter())
+        {
+        // value of the previous execution
+        continue;
+        }
+      key << (*pit).GetName() << "=";
+      if (tag == "image" || tag == "geometry" || tag == "transform"
+          || tag == "table" || tag == "measurement" || tag == "pointfile")
+        {
+        if (channel == "input")
+          {
+          std::map<std::string, std::string>::const_iterator it =
+            nodesToWrite.find((*pit).GetValue());
+          if (it != nodesToWrite.end())
+            {
+            std::string digest = vtkSlicerCLIModuleResultCache::ComputeFileDigest(it->second);
+            if (digest.empty())
+              {
+              return std::string();
+              }
+            key << digest;
+            }
+          }
+        else if (channel == "output")
+          {
+          std::map<std::string, std::string>::const_iterator it =
+            nodesToReload.find((*pit).GetValue());
+          if (it != nodesToReload.end())
+            {
+            outputFiles[(*pit).GetName()
+                        + itksys::SystemTools::GetFilenameLastExtension(it->second)] = it->second;
+            key << "output";
+            }
+          }
+        }
+      else if (tag == "file" || tag == "directory")
+        {
+        std::string digest;
+        if (tag == "file" && channel == "input")
+          {
+          digest = vtkSlicerCLIModuleResultCache::ComputeFileDigest((*pit).GetValue());
+          }
+        if (digest.empty() && !(*pit).GetValue().empty())
+          {
+          return std::string();
+          }
+        key << digest;
+        }
+      else
+        {
+        key << (*pit).GetValue();
+        }
+      key << "\n";
+      }
+    }
+  if (!returnParameterFile.empty())
+    {
+    outputFiles["returnparameters.params"] = returnParameterFile;
+    }
+  return vtkSlicerCLIModuleResultCache::ComputeDigest(key.str());
+}
+
+//----------------------------------------------------------------------------
+/// Start \a process with the ITK_AUTOLOAD_PATH environment variable set to
+/// \a autoLoadPath, and restore the variable. The environment is shared
+/// by all the threads, executions are serialized around the start of the
+/// processes.
+/// Return false if the environment variable can't be set or restored.
+bool ExecuteWithAutoLoadPath(itksysProcess* process, const std::string& autoLoadPath)
+{
+  ChildEnvironmentLock.Lock();
+  std::string saveITKAutoLoadPath;
+  itksys::SystemTools::GetEnv("ITK_AUTOLOAD_PATH", saveITKAutoLoadPath);
+  std::string putEnvString = "ITK_AUTOLOAD_PATH=" + autoLoadPath;
+  bool success =
+    itksys::SystemTools::PutEnv(const_cast <char *> (putEnvString.c_str()));
+
+  itksysProcess_Execute(process);
+
+  // restore the load path
+  std::string restoreEnvString = "ITK_AUTOLOAD_PATH=" + saveITKAutoLoadPath;
+  success = itksys::SystemTools::PutEnv(const_cast <char *> (restoreEnvString.c_str()))
+    && success;
+  ChildEnvironmentLock.Unlock();
+  return success;
+}
+
+//----------------------------------------------------------------------------
+/// Return true if the module declares in its XML description that it can
+/// be kept running between executions, with a hidden "AllowServerMode"
+/// parameter set to "true", and if its executable is run directly. Scripted
+/// CLIs run by an interpreter (e.g. Python) are never run as servers.
+bool IsServerModeAllowed(const ModuleDescription& description,
+                         const std::vector<std::string>& commandLine)
+{
+  return description.GetType() == "CommandLineModule"
+    && description.GetParameterValue("AllowServerMode") == "true"
+    && !commandLine.empty()
+    && commandLine[0] == description.GetTarget();
+}
+
+//----------------------------------------------------------------------------
+/// Executable CLI kept running between executions.
+/// The executable is started with the "--slicer-cli-server" argument that is
+/// handled by the CLI library wrapper (see SEMCommandLineLibraryWrapper.cxx.in):
+/// it then reads the arguments of each execution from its standard input and
+/// writes the exit code of the execution on its standard output (see
+/// SlicerCLIServerProtocol.h). Only the modules that allow it are started
+/// as servers (see IsServerModeAllowed()).
+/// Only supported on POSIX systems.
+class CLIServer
+{
+public:
+  CLIServer(const std::string& key)
+    : Key(key)
+    , Process(0)
+    , InputSocket(-1)
+  {
+  }
+
+  ~CLIServer()
+  {
+    this->Stop();
+  }
+
+  /// Start the executable with the given ITK_AUTOLOAD_PATH.
+  /// \sa WaitUntilReady()
+  bool Launch(const std::string& executable, const std::string& autoLoadPath)
+  {
+#ifdef _WIN32
+    (void)executable;
+    (void)autoLoadPath;
+    return false;
+#else
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+      {
+      return false;
+      }
+    // The executable must not inherit the end used by Slicer, otherwise
+    // it would never read the end of its input.
+    fcntl(sockets[1], F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+    int noSigPipe = 1;
+    setsockopt(sockets[1], SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+    const char* command[] = { executable.c_str(), "--slicer-cli-server", 0 };
+    this->Process = itksysProcess_New();
+    itksysProcess_SetCommand(this->Process, command);
+    itksysProcess_SetOption(this->Process, itksysProcess_Option_Detach, 0);
+    itksysProcess_SetOption(this->Process, itksysProcess_Option_HideWindow, 1);
+    itksysProcess_SetPipeNative(this->Process, itksysProcess_Pipe_STDIN, sockets);
+    bool success = ExecuteWithAutoLoadPath(this->Process, autoLoadPath);
+    close(sockets[0]);
+    this->InputSocket = sockets[1];
+    if (!success
+        || itksysProcess_GetState(this->Process) != itksysProcess_State_Executing)
+      {
+      this->Stop();
+      return false;
+      }
+    return true;
+#endif
+  }
+
+  /// Wait for the handshake of the launched executable.
+  /// Return false if the executable is not ready within 10 seconds.
+  bool WaitUntilReady()
+  {
+    if (!this->Process)
+      {
+      return false;
+      }
+    std::string output;
+    char* data = 0;
+    int length = 0;
+    double timeout = 10.;
+    int pipeId;
+    while ((pipeId = itksysProcess_WaitForData(this->Process, &data, &length, &timeout))
+           != itksysProcess_Pipe_None && pipeId != itksysProcess_Pipe_Timeout)
+      {
+      if (pipeId == itksysProcess_Pipe_STDOUT)
+        {
+        output.append(data, length);
+        if (output.find(GetCLIServerReadyTag()) != std::string::npos)
+          {
+          return true;
+          }
+        }
+      }
+    this->Stop();
+    return false;
+  }
+
+  /// Request an execution with the given arguments (without the executable).
+  bool Send(const std::vector<std::string>& arguments)
+  {
+#ifdef _WIN32
+    (void)arguments;
+    return false;
+#else
+    if (this->InputSocket < 0)
+      {
+      return false;
+      }
+    std::ostringstream request;
+    WriteCLIServerRequest(request, arguments);
+    const std::string requestString = request.str();
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    size_t sent = 0;
+    while (sent < requestString.size())
+      {
+      ssize_t count = send(this->InputSocket, requestString.c_str() + sent,
+                           requestString.size() - sent, flags);
+      if (count <= 0)
+        {
+        return false;
+        }
+      sent += static_cast<size_t>(count);
+      }
+    return true;
+#endif
+  }
+
+  /// Collect the error messages written right before the result.
+  void ReadPendingErrors(std::string& errors)
+  {
+    char* data = 0;
+    int length = 0;
+    double timeout = 0.;
+    int pipeId;
+    while ((pipeId = itksysProcess_WaitForData(this->Process, &data, &length, &timeout))
+           != itksysProcess_Pipe_None && pipeId != itksysProcess_Pipe_Timeout)
+      {
+      if (pipeId == itksysProcess_Pipe_STDERR)
+        {
+        errors.append(data, length);
+        }
+      timeout = 0.;
+      }
+  }
+
+  /// Close the input of the executable so that it exits, kill it if it
+  /// doesn't.
+  void Stop()
+  {
+#ifndef _WIN32
+    if (this->InputSocket >= 0)
+      {
+      close(this->InputSocket);
+      this->InputSocket = -1;
+      }
+#endif
+    if (this->Process)
+      {
+      double timeout = 1.;
+      if (!itksysProcess_WaitForExit(this->Process, &timeout))
+        {
+        itksysProcess_Kill(this->Process);
+        itksysProcess_WaitForExit(this->Process, 0);
+        }
+      itksysProcess_Delete(this->Process);
+      this->Process = 0;
+      }
+  }
+
+  /// Executable and environment the server has been started with.
+  std::string Key;
+  itksysProcess* Process;
+  int InputSocket;
+};
+
+} // end of anonymous namespace
+
 //---------------------------------------------------------------------------
 class vtkSlicerCLIRescheduleCallback : public vtkCallbackCommand
 {
@@ -91,8 +676,11 @@ public:
   }
   virtual void Execute(vtkObject* caller, unsigned long eid, void *callData)
   {
-    if (std::find(this->ThreadIDs.begin(), this->ThreadIDs.end(),
-                  vtkMultiThreader::GetCurrentThreadID()) != this->ThreadIDs.end())
+    this->ThreadIDsLock.Lock();
+    bool reschedule = std::find(this->ThreadIDs.begin(), this->ThreadIDs.end(),
+      vtkMultiThreader::GetCurrentThreadID()) != this->ThreadIDs.end();
+    this->ThreadIDsLock.Unlock();
+    if (reschedule)
       {
       if (this->CLIModuleLogic)
         {
@@ -128,14 +716,18 @@ public:
       {
       return;
       }
+    this->ThreadIDsLock.Lock();
     if (reschedule)
       {
       this->ThreadIDs.push_back(id);
       }
     else
       {
-      std::remove(this->ThreadIDs.begin(), this->ThreadIDs.end(), id);
+      this->ThreadIDs.erase(
+        std::remove(this->ThreadIDs.begin(), this->ThreadIDs.end(), id),
+        this->ThreadIDs.end());
       }
+    this->ThreadIDsLock.Unlock();
   }
 protected:
   vtkSlicerCLIRescheduleCallback()
@@ -150,6 +742,9 @@ protected:
 
   vtkSlicerCLIModuleLogic* CLIModuleLogic;
   int Delay;
+  /// Processing threads running a module, the callback can be invoked from
+  /// any thread while modules start and complete.
+  itk::SimpleFastMutexLock ThreadIDsLock;
   std::vector<vtkMultiThreaderIDType> ThreadIDs;
 };
 
@@ -198,12 +793,181 @@ public:
   ModuleDescription DefaultModuleDescription;
   int DeleteTemporaryFiles;
   int AllowInMemoryTransfer;
+  int AllowSharedMemoryTransfer;
+  int ResultCacheEnabled;
+
+  vtkSmartPointer<vtkSlicerCLIModuleResultCache> ResultCache;
 
   int RedirectModuleStreams;
 
   itk::MutexLock::Pointer ProcessesKillLock;
   std::vector<itksysProcess*> Processes;
 
+  /// Executable CLIs waiting for their next execution, by executable and
+  /// environment.
+  int ServerModeEnabled;
+  itk::MutexLock::Pointer ServersLock;
+  std::multimap<std::string, CLIServer*> IdleServers;
+  /// Executables that can't be run as servers.
+  std::set<std::string> UnsupportedServerExecutables;
+
+  /// Return a server running \a commandLine, or 0 if the executable can't
+  /// be run as a server. An idle server is reused if one has been started
+  /// with the same ITK_AUTOLOAD_PATH, otherwise a new one is started with
+  /// \a autoLoadPath.
+  /// \sa ReleaseServer(), IsServerModeAllowed()
+  CLIServer* AcquireServer(const std::vector<std::string>& commandLine,
+                           const std::string& autoLoadPath)
+  {
+    const std::string& executable = commandLine[0];
+    std::string key = executable + "\n" + autoLoadPath;
+    CLIServer* server = 0;
+    this->ServersLock->Lock();
+    bool unsupported = this->UnsupportedServerExecutables.count(executable) > 0;
+    std::multimap<std::string, CLIServer*>::iterator it = this->IdleServers.find(key);
+    if (!unsupported && it != this->IdleServers.end())
+      {
+      server = it->second;
+      this->IdleServers.erase(it);
+      }
+    this->ServersLock->Unlock();
+    if (unsupported)
+      {
+      return 0;
+      }
+
+    std::vector<std::string> arguments(commandLine.begin() + 1, commandLine.end());
+    if (server && !server->Send(arguments))
+      {
+      // the idle server is gone
+      delete server;
+      server = 0;
+      }
+    if (!server)
+      {
+      server = new CLIServer(key);
+      if (!server->Launch(executable, autoLoadPath) || !server->WaitUntilReady())
+        {
+        delete server;
+        this->ServersLock->Lock();
+        this->UnsupportedServerExecutables.insert(executable);
+        this->ServersLock->Unlock();
+        return 0;
+        }
+      if (!server->Send(arguments))
+        {
+        delete server;
+        return 0;
+        }
+      }
+    return server;
+  }
+
+  /// Keep a server that completed an execution for the next one.
+  void ReleaseServer(CLIServer* server)
+  {
+    this->ServersLock->Lock();
+    this->IdleServers.insert(std::make_pair(server->Key, server));
+    this->ServersLock->Unlock();
+  }
+
+  /// Stop all the idle servers.
+  void StopServers()
+  {
+    this->ServersLock->Lock();
+    for (std::multimap<std::string, CLIServer*>::iterator it = this->IdleServers.begin();
+         it != this->IdleServers.end(); ++it)
+      {
+      delete it->second;
+      }
+    this->IdleServers.clear();
+    this->UnsupportedServerExecutables.clear();
+    this->ServersLock->Unlock();
+  }
+
+  typedef std::map<std::string, std::string> FileNameMap;
+
+  /// Input files written once by ApplyBatch() for all the jobs of a batch,
+  /// by job and MRML node ID, and the number of jobs using each file.
+  itk::SimpleFastMutexLock BatchInputFilesLock;
+  std::map<vtkMRMLCommandLineModuleNode*, FileNameMap> BatchInputFiles;
+  std::map<std::string, int> BatchInputFileUsers;
+
+  /// Make \a job use the already written \a files instead of writing its
+  /// own copy of the input nodes.
+  /// \sa ReleaseBatchInputFiles()
+  void SetBatchInputFiles(vtkMRMLCommandLineModuleNode* job, const FileNameMap& files,
+                          bool deleteFiles)
+  {
+    this->ReleaseBatchInputFiles(job, deleteFiles);
+    this->BatchInputFilesLock.Lock();
+    this->BatchInputFiles[job] = files;
+    for (FileNameMap::const_iterator it = files.begin(); it != files.end(); ++it)
+      {
+      ++this->BatchInputFileUsers[it->second];
+      }
+    this->BatchInputFilesLock.Unlock();
+  }
+  FileNameMap GetBatchInputFiles(vtkMRMLCommandLineModuleNode* job)
+  {
+    FileNameMap files;
+    this->BatchInputFilesLock.Lock();
+    std::map<vtkMRMLCommandLineModuleNode*, FileNameMap>::const_iterator it =
+      this->BatchInputFiles.find(job);
+    if (it != this->BatchInputFiles.end())
+      {
+      files = it->second;
+      }
+    this->BatchInputFilesLock.Unlock();
+    return files;
+  }
+  /// Called when \a job doesn't need its batch input files anymore. Files
+  /// not used by any other job are deleted if \a deleteFiles is true.
+  /// Pass a null job to release the files of all the jobs.
+  void ReleaseBatchInputFiles(vtkMRMLCommandLineModuleNode* job, bool deleteFiles)
+  {
+    this->BatchInputFilesLock.Lock();
+    std::map<vtkMRMLCommandLineModuleNode*, FileNameMap>::iterator jobIt =
+      job ? this->BatchInputFiles.find(job) : this->BatchInputFiles.begin();
+    while (jobIt != this->BatchInputFiles.end())
+      {
+      for (FileNameMap::const_iterator it = jobIt->second.begin(); it != jobIt->second.end(); ++it)
+        {
+        if (--this->BatchInputFileUsers[it->second] > 0)
+          {
+          continue;
+          }
+        this->BatchInputFileUsers.erase(it->second);
+        if (deleteFiles)
+          {
+          itksys::SystemTools::RemoveFile(it->second.c_str());
+          }
+        }
+      this->BatchInputFiles.erase(jobIt++);
+      if (job)
+        {
+        break;
+        }
+      }
+    this->BatchInputFilesLock.Unlock();
+  }
+  /// Release the batch input files of a job when going out of scope.
+  struct BatchInputFilesReleaser
+  {
+    BatchInputFilesReleaser(vtkInternal* internal, vtkMRMLCommandLineModuleNode* job,
+                            bool deleteFiles)
+      : Internal(internal), Job(job), DeleteFiles(deleteFiles)
+    {
+    }
+    ~BatchInputFilesReleaser()
+    {
+      this->Internal->ReleaseBatchInputFiles(this->Job, this->DeleteFiles);
+    }
+    vtkInternal* Internal;
+    vtkMRMLCommandLineModuleNode* Job;
+    bool DeleteFiles;
+  };
+
   typedef std::vector<std::pair<vtkMTimeType, vtkMRMLCommandLineModuleNode*> > RequestType;
   struct FindRequest
   {
@@ -228,6 +992,7 @@ public:
 
   void SetLastRequest(vtkMRMLCommandLineModuleNode* node, vtkMTimeType requestUID)
   {
+    this->LastRequestsLock.Lock();
     RequestType::iterator it = std::find_if(
       this->LastRequests.begin(), this->LastRequests.end(), FindRequest(node));
     if (it == this->LastRequests.end())
@@ -239,12 +1004,32 @@ public:
       assert( it->first < requestUID );
       it->first = requestUID;
       }
+    this->LastRequestsLock.Unlock();
   }
   vtkMTimeType GetLastRequest(vtkMRMLCommandLineModuleNode* node)
   {
+    this->LastRequestsLock.Lock();
     RequestType::iterator it = std::find_if(
       this->LastRequests.begin(), this->LastRequests.end(), FindRequest(node));
-    return (it != this->LastRequests.end())? it->first : 0;
+    vtkMTimeType requestUID = (it != this->LastRequests.end())? it->first : 0;
+    this->LastRequestsLock.Unlock();
+    return requestUID;
+  }
+  /// Remove the request \a requestUID and return its node, 0 if the request
+  /// is not a last request.
+  vtkMRMLCommandLineModuleNode* TakeLastRequest(vtkMTimeType requestUID)
+  {
+    vtkMRMLCommandLineModuleNode* node = 0;
+    this->LastRequestsLock.Lock();
+    RequestType::iterator it = std::find_if(
+      this->LastRequests.begin(), this->LastRequests.end(), FindRequest(requestUID));
+    if (it != this->LastRequests.end())
+      {
+      node = it->second;
+      this->LastRequests.erase(it);
+      }
+    this->LastRequestsLock.Unlock();
+    return node;
   }
 
   /// Install the reschedule callback on a node and its references
@@ -283,6 +1068,8 @@ public:
 
   /// List of read data/scene requests of the CLI nodes
   /// being executed with their.
+  /// Modules running in processing threads and the main thread access it.
+  itk::SimpleFastMutexLock LastRequestsLock;
   RequestType LastRequests;
 
   vtkSmartPointer<vtkSlicerCLIRescheduleCallback> RescheduleCallback;
@@ -298,8 +1085,13 @@ vtkSlicerCLIModuleLogic::vtkSlicerCLIModuleLogic()
   this->Internal = new vtkInternal();
 
   this->Internal->ProcessesKillLock = itk::MutexLock::New();
+  this->Internal->ServerModeEnabled = 0;
+  this->Internal->ServersLock = itk::MutexLock::New();
   this->Internal->DeleteTemporaryFiles = 1;
   this->Internal->AllowInMemoryTransfer = 1;
+  this->Internal->AllowSharedMemoryTransfer = 0;
+  this->Internal->ResultCacheEnabled = 0;
+  this->Internal->ResultCache = vtkSmartPointer<vtkSlicerCLIModuleResultCache>::New();
   this->Internal->RedirectModuleStreams = 1;
   this->Internal->RescheduleCallback =
     vtkSmartPointer<vtkSlicerCLIRescheduleCallback>::New();
@@ -316,6 +1108,8 @@ vtkSlicerCLIModuleLogic::~vtkSlicerCLIModuleLogic()
 {
   this->RemoveObserver(this->Internal->OneShotCallbackCallback);
 
+  this->Internal->StopServers();
+  this->Internal->ReleaseBatchInputFiles(0, this->GetDeleteTemporaryFiles() != 0);
   delete this->Internal;
 }
 
@@ -403,6 +1197,64 @@ int vtkSlicerCLIModuleLogic::GetAllowInMemoryTransfer() const
   return this->Internal->AllowInMemoryTransfer;
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetAllowSharedMemoryTransfer(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting AllowSharedMemoryTransfer to " << value);
+  if (this->Internal->AllowSharedMemoryTransfer != value)
+    {
+    this->Internal->AllowSharedMemoryTransfer = value;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetAllowSharedMemoryTransfer() const
+{
+  return this->Internal->AllowSharedMemoryTransfer;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetServerModeEnabled(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting ServerModeEnabled to " << value);
+  if (this->Internal->ServerModeEnabled != value)
+    {
+    this->Internal->ServerModeEnabled = value;
+    if (!value)
+      {
+      this->Internal->StopServers();
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetServerModeEnabled() const
+{
+  return this->Internal->ServerModeEnabled;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetResultCacheEnabled(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting ResultCacheEnabled to " << value);
+  if (this->Internal->ResultCacheEnabled != value)
+    {
+    this->Internal->ResultCacheEnabled = value;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetResultCacheEnabled() const
+{
+  return this->Internal->ResultCacheEnabled;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCLIModuleResultCache* vtkSlicerCLIModuleLogic::GetResultCache()
+{
+  return this->Internal->ResultCache;
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerCLIModuleLogic::RedirectModuleStreamsOn()
 {
@@ -510,12 +1362,14 @@ vtkSlicerCLIModuleLogic
   // running instances of slicer will not collide).  The filename
   // will be unique to the node in the process (the same node will be
   // encoded to the same filename every time within that running
-  // instance of Slicer).  This last point is an optimization to
-  // minimize the number of times a file is written when running a
-  // module.  However, if we change the execution model such that more
-  // than one module can run at the same time within the same Slicer
-  // process, then this encoding will need to be changed to be unique
-  // per module execution.
+  // instance of Slicer).  As several modules can run at the same time
+  // within the same Slicer process, ApplyTask() makes the filename
+  // unique per module execution (see MakeTemporaryFileNameUnique()).
+  //
+  // 4. If the consumer of the file is an executable and shared memory
+  // transfer is allowed, plain volumes are passed in a shared memory
+  // segment encoded as slicershm:/%s where the string is unique to the
+  // module execution (see itkSharedMemoryImageIO).
   //
 
   // Encode process id into a string.  To avoid confusing the
@@ -553,6 +1407,19 @@ vtkSlicerCLIModuleLogic
   if (tag == "image")
     {
     if ( commandType == CommandLineModule
+         && type != "dynamic-contrast-enhanced"
+         && this->GetAllowSharedMemoryTransfer() != 0
+         && this->GetMRMLScene()
+         && IsSharedMemoryTransferPossible(this->GetMRMLScene()->GetNodeByID(name)))
+      {
+      // Segments are unique per call
+      std::ostringstream shmName;
+      shmName << "slicershm:/" << pid << "_"
+              << vtksys::SystemTools::GetFilenameName(fname) << "_"
+              << GetUniqueExecutionNumber();
+      fname = shmName.str();
+      }
+    else if ( commandType == CommandLineModule
          || type == "dynamic-contrast-enhanced"
          || this->GetAllowInMemoryTransfer() == 0)
       {
@@ -674,6 +1541,55 @@ void vtkSlicerCLIModuleLogic::ApplyAndWait ( vtkMRMLCommandLineModuleNode* node,
     }
 }
 
+//-----------------------------------------------------------------------------
+std::string vtkSlicerCLIModuleLogic::GetTagValue(const std::string& text, const std::string& tag)
+{
+  std::string startTag = "<" + tag + ">";
+  std::string::size_type start = text.find(startTag);
+  if (start == std::string::npos)
+    {
+    return std::string();
+    }
+  start += startTag.size();
+  std::string::size_type end = text.find("</" + tag + ">", start);
+  if (end == std::string::npos)
+    {
+    return std::string();
+    }
+  return text.substr(start, end - start);
+}
+
+//-----------------------------------------------------------------------------
+std::string vtkSlicerCLIModuleLogic::FindPartialOutputNodeID(
+  const std::map<std::string, std::string>& nodesToReload,
+  const std::string& partialFileName)
+{
+  std::string partialName = itksys::SystemTools::GetFilenameName(partialFileName);
+  std::string partialPath = itksys::SystemTools::GetFilenamePath(partialFileName);
+  if (partialName.compare(0, 7, "partial") != 0)
+    {
+    return std::string();
+    }
+  std::string::size_type separator = partialName.find('_');
+  if (separator == std::string::npos || separator == 7
+      || partialName.find_first_not_of("0123456789", 7) != separator)
+    {
+    return std::string();
+    }
+  std::string outputName = partialName.substr(separator + 1);
+  for (std::map<std::string, std::string>::const_iterator it = nodesToReload.begin();
+       it != nodesToReload.end(); ++it)
+    {
+    if (!IsSharedMemoryFileName(it->second)
+        && itksys::SystemTools::GetFilenameName(it->second) == outputName
+        && itksys::SystemTools::GetFilenamePath(it->second) == partialPath)
+      {
+      return it->first;
+      }
+    }
+  return std::string();
+}
+
 //-----------------------------------------------------------------------------
 void vtkSlicerCLIModuleLogic::KillProcesses()
 {
@@ -701,6 +1617,8 @@ void vtkSlicerCLIModuleLogic::Apply ( vtkMRMLCommandLineModuleNode* node, bool u
 
   vtkNew<vtkSlicerTask> task;
   task->SetTypeToProcessing();
+  // Allows the application logic to limit the number of concurrent runs of this module
+  task->SetModuleName(node->GetModuleDescription().GetTitle().c_str());
 
   // Pass the current node as client data to the task.  This allows
   // the user to switch to another parameter set after the task is
@@ -731,6 +1649,121 @@ void vtkSlicerCLIModuleLogic::Apply ( vtkMRMLCommandLineModuleNode* node, bool u
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::ApplyBatch(vtkSlicerCLIModuleBatch* batch)
+{
+  if (!batch)
+    {
+    return;
+    }
+  std::vector<vtkMRMLCommandLineModuleNode*> jobs;
+  for (int i = 0; i < batch->GetNumberOfJobs(); ++i)
+    {
+    vtkMRMLCommandLineModuleNode* job = batch->GetJob(i);
+    if (job->GetModuleDescription().GetType() == "PythonModule")
+      {
+      vtkErrorMacro("ApplyBatch: Python modules can't be run in batch");
+      return;
+      }
+    if (!job->IsBusy())
+      {
+      jobs.push_back(job);
+      }
+    }
+
+  // Input nodes shared by all the jobs (typically bound in the template
+  // node) are written once here instead of once per job.
+  if (jobs.size() > 1)
+    {
+    vtkInternal::FileNameMap sharedInputFiles = this->WriteSharedBatchInputs(jobs);
+    for (std::vector<vtkMRMLCommandLineModuleNode*>::const_iterator it = jobs.begin();
+         it != jobs.end(); ++it)
+      {
+      this->Internal->SetBatchInputFiles(*it, sharedInputFiles,
+                                         this->GetDeleteTemporaryFiles() != 0);
+      }
+    }
+
+  for (std::vector<vtkMRMLCommandLineModuleNode*>::const_iterator it = jobs.begin();
+       it != jobs.end(); ++it)
+    {
+    this->Apply(*it, false);
+    }
+}
+
+//----------------------------------------------------------------------------
+std::map<std::string, std::string> vtkSlicerCLIModuleLogic
+::WriteSharedBatchInputs(const std::vector<vtkMRMLCommandLineModuleNode*>& jobs)
+{
+  vtkInternal::FileNameMap files;
+  const ModuleDescription& description = jobs[0]->GetModuleDescription();
+  if (description.GetType() != "CommandLineModule" || !this->GetMRMLScene())
+    {
+    // Other modules exchange data with the scene without files
+    return files;
+    }
+  const std::vector<ModuleParameterGroup>& groups = description.GetParameterGroups();
+  for (std::vector<ModuleParameterGroup>::const_iterator pgit = groups.begin();
+       pgit != groups.end(); ++pgit)
+    {
+    const std::vector<ModuleParameter>& parameters = pgit->GetParameters();
+    for (std::vector<ModuleParameter>::const_iterator pit = parameters.begin();
+         pit != parameters.end(); ++pit)
+      {
+      // Point files are not shared: the coordinate system is set per job
+      const std::string& tag = pit->GetTag();
+      if (pit->GetChannel() != "input" || pit->GetHidden() == "true"
+          || (tag != "image" && tag != "geometry" && tag != "transform"
+              && tag != "table" && tag != "measurement"))
+        {
+        continue;
+        }
+      const std::string& id = pit->GetValue();
+      bool shared = true;
+      for (size_t i = 1; shared && i < jobs.size(); ++i)
+        {
+        shared = jobs[i]->GetParameterAsString(pit->GetName()) == id;
+        }
+      vtkMRMLStorableNode* node = vtkMRMLStorableNode::SafeDownCast(
+        this->GetMRMLScene()->GetNodeByID(id.c_str()));
+      if (!shared || !node || files.count(id)
+          || vtkMRMLModelHierarchyNode::SafeDownCast(node))
+        {
+        continue;
+        }
+      std::string fileName = this->ConstructTemporaryFileName(
+        tag, pit->GetType(), id, pit->GetFileExtensions(), CommandLineModule);
+      std::string extension = vtksys::SystemTools::LowerCase(
+        vtksys::SystemTools::GetFilenameLastExtension(fileName));
+      if (IsSharedMemoryFileName(fileName) || extension == ".mrml")
+        {
+        // Shared memory segments and miniscene transforms are set up by
+        // each job
+        continue;
+        }
+      fileName = MakeTemporaryFileNameUnique(fileName, GetUniqueExecutionTag());
+
+      vtkSmartPointer<vtkMRMLStorageNode> storageNode;
+      storageNode.TakeReference(node->CreateDefaultStorageNode());
+      if (!storageNode)
+        {
+        continue;
+        }
+      storageNode->ConfigureForDataExchange();
+      storageNode->SetScene(this->GetMRMLScene());
+      storageNode->SetFileName(fileName.c_str());
+      if (!storageNode->WriteData(node))
+        {
+        vtkErrorMacro("WriteSharedBatchInputs: ERROR writing file " << fileName);
+        itksys::SystemTools::RemoveFile(fileName.c_str());
+        continue;
+        }
+      files[id] = fileName;
+      }
+    }
+  return files;
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerCLIModuleLogic
 ::SetMRMLApplicationLogic(vtkMRMLApplicationLogic* logic)
@@ -833,6 +1866,12 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   // release it when it goes out of scope
   node0.TakeReference(reinterpret_cast<vtkMRMLCommandLineModuleNode*>(clientdata));
 
+  // input files shared with the other jobs of a batch, already written by
+  // ApplyBatch()
+  vtkInternal::FileNameMap batchInputFiles = this->Internal->GetBatchInputFiles(node0);
+  vtkInternal::BatchInputFilesReleaser batchInputFilesReleaser(
+    this->Internal, node0, this->GetDeleteTemporaryFiles() != 0);
+
   // Check to see if this node/task has been cancelled
   if (node0->GetStatus() == vtkMRMLCommandLineModuleNode::Cancelling ||
       node0->GetStatus() == vtkMRMLCommandLineModuleNode::Cancelled)
@@ -916,6 +1955,14 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   // vector of files to delete
   std::set<std::string> filesToDelete;
 
+  // temporary files are unique to this execution
+  const std::string executionTag = GetUniqueExecutionTag();
+
+  // files bound to the parameters of a batch job, they are neither written
+  // nor reloaded but directly read and written by the module
+  bool isBatchJob = vtkSlicerCLIModuleBatch::IsBatchJob(node0);
+  std::set<std::string> batchFileNames;
+
   // iterators for parameter groups
   std::vector<ModuleParameterGroup>::iterator pgbeginit
     = node0->GetModuleDescription().GetParameterGroups().begin();
@@ -955,6 +2002,12 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         // only keep track of objects associated with real nodes
         if (!this->GetMRMLScene()->GetNodeByID(id.c_str()) || id == "None")
           {
+          // batch jobs bind the parameters to files that are directly
+          // passed to the module
+          if (isBatchJob && !id.empty() && id != "None")
+            {
+            batchFileNames.insert(id);
+            }
           continue;
           }
 
@@ -964,6 +2017,17 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
                                              id,
                                              (*pit).GetFileExtensions(),
                                              commandType);
+        if (commandType != PythonModule)
+          {
+          fname = MakeTemporaryFileNameUnique(fname, executionTag);
+          }
+        vtkInternal::FileNameMap::const_iterator batchInputIt = batchInputFiles.find(id);
+        if ((*pit).GetChannel() == "input" && batchInputIt != batchInputFiles.end())
+          {
+          // written once for all the jobs, nothing to write or delete
+          nodesToWrite[id] = batchInputIt->second;
+          continue;
+          }
 
         filesToDelete.insert(fname);
         if ((*pit).GetChannel() == "input")
@@ -1015,6 +2079,10 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
        id2fn0 != nodesToWrite.end();
        ++id2fn0)
     {
+    if (batchInputFiles.count((*id2fn0).first))
+      {
+      continue;
+      }
     vtkMRMLNode *nd
       = this->GetMRMLScene()->GetNodeByID( (*id2fn0).first.c_str() );
 
@@ -1046,6 +2114,15 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       // Default case for CommandLineModule is to use a storage node
       out = defaultOut;
       }
+    if ((commandType == CommandLineModule) && IsSharedMemoryFileName((*id2fn0).second))
+      {
+      // The volume is copied to shared memory instead of being written
+      out = 0;
+      if (!WriteSharedMemoryImage(vtkMRMLVolumeNode::SafeDownCast(nd), (*id2fn0).second))
+        {
+        vtkErrorMacro("ERROR writing shared memory image " << (*id2fn0).second);
+        }
+      }
     if ((commandType == SharedObjectModule) && defaultOut)
       {
       //std::cerr << nd->GetName() << " is " << nd->GetClassName() << std::endl;
@@ -1261,19 +2338,8 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     pidString << getpid();
 #endif
 
-    static const char alphanum[] =
-        "0123456789"
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-        "abcdefghijklmnopqrstuvwxyz";
-    srand(time(0));
-
-    std::ostringstream code;
-    for (int ii = 0; ii < 10; ii++)
-      {
-      code << alphanum[rand() % (sizeof(alphanum)-1)];
-      }
     std::string returnFile = temporaryDirectory + "/" + pidString.str()
-      + "_" + code.str() + ".params";
+      + "_" + executionTag + ".params";
 
     commandLineAsString.push_back( returnFile );
 
@@ -1402,8 +2468,15 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
             fname = minisceneFilename + "#" + (*mit).second;
             }
 
+          // or use the file bound to the parameter of a batch job
+          if (fname.empty()
+              && batchFileNames.find((*pit).GetValue()) != batchFileNames.end())
+            {
+            fname = (*pit).GetValue();
+            }
+
           // Only put out the flag if the node in nodesToWrite/Reload
-          // or in the mini-scene
+          // or in the mini-scene or a file of a batch job
           if (fname.size() > 0)
             {
             commandLineAsString.push_back(prefix + flag);
@@ -1775,6 +2848,13 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         fname = minisceneFilename + "#" + (*mit).second;
         }
 
+      // or use the file bound to the parameter of a batch job
+      if (fname.empty()
+          && batchFileNames.find((*iit).second.GetValue()) != batchFileNames.end())
+        {
+        fname = (*iit).second.GetValue();
+        }
+
       if (fname.size() > 0)
         {
         commandLineAsString.push_back( fname );
@@ -1815,15 +2895,46 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   // vtkSlicerApplication::GetInstance()->InformationMessage
   qDebug() << information0.str().c_str();
 
+  // Look for the results of an identical execution in the cache
+  std::string resultCacheKey;
+  vtkSlicerCLIModuleResultCache::FileNameMap resultCacheFiles;
+  bool resultsFromCache = false;
+  if (commandType == CommandLineModule
+      && this->GetResultCacheEnabled()
+      && miniscene->GetNumberOfNodes() == 0
+      && batchFileNames.empty())
+    {
+    vtkSlicerCLIModuleResultCache* resultCache = this->Internal->ResultCache;
+    if (std::string(resultCache->GetCacheDirectory()).empty())
+      {
+      resultCache->SetCacheDirectory((temporaryDirectory + "/CLIResultCache").c_str());
+      }
+    MRMLIDToFileNameMap::const_iterator returnFileIt = nodesToReload.find(node0->GetID());
+    resultCacheKey = ComputeResultCacheKey(
+      node0->GetModuleDescription(), nodesToWrite, nodesToReload,
+      returnFileIt != nodesToReload.end() ? returnFileIt->second : std::string(),
+      resultCacheFiles);
+    resultsFromCache = !resultCacheKey.empty()
+      && resultCache->RetrieveEntry(resultCacheKey, resultCacheFiles);
+    }
+
   // run the filter
   //
   //
   node0->GetModuleDescription().GetProcessInformation()->Initialize();
   node0->SetOutputText("", false);
   node0->SetErrorText("", false);
+  node0->ClearExecutionStages(false);
   node0->SetStatus(vtkMRMLCommandLineModuleNode::Running, false);
   this->GetApplicationLogic()->RequestModified( node0 );
-  if (commandType == CommandLineModule)
+  if (resultsFromCache)
+    {
+    // The outputs have been copied from the cache, they are reloaded as if
+    // the module had written them.
+    node0->SetOutputText("Results retrieved from cache\n", false);
+    this->GetApplicationLogic()->RequestModified( node0 );
+    }
+  else if (commandType == CommandLineModule)
     {
     // Run as a command line module
     //
@@ -1836,41 +2947,68 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     // statically linked to the executable.
     // Historically, there was an nvidia driver bug that causes the module
     // to fail on exit with undefined symbol.
-     std::string saveITKAutoLoadPath;
-     itksys::SystemTools::GetEnv("ITK_AUTOLOAD_PATH", saveITKAutoLoadPath);
-     std::string emptyString("ITK_AUTOLOAD_PATH=");
-     int putSuccess =
-       itksys::SystemTools::PutEnv(const_cast <char *> (emptyString.c_str()));
-     if (!putSuccess)
-       {
-       vtkErrorMacro( "Unable to reset ITK_AUTOLOAD_PATH.");
-       }
+    // If images are passed through shared memory, only the directory of
+    // the ITK-only SharedMemoryIOPlugin is set.
+    std::string autoLoadPath;
+    bool useSharedMemory = false;
+    std::set<std::string>::const_iterator sfit;
+    for (sfit = filesToDelete.begin(); sfit != filesToDelete.end(); ++sfit)
+      {
+      useSharedMemory = useSharedMemory || IsSharedMemoryFileName(*sfit);
+      }
+    if (useSharedMemory)
+      {
+      // other threads temporarily change the variable to start their process
+      ChildEnvironmentLock.Lock();
+      std::string slicerITKAutoLoadPath;
+      itksys::SystemTools::GetEnv("ITK_AUTOLOAD_PATH", slicerITKAutoLoadPath);
+      ChildEnvironmentLock.Unlock();
+      std::vector<std::string> autoLoadPaths;
+      itksys::SystemTools::Split(slicerITKAutoLoadPath.c_str(), autoLoadPaths, ':');
+      for (std::vector<std::string>::const_iterator pathIt = autoLoadPaths.begin();
+           pathIt != autoLoadPaths.end(); ++pathIt)
+        {
+        std::string sharedMemoryPluginPath = *pathIt + "/SharedMemory";
+        if (!pathIt->empty()
+            && itksys::SystemTools::FileIsDirectory(sharedMemoryPluginPath.c_str()))
+          {
+          autoLoadPath = sharedMemoryPluginPath;
+          break;
+          }
+        }
+      }
     //
     // now run the process
     //
-    itksysProcess *process = itksysProcess_New();
+    // A resident executable started with the same environment receives the
+    // command line if server mode is enabled and the module allows it.
+    CLIServer* server = 0;
+    if (this->GetServerModeEnabled()
+        && IsServerModeAllowed(node0->GetModuleDescription(), commandLineAsString))
+      {
+      server = this->Internal->AcquireServer(commandLineAsString, autoLoadPath);
+      }
+    itksysProcess *process = server ? server->Process : itksysProcess_New();
 
+    this->Internal->ProcessesKillLock->Lock();
     this->Internal->Processes.push_back(process);
+    this->Internal->ProcessesKillLock->Unlock();
 
-    // setup the command
-    itksysProcess_SetCommand(process, command);
-    itksysProcess_SetOption(process,
-                            itksysProcess_Option_Detach, 0);
-    itksysProcess_SetOption(process,
-                            itksysProcess_Option_HideWindow, 1);
-    // itksysProcess_SetTimeout(process, 5.0); // 5 seconds
-
-    // execute the command
-    itksysProcess_Execute(process);
-
-    // restore the load path
-    std::string putEnvString = ("ITK_AUTOLOAD_PATH=");
-    putEnvString = putEnvString + saveITKAutoLoadPath;
-    putSuccess =
-      itksys::SystemTools::PutEnv(const_cast <char *> (putEnvString.c_str()));
-    if (!putSuccess)
+    if (!server)
       {
-      vtkErrorMacro( "Unable to restore ITK_AUTOLOAD_PATH. ");
+      // setup the command
+      itksysProcess_SetCommand(process, command);
+      itksysProcess_SetOption(process,
+                              itksysProcess_Option_Detach, 0);
+      itksysProcess_SetOption(process,
+                              itksysProcess_Option_HideWindow, 1);
+      // itksysProcess_SetTimeout(process, 5.0); // 5 seconds
+
+      // execute the command
+      if (!ExecuteWithAutoLoadPath(process, autoLoadPath))
+        {
+        vtkErrorMacro( "Unable to reset or restore ITK_AUTOLOAD_PATH.");
+        }
       }
 
     // Wait for the command to finish
@@ -1883,6 +3021,11 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     std::string stderrbuffer;
     std::string::size_type tagend;
     std::string::size_type tagstart;
+    bool serverCompleted = false;
+    int serverExitValue = EXIT_FAILURE;
+    // positions of the stage and partial output reports not handled yet
+    std::string::size_type stageSearchStart = 0;
+    std::string::size_type partialOutputSearchStart = 0;
     while ((pipe = itksysProcess_WaitForData(process ,&tbuffer,
                                              &length, &timeout)) != 0)
       {
@@ -1897,9 +3040,11 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       // Check to see if the plugin was cancelled
       if (node0->GetModuleDescription().GetProcessInformation()->Abort)
         {
+        this->Internal->ProcessesKillLock->Lock();
         itksysProcess_Kill(process);
         this->Internal->Processes.erase(
               std::find(this->Internal->Processes.begin(), this->Internal->Processes.end(), process));
+        this->Internal->ProcessesKillLock->Unlock();
         node0->GetModuleDescription().GetProcessInformation()->Progress = 0;
         node0->GetModuleDescription().GetProcessInformation()->StageProgress =0;
         this->GetApplicationLogic()->RequestModified( node0 );
@@ -1969,10 +3114,62 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
               foundTag = true;
               }
             }
+          // report the stages that ended
+          while ((tagstart = stdoutbuffer.find("<filter-end>", stageSearchStart))
+                 != std::string::npos
+                 && (tagend = stdoutbuffer.find("</filter-end>", tagstart))
+                 != std::string::npos)
+            {
+            std::string stage(stdoutbuffer, tagstart, tagend - tagstart);
+            node0->AddExecutionStage(
+              GetTagValue(stage, "filter-name"),
+              atof(GetTagValue(stage, "filter-time").c_str()),
+              atof(GetTagValue(stage, "filter-memory").c_str()), false);
+            stageSearchStart = tagend;
+            foundTag = true;
+            }
+
+          // load the intermediate outputs into the scene while the module
+          // keeps running
+          while ((tagstart = stdoutbuffer.find("<filter-partial-output>", partialOutputSearchStart))
+                 != std::string::npos
+                 && (tagend = stdoutbuffer.find("</filter-partial-output>", tagstart))
+                 != std::string::npos)
+            {
+            std::string partialFileName(stdoutbuffer, tagstart + 23, tagend - tagstart - 23);
+            partialOutputSearchStart = tagend;
+            std::string partialOutputNodeID =
+              FindPartialOutputNodeID(nodesToReload, partialFileName);
+            if (!partialOutputNodeID.empty()
+                && itksys::SystemTools::FileExists(partialFileName.c_str(), true))
+              {
+              // the file is deleted once read
+              this->GetApplicationLogic()->RequestReadFile(
+                partialOutputNodeID.c_str(), partialFileName.c_str(), false, true);
+              }
+            else
+              {
+              vtkWarningMacro("Ignoring partial output " << partialFileName
+                              << " that doesn't match any output");
+              if (itksys::SystemTools::FileExists(partialFileName.c_str(), true)
+                  && this->GetDeleteTemporaryFiles())
+                {
+                itksys::SystemTools::RemoveFile(partialFileName.c_str());
+                }
+              }
+            }
+
           if (foundTag)
             {
             this->GetApplicationLogic()->RequestModified( node0 );
             }
+
+          // a server keeps running after the execution
+          if (server && ExtractCLIServerResult(stdoutbuffer, serverExitValue))
+            {
+            serverCompleted = true;
+            break;
+            }
           }
         else if (pipe == itksysProcess_Pipe_STDERR)
           {
@@ -1980,9 +3177,16 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
           }
         }
       }
-    this->Internal->ProcessesKillLock->Lock();
-    itksysProcess_WaitForExit(process, 0);
-    this->Internal->ProcessesKillLock->Unlock();
+    if (serverCompleted)
+      {
+      server->ReadPendingErrors(stderrbuffer);
+      }
+    else
+      {
+      this->Internal->ProcessesKillLock->Lock();
+      itksysProcess_WaitForExit(process, 0);
+      this->Internal->ProcessesKillLock->Unlock();
+      }
 
     // remove the embedded XML from the stdout stream
     //
@@ -2025,6 +3229,20 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
                          filterTimeRegExp.end()
                          - filterTimeRegExp.start());
       }
+    itksys::RegularExpression filterMemoryRegExp("<filter-memory>[^<]*</filter-memory>[ \t\n\r]*");
+    while (filterMemoryRegExp.find(stdoutbuffer))
+      {
+      stdoutbuffer.erase(filterMemoryRegExp.start(),
+                         filterMemoryRegExp.end()
+                         - filterMemoryRegExp.start());
+      }
+    itksys::RegularExpression filterPartialOutputRegExp("<filter-partial-output>[^<]*</filter-partial-output>[ \t\n\r]*");
+    while (filterPartialOutputRegExp.find(stdoutbuffer))
+      {
+      stdoutbuffer.erase(filterPartialOutputRegExp.start(),
+                         filterPartialOutputRegExp.end()
+                         - filterPartialOutputRegExp.start());
+      }
     itksys::RegularExpression filterStartRegExp("<filter-start>[^<]*</filter-start>[ \t\n\r]*");
     while (filterStartRegExp.find(stdoutbuffer))
       {
@@ -2062,15 +3280,38 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       {
       node0->SetStatus(vtkMRMLCommandLineModuleNode::Cancelled, false);
       this->GetApplicationLogic()->RequestModified(node0);
+      if (server)
+        {
+        this->Internal->ProcessesKillLock->Lock();
+        std::vector<itksysProcess*>::iterator processIt = std::find(
+          this->Internal->Processes.begin(), this->Internal->Processes.end(), process);
+        if (processIt != this->Internal->Processes.end())
+          {
+          this->Internal->Processes.erase(processIt);
+          }
+        this->Internal->ProcessesKillLock->Unlock();
+        if (serverCompleted)
+          {
+          this->Internal->ReleaseServer(server);
+          }
+        else
+          {
+          // the server has been killed
+          delete server;
+          }
+        }
       }
     else
       {
-      int result = itksysProcess_GetState(process);
+      int result = serverCompleted ?
+        static_cast<int>(itksysProcess_State_Exited) : itksysProcess_GetState(process);
       if (result == itksysProcess_State_Exited)
         {
         // executable exited cleanly and must of done
         // "something"
-        if (itksysProcess_GetExitValue(process) == 0)
+        int exitValue = serverCompleted ?
+          serverExitValue : itksysProcess_GetExitValue(process);
+        if (exitValue == 0)
           {
           // executable exited without errors,
           std::stringstream information;
@@ -2146,7 +3387,19 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       this->Internal->ProcessesKillLock->Lock();
       this->Internal->Processes.erase(
             std::find(this->Internal->Processes.begin(), this->Internal->Processes.end(), process));
-      itksysProcess_Delete(process);
+      if (serverCompleted)
+        {
+        this->Internal->ReleaseServer(server);
+        }
+      else if (server)
+        {
+        // the server died during the execution
+        delete server;
+        }
+      else
+        {
+        itksysProcess_Delete(process);
+        }
       this->Internal->ProcessesKillLock->Unlock();
       }
     }
@@ -2353,6 +3606,13 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       vtkMultiThreader::GetCurrentThreadID(), false);
     }
 
+  // Keep a copy of the outputs for identical executions
+  if (!resultsFromCache && !resultCacheKey.empty()
+      && node0->GetStatus() == vtkMRMLCommandLineModuleNode::Completing)
+    {
+    this->Internal->ResultCache->StoreEntry(resultCacheKey, resultCacheFiles);
+    }
+
   // import the results if the plugin was allowed to complete
   //
   //
@@ -2369,6 +3629,23 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         {
         // Node is not being communicated in the miniscene, load via a file
 
+        // Volumes passed in shared memory are copied back into the node
+        // here, the read request only updates the display.
+        if (IsSharedMemoryFileName((*id2fn0).second))
+          {
+          vtkMRMLNode* node = this->GetMRMLScene()->GetNodeByID((*id2fn0).first);
+          this->Internal->StartRescheduleNodeEvents(node);
+          this->Internal->RescheduleCallback->RescheduleEventsFromThreadID(
+            vtkMultiThreader::GetCurrentThreadID(), true);
+          if (!ReadSharedMemoryImage(vtkMRMLVolumeNode::SafeDownCast(node), (*id2fn0).second))
+            {
+            vtkErrorMacro("ERROR reading shared memory image " << (*id2fn0).second);
+            }
+          this->Internal->RescheduleCallback->RescheduleEventsFromThreadID(
+            vtkMultiThreader::GetCurrentThreadID(), false);
+          RemoveSharedMemoryImage((*id2fn0).second);
+          }
+
         // Make request that data be reloaded. The data will loaded and
         // rendered in the main gui thread.  Data to be reloaded can be
         // safely deleted after the load. (It would not make sense for
@@ -2398,7 +3675,8 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         // outputs of a module to produce the same file to be reloaded.
         filesToDelete.erase( (*id2fn0).second );
 
-        if (commandType == SharedObjectModule)
+        if (commandType == SharedObjectModule
+            || IsSharedMemoryFileName((*id2fn0).second))
           {
           vtkMRMLNode* node = this->GetMRMLScene()->GetNodeByID((*id2fn0).first);
           this->Internal->StopRescheduleNodeEvents(node);
@@ -2538,6 +3816,17 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   //
   delete [] command;
 
+  // Shared memory segments are always removed, they are not visible to
+  // the user for debugging and would hold memory until reboot.
+  std::set<std::string>::iterator sfit;
+  for (sfit = filesToDelete.begin(); sfit != filesToDelete.end(); ++sfit)
+    {
+    if (IsSharedMemoryFileName(*sfit))
+      {
+      RemoveSharedMemoryImage(*sfit);
+      }
+    }
+
   // Remove any remaining temporary files.  At this point, these files
   // should be the files written as inputs to the module
   if ( this->GetDeleteTemporaryFiles() )
@@ -2718,16 +4007,12 @@ void vtkSlicerCLIModuleLogic::ProcessMRMLLogicsEvents(vtkObject* caller,
       event == vtkSlicerApplicationLogic::RequestProcessedEvent)
     {
     unsigned long uid = reinterpret_cast<unsigned long>(callData);
-    vtkInternal::RequestType::iterator it =
-      std::find_if(this->Internal->LastRequests.begin(),
-      this->Internal->LastRequests.end(), vtkInternal::FindRequest(uid));
-    if (it != this->Internal->LastRequests.end())
+    vtkMRMLCommandLineModuleNode* node = this->Internal->TakeLastRequest(uid);
+    if (node)
       {
-      vtkMRMLCommandLineModuleNode* node = it->second;
       // If the status is not Completing, then there should be no request made
       // on the application logic.
       assert(node->GetStatus() == vtkMRMLCommandLineModuleNode::Completing);
-      this->Internal->LastRequests.erase(it);
       // we are not interested in any request anymore because the cli node is
       // Completed.
 
@@ -2930,6 +4215,9 @@ void vtkSlicerCLIModuleLogic::AddCompleteModelHierarchyToMiniScene(vtkMRMLScene
                 std::string fname
                     = this->ConstructTemporaryFileName("geometry", "", tmcp->GetID(), std::vector<std::string>(),
                                                                                   CommandLineModule);
+                // the model file is only referenced by the miniscene, any
+                // name unique to the execution works
+                fname = MakeTemporaryFileNameUnique(fname, GetUniqueExecutionTag());
 
                 s->SetFileName(fname.c_str());
                 filesToDelete.insert(fname);
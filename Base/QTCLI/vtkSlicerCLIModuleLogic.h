@@ -26,8 +26,13 @@ class ModuleParameter;
 class vtkMRMLModelHierarchyNode;
 class MRMLIDMap;
 
+class vtkSlicerCLIModuleBatch;
+class vtkSlicerCLIModuleResultCache;
+
 // STL includes
+#include <map>
 #include <string>
+#include <vector>
 
 #include "qSlicerBaseQTCLIExport.h"
 
@@ -80,6 +85,40 @@ public:
   void SetAllowInMemoryTransfer(int value);
   int GetAllowInMemoryTransfer() const;
 
+  /// Control exchange of volumes with executable CLIs through shared memory
+  /// segments instead of temporary files. The voxels are copied once into the
+  /// segment and once out of it on each side of the exchange, the segments
+  /// are not used as image buffers. Only supported on POSIX systems,
+  /// ignored elsewhere. Disabled by default.
+  void SetAllowSharedMemoryTransfer(int value);
+  int GetAllowSharedMemoryTransfer() const;
+
+  /// Control reuse of resident executable CLIs: instead of starting a new
+  /// process for each execution, the executable is kept running and receives
+  /// the successive command lines, saving the process start, library loading
+  /// and ITK factory registration. Only executables built with the CLI
+  /// library wrapper and declaring it in their XML description, with a
+  /// hidden "AllowServerMode" boolean parameter defaulting to "true" (e.g.
+  /// ThresholdScalarVolume), are run this way: the module must not keep
+  /// static state between executions. Other modules, including scripted
+  /// CLIs, are run as usual. Only supported on Linux, where the peak memory
+  /// usage of each execution can be reset (see PluginMemoryUsage.h): on other
+  /// systems the executables refuse to run as servers and are started once
+  /// per execution. Disabled by default.
+  void SetServerModeEnabled(int value);
+  int GetServerModeEnabled() const;
+
+  /// Control reuse of the outputs of previous executions of executable CLIs
+  /// that had the same parameters and the same input data. Outputs are
+  /// stored in the result cache. Disabled by default.
+  /// \sa GetResultCache()
+  void SetResultCacheEnabled(int value);
+  int GetResultCacheEnabled() const;
+
+  /// Store of the outputs. If no cache directory is set, the
+  /// "CLIResultCache" subdirectory of the temporary path is used.
+  vtkSlicerCLIModuleResultCache* GetResultCache();
+
   /// For debugging, control redirection of cout and cerr
   virtual void RedirectModuleStreamsOn();
   virtual void RedirectModuleStreamsOff();
@@ -102,8 +141,32 @@ public:
   /// in the node selectors.
   void ApplyAndWait ( vtkMRMLCommandLineModuleNode* node, bool updateDisplay = true);
 
+  /// Schedules all the jobs of a batch that are not busy. Each job is run
+  /// as a separate task, the jobs run concurrently on the task worker
+  /// threads. The file names bound to the parameters of the jobs are passed
+  /// directly to the CLI, the outputs are not loaded into the scene.
+  /// Input nodes shared by all the jobs are written once before the jobs
+  /// are scheduled.
+  /// Only executable and shared object CLIs are supported.
+  /// This method is non blocking and returns immediately.
+  /// \sa vtkSlicerCLIModuleBatch
+  void ApplyBatch(vtkSlicerCLIModuleBatch* batch);
+
   void KillProcesses();
 
+  /// Return the content of the first \a tag element of the \a text
+  /// written by a module on its standard output, or an empty string.
+  static std::string GetTagValue(const std::string& text, const std::string& tag);
+
+  /// Return the ID of the output node \a partialFileName is an intermediate
+  /// version of, or an empty string. Partial outputs are written by the
+  /// module next to the output file, named "partial<N>_<output file name>".
+  /// \a nodesToReload are the files the outputs are read from, by node ID.
+  /// \sa itk::PluginPartialOutputWriter
+  static std::string FindPartialOutputNodeID(
+    const std::map<std::string, std::string>& nodesToReload,
+    const std::string& partialFileName);
+
 //   void LazyEvaluateModuleTarget(ModuleDescription& moduleDescriptionObject);
 //   void LazyEvaluateModuleTarget(vtkMRMLCommandLineModuleNode* node)
 //     { this->LazyEvaluateModuleTarget(node->GetModuleDescription()); }
@@ -135,6 +198,12 @@ protected:
   // The method that runs the command line module
   void ApplyTask(void *clientdata);
 
+  /// Write the input nodes bound to the same parameter in all the \a jobs
+  /// of a batch and return the written files by node ID.
+  /// \sa ApplyBatch()
+  std::map<std::string, std::string> WriteSharedBatchInputs(
+    const std::vector<vtkMRMLCommandLineModuleNode*>& jobs);
+
   // Communicate progress back to the node
   static void ProgressCallback(void *);
 
@@ -0,0 +1,341 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkSlicerCLIModuleResultCache.h"
+
+// CTK includes
+#include <ctkUtils.h>
+
+// Qt includes
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegExp>
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+// STL includes
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+/// Serialize the modifications of the cache directories, which can be
+/// shared by several logics running in several threads.
+QMutex CacheMutex;
+
+/// File of an entry that is rewritten each time the entry is used
+const char LastUsedFileName[] = ".lastused";
+
+/// Suffix of the directories of the entries being stored
+const char PartialEntrySuffix[] = ".partial";
+
+//----------------------------------------------------------------------------
+/// Return true if \a name is a valid entry key: a hexadecimal SHA-1 digest
+/// as returned by vtkSlicerCLIModuleResultCache::ComputeDigest().
+bool IsEntryKey(const QString& name)
+{
+  return QRegExp("[0-9a-f]{40}").exactMatch(name);
+}
+
+struct CacheEntry
+{
+  QString Path;
+  QDateTime LastUsed;
+  qint64 Size;
+  bool operator<(const CacheEntry& other)const
+    {
+    return this->LastUsed < other.LastUsed;
+    }
+};
+
+//----------------------------------------------------------------------------
+void TouchEntry(const QString& entryPath)
+{
+  QFile lastUsed(QDir(entryPath).filePath(LastUsedFileName));
+  if (lastUsed.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+    lastUsed.write(QDateTime::currentDateTime().toString(Qt::ISODate).toLatin1());
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Return the entries of the cache directory. Only the directories named
+/// after a key and that contain the last used file are entries: anything
+/// else in the cache directory (partial entries, files or directories not
+/// created by the cache) is ignored, and therefore never removed.
+std::vector<CacheEntry> ListEntries(const QString& cacheDirectory)
+{
+  std::vector<CacheEntry> entries;
+  QDir cacheDir(cacheDirectory);
+  foreach(const QFileInfo& entryInfo,
+          cacheDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks))
+    {
+    if (!IsEntryKey(entryInfo.fileName())
+        || !QFileInfo(QDir(entryInfo.absoluteFilePath()).filePath(LastUsedFileName)).isFile())
+      {
+      continue;
+      }
+    CacheEntry entry;
+    entry.Path = entryInfo.absoluteFilePath();
+    entry.LastUsed = entryInfo.lastModified();
+    entry.Size = 0;
+    foreach(const QFileInfo& fileInfo,
+            QDir(entry.Path).entryInfoList(QDir::Files | QDir::Hidden))
+      {
+      if (fileInfo.fileName() == LastUsedFileName)
+        {
+        entry.LastUsed = fileInfo.lastModified();
+        continue;
+        }
+      entry.Size += fileInfo.size();
+      }
+    entries.push_back(entry);
+    }
+  return entries;
+}
+
+//----------------------------------------------------------------------------
+bool CopyFile(const QString& source, const QString& destination)
+{
+  if (QFile::exists(destination) && !QFile::remove(destination))
+    {
+    return false;
+    }
+  return QFile::copy(source, destination);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerCLIModuleResultCache);
+
+//----------------------------------------------------------------------------
+vtkSlicerCLIModuleResultCache::vtkSlicerCLIModuleResultCache()
+{
+  this->MaximumCacheSize = 1024;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCLIModuleResultCache::~vtkSlicerCLIModuleResultCache()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleResultCache::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "CacheDirectory: " << this->CacheDirectory << "\n";
+  os << indent << "MaximumCacheSize: " << this->MaximumCacheSize << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleResultCache::SetCacheDirectory(const char* directory)
+{
+  std::string newDirectory = directory ? directory : "";
+  if (this->CacheDirectory == newDirectory)
+    {
+    return;
+    }
+  this->CacheDirectory = newDirectory;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+const char* vtkSlicerCLIModuleResultCache::GetCacheDirectory()const
+{
+  return this->CacheDirectory.c_str();
+}
+
+//----------------------------------------------------------------------------
+std::string vtkSlicerCLIModuleResultCache::ComputeDigest(const std::string& data)
+{
+  QByteArray digest = QCryptographicHash::hash(
+    QByteArray(data.c_str(), static_cast<int>(data.size())), QCryptographicHash::Sha1);
+  return std::string(digest.toHex().constData());
+}
+
+//----------------------------------------------------------------------------
+std::string vtkSlicerCLIModuleResultCache::ComputeFileDigest(const std::string& fileName)
+{
+  QFile file(QString::fromStdString(fileName));
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return std::string();
+    }
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  while (!file.atEnd())
+    {
+    hash.addData(file.read(1 << 20));
+    }
+  return std::string(hash.result().toHex().constData());
+}
+
+//----------------------------------------------------------------------------
+std::string vtkSlicerCLIModuleResultCache::GetEntryDirectory(const std::string& key)const
+{
+  return this->CacheDirectory + "/" + key;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIModuleResultCache::HasEntry(const std::string& key)
+{
+  if (this->CacheDirectory.empty() || !IsEntryKey(QString::fromStdString(key)))
+    {
+    return false;
+    }
+  return QFileInfo(QString::fromStdString(this->GetEntryDirectory(key))).isDir();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIModuleResultCache::RetrieveEntry(const std::string& key, const FileNameMap& files)
+{
+  QMutexLocker locker(&CacheMutex);
+  if (!this->HasEntry(key))
+    {
+    return false;
+    }
+  QDir entryDir(QString::fromStdString(this->GetEntryDirectory(key)));
+  for (FileNameMap::const_iterator it = files.begin(); it != files.end(); ++it)
+    {
+    if (!CopyFile(entryDir.filePath(QString::fromStdString(it->first)),
+                  QString::fromStdString(it->second)))
+      {
+      vtkWarningMacro("RetrieveEntry: failed to retrieve " << it->first
+                      << " from cache entry " << key);
+      return false;
+      }
+    }
+  TouchEntry(entryDir.absolutePath());
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIModuleResultCache::StoreEntry(const std::string& key, const FileNameMap& files)
+{
+  if (this->CacheDirectory.empty())
+    {
+    return false;
+    }
+  if (!IsEntryKey(QString::fromStdString(key)))
+    {
+    vtkErrorMacro("StoreEntry: invalid key " << key << ", a SHA-1 digest is expected");
+    return false;
+    }
+  QMutexLocker locker(&CacheMutex);
+  QDir cacheDir(QString::fromStdString(this->CacheDirectory));
+  if (!cacheDir.mkpath("."))
+    {
+    vtkErrorMacro("StoreEntry: failed to create cache directory " << this->CacheDirectory);
+    return false;
+    }
+
+  // Copy the files in a partial entry first so that an incomplete entry is
+  // never retrieved.
+  QString entryName = QString::fromStdString(key);
+  QString partialEntryName = entryName + PartialEntrySuffix;
+  ctk::removeDirRecursively(cacheDir.filePath(partialEntryName));
+  if (!cacheDir.mkdir(partialEntryName))
+    {
+    vtkErrorMacro("StoreEntry: failed to create cache entry " << key);
+    return false;
+    }
+  QDir partialEntryDir(cacheDir.filePath(partialEntryName));
+  for (FileNameMap::const_iterator it = files.begin(); it != files.end(); ++it)
+    {
+    if (!CopyFile(QString::fromStdString(it->second),
+                  partialEntryDir.filePath(QString::fromStdString(it->first))))
+      {
+      vtkWarningMacro("StoreEntry: failed to store " << it->second
+                      << " in cache entry " << key);
+      ctk::removeDirRecursively(partialEntryDir.absolutePath());
+      return false;
+      }
+    }
+  TouchEntry(partialEntryDir.absolutePath());
+
+  ctk::removeDirRecursively(cacheDir.filePath(entryName));
+  if (!cacheDir.rename(partialEntryName, entryName))
+    {
+    ctk::removeDirRecursively(partialEntryDir.absolutePath());
+    return false;
+    }
+  locker.unlock();
+
+  this->Prune();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleResultCache::Prune()
+{
+  if (this->CacheDirectory.empty())
+    {
+    return;
+    }
+  QMutexLocker locker(&CacheMutex);
+  std::vector<CacheEntry> entries = ListEntries(QString::fromStdString(this->CacheDirectory));
+  std::sort(entries.begin(), entries.end());
+
+  qint64 cacheSize = 0;
+  for (std::vector<CacheEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+    cacheSize += it->Size;
+    }
+  const qint64 maximumCacheSize = static_cast<qint64>(this->MaximumCacheSize) * 1024 * 1024;
+  // least recently used first
+  for (std::vector<CacheEntry>::const_iterator it = entries.begin();
+       it != entries.end() && cacheSize > maximumCacheSize; ++it)
+    {
+    if (ctk::removeDirRecursively(it->Path))
+      {
+      cacheSize -= it->Size;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleResultCache::Clear()
+{
+  if (this->CacheDirectory.empty())
+    {
+    return;
+    }
+  QMutexLocker locker(&CacheMutex);
+  std::vector<CacheEntry> entries = ListEntries(QString::fromStdString(this->CacheDirectory));
+  for (std::vector<CacheEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+    ctk::removeDirRecursively(it->Path);
+    }
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerCLIModuleResultCache::GetCacheSize()
+{
+  if (this->CacheDirectory.empty())
+    {
+    return 0.;
+    }
+  QMutexLocker locker(&CacheMutex);
+  std::vector<CacheEntry> entries = ListEntries(QString::fromStdString(this->CacheDirectory));
+  double cacheSize = 0.;
+  for (std::vector<CacheEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+    cacheSize += static_cast<double>(it->Size);
+    }
+  return cacheSize;
+}
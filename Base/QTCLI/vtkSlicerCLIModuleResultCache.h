@@ -0,0 +1,102 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkSlicerCLIModuleResultCache_h
+#define __vtkSlicerCLIModuleResultCache_h
+
+// VTK includes
+#include <vtkObject.h>
+
+// STL includes
+#include <map>
+#include <string>
+
+#include "qSlicerBaseQTCLIExport.h"
+
+/// \brief Size-bounded on-disk store of CLI output files.
+///
+/// Each entry is a directory of the cache directory named after a key
+/// (a SHA-1 digest of the module, its parameters and its input data, see
+/// ComputeDigest()) that contains the output files of one execution.
+/// Entries are stored atomically, and the least recently used entries are
+/// removed when the total size of the cache exceeds MaximumCacheSize.
+/// Only directories named after a key and marked as entries by the cache
+/// are listed or removed, other files of the cache directory are left
+/// untouched.
+///
+/// The cache can be shared by several CLI module logics and used from
+/// several threads.
+/// \sa vtkSlicerCLIModuleLogic::SetResultCacheEnabled()
+class Q_SLICER_BASE_QTCLI_EXPORT vtkSlicerCLIModuleResultCache : public vtkObject
+{
+public:
+  static vtkSlicerCLIModuleResultCache *New();
+  vtkTypeMacro(vtkSlicerCLIModuleResultCache, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  typedef std::map<std::string, std::string> FileNameMap;
+
+  /// Directory where the entries are stored.
+  void SetCacheDirectory(const char* directory);
+  const char* GetCacheDirectory()const;
+
+  /// Maximum total size of the entries, in megabytes. 1024 by default.
+  vtkSetClampMacro(MaximumCacheSize, int, 0, VTK_INT_MAX);
+  vtkGetMacro(MaximumCacheSize, int);
+
+  /// Return a hexadecimal digest of a string or of the content of a file.
+  /// An empty string is returned if the file can't be read.
+  static std::string ComputeDigest(const std::string& data);
+  static std::string ComputeFileDigest(const std::string& fileName);
+
+  /// Return true if an entry exists for \a key.
+  bool HasEntry(const std::string& key);
+
+  /// Copy the files of the entry \a key to their destination.
+  /// \a files maps the names of the files in the entry to the destination
+  /// file names. Returns false if the entry or any file is missing.
+  bool RetrieveEntry(const std::string& key, const FileNameMap& files);
+
+  /// Store copies of files as the entry \a key, replacing any existing
+  /// entry with the same key, then remove the least recently used entries
+  /// if the cache is too large. \a key must be a digest returned by
+  /// ComputeDigest().
+  /// \a files maps the names of the files in the entry to the source
+  /// file names.
+  bool StoreEntry(const std::string& key, const FileNameMap& files);
+
+  /// Remove the least recently used entries until the cache size is
+  /// below MaximumCacheSize.
+  void Prune();
+
+  /// Remove all the entries.
+  void Clear();
+
+  /// Total size of the entries in bytes.
+  double GetCacheSize();
+
+protected:
+  vtkSlicerCLIModuleResultCache();
+  virtual ~vtkSlicerCLIModuleResultCache();
+
+  /// Return the directory of the entry \a key
+  std::string GetEntryDirectory(const std::string& key)const;
+
+  std::string CacheDirectory;
+  int MaximumCacheSize;
+
+private:
+  vtkSlicerCLIModuleResultCache(const vtkSlicerCLIModuleResultCache&);
+  void operator=(const vtkSlicerCLIModuleResultCache&);
+};
+
+#endif
@@ -317,6 +317,11 @@ void qSlicerCoreApplicationPrivate::init()
   // in MRMLApplicationLogic.
   //this->AppLogic->ProcessMRMLEvents(scene, vtkCommand::ModifiedEvent, NULL);
   //this->AppLogic->SetAndObserveMRMLScene(scene);
+  if (q->userSettings()->contains("Modules/NumberOfProcessingThreads"))
+    {
+    this->AppLogic->SetNumberOfProcessingThreads(
+      q->userSettings()->value("Modules/NumberOfProcessingThreads").toInt());
+    }
   this->AppLogic->CreateProcessingThread();
 
   // Set up Slicer to use the system proxy
@@ -0,0 +1,85 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLCLI includes
+#include "vtkMRMLCommandLineModuleNode.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+int TestExecutionStages()
+{
+  vtkNew<vtkMRMLCommandLineModuleNode> node;
+  CHECK_INT(node->GetNumberOfExecutionStages(), 0);
+  CHECK_DOUBLE(node->GetExecutionPeakMemory(), 0.);
+
+  // Stages are kept in the order they are reported
+  vtkMTimeType mtime = node->GetMTime();
+  node->AddExecutionStage("Smoothing", 1.5, 120.);
+  CHECK_BOOL(node->GetMTime() > mtime, true);
+  mtime = node->GetMTime();
+  node->AddExecutionStage("Thresholding", 0.25, 300.5, false);
+  CHECK_BOOL(node->GetMTime() == mtime, true);
+  node->AddExecutionStage("Writing", 2., 0.);
+
+  CHECK_INT(node->GetNumberOfExecutionStages(), 3);
+  CHECK_STD_STRING(node->GetExecutionStageName(0), "Smoothing");
+  CHECK_DOUBLE(node->GetExecutionStageTime(0), 1.5);
+  CHECK_DOUBLE(node->GetExecutionStagePeakMemory(0), 120.);
+  CHECK_STD_STRING(node->GetExecutionStageName(1), "Thresholding");
+  CHECK_DOUBLE(node->GetExecutionStageTime(1), 0.25);
+  CHECK_DOUBLE(node->GetExecutionStagePeakMemory(1), 300.5);
+  CHECK_STD_STRING(node->GetExecutionStageName(2), "Writing");
+  CHECK_DOUBLE(node->GetExecutionStageTime(2), 2.);
+  CHECK_DOUBLE(node->GetExecutionStagePeakMemory(2), 0.);
+
+  // Highest peak of all the stages
+  CHECK_DOUBLE(node->GetExecutionPeakMemory(), 300.5);
+
+  // Invalid stages
+  CHECK_STD_STRING(node->GetExecutionStageName(-1), "");
+  CHECK_STD_STRING(node->GetExecutionStageName(3), "");
+  CHECK_DOUBLE(node->GetExecutionStageTime(3), 0.);
+  CHECK_DOUBLE(node->GetExecutionStagePeakMemory(-1), 0.);
+
+  // Clearing
+  mtime = node->GetMTime();
+  node->ClearExecutionStages(false);
+  CHECK_BOOL(node->GetMTime() == mtime, true);
+  CHECK_INT(node->GetNumberOfExecutionStages(), 0);
+  CHECK_DOUBLE(node->GetExecutionPeakMemory(), 0.);
+  CHECK_STD_STRING(node->GetExecutionStageName(0), "");
+
+  // Clearing no stage doesn't modify the node
+  node->ClearExecutionStages();
+  CHECK_BOOL(node->GetMTime() == mtime, true);
+  node->AddExecutionStage("Smoothing", 1., 10., false);
+  node->ClearExecutionStages();
+  CHECK_BOOL(node->GetMTime() > mtime, true);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkMRMLCommandLineModuleNodeTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  CHECK_EXIT_SUCCESS(TestExecutionStages());
+  return EXIT_SUCCESS;
+}
@@ -26,9 +26,12 @@ Version:   $Revision: 1.2 $
 #include <vtkIntArray.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkSimpleCriticalSection.h>
 
 // STD includes
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 
 //------------------------------------------------------------------------------
@@ -67,6 +70,17 @@ public:
   std::string OutputText;
   /// Error messages of last execution (printed to stderr)
   std::string ErrorText;
+
+  /// Stages reported during the last execution. They are added by the
+  /// thread running the module while the GUI reads them.
+  struct ExecutionStage
+  {
+    std::string Name;
+    double Time;
+    double PeakMemory;
+  };
+  std::vector<ExecutionStage> ExecutionStages;
+  mutable vtkSimpleCriticalSection ExecutionStagesLock;
 };
 
 ModuleDescriptionMap vtkMRMLCommandLineModuleNode::vtkInternal::RegisteredModules;
@@ -1058,6 +1072,99 @@ void vtkMRMLCommandLineModuleNode::SetErrorText(const std::string& text, bool mo
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLCommandLineModuleNode::AddExecutionStage(
+  const std::string& name, double time, double peakMemory, bool modify)
+{
+  vtkInternal::ExecutionStage stage;
+  stage.Name = name;
+  stage.Time = time;
+  stage.PeakMemory = peakMemory;
+  this->Internal->ExecutionStagesLock.Lock();
+  this->Internal->ExecutionStages.push_back(stage);
+  this->Internal->ExecutionStagesLock.Unlock();
+  if (modify)
+    {
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLCommandLineModuleNode::ClearExecutionStages(bool modify)
+{
+  this->Internal->ExecutionStagesLock.Lock();
+  bool wasEmpty = this->Internal->ExecutionStages.empty();
+  this->Internal->ExecutionStages.clear();
+  this->Internal->ExecutionStagesLock.Unlock();
+  if (modify && !wasEmpty)
+    {
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLCommandLineModuleNode::GetNumberOfExecutionStages() const
+{
+  this->Internal->ExecutionStagesLock.Lock();
+  int numberOfStages = static_cast<int>(this->Internal->ExecutionStages.size());
+  this->Internal->ExecutionStagesLock.Unlock();
+  return numberOfStages;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkMRMLCommandLineModuleNode::GetExecutionStageName(int stage) const
+{
+  std::string name;
+  this->Internal->ExecutionStagesLock.Lock();
+  if (stage >= 0 && stage < static_cast<int>(this->Internal->ExecutionStages.size()))
+    {
+    name = this->Internal->ExecutionStages[stage].Name;
+    }
+  this->Internal->ExecutionStagesLock.Unlock();
+  return name;
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLCommandLineModuleNode::GetExecutionStageTime(int stage) const
+{
+  double time = 0.;
+  this->Internal->ExecutionStagesLock.Lock();
+  if (stage >= 0 && stage < static_cast<int>(this->Internal->ExecutionStages.size()))
+    {
+    time = this->Internal->ExecutionStages[stage].Time;
+    }
+  this->Internal->ExecutionStagesLock.Unlock();
+  return time;
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLCommandLineModuleNode::GetExecutionStagePeakMemory(int stage) const
+{
+  double peakMemory = 0.;
+  this->Internal->ExecutionStagesLock.Lock();
+  if (stage >= 0 && stage < static_cast<int>(this->Internal->ExecutionStages.size()))
+    {
+    peakMemory = this->Internal->ExecutionStages[stage].PeakMemory;
+    }
+  this->Internal->ExecutionStagesLock.Unlock();
+  return peakMemory;
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLCommandLineModuleNode::GetExecutionPeakMemory() const
+{
+  double peakMemory = 0.;
+  this->Internal->ExecutionStagesLock.Lock();
+  for (std::vector<vtkInternal::ExecutionStage>::const_iterator it =
+         this->Internal->ExecutionStages.begin();
+       it != this->Internal->ExecutionStages.end(); ++it)
+    {
+    peakMemory = std::max(peakMemory, it->PeakMemory);
+    }
+  this->Internal->ExecutionStagesLock.Unlock();
+  return peakMemory;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLCommandLineModuleNode::SetOutputText(const std::string& text, bool modify)
 {
@@ -124,6 +124,22 @@ public:
   /// Get error messages generated during latest execution.
   const std::string GetErrorText() const;
 
+  /// Add a stage (filter) reported by the module during the latest
+  /// execution, with its duration in seconds and the high-water mark of the
+  /// memory used by the module when the stage ended, in megabytes (0 if
+  /// unknown).
+  /// Stages are reported by executable modules only.
+  void AddExecutionStage(const std::string& name, double time, double peakMemory,
+                         bool modify = true);
+  /// Remove the stages of the latest execution.
+  void ClearExecutionStages(bool modify = true);
+  int GetNumberOfExecutionStages() const;
+  std::string GetExecutionStageName(int stage) const;
+  double GetExecutionStageTime(int stage) const;
+  double GetExecutionStagePeakMemory(int stage) const;
+  /// Highest peak memory of the stages of the latest execution, in megabytes.
+  double GetExecutionPeakMemory() const;
+
   /// Return true if the module is in a busy state: Scheduled, Running,
   /// Cancelling, Completing.
   /// \sa SetStatus(), GetStatus(), BusyMask, Cancel()
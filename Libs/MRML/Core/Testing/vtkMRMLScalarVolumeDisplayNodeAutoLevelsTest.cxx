@@ -0,0 +1,115 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeDisplayNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// CT-like image: air (-1000) with a block of soft tissue (0 to 79) in the middle.
+vtkSmartPointer<vtkImageData> CreateImage(int dimensions[3], short tissueOffset)
+{
+  vtkSmartPointer<vtkImageData> imageData = vtkSmartPointer<vtkImageData>::New();
+  imageData->SetDimensions(dimensions);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  short* voxels = static_cast<short*>(imageData->GetScalarPointer());
+  for (int z = 0; z < dimensions[2]; ++z)
+    {
+    for (int y = 0; y < dimensions[1]; ++y)
+      {
+      for (int x = 0; x < dimensions[0]; ++x, ++voxels)
+        {
+        bool tissue =
+          x > dimensions[0] / 4 && x < 3 * dimensions[0] / 4 &&
+          y > dimensions[1] / 4 && y < 3 * dimensions[1] / 4 &&
+          z > dimensions[2] / 4 && z < 3 * dimensions[2] / 4;
+        *voxels = tissue ? tissueOffset + (7 * x + 13 * y + 3 * z) % 80 : -1000;
+        }
+      }
+    }
+  return imageData;
+}
+
+//---------------------------------------------------------------------------
+int TestAutoLevels(int dimensions[3], double& window, double& level)
+{
+  vtkSmartPointer<vtkImageData> imageData = CreateImage(dimensions, 0);
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetAndObserveImageData(imageData);
+  scene->AddNode(volumeNode.GetPointer());
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> displayNode;
+  scene->AddNode(displayNode.GetPointer());
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  timer->StopTimer();
+  std::cout << "<DartMeasurement name=\"vtkMRMLScalarVolumeDisplayNode-AutoLevelsPerformance-"
+            << imageData->GetNumberOfPoints() << "\" type=\"numeric/double\">"
+            << timer->GetElapsedTime() << "</DartMeasurement>" << std::endl;
+
+  window = displayNode->GetWindow();
+  level = displayNode->GetLevel();
+  CHECK_BOOL(window > 0.0, true);
+  CHECK_BOOL(level > 0.0 && level < 80.0, true);
+
+  // Auto levels are restored from the cache when the display node is modified
+  displayNode->SetWindowLevel(1.0, 1.0);
+  CHECK_DOUBLE(displayNode->GetWindow(), window);
+  CHECK_DOUBLE(displayNode->GetLevel(), level);
+
+  // Auto levels are computed again when the image is modified
+  imageData->DeepCopy(CreateImage(dimensions, 1000));
+  displayNode->Modified();
+  CHECK_BOOL(displayNode->GetLevel() > 1000.0 && displayNode->GetLevel() < 1080.0, true);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+// Check that auto window/level of an image that is large enough to be
+// subsampled is close to the one of a small image with the same histogram.
+int vtkMRMLScalarVolumeDisplayNodeAutoLevelsTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  int smallDimensions[3] = {64, 64, 64};
+  double smallWindow = 0.0;
+  double smallLevel = 0.0;
+  CHECK_EXIT_SUCCESS(TestAutoLevels(smallDimensions, smallWindow, smallLevel));
+
+  int largeDimensions[3] = {256, 256, 160};
+  double largeWindow = 0.0;
+  double largeLevel = 0.0;
+  CHECK_EXIT_SUCCESS(TestAutoLevels(largeDimensions, largeWindow, largeLevel));
+
+  CHECK_DOUBLE_TOLERANCE(largeWindow, smallWindow, 10.0);
+  CHECK_DOUBLE_TOLERANCE(largeLevel, smallLevel, 5.0);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLGridTransformNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkCommand.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkOrientedGridTransform.h>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Counts progress events and optionally cancels the transform application
+class vtkHardenProgressCallback : public vtkCommand
+{
+public:
+  static vtkHardenProgressCallback *New() { return new vtkHardenProgressCallback; }
+  virtual void Execute(vtkObject* caller, unsigned long eventId, void* callData) VTK_OVERRIDE
+    {
+    if (eventId != vtkCommand::ProgressEvent)
+      {
+      return;
+      }
+    this->NumberOfProgressEvents++;
+    this->LastProgress = *(reinterpret_cast<double*>(callData));
+    if (this->AbortOnFirstProgress)
+      {
+      vtkMRMLVolumeNode::SafeDownCast(caller)->AbortApplyNonLinearTransform();
+      }
+    }
+  int NumberOfProgressEvents;
+  double LastProgress;
+  bool AbortOnFirstProgress;
+protected:
+  vtkHardenProgressCallback() : NumberOfProgressEvents(0), LastProgress(0.0), AbortOnFirstProgress(false) {}
+};
+
+//---------------------------------------------------------------------------
+// Add a grid transform that translates by (shift, 0, 0) in the region of the test volume
+vtkMRMLGridTransformNode* AddTranslationGridTransform(vtkMRMLScene* scene, double shift)
+{
+  vtkNew<vtkImageData> displacementGrid;
+  displacementGrid->SetExtent(0, 5, 0, 5, 0, 5);
+  displacementGrid->SetOrigin(-10, -10, -10);
+  displacementGrid->SetSpacing(10, 10, 10);
+  displacementGrid->AllocateScalars(VTK_DOUBLE, 3);
+  double* displacement = static_cast<double*>(displacementGrid->GetScalarPointer());
+  for (vtkIdType i = 0; i < displacementGrid->GetNumberOfPoints(); i++)
+    {
+    *(displacement++) = shift;
+    *(displacement++) = 0.0;
+    *(displacement++) = 0.0;
+    }
+  vtkNew<vtkOrientedGridTransform> gridTransform;
+  gridTransform->SetDisplacementGridData(displacementGrid.GetPointer());
+
+  vtkNew<vtkMRMLGridTransformNode> transformNode;
+  transformNode->SetAndObserveTransformToParent(gridTransform.GetPointer());
+  scene->AddNode(transformNode.GetPointer());
+  return transformNode.GetPointer();
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+// Test hardening of a non-linear transform on a scalar volume
+// (slab-by-slab resampling, progress reporting, and cancellation)
+int vtkMRMLScalarVolumeNodeTest3(int , char * [] )
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  // Create a volume with voxel values increasing along the I axis
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(20, 20, 30);
+  imageData->AllocateScalars(VTK_FLOAT, 1);
+  int* dims = imageData->GetDimensions();
+  for (int z = 0; z < dims[2]; z++)
+    {
+    for (int y = 0; y < dims[1]; y++)
+      {
+      for (int x = 0; x < dims[0]; x++)
+        {
+        float* pixel = static_cast<float*>(imageData->GetScalarPointer(x,y,z));
+        pixel[0] = static_cast<float>(x);
+        }
+      }
+    }
+
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetAndObserveImageData(imageData.GetPointer());
+  scene->AddNode(volumeNode.GetPointer());
+
+  const double shift = 2.0;
+  vtkMRMLGridTransformNode* transformNode = AddTranslationGridTransform(scene.GetPointer(), shift);
+  volumeNode->SetAndObserveTransformNodeID(transformNode->GetID());
+
+  vtkNew<vtkHardenProgressCallback> callback;
+  volumeNode->AddObserver(vtkCommand::ProgressEvent, callback.GetPointer());
+
+  // Cancel hardening: transform must be kept and the image must not change
+  callback->AbortOnFirstProgress = true;
+  CHECK_BOOL(volumeNode->HardenTransform(), false);
+  CHECK_INT(callback->NumberOfProgressEvents, 1);
+  CHECK_POINTER(volumeNode->GetImageData(), imageData.GetPointer());
+  CHECK_POINTER(volumeNode->GetParentTransformNode(), transformNode);
+
+  // Harden the transform
+  callback->AbortOnFirstProgress = false;
+  callback->NumberOfProgressEvents = 0;
+  CHECK_BOOL(volumeNode->HardenTransform(), true);
+  CHECK_NULL(volumeNode->GetParentTransformNode());
+  CHECK_BOOL(callback->NumberOfProgressEvents > 1, true);
+  CHECK_DOUBLE(callback->LastProgress, 1.0);
+
+  // Transformed image content: output(x) = input(x - shift)
+  vtkImageData* hardenedImageData = volumeNode->GetImageData();
+  CHECK_NOT_NULL(hardenedImageData);
+  int* hardenedDims = hardenedImageData->GetDimensions();
+  CHECK_INT(hardenedDims[0], dims[0]);
+  CHECK_INT(hardenedDims[1], dims[1]);
+  CHECK_INT(hardenedDims[2], dims[2]);
+  for (int z = 0; z < dims[2]; z++)
+    {
+    CHECK_DOUBLE_TOLERANCE(hardenedImageData->GetScalarComponentAsDouble(10, 10, z, 0), 10.0 - shift, 1e-3);
+    }
+
+  return EXIT_SUCCESS;
+}
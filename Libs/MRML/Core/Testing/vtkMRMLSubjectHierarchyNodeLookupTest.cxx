@@ -0,0 +1,204 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSubjectHierarchyConstants.h"
+#include "vtkMRMLSubjectHierarchyNode.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+const int NUMBER_OF_PATIENTS = 10;
+const int NUMBER_OF_STUDIES_PER_PATIENT = 10;
+const int NUMBER_OF_SERIES_PER_STUDY = 500;
+/// One series in this many has a data node
+const int DATA_NODE_SERIES_RATIO = 50;
+
+//---------------------------------------------------------------------------
+std::string SeriesUID(int seriesIndex)
+{
+  std::stringstream ss;
+  ss << "1.2.840.113619." << seriesIndex;
+  return ss.str();
+}
+
+//---------------------------------------------------------------------------
+std::string InstanceUIDs(int seriesIndex)
+{
+  std::stringstream ss;
+  ss << SeriesUID(seriesIndex) << ".1 " << SeriesUID(seriesIndex) << ".2 " << SeriesUID(seriesIndex) << ".3";
+  return ss.str();
+}
+
+//---------------------------------------------------------------------------
+// UID lists match whole UIDs, whether they are searched with the lookup
+// table or by walking the tree
+int TestUIDListMatching()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSubjectHierarchyNode* shNode = vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(scene.GetPointer());
+  CHECK_NOT_NULL(shNode);
+  const char* instanceUIDName = vtkMRMLSubjectHierarchyConstants::GetDICOMInstanceUIDName();
+
+  // The UIDs of the first series start with the UID of the second one
+  vtkIdType studyItemID = shNode->CreateStudyItem(shNode->GetSceneItemID(), "Study");
+  vtkIdType firstSeriesItemID = shNode->CreateFolderItem(studyItemID, "FirstSeries");
+  shNode->SetItemUID(firstSeriesItemID, instanceUIDName, "1.2.30 1.2.31");
+  vtkIdType secondSeriesItemID = shNode->CreateFolderItem(studyItemID, "SecondSeries");
+  shNode->SetItemUID(secondSeriesItemID, instanceUIDName, "1.2.3");
+
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "1.2.31"), firstSeriesItemID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "1.2.30 1.2.31"), firstSeriesItemID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "1.2.3"), secondSeriesItemID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "1.2"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+  // Items already found are searched without the lookup table, the
+  // second series must not be taken for a part of the first one
+  vtkIdType referencingItemID = shNode->CreateFolderItem(studyItemID, "Referencing");
+  shNode->SetItemAttribute(referencingItemID,
+    vtkMRMLSubjectHierarchyConstants::GetDICOMReferencedInstanceUIDsAttributeName(), "1.2.30 1.2.3");
+  std::vector<vtkIdType> referencedItemIDs = shNode->GetItemsReferencedFromItemByDICOM(referencingItemID);
+  CHECK_INT(static_cast<int>(referencedItemIDs.size()), 2);
+  CHECK_INT(referencedItemIDs[0], firstSeriesItemID);
+  CHECK_INT(referencedItemIDs[1], secondSeriesItemID);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+// Build a hierarchy of about 50000 items the way DICOM import does (checking
+// that each series UID is not in the hierarchy yet before adding it), then
+// check that items are found by data node, UID and UID list.
+int vtkMRMLSubjectHierarchyNodeLookupTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSubjectHierarchyNode* shNode = vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(scene.GetPointer());
+  CHECK_NOT_NULL(shNode);
+
+  const char* uidName = vtkMRMLSubjectHierarchyConstants::GetDICOMUIDName();
+  const char* instanceUIDName = vtkMRMLSubjectHierarchyConstants::GetDICOMInstanceUIDName();
+
+  std::vector<vtkIdType> seriesItemIDs;
+  std::vector<vtkIdType> studyItemIDs;
+  std::vector<vtkSmartPointer<vtkMRMLScalarVolumeNode> > dataNodes;
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  int seriesIndex = 0;
+  for (int patient = 0; patient < NUMBER_OF_PATIENTS; ++patient)
+    {
+    vtkIdType patientItemID = shNode->CreateSubjectItem(shNode->GetSceneItemID(), "Patient");
+    for (int study = 0; study < NUMBER_OF_STUDIES_PER_PATIENT; ++study)
+      {
+      vtkIdType studyItemID = shNode->CreateStudyItem(patientItemID, "Study");
+      studyItemIDs.push_back(studyItemID);
+      for (int series = 0; series < NUMBER_OF_SERIES_PER_STUDY; ++series, ++seriesIndex)
+        {
+        std::string seriesUID = SeriesUID(seriesIndex);
+        CHECK_INT(shNode->GetItemByUID(uidName, seriesUID.c_str()), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+        vtkIdType seriesItemID = vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID;
+        if (seriesIndex % DATA_NODE_SERIES_RATIO == 0)
+          {
+          vtkSmartPointer<vtkMRMLScalarVolumeNode> volumeNode = vtkSmartPointer<vtkMRMLScalarVolumeNode>::New();
+          scene->AddNode(volumeNode);
+          dataNodes.push_back(volumeNode);
+          seriesItemID = shNode->CreateItem(studyItemID, volumeNode);
+          }
+        else
+          {
+          seriesItemID = shNode->CreateFolderItem(studyItemID, "Series");
+          }
+        shNode->SetItemUID(seriesItemID, uidName, seriesUID);
+        shNode->SetItemUID(seriesItemID, instanceUIDName, InstanceUIDs(seriesIndex));
+        seriesItemIDs.push_back(seriesItemID);
+        }
+      }
+    }
+  timer->StopTimer();
+  std::cout << "<DartMeasurement name=\"vtkMRMLSubjectHierarchyNode-BuildPerformance-"
+            << seriesIndex << "\" type=\"numeric/double\">"
+            << timer->GetElapsedTime() << "</DartMeasurement>" << std::endl;
+
+  // Look up all the items
+  timer->StartTimer();
+  for (int i = 0; i < seriesIndex; ++i)
+    {
+    CHECK_INT(shNode->GetItemByUID(uidName, SeriesUID(i).c_str()), seriesItemIDs[i]);
+    std::string secondInstanceUID = SeriesUID(i) + ".2";
+    CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, secondInstanceUID.c_str()), seriesItemIDs[i]);
+    }
+  for (int i = 0; i < static_cast<int>(dataNodes.size()); ++i)
+    {
+    CHECK_INT(shNode->GetItemByDataNode(dataNodes[i]), seriesItemIDs[i * DATA_NODE_SERIES_RATIO]);
+    }
+  timer->StopTimer();
+  std::cout << "<DartMeasurement name=\"vtkMRMLSubjectHierarchyNode-LookupPerformance-"
+            << seriesIndex << "\" type=\"numeric/double\">"
+            << timer->GetElapsedTime() << "</DartMeasurement>" << std::endl;
+
+  // The whole instance UID list is found as a UID, a single instance UID is not
+  CHECK_INT(shNode->GetItemByUID(instanceUIDName, InstanceUIDs(1).c_str()), seriesItemIDs[1]);
+  CHECK_INT(shNode->GetItemByUID(instanceUIDName, (SeriesUID(1) + ".2").c_str()), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+  // Reparented items are still found
+  shNode->SetItemParent(seriesItemIDs[0], studyItemIDs[1]);
+  CHECK_INT(shNode->GetItemParent(seriesItemIDs[0]), studyItemIDs[1]);
+  CHECK_INT(shNode->GetItemByDataNode(dataNodes[0]), seriesItemIDs[0]);
+  CHECK_INT(shNode->GetItemByUID(uidName, SeriesUID(0).c_str()), seriesItemIDs[0]);
+
+  // UIDs added after creation are found
+  shNode->SetItemUID(seriesItemIDs[2], "Other", "OtherUID");
+  CHECK_INT(shNode->GetItemByUID("Other", "OtherUID"), seriesItemIDs[2]);
+  CHECK_INT(shNode->GetItemByUID(uidName, SeriesUID(2).c_str()), seriesItemIDs[2]);
+
+  // Removed items are not found anymore, their children are
+  CHECK_BOOL(shNode->RemoveItem(seriesItemIDs[DATA_NODE_SERIES_RATIO], false, false), true);
+  CHECK_INT(shNode->GetItemByDataNode(dataNodes[1]), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  CHECK_INT(shNode->GetItemByUID(uidName, SeriesUID(DATA_NODE_SERIES_RATIO).c_str()), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, (SeriesUID(DATA_NODE_SERIES_RATIO) + ".1").c_str()),
+    vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+  CHECK_BOOL(shNode->RemoveItem(studyItemIDs[0], false, false), true);
+  CHECK_INT(shNode->GetItemByUID(uidName, SeriesUID(3).c_str()), seriesItemIDs[3]);
+
+  CHECK_BOOL(shNode->RemoveItem(studyItemIDs[2], false, true), true);
+  CHECK_INT(shNode->GetItemByUID(uidName, SeriesUID(2 * NUMBER_OF_SERIES_PER_STUDY).c_str()),
+    vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  CHECK_INT(shNode->GetItemByDataNode(dataNodes[2 * NUMBER_OF_SERIES_PER_STUDY / DATA_NODE_SERIES_RATIO]),
+    vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+  shNode->RemoveAllItems();
+  CHECK_INT(shNode->GetItemByDataNode(dataNodes[3]), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  CHECK_INT(shNode->GetItemByUID(uidName, SeriesUID(seriesIndex - 1).c_str()), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+  CHECK_EXIT_SUCCESS(TestUIDListMatching());
+
+  return EXIT_SUCCESS;
+}
@@ -13,6 +13,7 @@
 // MRML includes
 #include "vtkMRMLCoreTestingMacros.h"
 #include "vtkOrientedBSplineTransform.h"
+#include "vtkOrientedGridTransform.h"
 
 // ITK includes
 #include <itkAffineTransform.h>
@@ -20,8 +21,10 @@
 
 // VTK includes
 #include "vtkImageData.h"
+#include "vtkMath.h"
 #include "vtkMatrix4x4.h"
 #include "vtkNew.h"
+#include "vtkPoints.h"
 
 typedef itk::BSplineDeformableTransform<double,3,3> itkBSplineType;
 
@@ -365,6 +368,16 @@ int vtkOrientedBSplineTransformTest1(int , char * [] )
   SetBSplineNodeVtk(bsplineVtk.GetPointer(), modifiedBSplineNodeIndex2, modifiedBSplineNodeValue2);
   SetBSplineNodeVtk(bsplineVtk.GetPointer(), modifiedBSplineNodeIndex3, modifiedBSplineNodeValue3);
 
+  vtkNew<vtkPoints> batchInputPoints;
+  vtkNew<vtkMatrix4x4> gridDirectionMatrix;
+  for (int row=0; row<3; row++)
+    {
+    for (int col=0; col<3; col++)
+      {
+      gridDirectionMatrix->SetElement(row,col,direction[row][col]);
+      }
+    }
+
   int numberOfPointsTested=0;
   int numberOfItkVtkPointMismatches=0;
   int numberOfSingleDoubleVtkPointMismatches=0;
@@ -397,6 +410,7 @@ int vtkOrientedBSplineTransformTest1(int , char * [] )
         inputPoint[0] = origin[0]+direction[0][0]*spacing[0]*i+direction[0][1]*spacing[1]*j+direction[0][2]*spacing[2]*k;
         inputPoint[1] = origin[1]+direction[1][0]*spacing[0]*i+direction[1][1]*spacing[1]*j+direction[1][2]*spacing[2]*k;
         inputPoint[2] = origin[2]+direction[2][0]*spacing[0]*i+direction[2][1]*spacing[1]*j+direction[2][2]*spacing[2]*k;
+        batchInputPoints->InsertNextPoint(inputPoint);
         // Compare transformation results computed by ITK and VTK.
         double differenceItkVtk = getTransformedPointDifferenceItkVtk(inputPoint, bsplineItk, bsplineVtk.GetPointer(), false);
         if ( differenceItkVtk > 1e-6 )
@@ -432,13 +446,77 @@ int vtkOrientedBSplineTransformTest1(int , char * [] )
       }
     }
 
+  // Verify that batch (multithreaded) point transformation gives the same results
+  // as transforming points one by one
+  int numberOfBatchMismatches=0;
+  vtkNew<vtkPoints> batchOutputPoints;
+  bsplineVtk->TransformPoints(batchInputPoints.GetPointer(), batchOutputPoints.GetPointer());
+  if (batchOutputPoints->GetNumberOfPoints() != batchInputPoints->GetNumberOfPoints())
+    {
+    std::cout << "ERROR: TransformPoints output point count mismatch" << std::endl;
+    numberOfBatchMismatches++;
+    }
+  else
+    {
+    for (vtkIdType pointIndex=0; pointIndex<batchInputPoints->GetNumberOfPoints(); pointIndex++)
+      {
+      double outputPoint[3]={0};
+      bsplineVtk->TransformPoint(batchInputPoints->GetPoint(pointIndex), outputPoint);
+      double* batchOutputPoint = batchOutputPoints->GetPoint(pointIndex);
+      if (sqrt(vtkMath::Distance2BetweenPoints(outputPoint, batchOutputPoint)) > 1e-6)
+        {
+        std::cout << "ERROR: TransformPoints result mismatch at point " << pointIndex << std::endl;
+        numberOfBatchMismatches++;
+        }
+      }
+    }
+
+  // Verify that the transform converted to a grid transform gives the same
+  // displacement at the grid points
+  int numberOfGridMismatches=0;
+  vtkNew<vtkOrientedGridTransform> gridVtk;
+  int gridExtent[6]={2, 5, 2, 6, 2, 5};
+  if (!bsplineVtk->ConvertToGridTransform(gridVtk.GetPointer(), gridExtent, origin, spacing, gridDirectionMatrix.GetPointer()))
+    {
+    std::cout << "ERROR: ConvertToGridTransform failed" << std::endl;
+    numberOfGridMismatches++;
+    }
+  else
+    {
+    for (int k=gridExtent[4]; k<=gridExtent[5]; k++)
+      {
+      for (int j=gridExtent[2]; j<=gridExtent[3]; j++)
+        {
+        for (int i=gridExtent[0]; i<=gridExtent[1]; i++)
+          {
+          double gridPoint[3];
+          gridPoint[0] = origin[0]+direction[0][0]*spacing[0]*i+direction[0][1]*spacing[1]*j+direction[0][2]*spacing[2]*k;
+          gridPoint[1] = origin[1]+direction[1][0]*spacing[0]*i+direction[1][1]*spacing[1]*j+direction[1][2]*spacing[2]*k;
+          gridPoint[2] = origin[2]+direction[2][0]*spacing[0]*i+direction[2][1]*spacing[1]*j+direction[2][2]*spacing[2]*k;
+          double bsplineOutputPoint[3]={0};
+          bsplineVtk->TransformPoint(gridPoint, bsplineOutputPoint);
+          double gridOutputPoint[3]={0};
+          gridVtk->TransformPoint(gridPoint, gridOutputPoint);
+          if (sqrt(vtkMath::Distance2BetweenPoints(bsplineOutputPoint, gridOutputPoint)) > 1e-3)
+            {
+            std::cout << "ERROR: ConvertToGridTransform result mismatch at grid point ("<<i<<","<<j<<","<<k<<")"<< std::endl;
+            numberOfGridMismatches++;
+            }
+          }
+        }
+      }
+    }
+
   std::cout << "Number of points tested: " << numberOfPointsTested << std::endl;
   std::cout << "Number of ITK/VTK mismatches: " << numberOfItkVtkPointMismatches << std::endl;
   std::cout << "Number of single/double precision mismatches: " << numberOfSingleDoubleVtkPointMismatches << std::endl;
   std::cout << "Number of derivative mismatches: " << numberOfDerivativeMismatches << std::endl;
   std::cout << "Number of inverse mismatches: " << numberOfInverseMismatches << std::endl;
+  std::cout << "Number of batch transform mismatches: " << numberOfBatchMismatches << std::endl;
+  std::cout << "Number of grid conversion mismatches: " << numberOfGridMismatches << std::endl;
 
-  if (numberOfItkVtkPointMismatches==0 && numberOfDerivativeMismatches==0 && numberOfInverseMismatches==0)
+  if (numberOfItkVtkPointMismatches==0 && numberOfDerivativeMismatches==0 && numberOfInverseMismatches==0
+    && numberOfBatchMismatches==0 && numberOfGridMismatches==0)
     {
     std::cout << "Test result: PASSED" << std::endl;
     return EXIT_SUCCESS;
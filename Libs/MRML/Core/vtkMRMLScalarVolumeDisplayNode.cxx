@@ -23,16 +23,19 @@ Version:   $Revision: 1.2 $
 #include <vtkAlgorithmOutput.h>
 #include <vtkCallbackCommand.h>
 #include <vtkColorTransferFunction.h>
-#include <vtkImageAccumulate.h>
 #include <vtkImageAppendComponents.h>
 #include <vtkImageExtractComponents.h>
 #include <vtkImageBimodalAnalysis.h>
 #include <vtkImageCast.h>
 #include <vtkImageData.h>
+#include <vtkImageHistogram.h>
 #include <vtkImageLogic.h>
 #include <vtkImageMapToWindowLevelColors.h>
+#include <vtkImageShrink3D.h>
 #include <vtkImageStencil.h>
 #include <vtkImageThreshold.h>
+#include <vtkIdTypeArray.h>
+#include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkLookupTable.h>
 #include <vtkPointData.h>
@@ -40,7 +43,78 @@ Version:   $Revision: 1.2 $
 
 
 // STD includes
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+
+namespace
+{
+
+/// Auto window/level is computed from the histogram of at most this number
+/// of voxels. Larger images are subsampled with a constant stride, which
+/// hardly changes the bimodal analysis but saves seconds on large CT.
+const vtkIdType AUTO_LEVELS_MAXIMUM_NUMBER_OF_SAMPLES = 8 * 1024 * 1024;
+
+//----------------------------------------------------------------------------
+/// Compute the histogram of the image scalars into the bins
+/// [binOrigin + i * binSpacing, binOrigin + (i+1) * binSpacing[.
+/// Values outside of the bins are ignored (as in vtkImageAccumulate).
+/// The histogram is stored as the scalars of histogramImage, with the
+/// origin set to binOrigin, as expected by vtkImageBimodalAnalysis.
+void ComputeHistogramImage(vtkImageData* imageData,
+                           double binOrigin, double binSpacing, int numberOfBins,
+                           vtkImageData* histogramImage)
+{
+  vtkNew<vtkImageHistogram> histogram;
+  vtkNew<vtkImageShrink3D> subsample;
+  vtkIdType numberOfVoxels = imageData->GetNumberOfPoints();
+  if (numberOfVoxels > AUTO_LEVELS_MAXIMUM_NUMBER_OF_SAMPLES)
+    {
+    int dimensions[3] = {0, 0, 0};
+    imageData->GetDimensions(dimensions);
+    int numberOfDimensions = 0;
+    for (int i = 0; i < 3; ++i)
+      {
+      numberOfDimensions += (dimensions[i] > 1 ? 1 : 0);
+      }
+    int factor = static_cast<int>(ceil(pow(
+      static_cast<double>(numberOfVoxels) / AUTO_LEVELS_MAXIMUM_NUMBER_OF_SAMPLES,
+      1.0 / numberOfDimensions)));
+    subsample->SetShrinkFactors(dimensions[0] > 1 ? factor : 1,
+                                dimensions[1] > 1 ? factor : 1,
+                                dimensions[2] > 1 ? factor : 1);
+    // Keep every factor-th voxel instead of averaging them
+    subsample->MeanOff();
+    subsample->SetInputData(imageData);
+    histogram->SetInputConnection(subsample->GetOutputPort());
+    }
+  else
+    {
+    histogram->SetInputData(imageData);
+    }
+
+  // vtkImageHistogram bins are centered on their origin and the values that
+  // are out of the bin range are clamped into the first and last bins: add
+  // one extra bin on each side to collect them.
+  histogram->AutomaticBinningOff();
+  histogram->SetNumberOfBins(numberOfBins + 2);
+  histogram->SetBinOrigin(binOrigin - 0.5 * binSpacing);
+  histogram->SetBinSpacing(binSpacing);
+  histogram->GenerateHistogramImageOff();
+  histogram->Update();
+
+  vtkNew<vtkIdTypeArray> counts;
+  counts->SetNumberOfTuples(numberOfBins);
+  vtkIdType* histogramCounts = histogram->GetHistogram()->GetPointer(0);
+  std::copy(histogramCounts + 1, histogramCounts + 1 + numberOfBins, counts->GetPointer(0));
+
+  histogramImage->SetExtent(0, numberOfBins - 1, 0, 0, 0, 0);
+  histogramImage->SetOrigin(binOrigin, 0.0, 0.0);
+  histogramImage->SetSpacing(binSpacing, 1.0, 1.0);
+  histogramImage->GetPointData()->SetScalars(counts.GetPointer());
+}
+
+} // end of anonymous namespace
 
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLScalarVolumeDisplayNode);
@@ -106,8 +180,12 @@ vtkMRMLScalarVolumeDisplayNode::vtkMRMLScalarVolumeDisplayNode()
   this->AppendComponents->AddInputConnection(0, this->AlphaLogic->GetOutputPort() );
 
   this->Bimodal = NULL;
-  this->Accumulate = NULL;
   this->IsInCalculateAutoLevels = false;
+  for (int i = 0; i < 4; ++i)
+    {
+    this->AutoLevels[i] = 0.0;
+    }
+  this->AutoLevelsImageDataMTime = 0;
 
   vtkEventBroker::GetInstance()->AddObservation(
     this, vtkCommand::ModifiedEvent, this, this->MRMLCallbackCommand  , 10000.);
@@ -132,11 +210,6 @@ vtkMRMLScalarVolumeDisplayNode::~vtkMRMLScalarVolumeDisplayNode()
     this->Bimodal->Delete();
     this->Bimodal = NULL;
     }
-  if (this->Accumulate)
-    {
-    this->Accumulate->Delete();
-    this->Accumulate = NULL;
-    }
 }
 
 //----------------------------------------------------------------------------
@@ -737,19 +810,56 @@ void vtkMRMLScalarVolumeDisplayNode::CalculateAutoLevels()
     return;
     }
 
-  if (this->Bimodal == NULL)
+  // CalculateAutoLevels is called each time the display node is modified,
+  // the histogram only needs to be computed again if the image changed.
+  vtkMTimeType imageDataMTime = imageDataScalar->GetMTime();
+  if (this->AutoLevelsImageData.GetPointer() != imageDataScalar ||
+      this->AutoLevelsImageDataMTime != imageDataMTime)
     {
-    this->Bimodal = vtkImageBimodalAnalysis::New();
+    this->CalculateHistogramAutoLevels(imageDataScalar, this->AutoLevels);
+    this->AutoLevelsImageData = imageDataScalar;
+    this->AutoLevelsImageDataMTime = imageDataMTime;
+    }
+  double window = this->AutoLevels[0];
+  double level = this->AutoLevels[1];
+  double lower = this->AutoLevels[2];
+  double upper = this->AutoLevels[3];
+
+  this->IsInCalculateAutoLevels = true;
+  int disabledModify = this->StartModify();
+  if (this->GetAutoWindowLevel())
+    {
+    this->SetWindowLevel(window, level);
+    }
+  if (this->GetAutoThreshold())
+    {
+    this->SetThreshold(lower, upper);
     }
-  if (this->Accumulate == NULL)
+  vtkDebugMacro("CalculateScalarAutoLevels:"
+                << " window: " << window << " level: " << level
+                << " lower: " << lower << " upper: " << upper);
+  this->EndModify(disabledModify);
+  this->IsInCalculateAutoLevels = false;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLScalarVolumeDisplayNode::CalculateHistogramAutoLevels(
+  vtkImageData* imageDataScalar, double autoLevels[4])
+{
+  if (this->Bimodal == NULL)
     {
-    this->Accumulate = vtkImageAccumulate::New();
+    this->Bimodal = vtkImageBimodalAnalysis::New();
     }
+  vtkNew<vtkImageData> histogramImage;
 
-  double window = 0.0;
-  double level = 0.0;
-  double lower = 0.0;
-  double upper = 0.0;
+  double& window = autoLevels[0];
+  double& level = autoLevels[1];
+  double& lower = autoLevels[2];
+  double& upper = autoLevels[3];
+  window = 0.0;
+  level = 0.0;
+  lower = 0.0;
+  upper = 0.0;
 
   int needAdHoc = 0;
   int scalarType = imageDataScalar->GetScalarType();
@@ -769,15 +879,11 @@ void vtkMRMLScalarVolumeDisplayNode::CalculateAutoLevels()
     // Data type is VTK_INT or similar, so calculate window/level
     // check the scalar type, bimodal analysis only works on int
 
-    // Setup filter to work with signed 16-bit integer.
-    int extent[6] = {0, 65535, 0, 0, 0, 0};
-    this->Accumulate->SetComponentExtent(extent);
-    double origin[3] = {-32768, 0, 0};
-    this->Accumulate->SetComponentOrigin(origin);
-    this->Accumulate->SetInputData(imageDataScalar);
-    this->Bimodal->SetInputConnection(this->Accumulate->GetOutputPort());
+    // Setup histogram to work with signed 16-bit integer.
+    ComputeHistogramImage(imageDataScalar, -32768, 1.0, 65536, histogramImage.GetPointer());
+    this->Bimodal->SetInputData(histogramImage.GetPointer());
     this->Bimodal->Update();
-    // Workaround for image data where all accumulate samples fall
+    // Workaround for image data where all histogram samples fall
     // within the same histogram bin
     if ( this->Bimodal->GetWindow() == 0.0 &&
          this->Bimodal->GetLevel() == 0.0 )
@@ -798,21 +904,17 @@ void vtkMRMLScalarVolumeDisplayNode::CalculateAutoLevels()
            scalarType == VTK_UNSIGNED_LONG)
     {
     // If scalar range is expected to be less conventional, then scale the bins
-    // the image accumulate algorithm
+    // of the histogram
     double range[2];
     this->GetDisplayScalarRange(range);
     long minInt = trunc(range[0]) - 1;
     long maxInt = trunc(range[1]) + 1;
 
-    this->Accumulate->SetInputData(imageDataScalar);
-    int extent[6] = {0, 999, 0, 0, 0, 0};
-    this->Accumulate->SetComponentExtent(extent);
-    double origin[3] = {static_cast<double>(minInt), 0.0, 0.0};
-    this->Accumulate->SetComponentOrigin(origin);
     double spacing[3] = {(maxInt-minInt)/1000.0, 1.0, 1.0};
-    this->Accumulate->SetComponentSpacing(spacing);
+    ComputeHistogramImage(imageDataScalar, static_cast<double>(minInt), spacing[0], 1000,
+                          histogramImage.GetPointer());
 
-    this->Bimodal->SetInputConnection(this->Accumulate->GetOutputPort());
+    this->Bimodal->SetInputData(histogramImage.GetPointer());
     this->Bimodal->Update();
 
     // The bimodal analysis assumes that the bin indices correspond directly to
@@ -843,20 +945,4 @@ void vtkMRMLScalarVolumeDisplayNode::CalculateAutoLevels()
     lower = level;
     upper = range[1];
     }
-
-  this->IsInCalculateAutoLevels = true;
-  int disabledModify = this->StartModify();
-  if (this->GetAutoWindowLevel())
-    {
-    this->SetWindowLevel(window, level);
-    }
-  if (this->GetAutoThreshold())
-    {
-    this->SetThreshold(lower, upper);
-    }
-  vtkDebugMacro("CalculateScalarAutoLevels:"
-                << " window: " << window << " level: " << level
-                << " lower: " << lower << " upper: " << upper);
-  this->EndModify(disabledModify);
-  this->IsInCalculateAutoLevels = false;
 }
@@ -20,7 +20,6 @@
 
 // VTK includes
 class vtkImageAlgorithm;
-class vtkImageAccumulate;
 class vtkImageAppendComponents;
 class vtkImageBimodalAnalysis;
 class vtkImageCast;
@@ -195,6 +194,10 @@ protected:
   virtual void SetColorNodeInternal(vtkMRMLColorNode* newColorNode) VTK_OVERRIDE;
   void UpdateLookupTable(vtkMRMLColorNode* newColorNode);
   void CalculateAutoLevels();
+  /// Compute window, level and threshold from the bimodal analysis of the
+  /// histogram of the image scalars.
+  /// Large images are subsampled before the histogram is computed.
+  void CalculateHistogramAutoLevels(vtkImageData* imageDataScalar, double autoLevels[4]);
 
   /// Return the image data with scalar type, it can be in the middle of the
   /// pipeline, it's typically the input of the threshold/windowlevel filters
@@ -242,9 +245,16 @@ protected:
 
   ///
   /// Used internally in CalculateScalarAutoLevels and CalculateStatisticsAutoLevels
-  vtkImageAccumulate *Accumulate;
   vtkImageBimodalAnalysis *Bimodal;
   bool IsInCalculateAutoLevels;
+
+  ///
+  /// Window, level, lower and upper threshold last computed by
+  /// CalculateAutoLevels. They are reused as long as the image data
+  /// is not modified.
+  double AutoLevels[4];
+  vtkWeakPointer<vtkImageData> AutoLevelsImageData;
+  vtkMTimeType AutoLevelsImageDataMTime;
 };
 
 #endif
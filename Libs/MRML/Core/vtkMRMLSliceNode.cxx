@@ -94,6 +94,7 @@ vtkMRMLSliceNode::vtkMRMLSliceNode()
   this->WidgetVisible = 0;
   this->WidgetNormalLockedToCamera = 0;
   this->UseLabelOutline = 0;
+  this->UseLabelInterpolation = 0;
 
   this->LayoutGridColumns = 1;
   this->LayoutGridRows = 1;
@@ -952,6 +953,7 @@ void vtkMRMLSliceNode::WriteXML(ostream& of, int nIndent)
   of << " sliceVisibility=\"" << (this->SliceVisible ? "true" : "false") << "\"";
   of << " widgetVisibility=\"" << (this->WidgetVisible ? "true" : "false") << "\"";
   of << " useLabelOutline=\"" << (this->UseLabelOutline ? "true" : "false") << "\"";
+  of << " useLabelInterpolation=\"" << (this->UseLabelInterpolation ? "true" : "false") << "\"";
   of << " sliceSpacingMode=\"" << this->SliceSpacingMode << "\"";
   of << " prescribedSliceSpacing=\""
      << this->PrescribedSliceSpacing[0] << " "
@@ -1157,6 +1159,17 @@ void vtkMRMLSliceNode::ReadXMLAttributes(const char** atts)
         this->UseLabelOutline = 0;
         }
       }
+    else if (!strcmp(attName, "useLabelInterpolation"))
+      {
+      if (!strcmp(attValue,"true"))
+        {
+        this->UseLabelInterpolation = 1;
+        }
+      else
+        {
+        this->UseLabelInterpolation = 0;
+        }
+      }
    else if (!strcmp(attName, "orientation"))
       {
       if (strcmp( attValue, "Reformat" ))
@@ -1368,6 +1381,7 @@ void vtkMRMLSliceNode::Copy(vtkMRMLNode *anode)
 
   this->WidgetVisible = node->WidgetVisible;
   this->UseLabelOutline = node->UseLabelOutline;
+  this->UseLabelInterpolation = node->UseLabelInterpolation;
 
   this->SliceResolutionMode = node->SliceResolutionMode;
 
@@ -1472,6 +1486,8 @@ void vtkMRMLSliceNode::PrintSelf(ostream& os, vtkIndent indent)
     (this->WidgetVisible ? "true" : "false") << "\n";
   os << indent << "UseLabelOutline: " <<
     (this->UseLabelOutline ? "true" : "false") << "\n";
+  os << indent << "UseLabelInterpolation: " <<
+    (this->UseLabelInterpolation ? "true" : "false") << "\n";
 
   os << indent << "Jump mode: ";
   if (this->JumpMode == CenteredJumpSlice)
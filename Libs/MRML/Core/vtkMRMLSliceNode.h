@@ -124,6 +124,14 @@ class VTK_MRML_EXPORT vtkMRMLSliceNode : public vtkMRMLAbstractViewNode
   vtkSetMacro ( UseLabelOutline, int );
   vtkBooleanMacro ( UseLabelOutline, int );
 
+  ///
+  /// Reslice label maps with smooth label boundaries (each pixel gets the
+  /// dominant label of its trilinear neighborhood) instead of nearest
+  /// neighbor interpolation?
+  vtkGetMacro ( UseLabelInterpolation, int );
+  vtkSetMacro ( UseLabelInterpolation, int );
+  vtkBooleanMacro ( UseLabelInterpolation, int );
+
   /// \brief Set 'standard' radiological convention views of patient space.
   ///
   /// If the associated orientation preset has been renamed or removed, calling
@@ -438,6 +446,7 @@ public:
   ///    MultiplanarReformatFlag - broadcast reformat widget transformation
   ///    XYZOriginFlag - broadcast the XYZOrigin to all linked viewers
   ///    LabelOutlineFlag - broadcast outlining the labelmaps
+  ///    LabelInterpolationFlag - broadcast smoothing the label boundaries
   ///    SliceVisibleFlag = broadcast display of slice in 3D
   enum InteractionFlagType
   {
@@ -450,8 +459,9 @@ public:
     XYZOriginFlag = 32,
     LabelOutlineFlag = 64,
     SliceVisibleFlag = 128,
-    SliceSpacingFlag = 256
-    // Next one needs to be 512
+    SliceSpacingFlag = 256,
+    LabelInterpolationFlag = 512
+    // Next one needs to be 1024
   };
 
   /// Get/Set a flag indicating what parameters are being manipulated
@@ -518,6 +528,7 @@ protected:
   int WidgetVisible;
   int WidgetNormalLockedToCamera;
   int UseLabelOutline;
+  int UseLabelInterpolation;
 
   double FieldOfView[3];
   double XYZOrigin[3];
@@ -107,6 +107,23 @@ public:
   /// It can be static as the item IDs are unique in one application session.
   static std::map<vtkIdType, vtkSubjectHierarchyItem*> ItemCache;
 
+  /// Lookup tables to speed up finding items by data node and by UID in a tree,
+  /// that needs to be performed many times (for example for each instance in DICOM import).
+  /// They are only allocated for the scene item, and are updated when items are added,
+  /// removed, reparented to another tree, and when UIDs are set.
+  struct LookupTables
+    {
+    /// Items by their data node
+    std::map<vtkMRMLNode*, vtkSubjectHierarchyItem*> DataNodes;
+    /// Items by UID name and value. UID lists are also added by each UID they contain,
+    /// so that items can be found by UID list without string search
+    std::multimap<std::pair<std::string, std::string>, vtkSubjectHierarchyItem*> UIDs;
+    };
+  LookupTables* Lookup;
+  /// Data node the item is registered with in the lookup tables. Needed because the
+  /// data node pointer may become invalid before the item is removed
+  vtkMRMLNode* LookupDataNode;
+
 // Get/set functions
 public:
   /// Add data item to tree under parent, specifying basic properties
@@ -168,10 +185,14 @@ public:
   /// \param recursive Flag whether to find only direct children (false) or in the whole branch (true). True by default
   /// \return Item if found, NULL otherwise
   vtkSubjectHierarchyItem* FindChildByUID(std::string uidName, std::string uidValue, bool recursive=true);
-  /// Find child by UID list (containing). For example find UID in instance UID list
+  /// Find child by UID list (containing). For example find UID in instance UID list.
+  /// The UID needs to be the whole UID list or one of the UIDs of the list
   /// \param recursive Flag whether to find only direct children (false) or in the whole branch (true). True by default
   /// \return Item if found, NULL otherwise
   vtkSubjectHierarchyItem* FindChildByUIDList(std::string uidName, std::string uidValue, bool recursive=true);
+  /// Determine whether a UID is the whole UID list or one of the UIDs of the list.
+  /// Matches the same UIDs as the lookup table.
+  static bool UIDListContains(const std::string& uidList, const std::string& uidValue);
   /// Find children by name
   /// \param name Name (or part of a name) to find
   /// \param foundItemIDs List of found item IDs. Needs to be empty when passing as argument!
@@ -214,6 +235,14 @@ public:
   void ReparentChildrenToParent();
   /// Remove all children. Do not delete data nodes from the scene. Used in destructor, and for deleting virtual branches
   void RemoveAllChildren();
+  /// Get the root of the tree the item is in (the scene item for items in the tree)
+  vtkSubjectHierarchyItem* GetRootItem();
+  /// Add item to the lookup tables of the tree it is in
+  /// \param recursive Flag whether to add the whole branch of the item
+  void AddToLookup(bool recursive=false);
+  /// Remove item from the lookup tables of the tree it is in
+  /// \param recursive Flag whether to remove the whole branch of the item
+  void RemoveFromLookup(bool recursive=false);
   /// Remove all observers from item and its data node if any
   //void RemoveAllObservers(); //TODO: Needed? (the callback object belongs to the SH node so introduction of a new member would be needed)
 
@@ -263,6 +292,8 @@ vtkSubjectHierarchyItem::vtkSubjectHierarchyItem()
   , TemporaryID(vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
   , TemporaryDataNodeID("")
   , TemporaryParentItemID(vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+  , Lookup(NULL)
+  , LookupDataNode(NULL)
 {
   this->Children.clear();
   this->Attributes.clear();
@@ -276,6 +307,9 @@ vtkSubjectHierarchyItem::~vtkSubjectHierarchyItem()
 
   this->Attributes.clear();
   this->UIDs.clear();
+
+  delete this->Lookup;
+  this->Lookup = NULL;
 }
 
 //---------------------------------------------------------------------------
@@ -303,6 +337,7 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, vt
 
     // Add to cache
     vtkSubjectHierarchyItem::ItemCache[this->ID] = this;
+    this->AddToLookup();
     }
   else
     {
@@ -340,9 +375,17 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, st
 
     // Add to cache
     vtkSubjectHierarchyItem::ItemCache[this->ID] = this;
+    this->AddToLookup();
+    }
+  else if (!name.compare("Scene") && !level.compare("Scene"))
+    {
+    // The scene item contains the lookup tables of its tree
+    if (!this->Lookup)
+      {
+      this->Lookup = new LookupTables();
+      }
     }
-  else if (! ( (!name.compare("Scene") && !level.compare("Scene"))
-            || (!name.compare("UnresolvedItems") && !level.compare("UnresolvedItems")) ) )
+  else if (name.compare("UnresolvedItems") || level.compare("UnresolvedItems"))
     {
     // Only the scene item or the unresolved items parent can have NULL parent
     vtkErrorMacro("AddToTree: Invalid parent of non-scene item to add");
@@ -737,6 +780,18 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByDataNode(vtkMRMLNod
     return NULL;
     }
 
+  // Use lookup table if searching the whole tree
+  if (recursive && this->Lookup)
+    {
+    std::map<vtkMRMLNode*, vtkSubjectHierarchyItem*>::iterator itemIt = this->Lookup->DataNodes.find(dataNode);
+    if (itemIt == this->Lookup->DataNodes.end() || itemIt->second->DataNode.GetPointer() != dataNode)
+      {
+      // The item data node may have been deleted, and a new node allocated at the same address
+      return NULL;
+      }
+    return itemIt->second;
+    }
+
   ChildVector::iterator childIt;
   for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
     {
@@ -764,6 +819,23 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUID(std::string uid
     {
     return NULL;
     }
+
+  // Use lookup table if searching the whole tree. Return the first created item if there are multiple matches
+  if (recursive && this->Lookup)
+    {
+    vtkSubjectHierarchyItem* foundItem = NULL;
+    typedef std::multimap<std::pair<std::string, std::string>, vtkSubjectHierarchyItem*>::iterator UIDIterator;
+    std::pair<UIDIterator, UIDIterator> range = this->Lookup->UIDs.equal_range(std::make_pair(uidName, uidValue));
+    for (UIDIterator itemIt=range.first; itemIt!=range.second; ++itemIt)
+      {
+      if ( !itemIt->second->GetUID(uidName).compare(uidValue)
+        && (!foundItem || itemIt->second->ID < foundItem->ID) )
+        {
+        foundItem = itemIt->second;
+        }
+      }
+    return foundItem;
+    }
   ChildVector::iterator childIt;
   for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
     {
@@ -791,11 +863,28 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUIDList(std::string
     {
     return NULL;
     }
+
+  // Use lookup table if searching the whole tree, it contains each UID of the UID lists.
+  // Return the first created item if there are multiple matches
+  if (recursive && this->Lookup)
+    {
+    vtkSubjectHierarchyItem* foundItem = NULL;
+    typedef std::multimap<std::pair<std::string, std::string>, vtkSubjectHierarchyItem*>::iterator UIDIterator;
+    std::pair<UIDIterator, UIDIterator> range = this->Lookup->UIDs.equal_range(std::make_pair(uidName, uidValue));
+    for (UIDIterator itemIt=range.first; itemIt!=range.second; ++itemIt)
+      {
+      if (!foundItem || itemIt->second->ID < foundItem->ID)
+        {
+        foundItem = itemIt->second;
+        }
+      }
+    return foundItem;
+    }
   ChildVector::iterator childIt;
   for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
     {
     vtkSubjectHierarchyItem* currentItem = childIt->GetPointer();
-    if (currentItem->GetUID(uidName).find(uidValue) != std::string::npos)
+    if (vtkSubjectHierarchyItem::UIDListContains(currentItem->GetUID(uidName), uidValue))
       {
       return currentItem;
       }
@@ -811,6 +900,22 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUIDList(std::string
   return NULL;
 }
 
+//---------------------------------------------------------------------------
+bool vtkSubjectHierarchyItem::UIDListContains(const std::string& uidList, const std::string& uidValue)
+{
+  if (uidValue.empty())
+    {
+    return false;
+    }
+  if (!uidList.compare(uidValue))
+    {
+    return true;
+    }
+  std::vector<std::string> uids;
+  vtkMRMLSubjectHierarchyNode::DeserializeUIDList(uidList, uids);
+  return std::find(uids.begin(), uids.end(), uidValue) != uids.end();
+}
+
 //---------------------------------------------------------------------------
 void vtkSubjectHierarchyItem::FindChildrenByName(std::string name, std::vector<vtkIdType> &foundItemIDs, bool contains/*=false*/, bool recursive/*=true*/)
 {
@@ -947,6 +1052,13 @@ bool vtkSubjectHierarchyItem::Reparent(vtkSubjectHierarchyItem* newParentItem)
   // Prevent deletion of the item from memory until the events are processed
   vtkSmartPointer<vtkSubjectHierarchyItem> thisPointer = this;
 
+  // Move the branch to the lookup tables of the new tree if it changes
+  bool treeChanged = (formerParentItem->GetRootItem() != newParentItem->GetRootItem());
+  if (treeChanged)
+    {
+    this->RemoveFromLookup(true);
+    }
+
   // Remove item from former parent
   formerParentItem->Children.erase(childIt);
 
@@ -954,6 +1066,11 @@ bool vtkSubjectHierarchyItem::Reparent(vtkSubjectHierarchyItem* newParentItem)
   this->Parent = newParentItem;
   newParentItem->Children.push_back(thisPointer);
 
+  if (treeChanged)
+    {
+    this->AddToLookup(true);
+    }
+
   // Invoke modified events on all affected items
   formerParentItem->Modified();
   newParentItem->Modified();
@@ -1100,6 +1217,7 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkSubjectHierarchyItem* item)
 
   // Remove child
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAboutToBeRemovedEvent, item);
+  removedItem->RemoveFromLookup();
   this->Children.erase(childIt);
 
   // Reparent children to parent node (to avoid them becoming orphans and thus lost to the hierarchy)
@@ -1144,6 +1262,7 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkIdType itemID)
 
   // Remove child
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAboutToBeRemovedEvent, removedItem.GetPointer());
+  removedItem->RemoveFromLookup();
   this->Children.erase(childIt);
 
   // Reparent children to parent node (to avoid them becoming orphans and thus lost to the hierarchy)
@@ -1237,6 +1356,121 @@ void vtkSubjectHierarchyItem::RemoveAllChildren()
 //    }
 //}
 
+//---------------------------------------------------------------------------
+vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::GetRootItem()
+{
+  vtkSubjectHierarchyItem* rootItem = this;
+  while (rootItem->Parent)
+    {
+    rootItem = rootItem->Parent;
+    }
+  return rootItem;
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::AddToLookup(bool recursive/*=false*/)
+{
+  LookupTables* lookup = this->GetRootItem()->Lookup;
+  if (!lookup)
+    {
+    // Item is not in a tree that is looked up (e.g. unresolved items)
+    return;
+    }
+
+  this->LookupDataNode = this->DataNode.GetPointer();
+  if (this->LookupDataNode)
+    {
+    lookup->DataNodes[this->LookupDataNode] = this;
+    }
+
+  std::map<std::string, std::string>::iterator uidIt;
+  for (uidIt=this->UIDs.begin(); uidIt!=this->UIDs.end(); ++uidIt)
+    {
+    if (uidIt->second.empty())
+      {
+      continue;
+      }
+    lookup->UIDs.insert(std::make_pair(std::make_pair(uidIt->first, uidIt->second), this));
+    // Add each UID of UID lists
+    std::vector<std::string> uidList;
+    vtkMRMLSubjectHierarchyNode::DeserializeUIDList(uidIt->second, uidList);
+    if (uidList.size() > 1 || (uidList.size() == 1 && uidList[0].compare(uidIt->second)))
+      {
+      std::set<std::string> uniqueUIDs(uidList.begin(), uidList.end());
+      for (std::set<std::string>::iterator listIt=uniqueUIDs.begin(); listIt!=uniqueUIDs.end(); ++listIt)
+        {
+        if (!listIt->empty() && listIt->compare(uidIt->second))
+          {
+          lookup->UIDs.insert(std::make_pair(std::make_pair(uidIt->first, *listIt), this));
+          }
+        }
+      }
+    }
+
+  if (recursive)
+    {
+    ChildVector::iterator childIt;
+    for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
+      {
+      (*childIt)->AddToLookup(true);
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::RemoveFromLookup(bool recursive/*=false*/)
+{
+  LookupTables* lookup = this->GetRootItem()->Lookup;
+  if (!lookup)
+    {
+    return;
+    }
+
+  if (this->LookupDataNode)
+    {
+    std::map<vtkMRMLNode*, vtkSubjectHierarchyItem*>::iterator itemIt = lookup->DataNodes.find(this->LookupDataNode);
+    if (itemIt != lookup->DataNodes.end() && itemIt->second == this)
+      {
+      lookup->DataNodes.erase(itemIt);
+      }
+    this->LookupDataNode = NULL;
+    }
+
+  std::map<std::string, std::string>::iterator uidIt;
+  for (uidIt=this->UIDs.begin(); uidIt!=this->UIDs.end(); ++uidIt)
+    {
+    std::vector<std::string> uidList;
+    vtkMRMLSubjectHierarchyNode::DeserializeUIDList(uidIt->second, uidList);
+    uidList.push_back(uidIt->second);
+    std::set<std::string> uniqueUIDs(uidList.begin(), uidList.end());
+    for (std::set<std::string>::iterator listIt=uniqueUIDs.begin(); listIt!=uniqueUIDs.end(); ++listIt)
+      {
+      typedef std::multimap<std::pair<std::string, std::string>, vtkSubjectHierarchyItem*>::iterator UIDIterator;
+      std::pair<UIDIterator, UIDIterator> range = lookup->UIDs.equal_range(std::make_pair(uidIt->first, *listIt));
+      for (UIDIterator itemIt=range.first; itemIt!=range.second; )
+        {
+        if (itemIt->second == this)
+          {
+          lookup->UIDs.erase(itemIt++);
+          }
+        else
+          {
+          ++itemIt;
+          }
+        }
+      }
+    }
+
+  if (recursive)
+    {
+    ChildVector::iterator childIt;
+    for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
+      {
+      (*childIt)->RemoveFromLookup(true);
+      }
+    }
+}
+
 //---------------------------------------------------------------------------
 void vtkSubjectHierarchyItem::SetUID(std::string uidName, std::string uidValue)
 {
@@ -1254,7 +1488,17 @@ void vtkSubjectHierarchyItem::SetUID(std::string uidName, std::string uidValue)
       return; // Do nothing if the UID values match
       }
     }
+  // Update lookup tables (only if the item is in the tree)
+  bool inTree = (vtkSubjectHierarchyItem::ItemCache.find(this->ID) != vtkSubjectHierarchyItem::ItemCache.end());
+  if (inTree)
+    {
+    this->RemoveFromLookup();
+    }
   this->UIDs[uidName] = uidValue;
+  if (inTree)
+    {
+    this->AddToLookup();
+    }
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemUIDAddedEvent, this);
   this->Modified();
 }
@@ -2872,7 +3116,7 @@ std::vector<vtkIdType> vtkMRMLSubjectHierarchyNode::GetItemsReferencedFromItemBy
         {
         // Get instance UIDs of the referenced item
         std::string uids = (*itemIt)->GetUID(vtkMRMLSubjectHierarchyConstants::GetDICOMInstanceUIDName());
-        if (uids.find(*uidIt) != std::string::npos)
+        if (vtkSubjectHierarchyItem::UIDListContains(uids, *uidIt))
           {
           // If we found the UID in the already found referenced items, then we don't need to do anything
           foundUidInFoundReferencedItems = true;
@@ -253,7 +253,8 @@ public:
 
   /// Find subject hierarchy item according to a UID (by containing). For example find UID in instance UID list
   /// \param uidName UID string to lookup
-  /// \param uidValue UID string that needs to be _contained_ in the UID string of the subject hierarchy item
+  /// \param uidValue UID string that needs to be one of the UIDs in the UID list (separated by spaces,
+  ///   \sa DeserializeUIDList) of the subject hierarchy item
   /// \return First match
   /// \sa GetUID()
   vtkIdType GetItemByUIDList(const char* uidName, const char* uidValue);
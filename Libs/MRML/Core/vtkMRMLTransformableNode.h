@@ -109,7 +109,7 @@ public:
 
   /// Apply the associated transform to the transformable node. Return true
   /// on success, false otherwise.
-  bool HardenTransform();
+  virtual bool HardenTransform();
 
 protected:
   vtkMRMLTransformableNode();
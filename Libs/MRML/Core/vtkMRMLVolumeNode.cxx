@@ -20,14 +20,13 @@ Version:   $Revision: 1.14 $
 
 // VTK includes
 #include <vtkAlgorithmOutput.h>
-#include <vtkAppendPolyData.h>
 #include <vtkBoundingBox.h>
 #include <vtkCallbackCommand.h>
+#include <vtkCommand.h>
 #include <vtkEventForwarderCommand.h>
 #include <vtkGeneralTransform.h>
 #include <vtkHomogeneousTransform.h>
 #include <vtkImageData.h>
-#include <vtkImageDataGeometryFilter.h>
 #include <vtkImageReslice.h>
 #include <vtkMathUtilities.h>
 #include <vtkMatrix4x4.h>
@@ -66,6 +65,7 @@ vtkMRMLVolumeNode::vtkMRMLVolumeNode()
 
   this->ImageDataConnection = NULL;
   this->DataEventForwarder = NULL;
+  this->ApplyNonLinearTransformAbortRequested = false;
 }
 
 //----------------------------------------------------------------------------
@@ -1006,101 +1006,70 @@ void vtkMRMLVolumeNode::ApplyNonLinearTransform(vtkAbstractTransform* transform)
     {
     return;
     }
-  int extent[6];
-  this->GetImageData()->GetExtent(extent);
-
-  vtkNew<vtkMatrix4x4> rasToIJK;
-
-  /** THIS MAY BE NEEDED IF TRANSFORM ORIGIN
-  // Compute extents of the output image
-  // For each of 6 volume boundary planes:
-  // 1. Convert the slice image to a polydata
-  // 2. Transform polydata
-  // Then append all poly datas and compute RAS extents
+  this->ResampleImageDataWithNonLinearTransform(transform);
+}
 
-  vtkNew<vtkImageDataGeometryFilter> imageDataGeometryFilter;
-  imageDataGeometryFilter->SetInput(this->GetImageData());
+//-----------------------------------------------------------
+void vtkMRMLVolumeNode::AbortApplyNonLinearTransform()
+{
+  this->ApplyNonLinearTransformAbortRequested = true;
+}
 
-  vtkNew<vtkGeneralTransform> IJK2WorldTransform;
-  IJK2WorldTransform->Identity();
-  //IJK2WorldTransform->PostMultiply();
+//-----------------------------------------------------------
+bool vtkMRMLVolumeNode::HardenTransform()
+{
+  vtkMRMLTransformNode* transformNode = this->GetParentTransformNode();
+  if (!transformNode || transformNode->IsTransformToWorldLinear()
+    || this->GetImageData() == NULL || !this->CanApplyNonLinearTransforms())
+    {
+    return this->Superclass::HardenTransform();
+    }
+  vtkNew<vtkGeneralTransform> hardeningTransform;
+  transformNode->GetTransformToWorld(hardeningTransform.GetPointer());
+  if (!this->ResampleImageDataWithNonLinearTransform(hardeningTransform.GetPointer()))
+    {
+    // failed or cancelled, keep the volume under the transform
+    return false;
+    }
+  this->SetAndObserveTransformNodeID(NULL);
+  return true;
+}
 
-  IJK2WorldTransform->Concatenate(transform);
+//-----------------------------------------------------------
+bool vtkMRMLVolumeNode::ResampleImageDataWithNonLinearTransform(vtkAbstractTransform* transform)
+{
+  vtkImageData* inputImage = this->GetImageData();
+  if (inputImage == NULL || transform == NULL)
+    {
+    return false;
+    }
+  this->ApplyNonLinearTransformAbortRequested = false;
 
-  this->GetRASToIJKMatrix(rasToIJK.GetPointer());
-  rasToIJK->Invert();
-  IJK2WorldTransform->Concatenate(rasToIJK.GetPointer());
-
-  vtkNew<vtkTransformPolyDataFilter> transformFilter;
-  transformFilter->SetInput(imageDataGeometryFilter->GetOutput());
-  transformFilter->SetTransform(IJK2WorldTransform.GetPointer());
-
-  vtkSmartPointer<vtkPolyData> planes[6];
-
-  planes[0] = vtkSmartPointer<vtkPolyData>::New();
-  imageDataGeometryFilter->SetExtent(extent[0],extent[0], extent[2],extent[3],extent[4],extent[5]);
-  imageDataGeometryFilter->Update();
-  transformFilter->Update();
-  planes[0]->DeepCopy(transformFilter->GetOutput());
-
-  planes[1] = vtkSmartPointer<vtkPolyData>::New();
-  imageDataGeometryFilter->SetExtent(extent[1],extent[1], extent[2],extent[3],extent[4],extent[5]);
-  imageDataGeometryFilter->Update();
-  transformFilter->Update();
-  planes[1]->DeepCopy(transformFilter->GetOutput());
-
-  planes[2] = vtkSmartPointer<vtkPolyData>::New();
-  imageDataGeometryFilter->SetExtent(extent[0],extent[1], extent[2],extent[2],extent[4],extent[5]);
-  imageDataGeometryFilter->Update();
-  transformFilter->Update();
-  planes[2]->DeepCopy(transformFilter->GetOutput());
-
-  planes[3] = vtkSmartPointer<vtkPolyData>::New();
-  imageDataGeometryFilter->SetExtent(extent[0],extent[1], extent[3],extent[3],extent[4],extent[5]);
-  imageDataGeometryFilter->Update();
-  transformFilter->Update();
-  planes[3]->DeepCopy(transformFilter->GetOutput());
-
-  planes[4] = vtkSmartPointer<vtkPolyData>::New();
-  imageDataGeometryFilter->SetExtent(extent[0],extent[1], extent[2],extent[3],extent[4],extent[4]);
-  imageDataGeometryFilter->Update();
-  transformFilter->Update();
-  planes[4]->DeepCopy(transformFilter->GetOutput());
-
-  planes[5] = vtkSmartPointer<vtkPolyData>::New();
-  imageDataGeometryFilter->SetExtent(extent[0],extent[1], extent[2],extent[3],extent[5],extent[5]);
-  imageDataGeometryFilter->Update();
-  transformFilter->Update();
-  planes[5]->DeepCopy(transformFilter->GetOutput());
-
-  vtkNew<vtkAppendPolyData> appendPolyData;
-  for (int i=0; i<6; i++)
-    {
-    appendPolyData->AddInput(planes[i]);
-    }
-  appendPolyData->Update();
-  double bounds[6];
-  appendPolyData->GetOutput()->ComputeBounds();
-  appendPolyData->GetOutput()->GetBounds(bounds);
-
-  ****/
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  inputImage->GetExtent(extent);
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+    {
+    // empty image, nothing to resample
+    return true;
+    }
 
   vtkNew<vtkImageReslice> reslice;
-  reslice->GenerateStencilOutputOn();
 
   vtkNew<vtkGeneralTransform> resampleXform;
   resampleXform->Identity();
   resampleXform->PostMultiply();
 
+  vtkNew<vtkMatrix4x4> rasToIJK;
   this->GetRASToIJKMatrix(rasToIJK.GetPointer());
 
   vtkNew<vtkMatrix4x4> IJKToRAS;
   IJKToRAS->DeepCopy(rasToIJK.GetPointer());
   IJKToRAS->Invert();
-  transform->Inverse();
 
+  // Use the inverse transform (output voxel position to input voxel position).
+  // GetInverse() is used instead of Inverse() so that the input transform is not modified.
   resampleXform->Concatenate(IJKToRAS.GetPointer());
-  resampleXform->Concatenate(transform);
+  resampleXform->Concatenate(transform->GetInverse());
   resampleXform->Concatenate(rasToIJK.GetPointer());
 
   // vtkImageReslice works faster if the input is a linear transform, so try to convert it
@@ -1121,38 +1090,54 @@ void vtkMRMLVolumeNode::ApplyNonLinearTransform(vtkAbstractTransform* transform)
   reslice->AutoCropOutputOff();
   reslice->SetOptimization(1);
 
-  reslice->SetOutputOrigin( this->GetImageData()->GetOrigin() );
-  reslice->SetOutputSpacing( this->GetImageData()->GetSpacing() );
+  reslice->SetOutputOrigin( inputImage->GetOrigin() );
+  reslice->SetOutputSpacing( inputImage->GetSpacing() );
   reslice->SetOutputDimensionality( 3 );
+  reslice->SetOutputExtent( extent );
 
-  /***
-  double spacing[3];
-  double boxBounds[6];
-
-  int dimensions[3];
-  double origin[3];
-
-  this->GetOrigin(origin);
-  this->GetSpacing(spacing);
-  this->GetRASBounds(boxBounds);
-
-  for (int i=0; i<3; i++)
+  // Allocate the output image once and fill it slab by slab. This way only one
+  // slab of temporary memory is needed in addition to the input and output image.
+  vtkNew<vtkImageData> resampleImage;
+  resampleImage->SetExtent(extent);
+  resampleImage->SetOrigin(inputImage->GetOrigin());
+  resampleImage->SetSpacing(inputImage->GetSpacing());
+  resampleImage->AllocateScalars(inputImage->GetScalarType(), inputImage->GetNumberOfScalarComponents());
+
+  // Choose the slab size: small enough to keep memory usage low and
+  // to allow reporting progress, but large enough to be efficiently
+  // processed by multiple threads.
+  const vtkIdType maximumSlabSizeInBytes = 64 * 1024 * 1024;
+  const int minimumNumberOfSlabs = 10;
+  const int numberOfSlices = extent[5] - extent[4] + 1;
+  vtkIdType sliceSizeInBytes = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * (extent[3] - extent[2] + 1)
+    * inputImage->GetNumberOfScalarComponents() * inputImage->GetScalarSize();
+  int numberOfSlicesPerSlab = static_cast<int>(std::max(vtkIdType(1), maximumSlabSizeInBytes / std::max(vtkIdType(1), sliceSizeInBytes)));
+  numberOfSlicesPerSlab = std::min(numberOfSlicesPerSlab, std::max(1, numberOfSlices / minimumNumberOfSlabs));
+
+  int slabExtent[6] = { extent[0], extent[1], extent[2], extent[3], extent[4], extent[5] };
+  for (int slabStart = extent[4]; slabStart <= extent[5]; slabStart += numberOfSlicesPerSlab)
     {
-    dimensions[i] = (bounds[2*i+1] - bounds[2*i])/spacing[i];
+    slabExtent[4] = slabStart;
+    slabExtent[5] = std::min(slabStart + numberOfSlicesPerSlab - 1, extent[5]);
+    reslice->UpdateExtent(slabExtent);
+    resampleImage->CopyAndCastFrom(reslice->GetOutput(), slabExtent);
+
+    double progress = double(slabExtent[5] - extent[4] + 1) / double(numberOfSlices);
+    this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+    if (this->ApplyNonLinearTransformAbortRequested)
+      {
+      vtkDebugMacro("ResampleImageDataWithNonLinearTransform: cancelled");
+      this->ApplyNonLinearTransformAbortRequested = false;
+      return false;
+      }
     }
-  reslice->SetOutputExtent( 0, dimensions[0],
-                            0, dimensions[1],
-                            0, dimensions[2]);
-  ***/
 
-  reslice->SetOutputExtent( extent);
-
-  reslice->Update();
-
-  vtkNew<vtkImageData> resampleImage;
-  resampleImage->DeepCopy(reslice->GetOutput());
+  // Release the internal reslice buffer before setting the new image
+  reslice->SetInputConnection(NULL);
+  reslice->GetOutput()->ReleaseData();
 
   this->SetAndObserveImageData(resampleImage.GetPointer());
+  return true;
 }
 
 //---------------------------------------------------------------------------
@@ -208,8 +208,23 @@ public:
 
   virtual void ApplyTransformMatrix(vtkMatrix4x4* transformMatrix) VTK_OVERRIDE;
 
+  /// Resample the image data using a non-linear transform.
+  /// The image is resampled slab-by-slab (using multiple threads within each slab)
+  /// so that peak memory usage is approximately the size of the input and the output image.
+  /// ProgressEvent is invoked after each slab (call data is a pointer to a double value
+  /// between 0.0 and 1.0). Resampling can be cancelled by calling AbortApplyNonLinearTransform
+  /// from a progress event observer. If resampling is cancelled, the image data is left unchanged.
   virtual void ApplyNonLinearTransform(vtkAbstractTransform* transform);
 
+  /// Request cancellation of ApplyNonLinearTransform that is in progress.
+  /// \sa ApplyNonLinearTransform
+  void AbortApplyNonLinearTransform();
+
+  /// Apply the parent transform to the volume.
+  /// Returns false if hardening of a non-linear transform was cancelled
+  /// (in this case the volume remains under the transform).
+  virtual bool HardenTransform() VTK_OVERRIDE;
+
   virtual bool GetModifiedSinceRead() VTK_OVERRIDE;
 protected:
   vtkMRMLVolumeNode();
@@ -238,6 +253,12 @@ protected:
   /// the useTransform parameter and the rasToSlice transform
   virtual void GetBoundsInternal(double bounds[6], vtkMatrix4x4* rasToSlice, bool useTransform);
 
+  ///
+  /// Resample the image data using a non-linear transform.
+  /// Returns false if the operation failed or was cancelled.
+  /// \sa ApplyNonLinearTransform
+  virtual bool ResampleImageDataWithNonLinearTransform(vtkAbstractTransform* transform);
+
   /// these are unit length direction cosines
   double IJKToRASDirections[3][3];
 
@@ -248,6 +269,9 @@ protected:
   vtkAlgorithmOutput* ImageDataConnection;
   vtkEventForwarderCommand* DataEventForwarder;
 
+  /// Set by AbortApplyNonLinearTransform to request cancellation of image resampling
+  bool ApplyNonLinearTransformAbortRequested;
+
   itk::MetaDataDictionary Dictionary;
 };
 
@@ -0,0 +1,134 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLDisplayableManagerGroup.h>
+#include <vtkMRMLModelDisplayableManager.h>
+
+// MRMLLogic includes
+#include <vtkMRMLApplicationLogic.h>
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLModelDisplayNode.h>
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLViewNode.h>
+
+// VTK includes
+#include <vtkCamera.h>
+#include <vtkNew.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkSphereSource.h>
+
+// STD includes
+#include <cmath>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Pick the view at the display position of a world point, return the ID of
+// the picked display node or an empty string.
+std::string PickWorldPoint(vtkMRMLModelDisplayableManager* displayableManager,
+                           vtkRenderer* renderer, double x, double y, double z)
+{
+  renderer->GetRenderWindow()->Render();
+  renderer->SetWorldPoint(x, y, z, 1.);
+  renderer->WorldToDisplay();
+  double* displayPoint = renderer->GetDisplayPoint();
+  // Pick() takes a position with the origin at the top of the view
+  displayableManager->Pick(static_cast<int>(std::floor(displayPoint[0] + 0.5)),
+    renderer->GetSize()[1] - static_cast<int>(std::floor(displayPoint[1] + 0.5)));
+  const char* pickedNodeID = displayableManager->GetPickedNodeID();
+  return pickedNodeID ? pickedNodeID : "";
+}
+
+//----------------------------------------------------------------------------
+// The cell locator used for picking a large mesh is rebuilt when the mesh
+// is modified: picking finds the mesh where it is now, not where it was.
+int TestPickModifiedMesh(vtkMRMLScene* scene, vtkMRMLModelDisplayableManager* displayableManager,
+                         vtkRenderer* renderer)
+{
+  vtkNew<vtkMRMLModelNode> modelNode;
+  vtkNew<vtkSphereSource> sphereSource;
+  // more cells than needed for using a locator
+  sphereSource->SetThetaResolution(64);
+  sphereSource->SetPhiResolution(64);
+  sphereSource->SetRadius(10.);
+  modelNode->SetPolyDataConnection(sphereSource->GetOutputPort());
+  scene->AddNode(modelNode.GetPointer());
+
+  vtkNew<vtkMRMLModelDisplayNode> displayNode;
+  scene->AddNode(displayNode.GetPointer());
+  modelNode->AddAndObserveDisplayNodeID(displayNode->GetID());
+
+  vtkCamera* camera = renderer->GetActiveCamera();
+  camera->SetPosition(0., 0., 100.);
+  camera->SetFocalPoint(0., 0., 0.);
+  camera->SetViewUp(0., 1., 0.);
+  renderer->ResetCameraClippingRange(-50., 50., -50., 50., -50., 50.);
+
+  CHECK_STD_STRING(PickWorldPoint(displayableManager, renderer, 0., 0., 10.), displayNode->GetID());
+  CHECK_STD_STRING(PickWorldPoint(displayableManager, renderer, 15., 0., 10.), "");
+
+  // Move the mesh: the points of the same poly data are modified
+  sphereSource->SetCenter(15., 0., 0.);
+  CHECK_STD_STRING(PickWorldPoint(displayableManager, renderer, 15., 0., 10.), displayNode->GetID());
+  CHECK_STD_STRING(PickWorldPoint(displayableManager, renderer, 0., 0., 10.), "");
+
+  // And back
+  sphereSource->SetCenter(0., 0., 0.);
+  CHECK_STD_STRING(PickWorldPoint(displayableManager, renderer, 0., 0., 10.), displayNode->GetID());
+  CHECK_STD_STRING(PickWorldPoint(displayableManager, renderer, 15., 0., 10.), "");
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelDisplayableManagerPickTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkRenderer> renderer;
+  vtkNew<vtkRenderWindow> renderWindow;
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindow->SetSize(200, 200);
+  renderWindow->AddRenderer(renderer.GetPointer());
+  renderWindow->SetInteractor(renderWindowInteractor.GetPointer());
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLApplicationLogic> applicationLogic;
+  applicationLogic->SetMRMLScene(scene.GetPointer());
+
+  vtkNew<vtkMRMLViewNode> viewNode;
+  scene->AddNode(viewNode.GetPointer());
+
+  vtkNew<vtkMRMLDisplayableManagerGroup> displayableManagerGroup;
+  displayableManagerGroup->SetRenderer(renderer.GetPointer());
+  displayableManagerGroup->SetMRMLDisplayableNode(viewNode.GetPointer());
+
+  vtkNew<vtkMRMLModelDisplayableManager> displayableManager;
+  displayableManager->SetMRMLApplicationLogic(applicationLogic.GetPointer());
+  displayableManagerGroup->AddDisplayableManager(displayableManager.GetPointer());
+
+  int result = TestPickModifiedMesh(scene.GetPointer(), displayableManager.GetPointer(), renderer.GetPointer());
+
+  displayableManager->SetMRMLApplicationLogic(0);
+  return result;
+}
@@ -0,0 +1,182 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLDisplayableManagerGroup.h>
+#include <vtkMRMLModelDisplayableManager.h>
+
+// MRMLLogic includes
+#include <vtkMRMLApplicationLogic.h>
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLModelDisplayNode.h>
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLViewNode.h>
+
+// VTK includes
+#include <vtkActor.h>
+#include <vtkMapper.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkSphereSource.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+vtkMapper* GetMapper(vtkMRMLModelDisplayableManager* displayableManager,
+                     vtkRenderWindow* renderWindow, vtkMRMLModelDisplayNode* displayNode)
+{
+  renderWindow->Render();
+  vtkActor* actor = vtkActor::SafeDownCast(displayableManager->GetActorByID(displayNode->GetID()));
+  return actor ? actor->GetMapper() : NULL;
+}
+
+//----------------------------------------------------------------------------
+int TestSharedMapper(vtkMRMLScene* scene, vtkMRMLModelDisplayableManager* displayableManager,
+                     vtkRenderWindow* renderWindow)
+{
+  vtkNew<vtkMRMLModelNode> modelNode;
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetRadius(10.);
+  sphereSource->Update();
+  modelNode->SetPolyDataConnection(sphereSource->GetOutputPort());
+  scene->AddNode(modelNode.GetPointer());
+
+  vtkNew<vtkMRMLModelDisplayNode> displayNode1;
+  scene->AddNode(displayNode1.GetPointer());
+  modelNode->AddAndObserveDisplayNodeID(displayNode1->GetID());
+  vtkMapper* mapper1 = GetMapper(displayableManager, renderWindow, displayNode1.GetPointer());
+  CHECK_NOT_NULL(mapper1);
+
+  // The only user of a mapper keeps its mapper when its settings change
+  displayNode1->SetRepresentation(vtkMRMLDisplayNode::WireframeRepresentation);
+  CHECK_POINTER(GetMapper(displayableManager, renderWindow, displayNode1.GetPointer()), mapper1);
+
+  // Display nodes with the same settings share the mapper
+  vtkNew<vtkMRMLModelDisplayNode> displayNode2;
+  displayNode2->SetRepresentation(vtkMRMLDisplayNode::WireframeRepresentation);
+  scene->AddNode(displayNode2.GetPointer());
+  modelNode->AddAndObserveDisplayNodeID(displayNode2->GetID());
+  CHECK_POINTER(GetMapper(displayableManager, renderWindow, displayNode2.GetPointer()), mapper1);
+
+  // Diverging settings: the display node leaves the group, the other keeps the mapper
+  displayNode2->SetRepresentation(vtkMRMLDisplayNode::SurfaceRepresentation);
+  vtkMapper* mapper2 = GetMapper(displayableManager, renderWindow, displayNode2.GetPointer());
+  CHECK_NOT_NULL(mapper2);
+  CHECK_POINTER_DIFFERENT(mapper2, mapper1);
+  CHECK_POINTER(GetMapper(displayableManager, renderWindow, displayNode1.GetPointer()), mapper1);
+
+  // Same settings again: the display node joins the group
+  displayNode2->SetRepresentation(vtkMRMLDisplayNode::WireframeRepresentation);
+  CHECK_POINTER(GetMapper(displayableManager, renderWindow, displayNode2.GetPointer()), mapper1);
+
+  // Mapper settings of a display node don't affect the other display node
+  displayNode1->SetScalarVisibility(1);
+  mapper1 = GetMapper(displayableManager, renderWindow, displayNode1.GetPointer());
+  mapper2 = GetMapper(displayableManager, renderWindow, displayNode2.GetPointer());
+  CHECK_NOT_NULL(mapper1);
+  CHECK_NOT_NULL(mapper2);
+  CHECK_POINTER_DIFFERENT(mapper1, mapper2);
+  CHECK_INT(mapper1->GetScalarVisibility(), 1);
+  CHECK_INT(mapper2->GetScalarVisibility(), 0);
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// The geometry buffers of a shared mapper are built from the mapper settings
+// and its input only: changing the display properties that are not part of
+// the sharing key must not modify them, or the mesh would be uploaded again.
+int TestSharedMapperNotRebuilt(vtkMRMLScene* scene, vtkMRMLModelDisplayableManager* displayableManager,
+                               vtkRenderWindow* renderWindow)
+{
+  vtkNew<vtkMRMLModelNode> modelNode;
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetThetaResolution(64);
+  sphereSource->SetPhiResolution(64);
+  sphereSource->Update();
+  modelNode->SetPolyDataConnection(sphereSource->GetOutputPort());
+  scene->AddNode(modelNode.GetPointer());
+
+  vtkNew<vtkMRMLModelDisplayNode> displayNode1;
+  scene->AddNode(displayNode1.GetPointer());
+  modelNode->AddAndObserveDisplayNodeID(displayNode1->GetID());
+  vtkNew<vtkMRMLModelDisplayNode> displayNode2;
+  scene->AddNode(displayNode2.GetPointer());
+  modelNode->AddAndObserveDisplayNodeID(displayNode2->GetID());
+
+  vtkMapper* mapper = GetMapper(displayableManager, renderWindow, displayNode1.GetPointer());
+  CHECK_NOT_NULL(mapper);
+  CHECK_POINTER(GetMapper(displayableManager, renderWindow, displayNode2.GetPointer()), mapper);
+  vtkMTimeType mapperMTime = mapper->GetMTime();
+  vtkMTimeType inputMTime = mapper->GetInput()->GetMTime();
+
+  for (int i = 0; i < 10; ++i)
+    {
+    displayNode1->SetColor(0.1 * i, 0.5, 0.5);
+    displayNode2->SetOpacity(1. - 0.05 * i);
+    displayNode2->SetBackfaceCulling(i % 2);
+    displayNode1->SetVisibility(i % 2);
+    CHECK_POINTER(GetMapper(displayableManager, renderWindow, displayNode1.GetPointer()), mapper);
+    CHECK_POINTER(GetMapper(displayableManager, renderWindow, displayNode2.GetPointer()), mapper);
+    }
+  CHECK_BOOL(mapper->GetMTime() == mapperMTime, true);
+  CHECK_BOOL(mapper->GetInput()->GetMTime() == inputMTime, true);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelDisplayableManagerSharedMapperTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkRenderer> renderer;
+  vtkNew<vtkRenderWindow> renderWindow;
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindow->SetSize(200, 200);
+  renderWindow->AddRenderer(renderer.GetPointer());
+  renderWindow->SetInteractor(renderWindowInteractor.GetPointer());
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLApplicationLogic> applicationLogic;
+  applicationLogic->SetMRMLScene(scene.GetPointer());
+
+  vtkNew<vtkMRMLViewNode> viewNode;
+  scene->AddNode(viewNode.GetPointer());
+
+  vtkNew<vtkMRMLDisplayableManagerGroup> displayableManagerGroup;
+  displayableManagerGroup->SetRenderer(renderer.GetPointer());
+  displayableManagerGroup->SetMRMLDisplayableNode(viewNode.GetPointer());
+
+  vtkNew<vtkMRMLModelDisplayableManager> displayableManager;
+  displayableManager->SetMRMLApplicationLogic(applicationLogic.GetPointer());
+  displayableManagerGroup->AddDisplayableManager(displayableManager.GetPointer());
+
+  int result = TestSharedMapper(scene.GetPointer(), displayableManager.GetPointer(), renderWindow.GetPointer());
+  if (result == EXIT_SUCCESS)
+    {
+    result = TestSharedMapperNotRebuilt(scene.GetPointer(), displayableManager.GetPointer(), renderWindow.GetPointer());
+    }
+
+  displayableManager->SetMRMLApplicationLogic(0);
+  return result;
+}
@@ -71,6 +71,7 @@
 #include <vtkWeakPointer.h>
 
 // for picking
+#include <vtkCellLocator.h>
 #include <vtkCellPicker.h>
 #include <vtkPointPicker.h>
 #include <vtkPropPicker.h>
@@ -95,6 +96,59 @@ public:
   /// Reset all the pick vars
   void ResetPick();
 
+  /// Update cell locators of displayed models and register them in the cell picker.
+  /// Locators are only (re)built when a model mesh is modified, therefore repeated
+  /// picking (for example, on mouse hover) does not need to visit every cell of every model.
+  void UpdatePickLocators();
+
+  struct PickLocatorInfo
+    {
+    PickLocatorInfo() : MeshMTime(0) {}
+    vtkSmartPointer<vtkCellLocator> Locator;
+    vtkMTimeType MeshMTime;
+    };
+
+  /// Display nodes that render the same mesh with the same mesh-dependent
+  /// rendering options can use a single mapper. As the mapper owns the
+  /// geometry buffers, the mesh is then uploaded to the GPU only once.
+  /// The buffers depend on the input, the representation, the interpolation
+  /// (normals) and the edge visibility; scalar colors and texture coordinates
+  /// too, but scalar-colored and textured display nodes are never shared.
+  /// Mappers are only shared within a view.
+  struct SharedMapperKey
+    {
+    SharedMapperKey() : InputConnection(0), Representation(0), Interpolation(0), EdgeVisibility(0) {}
+    vtkAlgorithmOutput* InputConnection;
+    int Representation;
+    int Interpolation;
+    int EdgeVisibility;
+    bool operator<(const SharedMapperKey& other) const
+      {
+      if (this->InputConnection != other.InputConnection)
+        {
+        return this->InputConnection < other.InputConnection;
+        }
+      if (this->Representation != other.Representation)
+        {
+        return this->Representation < other.Representation;
+        }
+      if (this->Interpolation != other.Interpolation)
+        {
+        return this->Interpolation < other.Interpolation;
+        }
+      return this->EdgeVisibility < other.EdgeVisibility;
+      }
+    };
+
+  /// Make the actor use the mapper of other actors that display the same mesh
+  /// the same way, or use a mapper of its own if sharing is not possible.
+  void UpdateMapperSharing(vtkActor* actor, vtkMRMLModelDisplayNode* modelDisplayNode);
+  /// Give the actor a mapper of its own if its mapper is shared.
+  /// Must be called before changing any properties of the actor's mapper.
+  void UnshareMapper(vtkActor* actor);
+  /// Return true if the mapper of the actor is used by other displayed actors.
+  bool IsMapperShared(vtkActor* actor);
+
   std::map<std::string, vtkProp3D *>               DisplayedActors;
   std::map<std::string, vtkMRMLDisplayNode *>      DisplayedNodes;
   std::map<std::string, int>                       DisplayedClipState;
@@ -102,6 +156,7 @@ public:
   std::map<std::string, vtkMRMLDisplayableNode *>  DisplayableNodes;
   std::map<std::string, int>                       RegisteredModelHierarchies;
   std::map<std::string, vtkTransformFilter *>      DisplayNodeTransformFilters;
+  std::map<SharedMapperKey, vtkWeakPointer<vtkMapper> > SharedMappers;
 
   vtkMRMLSliceNode *   RedSliceNode;
   vtkMRMLSliceNode *   GreenSliceNode;
@@ -134,6 +189,12 @@ public:
   vtkIdType    PickedCellID;
   vtkIdType    PickedPointID;
 
+  /// Cell locators for picking, indexed by display node ID
+  std::map<std::string, PickLocatorInfo> PickLocators;
+  /// Meshes with fewer cells than this are picked without using a locator,
+  /// as for them building a locator would take longer than the picking.
+  vtkIdType PickLocatorMinimumNumberOfCells;
+
   // Used for caching the node pointer so that we do not have to search in the scene each time.
   // We do not add an observer therefore we can let the selection node deleted without our knowledge.
   vtkWeakPointer<vtkMRMLSelectionNode>   SelectionNode;
@@ -159,6 +220,7 @@ vtkMRMLModelDisplayableManager::vtkInternal::vtkInternal()
   this->CellPicker = vtkSmartPointer<vtkCellPicker>::New();
   this->CellPicker->SetTolerance(0.00001);
   this->PointPicker = vtkSmartPointer<vtkPointPicker>::New();
+  this->PickLocatorMinimumNumberOfCells = 1000;
   this->ResetPick();
 }
 
@@ -199,6 +261,168 @@ void vtkMRMLModelDisplayableManager::vtkInternal::ResetPick()
   this->PickedPointID = -1;
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::UpdatePickLocators()
+{
+  std::map<std::string, PickLocatorInfo> updatedPickLocators;
+  // Display nodes that share a mapper pick on the same mesh, one locator is enough for them
+  std::map<vtkPointSet*, vtkCellLocator*> locatorsByMesh;
+  for (std::map<std::string, vtkProp3D *>::iterator actorIt = this->DisplayedActors.begin();
+    actorIt != this->DisplayedActors.end(); ++actorIt)
+    {
+    vtkActor* actor = vtkActor::SafeDownCast(actorIt->second);
+    if (!actor || !actor->GetVisibility() || !actor->GetPickable() || !actor->GetMapper())
+      {
+      continue;
+      }
+    // The locator must be built for the same data set that the picker finds
+    // as mapper input, otherwise the picker would not use it.
+    vtkPointSet* mesh = vtkPointSet::SafeDownCast(actor->GetMapper()->GetInput());
+    if (!mesh || mesh->GetNumberOfCells() < this->PickLocatorMinimumNumberOfCells)
+      {
+      continue;
+      }
+    PickLocatorInfo& locatorInfo = updatedPickLocators[actorIt->first];
+    std::map<vtkPointSet*, vtkCellLocator*>::iterator meshLocatorIt = locatorsByMesh.find(mesh);
+    if (meshLocatorIt != locatorsByMesh.end())
+      {
+      locatorInfo.Locator = meshLocatorIt->second;
+      locatorInfo.MeshMTime = mesh->GetMTime();
+      continue;
+      }
+    std::map<std::string, PickLocatorInfo>::iterator existingLocatorIt = this->PickLocators.find(actorIt->first);
+    if (existingLocatorIt != this->PickLocators.end())
+      {
+      locatorInfo = existingLocatorIt->second;
+      }
+    if (!locatorInfo.Locator)
+      {
+      locatorInfo.Locator = vtkSmartPointer<vtkCellLocator>::New();
+      }
+    if (locatorInfo.Locator->GetDataSet() != mesh || locatorInfo.MeshMTime != mesh->GetMTime())
+      {
+      // mesh is new or changed, rebuild the locator
+      locatorInfo.Locator->SetDataSet(mesh);
+      locatorInfo.Locator->Initialize();
+      locatorInfo.Locator->BuildLocator();
+      locatorInfo.MeshMTime = mesh->GetMTime();
+      }
+    locatorsByMesh[mesh] = locatorInfo.Locator;
+    }
+  // Locators of models that are not displayed anymore are released here
+  this->PickLocators.swap(updatedPickLocators);
+
+  this->CellPicker->RemoveAllLocators();
+  for (std::map<vtkPointSet*, vtkCellLocator*>::iterator locatorIt = locatorsByMesh.begin();
+    locatorIt != locatorsByMesh.end(); ++locatorIt)
+    {
+    this->CellPicker->AddLocator(locatorIt->second);
+    }
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLModelDisplayableManager::vtkInternal::IsMapperShared(vtkActor* actor)
+{
+  vtkMapper* mapper = actor ? actor->GetMapper() : NULL;
+  if (!mapper)
+    {
+    return false;
+    }
+  for (std::map<std::string, vtkProp3D *>::iterator actorIt = this->DisplayedActors.begin();
+    actorIt != this->DisplayedActors.end(); ++actorIt)
+    {
+    vtkActor* otherActor = vtkActor::SafeDownCast(actorIt->second);
+    if (otherActor && otherActor != actor && otherActor->GetMapper() == mapper)
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::UnshareMapper(vtkActor* actor)
+{
+  vtkMapper* mapper = actor ? actor->GetMapper() : NULL;
+  if (!mapper)
+    {
+    return;
+    }
+  if (!this->IsMapperShared(actor))
+    {
+    // The actor is the only user of the mapper, it can keep it, but the mapper
+    // must not be given to other actors anymore as its settings may change.
+    std::map<SharedMapperKey, vtkWeakPointer<vtkMapper> >::iterator mapperIt = this->SharedMappers.begin();
+    while (mapperIt != this->SharedMappers.end())
+      {
+      if (mapperIt->second.GetPointer() == mapper)
+        {
+        this->SharedMappers.erase(mapperIt++);
+        }
+      else
+        {
+        ++mapperIt;
+        }
+      }
+    return;
+    }
+  vtkSmartPointer<vtkMapper> privateMapper = vtkSmartPointer<vtkMapper>::Take(mapper->NewInstance());
+  privateMapper->ShallowCopy(mapper);
+  privateMapper->SetInputConnection(mapper->GetInputConnection(0, 0));
+  actor->SetMapper(privateMapper);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::UpdateMapperSharing(
+  vtkActor* actor, vtkMRMLModelDisplayNode* modelDisplayNode)
+{
+  vtkMapper* mapper = actor ? actor->GetMapper() : NULL;
+  if (!mapper || !modelDisplayNode)
+    {
+    return;
+    }
+  // Scalar coloring options are stored in the mapper and texture coordinates
+  // are only uploaded for textured actors, so these cannot be shared.
+  if (modelDisplayNode->GetScalarVisibility()
+    || modelDisplayNode->GetTextureImageDataConnection() != 0
+    || mapper->GetInputConnection(0, 0) == 0)
+    {
+    this->UnshareMapper(actor);
+    return;
+    }
+
+  // Clipped and non-linearly transformed models have their own filter output
+  // as mapper input, so they never end up in the same group as other models.
+  SharedMapperKey key;
+  key.InputConnection = mapper->GetInputConnection(0, 0);
+  key.Representation = modelDisplayNode->GetRepresentation();
+  key.Interpolation = modelDisplayNode->GetInterpolation();
+  key.EdgeVisibility = modelDisplayNode->GetEdgeVisibility();
+
+  std::map<SharedMapperKey, vtkWeakPointer<vtkMapper> >::iterator sharedMapperIt = this->SharedMappers.find(key);
+  if (sharedMapperIt != this->SharedMappers.end() && sharedMapperIt->second.GetPointer() == mapper)
+    {
+    // already shared within the right group
+    return;
+    }
+  // leave the group that the actor is in, without affecting the other members
+  this->UnshareMapper(actor);
+  mapper = actor->GetMapper();
+
+  if (sharedMapperIt != this->SharedMappers.end())
+    {
+    vtkMapper* sharedMapper = sharedMapperIt->second.GetPointer();
+    // the mapper may have been deleted or its input may have been changed since it was registered
+    if (sharedMapper && sharedMapper->IsA(mapper->GetClassName())
+      && sharedMapper->GetInputConnection(0, 0) == key.InputConnection)
+      {
+      actor->SetMapper(sharedMapper);
+      return;
+      }
+    }
+  this->SharedMappers[key] = mapper;
+}
+
 //---------------------------------------------------------------------------
 // vtkMRMLModelDisplayableManager methods
 
@@ -852,6 +1076,8 @@ void vtkMRMLModelDisplayableManager::UpdateModelsFromMRML()
     this->RemoveModelObservers(1);
     this->RemoveHierarchyObservers(1);
     this->Internal->DisplayedActors.clear();
+    this->Internal->PickLocators.clear();
+    this->Internal->SharedMappers.clear();
     this->Internal->DisplayedNodes.clear();
     this->Internal->DisplayedClipState.clear();
     this->Internal->DisplayedVisibility.clear();
@@ -1029,13 +1255,21 @@ void vtkMRMLModelDisplayableManager
           {
           vtkMapper *mapper = actor->GetMapper();
 
+          vtkAlgorithmOutput* mapperInputConnection = NULL;
           if (transformFilter)
             {
-            mapper->SetInputConnection(transformFilter->GetOutputPort());
+            mapperInputConnection = transformFilter->GetOutputPort();
             }
-          else if (mapper && !(this->Internal->ClippingOn && clipping))
+          else if (!(this->Internal->ClippingOn && clipping))
             {
-            mapper->SetInputConnection(meshConnection);
+            mapperInputConnection = meshConnection;
+            }
+          if (mapper && mapperInputConnection
+            && mapper->GetInputConnection(0, 0) != mapperInputConnection)
+            {
+            // other display nodes that share the mapper keep displaying their mesh
+            this->Internal->UnshareMapper(actor);
+            actor->GetMapper()->SetInputConnection(mapperInputConnection);
             }
           }
         vtkMRMLTransformNode* tnode = displayableNode->GetParentTransformNode();
@@ -1386,6 +1620,7 @@ void vtkMRMLModelDisplayableManager::RemoveDispalyedID(std::string &id)
 {
   std::map<std::string, vtkMRMLDisplayNode *>::iterator modelIter;
   this->Internal->DisplayedActors.erase(id);
+  this->Internal->PickLocators.erase(id);
   this->Internal->DisplayedClipState.erase(id);
   this->Internal->DisplayedVisibility.erase(id);
   modelIter = this->Internal->DisplayedNodes.find(id);
@@ -1435,6 +1670,8 @@ void vtkMRMLModelDisplayableManager::RemoveModelObservers(int clearCache)
     {
     this->Internal->DisplayableNodes.clear();
     this->Internal->DisplayedActors.clear();
+    this->Internal->PickLocators.clear();
+    this->Internal->SharedMappers.clear();
     this->Internal->DisplayedNodes.clear();
     this->Internal->DisplayedClipState.clear();
     this->Internal->DisplayedVisibility.clear();
@@ -1546,6 +1783,10 @@ void vtkMRMLModelDisplayableManager::SetModelDisplayProperty(vtkMRMLDisplayableN
       prop->SetVisibility(visible);
       this->Internal->DisplayedVisibility[modelDisplayNode->GetID()] = visible;
 
+      if (actor)
+        {
+        this->Internal->UpdateMapperSharing(actor, modelDisplayNode);
+        }
       vtkMapper* mapper = actor ? actor->GetMapper() : NULL;
       if (mapper)
         {
@@ -1834,6 +2075,8 @@ int vtkMRMLModelDisplayableManager::Pick(int x, int y)
   displayPoint[1] = renSize[1] - y;
   displayPoint[2] = 0.0;
 
+  this->Internal->UpdatePickLocators();
+
   if (this->Internal->CellPicker->Pick(displayPoint[0], displayPoint[1], displayPoint[2], ren))
     {
     this->Internal->CellPicker->GetPickPosition(pickPoint);
@@ -0,0 +1,155 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// MRMLIDImageIO includes
+#include "itkMRMLIDImageIO.h"
+
+// MRML includes
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+std::string GetNodeFileName(vtkMRMLScene* scene, vtkMRMLNode* node)
+{
+  char sceneAddress[64];
+  sprintf(sceneAddress, "%p", static_cast<void*>(scene));
+  return std::string("slicer:") + sceneAddress + "#" + node->GetID();
+}
+
+//----------------------------------------------------------------------------
+// The image read from a node uses the node voxels.
+int TestReadUsingOwnBuffer()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLScalarVolumeNode> node;
+  scene->AddNode(node.GetPointer());
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(4, 3, 2);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  short* voxels = static_cast<short*>(imageData->GetScalarPointer());
+  for (int i = 0; i < 4 * 3 * 2; ++i)
+    {
+    voxels[i] = static_cast<short>(i);
+    }
+  node->SetAndObserveImageData(imageData.GetPointer());
+
+  itk::MRMLIDImageIO::Pointer imageIO = itk::MRMLIDImageIO::New();
+  imageIO->SetFileName(GetNodeFileName(scene.GetPointer(), node.GetPointer()));
+  imageIO->ReadImageInformation();
+  if (!imageIO->CanUseOwnBuffer())
+    {
+    std::cerr << "Line " << __LINE__ << ": the node voxels can't be used" << std::endl;
+    return EXIT_FAILURE;
+    }
+  imageIO->ReadUsingOwnBuffer();
+  short* buffer = static_cast<short*>(imageIO->GetOwnBuffer());
+  if (buffer != voxels)
+    {
+    std::cerr << "Line " << __LINE__ << ": the node voxels have been copied" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The voxels stay valid when the node image data is replaced
+  vtkNew<vtkImageData> otherImageData;
+  otherImageData->SetDimensions(1, 1, 1);
+  otherImageData->AllocateScalars(VTK_SHORT, 1);
+  node->SetAndObserveImageData(otherImageData.GetPointer());
+  imageData->Initialize();
+  if (buffer[4 * 3 * 2 - 1] != 4 * 3 * 2 - 1)
+    {
+    std::cerr << "Line " << __LINE__ << ": the node voxels have been released" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// The node written from an image adopts the image buffer.
+int TestWriteAdoptingBuffer()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLScalarVolumeNode> node;
+  scene->AddNode(node.GetPointer());
+
+  itk::MRMLIDImageIO::Pointer imageIO = itk::MRMLIDImageIO::New();
+  imageIO->SetFileName(GetNodeFileName(scene.GetPointer(), node.GetPointer()));
+  imageIO->SetNumberOfDimensions(3);
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    imageIO->SetDimensions(i, 4 - i);
+    std::vector<double> direction(3, 0.);
+    direction[i] = 1.;
+    imageIO->SetDirection(i, direction);
+    }
+  imageIO->SetPixelType(itk::ImageIOBase::SCALAR);
+  imageIO->SetComponentType(itk::ImageIOBase::FLOAT);
+  imageIO->SetNumberOfComponents(1);
+  const itk::SizeValueType numberOfValues = 4 * 3 * 2;
+  if (!imageIO->CanAdoptBuffer())
+    {
+    std::cerr << "Line " << __LINE__ << ": the node can't adopt the buffer" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  float* buffer = new float[numberOfValues];
+  for (itk::SizeValueType i = 0; i < numberOfValues; ++i)
+    {
+    buffer[i] = 0.5f * i;
+    }
+  // A buffer of the wrong size is not adopted
+  if (imageIO->WriteAdoptingBuffer(buffer, numberOfValues - 1))
+    {
+    std::cerr << "Line " << __LINE__ << ": a buffer of the wrong size has been adopted" << std::endl;
+    delete [] buffer;
+    return EXIT_FAILURE;
+    }
+  if (!imageIO->WriteAdoptingBuffer(buffer, numberOfValues))
+    {
+    std::cerr << "Line " << __LINE__ << ": the buffer has not been adopted" << std::endl;
+    delete [] buffer;
+    return EXIT_FAILURE;
+    }
+  // The node now owns the buffer
+  vtkImageData* imageData = node->GetImageData();
+  if (!imageData || imageData->GetScalarPointer() != buffer
+      || imageData->GetScalarType() != VTK_FLOAT
+      || imageData->GetNumberOfPoints() != static_cast<vtkIdType>(numberOfValues))
+    {
+    std::cerr << "Line " << __LINE__ << ": the node doesn't use the written buffer" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int itkMRMLIDImageIOTest1(int, char *[])
+{
+  if (TestReadUsingOwnBuffer() != EXIT_SUCCESS
+      || TestWriteAdoptingBuffer() != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
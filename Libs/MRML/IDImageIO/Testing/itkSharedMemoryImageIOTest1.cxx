@@ -0,0 +1,232 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// MRMLIDImageIO includes
+#include "itkSharedMemoryImageIO.h"
+#include "itkSharedMemoryImageSegment.h"
+
+// ITK includes
+#include <itkImage.h>
+#include <itkImageFileReader.h>
+#include <itkImageFileWriter.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+std::string GetTestFileName(const char* name)
+{
+  // Segments are global to the system, make them unique to the test process
+  std::ostringstream fileName;
+  fileName << itk::SharedMemoryImageSegment::GetFileNamePrefix() << "/"
+           << name << "_" << getpid();
+  return fileName.str();
+}
+
+//----------------------------------------------------------------------------
+int TestSegment()
+{
+  const std::string fileName = GetTestFileName("itkSharedMemoryImageSegmentTest");
+
+  itk::SharedMemoryImageHeader header;
+  memset(&header, 0, sizeof(header));
+  header.ComponentType = itk::SharedMemoryImageHeader::FloatComponent;
+  header.NumberOfComponents = 2;
+  header.Dimension = 3;
+  header.Size[0] = 4;
+  header.Size[1] = 3;
+  header.Size[2] = 2;
+  header.Spacing[0] = header.Spacing[1] = header.Spacing[2] = 1.5;
+  header.Direction[0] = header.Direction[4] = header.Direction[8] = 1.;
+  const size_t numberOfValues = 4 * 3 * 2 * 2;
+
+  itk::SharedMemoryImageSegment writtenSegment;
+  if (!writtenSegment.Create(fileName, header))
+    {
+    std::cerr << "Line " << __LINE__ << ": failed to create " << fileName << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (writtenSegment.GetHeader()->DataSize != numberOfValues * sizeof(float))
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong data size "
+              << writtenSegment.GetHeader()->DataSize << std::endl;
+    itk::SharedMemoryImageSegment::Remove(fileName);
+    return EXIT_FAILURE;
+    }
+  float* writtenData = static_cast<float*>(writtenSegment.GetData());
+  for (size_t i = 0; i < numberOfValues; ++i)
+    {
+    writtenData[i] = 0.5f * i;
+    }
+  writtenSegment.Close();
+
+  // The segment outlives its mapping and can be read back by another object
+  itk::SharedMemoryImageSegment readSegment;
+  bool opened = readSegment.Open(fileName);
+  bool same = opened
+    && readSegment.GetHeader()->ComponentType == header.ComponentType
+    && readSegment.GetHeader()->NumberOfComponents == header.NumberOfComponents
+    && readSegment.GetHeader()->Size[0] == 4
+    && readSegment.GetHeader()->Size[2] == 2
+    && readSegment.GetHeader()->Spacing[1] == 1.5
+    && memcmp(readSegment.GetHeader()->Direction, header.Direction, sizeof(header.Direction)) == 0;
+  for (size_t i = 0; same && i < numberOfValues; ++i)
+    {
+    same = static_cast<const float*>(readSegment.GetData())[i] == 0.5f * i;
+    }
+  readSegment.Close();
+  if (!itk::SharedMemoryImageSegment::Remove(fileName) || !opened || !same)
+    {
+    std::cerr << "Line " << __LINE__ << ": failed to read back " << fileName << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Removed segments and regular files can't be opened
+  if (readSegment.Open(fileName) || readSegment.Open("/tmp/image.nrrd"))
+    {
+    std::cerr << "Line " << __LINE__ << ": opened an invalid segment" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestImageIO()
+{
+  typedef itk::Image<short, 3> ImageType;
+  const std::string fileName = GetTestFileName("itkSharedMemoryImageIOTest");
+
+  ImageType::SizeType size;
+  size[0] = 5;
+  size[1] = 4;
+  size[2] = 3;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(ImageType::RegionType(size));
+  image->Allocate();
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = 0.75;
+  spacing[2] = 2.;
+  image->SetSpacing(spacing);
+  ImageType::PointType origin;
+  origin[0] = -10.;
+  origin[1] = 20.;
+  origin[2] = 30.;
+  image->SetOrigin(origin);
+  ImageType::DirectionType direction;
+  direction.Fill(0.);
+  direction[0][1] = 1.;
+  direction[1][0] = -1.;
+  direction[2][2] = 1.;
+  image->SetDirection(direction);
+  short value = -100;
+  for (itk::ImageRegionIterator<ImageType> it(image, image->GetLargestPossibleRegion());
+       !it.IsAtEnd(); ++it)
+    {
+    it.Set(value++);
+    }
+
+  itk::SharedMemoryImageIO::Pointer imageIO = itk::SharedMemoryImageIO::New();
+  if (!imageIO->CanWriteFile(fileName.c_str()) || imageIO->CanWriteFile("/tmp/image.nrrd"))
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong CanWriteFile result" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ImageType::Pointer readImage;
+  try
+    {
+    itk::ImageFileWriter<ImageType>::Pointer writer = itk::ImageFileWriter<ImageType>::New();
+    writer->SetImageIO(imageIO);
+    writer->SetFileName(fileName);
+    writer->SetInput(image);
+    writer->Update();
+
+    if (!imageIO->CanReadFile(fileName.c_str()))
+      {
+      std::cerr << "Line " << __LINE__ << ": can't read " << fileName << std::endl;
+      itk::SharedMemoryImageSegment::Remove(fileName);
+      return EXIT_FAILURE;
+      }
+
+    itk::ImageFileReader<ImageType>::Pointer reader = itk::ImageFileReader<ImageType>::New();
+    reader->SetImageIO(itk::SharedMemoryImageIO::New());
+    reader->SetFileName(fileName);
+    reader->Update();
+    readImage = reader->GetOutput();
+    }
+  catch (itk::ExceptionObject& exception)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << exception << std::endl;
+    itk::SharedMemoryImageSegment::Remove(fileName);
+    return EXIT_FAILURE;
+    }
+  itk::SharedMemoryImageSegment::Remove(fileName);
+
+  if (readImage->GetLargestPossibleRegion().GetSize() != size)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong size "
+              << readImage->GetLargestPossibleRegion().GetSize() << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (int i = 0; i < 3; ++i)
+    {
+    bool sameDirection = true;
+    for (int j = 0; j < 3; ++j)
+      {
+      sameDirection = sameDirection
+        && std::fabs(readImage->GetDirection()[i][j] - direction[i][j]) < 1e-9;
+      }
+    if (std::fabs(readImage->GetSpacing()[i] - spacing[i]) > 1e-9
+        || std::fabs(readImage->GetOrigin()[i] - origin[i]) > 1e-9
+        || !sameDirection)
+      {
+      std::cerr << "Line " << __LINE__ << ": wrong geometry along axis " << i << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  itk::ImageRegionConstIterator<ImageType> writtenIt(image, image->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<ImageType> readIt(readImage, readImage->GetLargestPossibleRegion());
+  for (; !writtenIt.IsAtEnd(); ++writtenIt, ++readIt)
+    {
+    if (readIt.Get() != writtenIt.Get())
+      {
+      std::cerr << "Line " << __LINE__ << ": wrong voxel " << writtenIt.GetIndex()
+                << ": " << readIt.Get() << " instead of " << writtenIt.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int itkSharedMemoryImageIOTest1(int, char*[])
+{
+  if (TestSegment() != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+  if (TestImageIO() != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -36,12 +36,17 @@ MRMLIDImageIO
   this->m_Authority = "";
   this->m_SceneID = "";
   this->m_NodeID = "";
+  this->m_OwnBufferArray = 0;
 }
 
 //----------------------------------------------------------------------------
 MRMLIDImageIO
 ::~MRMLIDImageIO()
 {
+  if (this->m_OwnBufferArray)
+    {
+    this->m_OwnBufferArray->UnRegister(NULL);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -153,6 +158,24 @@ MRMLIDImageIO
   return 0;
 }
 
+//----------------------------------------------------------------------------
+vtkDataArray *
+MRMLIDImageIO
+::GetNodeVoxelArray(vtkMRMLVolumeNode* node)
+{
+  if (!node || !node->GetImageData())
+    {
+    return 0;
+    }
+  if (vtkMRMLDiffusionImageVolumeNode::SafeDownCast(node) == 0)
+    {
+    // Scalar, Diffusion Weighted, or Vector image
+    return node->GetImageData()->GetPointData()->GetScalars();
+    }
+  // Tensor image
+  return node->GetImageData()->GetPointData()->GetTensors();
+}
+
 //----------------------------------------------------------------------------
 bool
 MRMLIDImageIO
@@ -383,7 +406,17 @@ bool
 MRMLIDImageIO
 ::CanUseOwnBuffer()
 {
-  return true;
+  vtkDataArray* array =
+    this->GetNodeVoxelArray(this->FileNameToVolumeNodePtr( m_FileName.c_str() ));
+  if (!array || array->GetNumberOfTuples() == 0)
+    {
+    return false;
+    }
+  // The node buffer must hold exactly the pixels described by
+  // ReadImageInformation()
+  return static_cast<SizeType>(array->GetNumberOfTuples())
+    * array->GetNumberOfComponents()
+    * array->GetDataTypeSize() == this->GetImageSizeInBytes();
 }
 
 //----------------------------------------------------------------------------
@@ -401,21 +434,18 @@ void *
 MRMLIDImageIO
 ::GetOwnBuffer()
 {
-  vtkMRMLVolumeNode *node;
-
-  node = this->FileNameToVolumeNodePtr( m_FileName.c_str() );
-  if (node)
+  vtkDataArray* array =
+    this->GetNodeVoxelArray(this->FileNameToVolumeNodePtr( m_FileName.c_str() ));
+  if (array)
     {
-    // buffer is preallocated, memcpy the data
-    if (vtkMRMLDiffusionImageVolumeNode::SafeDownCast(node) == 0)
+    // keep the voxels alive while the caller uses them
+    array->Register(NULL);
+    if (this->m_OwnBufferArray)
       {
-      // Scalar, Diffusion Weighted, or Vector image
-      return node->GetImageData()->GetScalarPointer();
-      }
-    else
-      {
-      return node->GetImageData()->GetPointData()->GetTensors()->GetVoidPointer(0);
+      this->m_OwnBufferArray->UnRegister(NULL);
       }
+    this->m_OwnBufferArray = array;
+    return array->GetVoidPointer(0);
     }
 
   throw( "MRML Node does not contain image data." );
@@ -593,6 +623,58 @@ MRMLIDImageIO
 void
 MRMLIDImageIO
 ::Write(const void *buffer)
+{
+  this->WriteBuffer(buffer, false);
+}
+
+//----------------------------------------------------------------------------
+bool
+MRMLIDImageIO
+::CanAdoptBuffer()
+{
+  vtkMRMLVolumeNode *node = this->FileNameToVolumeNodePtr( m_FileName.c_str() );
+  if (node == 0 || vtkMRMLDiffusionTensorVolumeNode::SafeDownCast(node) != 0)
+    {
+    return false;
+    }
+  // Only the component types that have an exact VTK equivalent (see
+  // WriteImageInformation())
+  switch (this->GetComponentType())
+    {
+    case FLOAT:
+    case DOUBLE:
+    case INT:
+    case UINT:
+    case SHORT:
+    case USHORT:
+    case LONG:
+    case ULONG:
+    case CHAR:
+    case UCHAR:
+      return true;
+    default:
+      return false;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool
+MRMLIDImageIO
+::WriteAdoptingBuffer(void *buffer, SizeValueType size)
+{
+  if (!buffer || !this->CanAdoptBuffer()
+      || size != this->GetImageSizeInPixels() * this->GetNumberOfComponents())
+    {
+    return false;
+    }
+  this->WriteBuffer(buffer, true);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void
+MRMLIDImageIO
+::WriteBuffer(const void *buffer, bool adopt)
 {
   vtkMRMLVolumeNode *node;
 
@@ -638,13 +720,31 @@ MRMLIDImageIO
     if (vtkMRMLDiffusionTensorVolumeNode::SafeDownCast(node) == 0)
       {
       // Everything but tensor images are passed in the scalars
-      img->AllocateScalars(scalarType, numberOfScalarComponents);
+      if (adopt)
+        {
+        // The node takes ownership of the ITK buffer, allocated with new[]
+        vtkDataArray *scalars = vtkDataArray::CreateDataArray(scalarType);
+        scalars->SetNumberOfComponents(numberOfScalarComponents);
+        scalars->SetVoidArray(const_cast<void*>(buffer),
+                              this->GetImageSizeInPixels() * numberOfScalarComponents,
+                              0, vtkAbstractArray::VTK_DATA_ARRAY_DELETE);
+        if (img->GetPointData()->GetScalars())
+          {
+          scalars->SetName(img->GetPointData()->GetScalars()->GetName());
+          }
+        img->GetPointData()->SetScalars(scalars);
+        scalars->Delete();
+        }
+      else
+        {
+        img->AllocateScalars(scalarType, numberOfScalarComponents);
 
-      memcpy(img->GetScalarPointer(), buffer,
-             img->GetPointData()->GetScalars()->GetNumberOfComponents() *
-             img->GetPointData()->GetScalars()->GetNumberOfTuples() *
-             img->GetPointData()->GetScalars()->GetDataTypeSize()
-        );
+        memcpy(img->GetScalarPointer(), buffer,
+               img->GetPointData()->GetScalars()->GetNumberOfComponents() *
+               img->GetPointData()->GetScalars()->GetNumberOfTuples() *
+               img->GetPointData()->GetScalars()->GetDataTypeSize()
+          );
+        }
       }
     else
       {
@@ -710,6 +810,7 @@ MRMLIDImageIO
   os << indent << "Authority: " << this->m_Authority << std::endl;
   os << indent << "SceneID: " << this->m_SceneID << std::endl;
   os << indent << "NodeID: " << this->m_NodeID << std::endl;
+  os << indent << "OwnBufferArray: " << this->m_OwnBufferArray << std::endl;
 }
 
 //----------------------------------------------------------------------------
@@ -23,6 +23,7 @@
 class vtkMRMLVolumeNode;
 class vtkMRMLDiffusionWeightedVolumeNode;
 class vtkMRMLDiffusionImageVolumeNode;
+class vtkDataArray;
 class vtkImageData;
 
 namespace itk
@@ -68,8 +69,19 @@ public:
    * file specified. */
   virtual bool CanReadFile(const char*) ITK_OVERRIDE;
 
+  /** Returns true if the voxels of the node can be used directly as the
+   * pixel buffer of the image being read, without copying them. The
+   * node buffer has the layout described by ReadImageInformation().
+   * ImageFileReader always reads into its own buffer: code running in the
+   * Slicer process imports GetOwnBuffer() in the pixel container of its
+   * image instead (ImportImageContainer::SetImportPointer()).
+   * \sa GetOwnBuffer() */
   virtual bool CanUseOwnBuffer();
   virtual void ReadUsingOwnBuffer();
+  /** Returns the voxels of the node. The array holding them is kept alive
+   * as long as this ImageIO, even if the node image data is replaced
+   * (e.g. when the same node is also written). The buffer must be
+   * treated as read-only. */
   virtual void * GetOwnBuffer();
 
   /** Set the spacing and dimension information for the set filename. */
@@ -92,6 +104,21 @@ public:
    * that the IORegion has been set properly. */
   virtual void Write(const void* buffer) ITK_OVERRIDE;
 
+  /** Returns true if the node being written can take ownership of a pixel
+   * buffer allocated by ITK (with new[]) instead of copying it. This is
+   * not possible for tensor images, which are stored with 9 components
+   * in the node and 6 components in ITK.
+   * \sa WriteAdoptingBuffer() */
+  virtual bool CanAdoptBuffer();
+
+  /** Same as Write() but the node takes ownership of \a buffer, which
+   * must have been allocated with new[] as an array of \a size
+   * components of the IO component type. Returns false, without taking
+   * ownership, if the buffer cannot be adopted. On success, the pixel
+   * container of the written image must stop managing its memory
+   * (ContainerManageMemoryOff()). */
+  virtual bool WriteAdoptingBuffer(void* buffer, SizeValueType size);
+
 protected:
   MRMLIDImageIO();
   ~MRMLIDImageIO();
@@ -128,11 +155,20 @@ private:
   bool IsAVolumeNode(const char*);
   vtkMRMLVolumeNode* FileNameToVolumeNodePtr(const char*);
 
+  /** Returns the array holding the voxels of the node */
+  vtkDataArray* GetNodeVoxelArray(vtkMRMLVolumeNode*);
+
+  /** Write to the node either by copying \a buffer or, if \a adopt is
+   * true, by taking ownership of it. */
+  void WriteBuffer(const void* buffer, bool adopt);
+
   std::string m_Scheme;
   std::string m_Authority;
   std::string m_SceneID;
   std::string m_NodeID;
 
+  /** Array returned by GetOwnBuffer(), referenced by the IO */
+  vtkDataArray* m_OwnBufferArray;
 };
 
 
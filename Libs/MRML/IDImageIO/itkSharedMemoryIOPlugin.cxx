@@ -0,0 +1,15 @@
+#include "itkSharedMemoryIOPlugin.h"
+#include "itkSharedMemoryImageIOFactory.h"
+
+/**
+ * Routine that is called when the shared library is loaded by
+ * itk::ObjectFactoryBase::LoadDynamicFactories().
+ *
+ * itkLoad() is C (not C++) function.
+ */
+itk::ObjectFactoryBase* itkLoad()
+{
+  static itk::SharedMemoryImageIOFactory::Pointer f
+    = itk::SharedMemoryImageIOFactory::New();
+  return f;
+}
@@ -0,0 +1,176 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#include "itkSharedMemoryImageIO.h"
+#include "itkSharedMemoryImageSegment.h"
+
+// STD includes
+#include <cstring>
+
+namespace itk
+{
+
+//----------------------------------------------------------------------------
+SharedMemoryImageIO::SharedMemoryImageIO()
+{
+}
+
+//----------------------------------------------------------------------------
+SharedMemoryImageIO::~SharedMemoryImageIO()
+{
+}
+
+//----------------------------------------------------------------------------
+void SharedMemoryImageIO::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+}
+
+//----------------------------------------------------------------------------
+bool SharedMemoryImageIO::CanReadFile(const char* filename)
+{
+  if (!filename || !SharedMemoryImageSegment::IsSharedMemoryFileName(filename))
+    {
+    return false;
+    }
+  SharedMemoryImageSegment segment;
+  return segment.Open(filename);
+}
+
+//----------------------------------------------------------------------------
+void SharedMemoryImageIO::ReadImageInformation()
+{
+  SharedMemoryImageSegment segment;
+  if (!segment.Open(this->GetFileName()))
+    {
+    itkExceptionMacro("Cannot open shared memory image " << this->GetFileName());
+    }
+  const SharedMemoryImageHeader* header = segment.GetHeader();
+
+  this->SetNumberOfDimensions(header->Dimension);
+  for (unsigned int i = 0; i < header->Dimension; ++i)
+    {
+    this->SetDimensions(i, static_cast<unsigned int>(header->Size[i]));
+    this->SetSpacing(i, header->Spacing[i]);
+    this->SetOrigin(i, header->Origin[i]);
+    std::vector<double> direction(header->Dimension);
+    for (unsigned int j = 0; j < header->Dimension; ++j)
+      {
+      direction[j] = header->Direction[j * 3 + i];
+      }
+    this->SetDirection(i, direction);
+    }
+
+  switch (header->ComponentType)
+    {
+    case SharedMemoryImageHeader::UCharComponent: this->SetComponentType(UCHAR); break;
+    case SharedMemoryImageHeader::CharComponent: this->SetComponentType(CHAR); break;
+    case SharedMemoryImageHeader::UShortComponent: this->SetComponentType(USHORT); break;
+    case SharedMemoryImageHeader::ShortComponent: this->SetComponentType(SHORT); break;
+    case SharedMemoryImageHeader::UIntComponent: this->SetComponentType(UINT); break;
+    case SharedMemoryImageHeader::IntComponent: this->SetComponentType(INT); break;
+    case SharedMemoryImageHeader::ULongLongComponent:
+      this->SetComponentType(sizeof(unsigned long) == 8 ? ULONG : ULONGLONG); break;
+    case SharedMemoryImageHeader::LongLongComponent:
+      this->SetComponentType(sizeof(long) == 8 ? LONG : LONGLONG); break;
+    case SharedMemoryImageHeader::FloatComponent: this->SetComponentType(FLOAT); break;
+    case SharedMemoryImageHeader::DoubleComponent: this->SetComponentType(DOUBLE); break;
+    default:
+      itkExceptionMacro("Unknown component type in shared memory image " << this->GetFileName());
+    }
+
+  this->SetNumberOfComponents(header->NumberOfComponents);
+  this->SetPixelType(header->NumberOfComponents > 1 ? VECTOR : SCALAR);
+}
+
+//----------------------------------------------------------------------------
+void SharedMemoryImageIO::Read(void* buffer)
+{
+  SharedMemoryImageSegment segment;
+  if (!segment.Open(this->GetFileName()))
+    {
+    itkExceptionMacro("Cannot open shared memory image " << this->GetFileName());
+    }
+  // streaming is not supported, the whole image is always requested
+  SizeType imageSizeInBytes = this->GetImageSizeInBytes();
+  if (imageSizeInBytes != segment.GetHeader()->DataSize)
+    {
+    itkExceptionMacro("Size of shared memory image " << this->GetFileName()
+                      << " does not match its header");
+    }
+  memcpy(buffer, segment.GetData(), imageSizeInBytes);
+}
+
+//----------------------------------------------------------------------------
+bool SharedMemoryImageIO::CanWriteFile(const char* filename)
+{
+  return filename && SharedMemoryImageSegment::IsSharedMemoryFileName(filename);
+}
+
+//----------------------------------------------------------------------------
+void SharedMemoryImageIO::Write(const void* buffer)
+{
+  unsigned int dimension = this->GetNumberOfDimensions();
+  if (dimension < 1 || dimension > 3)
+    {
+    itkExceptionMacro("Only 1D to 3D images can be written to shared memory");
+    }
+
+  SharedMemoryImageHeader header;
+  memset(&header, 0, sizeof(header));
+  switch (this->GetComponentType())
+    {
+    case UCHAR: header.ComponentType = SharedMemoryImageHeader::UCharComponent; break;
+    case CHAR: header.ComponentType = SharedMemoryImageHeader::CharComponent; break;
+    case USHORT: header.ComponentType = SharedMemoryImageHeader::UShortComponent; break;
+    case SHORT: header.ComponentType = SharedMemoryImageHeader::ShortComponent; break;
+    case UINT: header.ComponentType = SharedMemoryImageHeader::UIntComponent; break;
+    case INT: header.ComponentType = SharedMemoryImageHeader::IntComponent; break;
+    case ULONG:
+      header.ComponentType = sizeof(unsigned long) == 8 ?
+        SharedMemoryImageHeader::ULongLongComponent : SharedMemoryImageHeader::UIntComponent; break;
+    case LONG:
+      header.ComponentType = sizeof(long) == 8 ?
+        SharedMemoryImageHeader::LongLongComponent : SharedMemoryImageHeader::IntComponent; break;
+    case ULONGLONG: header.ComponentType = SharedMemoryImageHeader::ULongLongComponent; break;
+    case LONGLONG: header.ComponentType = SharedMemoryImageHeader::LongLongComponent; break;
+    case FLOAT: header.ComponentType = SharedMemoryImageHeader::FloatComponent; break;
+    case DOUBLE: header.ComponentType = SharedMemoryImageHeader::DoubleComponent; break;
+    default:
+      itkExceptionMacro("Component type " << this->GetComponentTypeAsString(this->GetComponentType())
+                        << " cannot be written to shared memory");
+    }
+  header.NumberOfComponents = this->GetNumberOfComponents();
+  header.Dimension = dimension;
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    header.Size[i] = 1;
+    header.Spacing[i] = 1.0;
+    header.Direction[i * 3 + i] = 1.0;
+    }
+  for (unsigned int i = 0; i < dimension; ++i)
+    {
+    header.Size[i] = this->GetDimensions(i);
+    header.Spacing[i] = this->GetSpacing(i);
+    header.Origin[i] = this->GetOrigin(i);
+    for (unsigned int j = 0; j < dimension; ++j)
+      {
+      header.Direction[j * 3 + i] = this->GetDirection(i)[j];
+      }
+    }
+
+  SharedMemoryImageSegment segment;
+  if (!segment.Create(this->GetFileName(), header))
+    {
+    itkExceptionMacro("Cannot create shared memory image " << this->GetFileName());
+    }
+  memcpy(segment.GetData(), buffer, segment.GetHeader()->DataSize);
+}
+
+} // end namespace itk
@@ -0,0 +1,84 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef itkSharedMemoryImageIO_h
+#define itkSharedMemoryImageIO_h
+
+#include "itkSharedMemoryIOExport.h"
+
+#include "itkImageIOBase.h"
+
+namespace itk
+{
+/** \class SharedMemoryImageIO
+ * \brief ImageIO object for reading and writing images from shared memory
+ *
+ * SharedMemoryImageIO lets a command line module executable read its
+ * input images from and write its output images to shared memory segments
+ * created by Slicer (see SharedMemoryImageSegment), using a standard ITK
+ * ImageFileReader or ImageFileWriter. This saves writing and parsing
+ * temporary files while the module still runs in its own process.
+ * The voxels are still copied once between the segment and the buffer of
+ * the image by Read() and Write().
+ *
+ * Unlike MRMLIDImageIO, it depends on ITK only, therefore it can be
+ * loaded in the executable (from the ITK_AUTOLOAD_PATH set by Slicer)
+ * without loading VTK or MRML.
+ *
+ * The "filename" looks like:
+ *     <code>slicershm:/\<segment name\></code>
+ */
+class SharedMemoryIO_EXPORT SharedMemoryImageIO : public ImageIOBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef SharedMemoryImageIO  Self;
+  typedef ImageIOBase          Superclass;
+  typedef SmartPointer<Self>   Pointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SharedMemoryImageIO, ImageIOBase);
+
+  /** Determine the file type. Returns true if this ImageIO can read the
+   * file specified. */
+  virtual bool CanReadFile(const char*) ITK_OVERRIDE;
+
+  /** Set the spacing and dimension information for the set filename. */
+  virtual void ReadImageInformation() ITK_OVERRIDE;
+
+  /** Copies the data from shared memory into the memory buffer provided. */
+  virtual void Read(void* buffer) ITK_OVERRIDE;
+
+  /** Determine the file type. Returns true if this ImageIO can write the
+   * file specified. */
+  virtual bool CanWriteFile(const char*) ITK_OVERRIDE;
+
+  /** Image information is written with the data, in Write(). */
+  virtual void WriteImageInformation() ITK_OVERRIDE {}
+
+  /** Copies the data from the memory buffer provided to a new shared
+   * memory segment. */
+  virtual void Write(const void* buffer) ITK_OVERRIDE;
+
+protected:
+  SharedMemoryImageIO();
+  ~SharedMemoryImageIO();
+  void PrintSelf(std::ostream& os, Indent indent) const ITK_OVERRIDE;
+
+private:
+  SharedMemoryImageIO(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+};
+
+} // end namespace itk
+
+#endif
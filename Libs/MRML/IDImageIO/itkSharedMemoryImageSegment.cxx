@@ -0,0 +1,210 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#include "itkSharedMemoryImageSegment.h"
+
+// STD includes
+#include <cstring>
+
+// POSIX includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+const char SharedMemoryImageMagic[8] = { 'S', 'L', 'C', 'R', 'S', 'H', 'M', '1' };
+}
+
+namespace itk
+{
+
+//----------------------------------------------------------------------------
+SharedMemoryImageSegment::SharedMemoryImageSegment()
+{
+  this->Memory = 0;
+  this->MemorySize = 0;
+}
+
+//----------------------------------------------------------------------------
+SharedMemoryImageSegment::~SharedMemoryImageSegment()
+{
+  this->Close();
+}
+
+//----------------------------------------------------------------------------
+bool SharedMemoryImageSegment::IsSharedMemoryFileName(const std::string& fileName)
+{
+  std::string prefix = SharedMemoryImageSegment::GetFileNamePrefix();
+  return fileName.size() > prefix.size() && fileName.compare(0, prefix.size(), prefix) == 0;
+}
+
+//----------------------------------------------------------------------------
+std::string SharedMemoryImageSegment::GetSegmentName(const std::string& fileName)
+{
+  std::string segmentName = fileName.substr(std::string(SharedMemoryImageSegment::GetFileNamePrefix()).size());
+  if (segmentName.empty() || segmentName[0] != '/')
+    {
+    segmentName = "/" + segmentName;
+    }
+  return segmentName;
+}
+
+//----------------------------------------------------------------------------
+size_t SharedMemoryImageSegment::GetComponentSize(unsigned int componentType)
+{
+  switch (componentType)
+    {
+    case SharedMemoryImageHeader::UCharComponent: return sizeof(unsigned char);
+    case SharedMemoryImageHeader::CharComponent: return sizeof(char);
+    case SharedMemoryImageHeader::UShortComponent: return sizeof(unsigned short);
+    case SharedMemoryImageHeader::ShortComponent: return sizeof(short);
+    case SharedMemoryImageHeader::UIntComponent: return sizeof(unsigned int);
+    case SharedMemoryImageHeader::IntComponent: return sizeof(int);
+    case SharedMemoryImageHeader::ULongLongComponent: return sizeof(unsigned long long);
+    case SharedMemoryImageHeader::LongLongComponent: return sizeof(long long);
+    case SharedMemoryImageHeader::FloatComponent: return sizeof(float);
+    case SharedMemoryImageHeader::DoubleComponent: return sizeof(double);
+    default: return 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool SharedMemoryImageSegment::Create(const std::string& fileName, const SharedMemoryImageHeader& header)
+{
+  this->Close();
+  if (!SharedMemoryImageSegment::IsSharedMemoryFileName(fileName))
+    {
+    return false;
+    }
+  size_t componentSize = SharedMemoryImageSegment::GetComponentSize(header.ComponentType);
+  if (componentSize == 0 || header.Dimension < 1 || header.Dimension > 3)
+    {
+    return false;
+    }
+  unsigned long long dataSize = componentSize * header.NumberOfComponents;
+  for (unsigned int i = 0; i < header.Dimension; ++i)
+    {
+    dataSize *= header.Size[i];
+    }
+  // keep the voxels aligned for any component type
+  unsigned long long dataOffset = ((sizeof(SharedMemoryImageHeader) + 63) / 64) * 64;
+
+  std::string segmentName = SharedMemoryImageSegment::GetSegmentName(fileName);
+  shm_unlink(segmentName.c_str());
+  int fd = shm_open(segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+  if (fd < 0)
+    {
+    return false;
+    }
+  size_t memorySize = static_cast<size_t>(dataOffset + dataSize);
+  if (ftruncate(fd, static_cast<off_t>(memorySize)) != 0)
+    {
+    close(fd);
+    shm_unlink(segmentName.c_str());
+    return false;
+    }
+  void* memory = mmap(0, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED)
+    {
+    shm_unlink(segmentName.c_str());
+    return false;
+    }
+  this->Memory = memory;
+  this->MemorySize = memorySize;
+
+  SharedMemoryImageHeader* segmentHeader = static_cast<SharedMemoryImageHeader*>(this->Memory);
+  *segmentHeader = header;
+  memcpy(segmentHeader->Magic, SharedMemoryImageMagic, sizeof(SharedMemoryImageMagic));
+  segmentHeader->DataOffset = dataOffset;
+  segmentHeader->DataSize = dataSize;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool SharedMemoryImageSegment::Open(const std::string& fileName)
+{
+  this->Close();
+  if (!SharedMemoryImageSegment::IsSharedMemoryFileName(fileName))
+    {
+    return false;
+    }
+  std::string segmentName = SharedMemoryImageSegment::GetSegmentName(fileName);
+  int fd = shm_open(segmentName.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    {
+    return false;
+    }
+  struct stat segmentStat;
+  if (fstat(fd, &segmentStat) != 0
+    || static_cast<size_t>(segmentStat.st_size) < sizeof(SharedMemoryImageHeader))
+    {
+    close(fd);
+    return false;
+    }
+  size_t memorySize = static_cast<size_t>(segmentStat.st_size);
+  void* memory = mmap(0, memorySize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED)
+    {
+    return false;
+    }
+  this->Memory = memory;
+  this->MemorySize = memorySize;
+
+  const SharedMemoryImageHeader* header = this->GetHeader();
+  if (memcmp(header->Magic, SharedMemoryImageMagic, sizeof(SharedMemoryImageMagic)) != 0
+    || header->DataOffset + header->DataSize > memorySize)
+    {
+    this->Close();
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void SharedMemoryImageSegment::Close()
+{
+  if (this->Memory)
+    {
+    munmap(this->Memory, this->MemorySize);
+    }
+  this->Memory = 0;
+  this->MemorySize = 0;
+}
+
+//----------------------------------------------------------------------------
+bool SharedMemoryImageSegment::Remove(const std::string& fileName)
+{
+  if (!SharedMemoryImageSegment::IsSharedMemoryFileName(fileName))
+    {
+    return false;
+    }
+  return shm_unlink(SharedMemoryImageSegment::GetSegmentName(fileName).c_str()) == 0;
+}
+
+//----------------------------------------------------------------------------
+const SharedMemoryImageHeader* SharedMemoryImageSegment::GetHeader() const
+{
+  return static_cast<const SharedMemoryImageHeader*>(this->Memory);
+}
+
+//----------------------------------------------------------------------------
+void* SharedMemoryImageSegment::GetData() const
+{
+  if (!this->Memory)
+    {
+    return 0;
+    }
+  return static_cast<char*>(this->Memory) + this->GetHeader()->DataOffset;
+}
+
+} // end namespace itk
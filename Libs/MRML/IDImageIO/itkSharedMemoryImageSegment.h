@@ -0,0 +1,124 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef itkSharedMemoryImageSegment_h
+#define itkSharedMemoryImageSegment_h
+
+#include "itkSharedMemoryIOExport.h"
+
+// STD includes
+#include <cstddef>
+#include <string>
+
+namespace itk
+{
+
+/** \struct SharedMemoryImageHeader
+ * \brief Layout of the header at the beginning of a shared memory image segment.
+ *
+ * Geometry is stored in LPS, as in ITK. Direction is stored row by row,
+ * column i being the direction of the i-th image axis.
+ */
+struct SharedMemoryImageHeader
+{
+  enum ComponentTypes
+    {
+    UnknownComponent = 0,
+    UCharComponent,
+    CharComponent,
+    UShortComponent,
+    ShortComponent,
+    UIntComponent,
+    IntComponent,
+    ULongLongComponent,
+    LongLongComponent,
+    FloatComponent,
+    DoubleComponent
+    };
+
+  char Magic[8];
+  unsigned int ComponentType;
+  unsigned int NumberOfComponents;
+  unsigned int Dimension;
+  unsigned int Reserved;
+  unsigned long long Size[3];
+  double Origin[3];
+  double Spacing[3];
+  double Direction[9];
+  /** Offset of the voxel buffer from the beginning of the segment */
+  unsigned long long DataOffset;
+  /** Size of the voxel buffer in bytes */
+  unsigned long long DataSize;
+};
+
+/** \class SharedMemoryImageSegment
+ * \brief Image stored in a named POSIX shared memory segment.
+ *
+ * Images are passed between Slicer and command line module executables
+ * in shared memory segments instead of temporary files. The "filename"
+ * of such an image looks like:
+ *     <code>slicershm:/\<segment name\></code>
+ *
+ * The segment starts with a SharedMemoryImageHeader, followed by the
+ * voxels. The class does not depend on ITK or VTK so that it can be used
+ * on both sides of the exchange.
+ *
+ * This is a copy-once transport: the segment replaces the temporary file,
+ * it is never used as the voxel buffer of an image. The voxels are copied
+ * into the segment by the writer and out of it by the reader, which saves
+ * the file writing and parsing but not the copies.
+ *
+ * Segments outlive the process that created them: they are removed by
+ * calling Remove(), which is the responsibility of Slicer for both input
+ * and output images.
+ */
+class SharedMemoryIO_EXPORT SharedMemoryImageSegment
+{
+public:
+  SharedMemoryImageSegment();
+  /** Unmap the segment. The segment itself is not removed. */
+  ~SharedMemoryImageSegment();
+
+  static const char* GetFileNamePrefix() { return "slicershm:"; }
+  static bool IsSharedMemoryFileName(const std::string& fileName);
+
+  /** Return the size in bytes of a component of the given type */
+  static size_t GetComponentSize(unsigned int componentType);
+
+  /** Create a segment for an image described by \a header, replacing any
+   * existing segment of the same name, and map it for writing.
+   * DataOffset and DataSize of the header are computed. */
+  bool Create(const std::string& fileName, const SharedMemoryImageHeader& header);
+
+  /** Map an existing segment for reading. Fails if the segment does not
+   * contain a valid image header. */
+  bool Open(const std::string& fileName);
+
+  /** Unmap the segment */
+  void Close();
+
+  /** Remove the segment. Memory already mapped remains valid until unmapped. */
+  static bool Remove(const std::string& fileName);
+
+  const SharedMemoryImageHeader* GetHeader() const;
+  void* GetData() const;
+
+private:
+  SharedMemoryImageSegment(const SharedMemoryImageSegment&); //purposely not implemented
+  void operator=(const SharedMemoryImageSegment&); //purposely not implemented
+
+  static std::string GetSegmentName(const std::string& fileName);
+
+  void* Memory;
+  size_t MemorySize;
+};
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,82 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLLogic includes
+#include "vtkImageLabelInterpolator.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkImageReslice.h>
+#include <vtkNew.h>
+
+//---------------------------------------------------------------------------
+int vtkImageLabelInterpolatorTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkImageLabelInterpolator> interpolator;
+  EXERCISE_BASIC_OBJECT_METHODS(interpolator.GetPointer());
+  CHECK_BOOL(interpolator->IsSeparable(), false);
+
+  // 2x2 labelmap:
+  //   y=1: 2 3
+  //   y=0: 1 2
+  vtkNew<vtkImageData> labelmap;
+  labelmap->SetDimensions(2, 2, 1);
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* labels = static_cast<unsigned char*>(labelmap->GetScalarPointer());
+  labels[0] = 1;
+  labels[1] = 2;
+  labels[2] = 2;
+  labels[3] = 3;
+
+  interpolator->Initialize(labelmap.GetPointer());
+  interpolator->Update();
+
+  // Voxel centers keep their label
+  CHECK_DOUBLE(interpolator->Interpolate(0.0, 0.0, 0.0, 0), 1.0);
+  CHECK_DOUBLE(interpolator->Interpolate(1.0, 1.0, 0.0, 0), 3.0);
+  // The closest voxel wins between two labels
+  CHECK_DOUBLE(interpolator->Interpolate(0.4, 0.0, 0.0, 0), 1.0);
+  CHECK_DOUBLE(interpolator->Interpolate(0.6, 0.0, 0.0, 0), 2.0);
+  // The label with the largest sum of weights wins, even if it is not the
+  // label of the closest voxel
+  CHECK_DOUBLE(interpolator->Interpolate(0.4, 0.4, 0.0, 0), 2.0);
+  CHECK_DOUBLE(interpolator->Interpolate(0.1, 0.1, 0.0, 0), 1.0);
+  CHECK_DOUBLE(interpolator->Interpolate(0.9, 0.9, 0.0, 0), 3.0);
+
+  // Magnify the labelmap: only existing labels are generated
+  vtkNew<vtkImageReslice> reslice;
+  reslice->SetInputData(labelmap.GetPointer());
+  reslice->SetInterpolator(interpolator.GetPointer());
+  reslice->SetInterpolationModeToLinear();
+  reslice->SetOutputSpacing(0.1, 0.1, 1.0);
+  reslice->SetOutputExtent(0, 10, 0, 10, 0, 0);
+  reslice->Update();
+  vtkImageData* output = reslice->GetOutput();
+  CHECK_INT(output->GetScalarType(), VTK_UNSIGNED_CHAR);
+  unsigned char* outputLabels = static_cast<unsigned char*>(output->GetScalarPointer());
+  for (vtkIdType i = 0; i < output->GetNumberOfPoints(); ++i)
+    {
+    CHECK_BOOL(outputLabels[i] >= 1 && outputLabels[i] <= 3, true);
+    }
+  CHECK_INT(*static_cast<unsigned char*>(output->GetScalarPointer(0, 0, 0)), 1);
+  CHECK_INT(*static_cast<unsigned char*>(output->GetScalarPointer(10, 0, 0)), 2);
+  CHECK_INT(*static_cast<unsigned char*>(output->GetScalarPointer(4, 4, 0)), 2);
+  CHECK_INT(*static_cast<unsigned char*>(output->GetScalarPointer(10, 10, 0)), 3);
+
+  return EXIT_SUCCESS;
+}
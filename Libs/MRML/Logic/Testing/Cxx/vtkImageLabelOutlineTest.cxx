@@ -0,0 +1,140 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLLogic includes
+#include "vtkImageLabelOutline.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+namespace
+{
+
+const int SLICE_SIZE = 1024;
+const int NUMBER_OF_RENDERS = 20;
+
+//---------------------------------------------------------------------------
+// Slice of a labelmap: a grid of discs with different labels, some of them
+// touching each other and the image border.
+vtkSmartPointer<vtkImageData> CreateLabelSlice()
+{
+  vtkSmartPointer<vtkImageData> imageData = vtkSmartPointer<vtkImageData>::New();
+  imageData->SetDimensions(SLICE_SIZE, SLICE_SIZE, 1);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  short* pixels = static_cast<short*>(imageData->GetScalarPointer());
+  const int cellSize = 64;
+  for (int y = 0; y < SLICE_SIZE; ++y)
+    {
+    for (int x = 0; x < SLICE_SIZE; ++x, ++pixels)
+      {
+      int dx = x % cellSize - cellSize / 2;
+      int dy = y % cellSize - cellSize / 2;
+      int label = 1 + (x / cellSize + 3 * (y / cellSize)) % 7;
+      int radius = (label % 2) ? cellSize / 2 : cellSize / 3;
+      *pixels = (dx * dx + dy * dy <= radius * radius) ? label : 0;
+      }
+    }
+  return imageData;
+}
+
+//---------------------------------------------------------------------------
+// Straightforward implementation: compare each non-background pixel with
+// every pixel of its neighborhood.
+void ComputeReferenceOutline(vtkImageData* input, int outline, vtkImageData* output)
+{
+  output->SetDimensions(input->GetDimensions());
+  output->AllocateScalars(VTK_SHORT, 1);
+  int* dims = input->GetDimensions();
+  for (int y = 0; y < dims[1]; ++y)
+    {
+    for (int x = 0; x < dims[0]; ++x)
+      {
+      short label = *static_cast<short*>(input->GetScalarPointer(x, y, 0));
+      short outputLabel = 0;
+      for (int j = -outline; label != 0 && j <= outline; ++j)
+        {
+        for (int i = -outline; i <= outline; ++i)
+          {
+          if (x + i < 0 || x + i >= dims[0] || y + j < 0 || y + j >= dims[1] ||
+              *static_cast<short*>(input->GetScalarPointer(x + i, y + j, 0)) != label)
+            {
+            outputLabel = label;
+            }
+          }
+        }
+      *static_cast<short*>(output->GetScalarPointer(x, y, 0)) = outputLabel;
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+int TestOutline(vtkImageData* input, int outline)
+{
+  vtkNew<vtkTimerLog> timer;
+
+  vtkNew<vtkImageData> expected;
+  timer->StartTimer();
+  ComputeReferenceOutline(input, outline, expected.GetPointer());
+  timer->StopTimer();
+  std::cout << "<DartMeasurement name=\"vtkImageLabelOutline-ReferencePerformance-Outline"
+            << outline << "\" type=\"numeric/double\">"
+            << timer->GetElapsedTime() << "</DartMeasurement>" << std::endl;
+
+  vtkNew<vtkImageLabelOutline> labelOutline;
+  labelOutline->SetOutline(outline);
+  labelOutline->SetInputData(input);
+  timer->StartTimer();
+  for (int i = 0; i < NUMBER_OF_RENDERS; ++i)
+    {
+    labelOutline->Modified();
+    labelOutline->Update();
+    }
+  timer->StopTimer();
+  std::cout << "<DartMeasurement name=\"vtkImageLabelOutline-Performance-Outline"
+            << outline << "\" type=\"numeric/double\">"
+            << timer->GetElapsedTime() / NUMBER_OF_RENDERS << "</DartMeasurement>" << std::endl;
+
+  vtkImageData* output = labelOutline->GetOutput();
+  CHECK_INT(output->GetScalarType(), VTK_SHORT);
+  short* outputPixels = static_cast<short*>(output->GetScalarPointer());
+  short* expectedPixels = static_cast<short*>(expected->GetScalarPointer());
+  for (vtkIdType i = 0; i < expected->GetNumberOfPoints(); ++i)
+    {
+    CHECK_INT(outputPixels[i], expectedPixels[i]);
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkImageLabelOutlineTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkImageLabelOutline> labelOutline;
+  EXERCISE_BASIC_OBJECT_METHODS(labelOutline.GetPointer());
+
+  vtkSmartPointer<vtkImageData> input = CreateLabelSlice();
+  for (int outline = 1; outline <= 3; ++outline)
+    {
+    CHECK_EXIT_SUCCESS(TestOutline(input, outline));
+    }
+  return EXIT_SUCCESS;
+}
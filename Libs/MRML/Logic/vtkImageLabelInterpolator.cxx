@@ -0,0 +1,168 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkImageLabelInterpolator.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+#include <vtkTemplateAliasMacro.h>
+
+// STD includes
+#include <cmath>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkImageLabelInterpolator);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Index of the voxel before the point (clamped to the extent) and
+// fractional distance of the point from it
+template <class F>
+void vtkLabelInterpolationCorners(F point, int minIdx, int maxIdx,
+                                  int& idx0, int& idx1, F& fraction)
+{
+  F floorPoint = std::floor(point);
+  idx0 = static_cast<int>(floorPoint);
+  fraction = point - floorPoint;
+  idx1 = idx0 + (fraction != 0);
+  idx0 = (idx0 < minIdx ? minIdx : (idx0 > maxIdx ? maxIdx : idx0));
+  idx1 = (idx1 < minIdx ? minIdx : (idx1 > maxIdx ? maxIdx : idx1));
+}
+
+//----------------------------------------------------------------------------
+template <class F, class T>
+void vtkLabelInterpolationFunc(vtkInterpolationInfo *info,
+                               const F point[3], F *outPtr)
+{
+  const T *inPtr = static_cast<const T *>(info->Pointer);
+  const int *inExt = info->Extent;
+  const vtkIdType *inInc = info->Increments;
+  int numscalars = info->NumberOfComponents;
+
+  int idX0, idX1, idY0, idY1, idZ0, idZ1;
+  F fx, fy, fz;
+  vtkLabelInterpolationCorners(point[0], inExt[0], inExt[1], idX0, idX1, fx);
+  vtkLabelInterpolationCorners(point[1], inExt[2], inExt[3], idY0, idY1, fy);
+  vtkLabelInterpolationCorners(point[2], inExt[4], inExt[5], idZ0, idZ1, fz);
+
+  // Offsets and trilinear weights of the 8 voxels around the point
+  vtkIdType factX[2] = { (idX0 - inExt[0]) * inInc[0], (idX1 - inExt[0]) * inInc[0] };
+  vtkIdType factY[2] = { (idY0 - inExt[2]) * inInc[1], (idY1 - inExt[2]) * inInc[1] };
+  vtkIdType factZ[2] = { (idZ0 - inExt[4]) * inInc[2], (idZ1 - inExt[4]) * inInc[2] };
+  F weightX[2] = { 1 - fx, fx };
+  F weightY[2] = { 1 - fy, fy };
+  F weightZ[2] = { 1 - fz, fz };
+
+  vtkIdType offsets[8];
+  F weights[8];
+  int corner = 0;
+  for (int k = 0; k < 2; ++k)
+    {
+    for (int j = 0; j < 2; ++j)
+      {
+      for (int i = 0; i < 2; ++i, ++corner)
+        {
+        offsets[corner] = factX[i] + factY[j] + factZ[k];
+        weights[corner] = weightX[i] * weightY[j] * weightZ[k];
+        }
+      }
+    }
+
+  for (int c = 0; c < numscalars; ++c, ++inPtr, ++outPtr)
+    {
+    T labels[8];
+    for (int i = 0; i < 8; ++i)
+      {
+      labels[i] = inPtr[offsets[i]];
+      }
+    // The label with the largest sum of weights wins. In case of a tie,
+    // the label of the voxel with the smallest index wins.
+    T bestLabel = labels[0];
+    F bestWeight = -1;
+    for (int i = 0; i < 8; ++i)
+      {
+      F labelWeight = 0;
+      for (int j = 0; j < 8; ++j)
+        {
+        labelWeight += (labels[j] == labels[i] ? weights[j] : 0);
+        }
+      if (labelWeight > bestWeight)
+        {
+        bestWeight = labelWeight;
+        bestLabel = labels[i];
+        }
+      }
+    *outPtr = static_cast<F>(bestLabel);
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class F>
+void vtkGetLabelInterpolationFunc(
+  void (**interpolate)(vtkInterpolationInfo *, const F [3], F *),
+  int dataType)
+{
+  switch (dataType)
+    {
+    vtkTemplateAliasMacro(
+      *interpolate = &(vtkLabelInterpolationFunc<F, VTK_TT>)
+      );
+    default:
+      *interpolate = 0;
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkImageLabelInterpolator::vtkImageLabelInterpolator()
+{
+  // The neighborhood of the interpolated points is the same as
+  // for linear interpolation (used to compute the support size).
+  this->InterpolationMode = VTK_LINEAR_INTERPOLATION;
+}
+
+//----------------------------------------------------------------------------
+vtkImageLabelInterpolator::~vtkImageLabelInterpolator()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelInterpolator::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageLabelInterpolator::IsSeparable()
+{
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelInterpolator::GetInterpolationFunc(
+  void (**func)(vtkInterpolationInfo *, const double [3], double *))
+{
+  vtkGetLabelInterpolationFunc(func, this->InterpolationInfo->ScalarType);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelInterpolator::GetInterpolationFunc(
+  void (**func)(vtkInterpolationInfo *, const float [3], float *))
+{
+  vtkGetLabelInterpolationFunc(func, this->InterpolationInfo->ScalarType);
+}
@@ -0,0 +1,59 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkImageLabelInterpolator_h
+#define __vtkImageLabelInterpolator_h
+
+#include <vtkImageInterpolator.h>
+
+#include "vtkMRMLLogicExport.h"
+
+/// \brief Interpolate labelmaps with smooth label boundaries.
+///
+/// Each interpolated point gets the label that has the largest sum of
+/// trilinear weights among the 8 voxels around the point. Label boundaries
+/// are therefore smooth when the labelmap is magnified (as opposed to
+/// nearest neighbor interpolation), while only existing label values are
+/// generated (as opposed to linear interpolation) and without the need for
+/// interpolating a fractional image per label.
+/// Components are interpolated independently.
+///
+/// To be used as the interpolator of vtkImageReslice.
+class VTK_MRML_LOGIC_EXPORT vtkImageLabelInterpolator : public vtkImageInterpolator
+{
+public:
+  static vtkImageLabelInterpolator *New();
+  vtkTypeMacro(vtkImageLabelInterpolator, vtkImageInterpolator);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /// The label of a point depends on all its neighbors, weights cannot
+  /// be precomputed per axis.
+  virtual bool IsSeparable() VTK_OVERRIDE;
+
+protected:
+  vtkImageLabelInterpolator();
+  ~vtkImageLabelInterpolator();
+
+  virtual void GetInterpolationFunc(
+    void (**doublefunc)(vtkInterpolationInfo *, const double [3], double *)) VTK_OVERRIDE;
+  virtual void GetInterpolationFunc(
+    void (**floatfunc)(vtkInterpolationInfo *, const float [3], float *)) VTK_OVERRIDE;
+
+private:
+  vtkImageLabelInterpolator(const vtkImageLabelInterpolator&);  // Not implemented.
+  void operator=(const vtkImageLabelInterpolator&);  // Not implemented.
+};
+
+#endif
@@ -20,6 +20,10 @@
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkVersion.h>
 
+// STD includes
+#include <algorithm>
+#include <vector>
+
 //------------------------------------------------------------------------------
 vtkStandardNewMacro(vtkImageLabelOutline);
 
@@ -45,81 +49,79 @@ vtkImageLabelOutline::~vtkImageLabelOutline()
 
 // Description:
 // This templated function executes the filter for any type of data.
+// A non-background pixel is an outline pixel if a pixel of its
+// (2*outline+1) x (2*outline+1) in-slice neighborhood has a different value
+// or if the neighborhood reaches outside of the input image.
+// The neighborhood is split into rows: a pixel is horizontally uniform if
+// its row neighbors have the same value, a pixel is then inside the label
+// if the pixels of its column neighborhood have the same value and are
+// horizontally uniform. Inner loops only compare contiguous rows of pixels
+// so that the compiler can vectorize them.
 template <class T>
 static void vtkImageLabelOutlineExecute(vtkImageLabelOutline *self,
-                     vtkImageData *inData, T *inPtr,
+                     vtkImageData *inData, T *vtkNotUsed(inPtr),
                      vtkImageData *outData,
                      int outExt[6], int id)
 {
-  int *kernelMiddle, *kernelSize;
-  // For looping though output (and input) pixels.
-  int outMin0, outMax0, outMin1, outMax1, outMin2, outMax2;
-  int outIdx0, outIdx1, outIdx2;
-  vtkIdType inInc0, inInc1, inInc2;
-  vtkIdType outInc0, outInc1, outInc2;
-  T *inPtr0, *inPtr1, *inPtr2;
-  T *outPtr0, *outPtr1, *outPtr2;
-  // For looping through hood pixels
-  int hoodMin0, hoodMax0, hoodMin1, hoodMax1, hoodMin2, hoodMax2;
-  int hoodIdx0, hoodIdx1, hoodIdx2;
-  T *hoodPtr0, *hoodPtr1, *hoodPtr2;
-  // The extent of the whole input image
-  int inImageMin0, inImageMin1, inImageMin2;
-  int inImageMax0, inImageMax1, inImageMax2;
-  // Other
-  T backgroundLabelValue = (T)(self->GetBackground());
-  T inLabelValue;
-  T *outPtr = (T*)outData->GetScalarPointerForExtent(outExt);
-  unsigned long count = 0;
-  unsigned long target;
-
-  // Get information to march through data
+  const T backgroundLabelValue = static_cast<T>(self->GetBackground());
+  const int outline = self->GetOutline();
 
-  inData->GetIncrements(inInc0, inInc1, inInc2);
-  int inExt[6];
+  // Pixels out of the whole input extent (or not provided in the input
+  // data) are considered to be different from any label.
+  int wholeExt[6];
   self->GetInputInformation()->Get(
-        vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), inExt);
-  inImageMin0 = inExt[0]; inImageMax0 = inExt[1];
-  inImageMin1 = inExt[2]; inImageMax1 = inExt[3];
-  inImageMin2 = inExt[4]; inImageMax2 = inExt[5];
-  outData->GetIncrements(outInc0, outInc1, outInc2);
-  outMin0 = outExt[0];   outMax0 = outExt[1];
-  outMin1 = outExt[2];   outMax1 = outExt[3];
-  outMin2 = outExt[4];   outMax2 = outExt[5];
-
-  // Neighborhood around current voxel
-  kernelSize = self->GetKernelSize();
-  kernelMiddle = self->GetKernelMiddle();
-  hoodMin0 = kernelMiddle[0] - kernelSize[0]/2; // truncate on purpose
-  hoodMin1 = kernelMiddle[1] - kernelSize[1]/2; // to round down odd sizes
-  hoodMin2 = kernelMiddle[2] - kernelSize[2]/2;
-  hoodMax0 = hoodMin0 + kernelSize[0];
-  hoodMax1 = hoodMin1 + kernelSize[1];
-  hoodMax2 = hoodMin2 + kernelSize[2];
-
-  int outline = self->GetOutline();
-  hoodMin0 = - outline;
-  hoodMin1 = - outline;
-  hoodMin2 = 0;
-  hoodMax0 = outline;
-  hoodMax1 = outline;
-  hoodMax2 = 0;
-
-  // in and out should be marching through corresponding pixels.
-  inPtr = (T *)(inData->GetScalarPointer(outMin0, outMin1, outMin2));
-
-  target = (unsigned long)((outMax2-outMin2+1)*(outMax1-outMin1+1)/50.0);
+        vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
+  int inExt[6];
+  inData->GetExtent(inExt);
+  const int inMin0 = std::max(wholeExt[0], inExt[0]);
+  const int inMax0 = std::min(wholeExt[1], inExt[1]);
+  const int inMin1 = std::max(wholeExt[2], inExt[2]);
+  const int inMax1 = std::min(wholeExt[3], inExt[3]);
+
+  // Input is single component, pixels of a row are contiguous
+  const vtkIdType inInc1 = inData->GetIncrements()[1];
+
+  const int rowLength = outExt[1] - outExt[0] + 1;
+  // Rows of the column neighborhood of the output rows
+  const int rowMin = std::max(outExt[2] - outline, inMin1);
+  const int rowMax = std::min(outExt[3] + outline, inMax1);
+  // Horizontal uniformity of the pixels of the rows [rowMin, rowMax]
+  std::vector<unsigned char> uniform(
+    static_cast<size_t>(rowLength) * std::max(rowMax - rowMin + 1, 0));
+  // Pixels of the current output row that are inside their label
+  std::vector<unsigned char> inside(rowLength);
+
+  unsigned long count = 0;
+  unsigned long target = static_cast<unsigned long>(
+    (outExt[5]-outExt[4]+1)*(outExt[3]-outExt[2]+1)/50.0);
   target++;
 
-  // loop through pixels of output
-  outPtr2 = outPtr;
-  inPtr2 = inPtr;
-  for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
+  for (int idx2 = outExt[4]; idx2 <= outExt[5]; ++idx2)
     {
-    outPtr1 = outPtr2;
-    inPtr1 = inPtr2;
-    for (outIdx1 = outMin1;
-      !self->AbortExecute && outIdx1 <= outMax1; outIdx1++)
+    // Horizontal uniformity
+    for (int row = rowMin; row <= rowMax; ++row)
+      {
+      unsigned char* uniformRow = &uniform[0] + static_cast<size_t>(row - rowMin) * rowLength;
+      const T* inRow = static_cast<T*>(inData->GetScalarPointer(outExt[0], row, idx2));
+      for (int x = 0; x < rowLength; ++x)
+        {
+        uniformRow[x] = (outExt[0] + x - outline >= inMin0 && outExt[0] + x + outline <= inMax0);
+        }
+      for (int offset = 1; offset <= outline; ++offset)
+        {
+        // Only compare the pixels whose neighbors are in the input,
+        // the others are not uniform anyway
+        const int first = std::max(0, inMin0 + offset - outExt[0]);
+        const int last = std::min(rowLength - 1, inMax0 - offset - outExt[0]);
+        for (int x = first; x <= last; ++x)
+          {
+          uniformRow[x] &= static_cast<unsigned char>(
+            (inRow[x - offset] == inRow[x]) & (inRow[x + offset] == inRow[x]));
+          }
+        }
+      }
+
+    for (int idx1 = outExt[2]; !self->AbortExecute && idx1 <= outExt[3]; ++idx1)
       {
       if (!id)
         {
@@ -129,74 +131,29 @@ static void vtkImageLabelOutlineExecute(vtkImageLabelOutline *self,
           }
         count++;
         }
-      outPtr0 = outPtr1;
-      inPtr0 = inPtr1;
-      for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
+      const T* inRow = static_cast<T*>(inData->GetScalarPointer(outExt[0], idx1, idx2));
+      T* outRow = static_cast<T*>(outData->GetScalarPointer(outExt[0], idx1, idx2));
+
+      // Vertical uniformity
+      bool columnInInput = (idx1 - outline >= inMin1 && idx1 + outline <= inMax1);
+      std::fill(inside.begin(), inside.end(), columnInInput ? 1 : 0);
+      for (int offset = -outline; columnInInput && offset <= outline; ++offset)
         {
-        inLabelValue = *inPtr0;
-        // Default output equal to backgroundLabelValue
-        // on the assumption this is not an outline pixel
-        *outPtr0 = backgroundLabelValue;
-
-        // look at neighborhood around non-background
-        // pixels to see if there is a transition.
-        // If there is, then this is an outline pixel
-        if (inLabelValue != backgroundLabelValue)
+        const T* neighborRow = inRow + offset * inInc1;
+        const unsigned char* uniformRow = &uniform[0] + static_cast<size_t>(idx1 + offset - rowMin) * rowLength;
+        for (int x = 0; x < rowLength; ++x)
           {
-          // Loop through neighborhood pixels
-          // Note: hood pointer marches out of bounds.
-          // start at lower left pixel
-          hoodPtr2 = inPtr0 + hoodMin0 * inInc0
-                            + hoodMin1 * inInc1
-                            + hoodMin2 * inInc2;
-
-          for (hoodIdx2 = hoodMin2; hoodIdx2 <= hoodMax2; ++hoodIdx2)
-            {
-            hoodPtr1 = hoodPtr2;
-            for (hoodIdx1 = hoodMin1; hoodIdx1 <= hoodMax1; ++hoodIdx1)
-              {
-              hoodPtr0 = hoodPtr1;
-              for (hoodIdx0 = hoodMin0; hoodIdx0 <= hoodMax0; ++hoodIdx0)
-                {
-                // handle boundaries
-                if (outIdx0 + hoodIdx0 >= inImageMin0 &&
-                    outIdx0 + hoodIdx0 <= inImageMax0 &&
-                    outIdx1 + hoodIdx1 >= inImageMin1 &&
-                    outIdx1 + hoodIdx1 <= inImageMax1 &&
-                    outIdx2 + hoodIdx2 >= inImageMin2 &&
-                    outIdx2 + hoodIdx2 <= inImageMax2)
-                  {
-                  // If the neighbor value is not the same label value
-                  // that means this is an outline pixel
-                  // (border is within neighborhood).
-                  // so set the output to foreground
-                  if (*hoodPtr0 != inLabelValue)
-                    {
-                    *outPtr0 = inLabelValue;
-                    }
-                  }
-                else
-                  {
-                  // neighborhood reaches outside of the input
-                  // domain, so this is also an outline pixel
-                  *outPtr0 = inLabelValue;
-                  }
-                hoodPtr0 += inInc0;
-                }//for0
-              hoodPtr1 += inInc1;
-              }//for1
-            hoodPtr2 += inInc2;
-            }//for2
-          }//if
-        inPtr0 += inInc0;
-        outPtr0 += outInc0;
-        }//for0
-      inPtr1 += inInc1;
-      outPtr1 += outInc1;
-      }//for1
-    inPtr2 += inInc2;
-    outPtr2 += outInc2;
-    }//for2
+          inside[x] &= static_cast<unsigned char>((neighborRow[x] == inRow[x]) & uniformRow[x]);
+          }
+        }
+
+      // Non-background pixels that are not inside their label are outline pixels
+      for (int x = 0; x < rowLength; ++x)
+        {
+        outRow[x] = (inside[x] || inRow[x] == backgroundLabelValue) ? backgroundLabelValue : inRow[x];
+        }
+      }
+    }
 }
 
 //----------------------------------------------------------------------------
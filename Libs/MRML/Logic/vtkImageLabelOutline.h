@@ -25,6 +25,11 @@ class vtkImageData;
 ///
 /// Used  in slicer for the Label layer to outline the segmented
 /// structures (instead of showing them filled-in).
+/// Each slice of the input is processed independently: a non-background
+/// pixel is kept if a pixel within Outline pixels (in the slice) has a
+/// different value or is outside of the image.
+/// Threads process ranges of rows of the output extent, as split by
+/// vtkThreadedImageAlgorithm.
 class VTK_MRML_LOGIC_EXPORT vtkImageLabelOutline : public vtkImageNeighborhoodFilter
 {
 public:
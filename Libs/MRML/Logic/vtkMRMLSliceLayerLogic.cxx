@@ -45,6 +45,7 @@
 #include <vtkAddonMathUtilities.h>
 
 //
+#include "vtkImageLabelInterpolator.h"
 #include "vtkImageLabelOutline.h"
 
 // STD includes
@@ -125,6 +126,8 @@ vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
   this->ResliceUVW = vtkImageReslice::New();
   this->LabelOutline = vtkImageLabelOutline::New();
   this->LabelOutlineUVW = vtkImageLabelOutline::New();
+  this->LabelInterpolator = vtkImageLabelInterpolator::New();
+  this->LabelInterpolatorUVW = vtkImageLabelInterpolator::New();
 
   //
   // Set parameters that won't change based on input
@@ -180,6 +183,9 @@ vtkMRMLSliceLayerLogic::~vtkMRMLSliceLayerLogic()
   this->LabelOutline->Delete();
   this->LabelOutlineUVW->Delete();
 
+  this->LabelInterpolator->Delete();
+  this->LabelInterpolatorUVW->Delete();
+
   this->AssignAttributeTensorsToScalars->Delete();
   this->AssignAttributeScalarsToTensors->Delete();
   this->AssignAttributeScalarsToTensorsUVW->Delete();
@@ -652,14 +658,38 @@ void vtkMRMLSliceLayerLogic::UpdateImageDisplay()
   vtkMTimeType oldLabel = this->LabelOutline->GetMTime();
   vtkMTimeType oldLabelUVW = this->LabelOutlineUVW->GetMTime();
 
-  if ( (this->VolumeNode->GetImageData() && labelMapVolumeDisplayNode) ||
-       (scalarVolumeDisplayNode && scalarVolumeDisplayNode->GetInterpolate() == 0))
+  bool useLabelInterpolation = this->VolumeNode->GetImageData() && labelMapVolumeDisplayNode &&
+    this->SliceNode && this->SliceNode->GetUseLabelInterpolation();
+  if (useLabelInterpolation)
+    {
+    // Smooth label boundaries: the dominant label of the trilinear
+    // neighborhood is used, in a single pass
+    this->Reslice->SetInterpolator(this->LabelInterpolator);
+    this->ResliceUVW->SetInterpolator(this->LabelInterpolatorUVW);
+    }
+  else
+    {
+    // Revert to the default interpolator of vtkImageReslice
+    if (this->Reslice->GetInterpolator() == this->LabelInterpolator)
+      {
+      this->Reslice->SetInterpolator(0);
+      }
+    if (this->ResliceUVW->GetInterpolator() == this->LabelInterpolatorUVW)
+      {
+      this->ResliceUVW->SetInterpolator(0);
+      }
+    }
+
+  if ( !useLabelInterpolation &&
+       ((this->VolumeNode->GetImageData() && labelMapVolumeDisplayNode) ||
+        (scalarVolumeDisplayNode && scalarVolumeDisplayNode->GetInterpolate() == 0)))
     {
     this->Reslice->SetInterpolationModeToNearestNeighbor();
     this->ResliceUVW->SetInterpolationModeToNearestNeighbor();
     }
   else
     {
+    // Label interpolation requires the same input neighborhood as linear interpolation
     this->Reslice->SetInterpolationModeToLinear();
     this->ResliceUVW->SetInterpolationModeToLinear();
     }
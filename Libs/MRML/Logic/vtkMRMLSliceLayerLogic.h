@@ -54,6 +54,7 @@ class vtkGeneralTransform;
 // STL includes
 //#include <cstdlib>
 
+class vtkImageLabelInterpolator;
 class vtkImageLabelOutline;
 class vtkTransform;
 
@@ -170,6 +171,8 @@ protected:
   vtkImageReslice *ResliceUVW;
   vtkImageLabelOutline *LabelOutline;
   vtkImageLabelOutline *LabelOutlineUVW;
+  vtkImageLabelInterpolator *LabelInterpolator;
+  vtkImageLabelInterpolator *LabelInterpolatorUVW;
 
   vtkAssignAttribute* AssignAttributeTensorsToScalars;
   vtkAssignAttribute* AssignAttributeScalarsToTensors;
@@ -466,6 +466,13 @@ void vtkMRMLSliceLinkLogic::BroadcastSliceNodeEvent(vtkMRMLSliceNode *sliceNode)
         sNode->SetUseLabelOutline( sliceNode->GetUseLabelOutline() );
         }
 
+      // Setting the label interpolation mode
+      if (sliceNode->GetInteractionFlags() & sliceNode->GetInteractionFlagsModifier()
+        & vtkMRMLSliceNode::LabelInterpolationFlag)
+        {
+        sNode->SetUseLabelInterpolation( sliceNode->GetUseLabelInterpolation() );
+        }
+
       // Broadcasting the visibility of slice in 3D
       if (sliceNode->GetInteractionFlags() & sliceNode->GetInteractionFlagsModifier()
         & vtkMRMLSliceNode::SliceVisibleFlag)
@@ -19,6 +19,7 @@
 ==============================================================================*/
 
 // Qt includes
+#include <QAction>
 #include <QApplication>
 #include <QTimer>
 
@@ -71,6 +72,8 @@ private slots:
   void testSetLabelVolumeWithNoLinkedControl();
 
   void testUpdateSliceOrientationSelector();
+
+  void testLabelInterpolation();
 };
 
 // ----------------------------------------------------------------------------
@@ -351,6 +354,32 @@ void qMRMLSliceControllerWidgetTester::testUpdateSliceOrientationSelector()
 
 }
 
+// ----------------------------------------------------------------------------
+void qMRMLSliceControllerWidgetTester::testLabelInterpolation()
+{
+  qMRMLSliceControllerWidget sliceControllerWidget;
+  sliceControllerWidget.setMRMLScene(this->MRMLScene);
+  sliceControllerWidget.setMRMLSliceNode(this->MRMLSliceNode);
+
+  QAction* interpolationAction =
+    sliceControllerWidget.findChild<QAction*>("actionLabelMapInterpolation");
+  QVERIFY(interpolationAction != 0);
+  QCOMPARE(interpolationAction->isEnabled(), false);
+  QCOMPARE(interpolationAction->isChecked(), false);
+
+  // Available when a label map is shown
+  sliceControllerWidget.mrmlSliceCompositeNode()->SetLabelVolumeID("vtkMRMLLabelMapVolumeNode1");
+  QCOMPARE(interpolationAction->isEnabled(), true);
+
+  // Action -> MRML
+  interpolationAction->setChecked(true);
+  QCOMPARE(this->MRMLSliceNode->GetUseLabelInterpolation(), 1);
+
+  // MRML -> action
+  this->MRMLSliceNode->SetUseLabelInterpolation(0);
+  QCOMPARE(interpolationAction->isChecked(), false);
+}
+
 // ----------------------------------------------------------------------------
 CTK_TEST_MAIN(qMRMLSliceControllerWidgetTest)
 #include "moc_qMRMLSliceControllerWidgetTest.cxx"
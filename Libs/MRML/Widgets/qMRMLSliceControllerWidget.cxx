@@ -270,6 +270,8 @@ void qMRMLSliceControllerWidgetPrivate::setupPopupUi()
                    q, SLOT(toggleSegmentationOutlineFill()));
   QObject::connect(this->actionLabelMapOutline, SIGNAL(toggled(bool)),
                    q, SLOT(showLabelOutline(bool)));
+  QObject::connect(this->actionLabelMapInterpolation, SIGNAL(toggled(bool)),
+                   q, SLOT(setLabelInterpolation(bool)));
   QObject::connect(this->actionForegroundInterpolation, SIGNAL(toggled(bool)),
                    q, SLOT(setForegroundInterpolation(bool)));
   QObject::connect(this->actionBackgroundInterpolation, SIGNAL(toggled(bool)),
@@ -704,6 +706,8 @@ void qMRMLSliceControllerWidgetPrivate::setupLabelMapMenu()
   QWidgetAction* opacityAction = new QWidgetAction(this->LabelMapOpacitySlider);
   opacityAction->setDefaultWidget(this->LabelMapOpacitySlider->slider());
   this->LabelMapMenu->addAction(opacityAction);
+  this->LabelMapMenu->addSeparator();
+  this->LabelMapMenu->addAction(this->actionLabelMapInterpolation);
 }
 
 // --------------------------------------------------------------------------
@@ -805,6 +809,7 @@ void qMRMLSliceControllerWidgetPrivate::enableLayerWidgets()
 
   // enable the interpolation or outline modes
   this->actionLabelMapOutline->setEnabled(hasLabelMap);
+  this->actionLabelMapInterpolation->setEnabled(hasLabelMap);
   this->actionBackgroundInterpolation->setEnabled(hasBackground);
   this->actionForegroundInterpolation->setEnabled(hasForeground);
 }
@@ -887,6 +892,8 @@ void qMRMLSliceControllerWidgetPrivate::updateWidgetFromMRMLSliceNode()
   this->actionLabelMapOutline->setChecked(showOutline);
   this->actionLabelMapOutline->setText(showOutline ?
     tr("Hide label volume outlines") : tr("Show label volume outlines"));
+  // Label Interpolation
+  this->actionLabelMapInterpolation->setChecked(this->MRMLSliceNode->GetUseLabelInterpolation());
   // Reformat
   bool showReformat = this->MRMLSliceNode->GetWidgetVisible();
   this->actionShow_reformat_widget->setChecked(showReformat);
@@ -2259,6 +2266,26 @@ void qMRMLSliceControllerWidget::showLabelOutline(bool show)
   d->SliceLogic->EndSliceNodeInteraction();
 }
 
+//---------------------------------------------------------------------------
+void qMRMLSliceControllerWidget::setLabelInterpolation(bool smooth)
+{
+  Q_D(qMRMLSliceControllerWidget);
+  vtkSmartPointer<vtkCollection> nodes = d->saveNodesForUndo("vtkMRMLSliceNode");
+  if (!nodes.GetPointer())
+    {
+    return;
+    }
+
+  if (!d->MRMLSliceNode)
+    {
+    return;
+    }
+
+  d->SliceLogic->StartSliceNodeInteraction(vtkMRMLSliceNode::LabelInterpolationFlag);
+  d->MRMLSliceNode->SetUseLabelInterpolation(smooth);
+  d->SliceLogic->EndSliceNodeInteraction();
+}
+
 //---------------------------------------------------------------------------
 void qMRMLSliceControllerWidget::showReformatWidget(bool show)
 {
@@ -211,6 +211,9 @@ public slots:
   void toggleSegmentationOutlineFill();
   /// Label outline
   void showLabelOutline(bool show);
+  /// Label interpolation: smooth label boundaries instead of nearest
+  /// neighbor reslicing of the label map
+  void setLabelInterpolation(bool smooth);
   /// Reformat widget
   void showReformatWidget(bool show);
   void lockReformatWidgetToCamera(bool lock);
@@ -8,11 +8,17 @@
 =========================================================================auto=*/
 
 #include "vtkOrientedBSplineTransform.h"
+#include "vtkOrientedGridTransform.h"
 
+#include "vtkDoubleArray.h"
 #include "vtkImageData.h"
 #include "vtkMath.h"
 #include "vtkMatrix4x4.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSMPTools.h"
 
 #include <math.h>
 
@@ -77,6 +83,95 @@ inline void vtkLinearTransformDerivative(const double matrix[4][4],
     }
 }
 
+//------------------------------------------------------------------------
+// Functor for transforming a list of points in parallel.
+// The transform must be up-to-date (Update() called) before the functor is
+// executed, as InternalTransformPoint does not update the transform.
+class vtkOrientedBSplineTransformPointsFunctor
+{
+public:
+  vtkOrientedBSplineTransformPointsFunctor(vtkAbstractTransform* transform,
+    vtkPoints* inPts, vtkPoints* outPts, vtkIdType outOffset)
+    : Transform(transform), InPts(inPts), OutPts(outPts), OutOffset(outOffset)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    double point[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType pointIndex = begin; pointIndex < end; pointIndex++)
+      {
+      this->InPts->GetPoint(pointIndex, point);
+      this->Transform->InternalTransformPoint(point, point);
+      this->OutPts->SetPoint(this->OutOffset + pointIndex, point);
+      }
+  }
+
+private:
+  vtkAbstractTransform* Transform;
+  vtkPoints* InPts;
+  vtkPoints* OutPts;
+  vtkIdType OutOffset;
+};
+
+//------------------------------------------------------------------------
+// Functor for sampling the transform over a regular grid in parallel.
+// Each work item is one slice (k index) of the output displacement grid.
+class vtkOrientedBSplineTransformSampleGridFunctor
+{
+public:
+  vtkOrientedBSplineTransformSampleGridFunctor(vtkAbstractTransform* transform,
+    const int extent[6], const double gridIndexToOutput[4][4], double* displacements)
+    : Transform(transform), Displacements(displacements)
+  {
+    for (int i = 0; i < 6; i++)
+      {
+      this->Extent[i] = extent[i];
+      }
+    for (int row = 0; row < 4; row++)
+      {
+      for (int col = 0; col < 4; col++)
+        {
+        this->GridIndexToOutput[row][col] = gridIndexToOutput[row][col];
+        }
+      }
+  }
+
+  void operator()(vtkIdType beginSlice, vtkIdType endSlice) const
+  {
+    const vtkIdType numberOfColumns = this->Extent[1] - this->Extent[0] + 1;
+    const vtkIdType numberOfRows = this->Extent[3] - this->Extent[2] + 1;
+    double ijk[3] = { 0.0, 0.0, 0.0 };
+    double point[3] = { 0.0, 0.0, 0.0 };
+    double transformedPoint[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType sliceIndex = beginSlice; sliceIndex < endSlice; sliceIndex++)
+      {
+      double* displacement = this->Displacements + sliceIndex * numberOfRows * numberOfColumns * 3;
+      ijk[2] = this->Extent[4] + sliceIndex;
+      for (int j = this->Extent[2]; j <= this->Extent[3]; j++)
+        {
+        ijk[1] = j;
+        for (int i = this->Extent[0]; i <= this->Extent[1]; i++)
+          {
+          ijk[0] = i;
+          vtkLinearTransformPoint(this->GridIndexToOutput, ijk, point);
+          this->Transform->InternalTransformPoint(point, transformedPoint);
+          displacement[0] = transformedPoint[0] - point[0];
+          displacement[1] = transformedPoint[1] - point[1];
+          displacement[2] = transformedPoint[2] - point[2];
+          displacement += 3;
+          }
+        }
+      }
+  }
+
+private:
+  vtkAbstractTransform* Transform;
+  int Extent[6];
+  double GridIndexToOutput[4][4];
+  double* Displacements;
+};
+
 //----------------------------------------------------------------------------
 vtkOrientedBSplineTransform::vtkOrientedBSplineTransform()
 {
@@ -487,6 +582,87 @@ void vtkOrientedBSplineTransform::InternalUpdate()
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkOrientedBSplineTransform::TransformPoints(vtkPoints *inPts, vtkPoints *outPts)
+{
+  if (inPts == NULL || outPts == NULL)
+    {
+    return;
+    }
+
+  // Update must be called here, because InternalTransformPoint is not
+  // allowed to modify the transform from multiple threads.
+  this->Update();
+
+  vtkIdType numberOfPoints = inPts->GetNumberOfPoints();
+  vtkIdType outOffset = outPts->GetNumberOfPoints();
+  outPts->SetNumberOfPoints(outOffset + numberOfPoints);
+
+  vtkOrientedBSplineTransformPointsFunctor functor(this, inPts, outPts, outOffset);
+  vtkSMPTools::For(0, numberOfPoints, functor);
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedBSplineTransform::ConvertToGridTransform(vtkOrientedGridTransform* gridTransform,
+  const int gridExtent[6], const double gridOrigin[3], const double gridSpacing[3],
+  vtkMatrix4x4* gridDirectionMatrix/*=NULL*/)
+{
+  if (gridTransform == NULL)
+    {
+    vtkErrorMacro("ConvertToGridTransform failed: invalid output grid transform");
+    return false;
+    }
+  if (gridExtent[0] > gridExtent[1] || gridExtent[2] > gridExtent[3] || gridExtent[4] > gridExtent[5])
+    {
+    vtkErrorMacro("ConvertToGridTransform failed: empty grid extent");
+    return false;
+    }
+
+  this->Update();
+
+  vtkNew<vtkMatrix4x4> gridIndexToOutput;
+  for (int row = 0; row < 3; row++)
+    {
+    for (int col = 0; col < 3; col++)
+      {
+      double direction = (gridDirectionMatrix != NULL ? gridDirectionMatrix->GetElement(row, col) : (row == col ? 1.0 : 0.0));
+      gridIndexToOutput->SetElement(row, col, direction * gridSpacing[col]);
+      }
+    gridIndexToOutput->SetElement(row, 3, gridOrigin[row]);
+    }
+
+  vtkNew<vtkImageData> displacementGrid;
+  displacementGrid->SetExtent(const_cast<int*>(gridExtent));
+  displacementGrid->SetOrigin(gridOrigin[0], gridOrigin[1], gridOrigin[2]);
+  displacementGrid->SetSpacing(gridSpacing[0], gridSpacing[1], gridSpacing[2]);
+  displacementGrid->AllocateScalars(VTK_DOUBLE, 3);
+  double* displacements = static_cast<double*>(displacementGrid->GetScalarPointer());
+  if (displacements == NULL)
+    {
+    vtkErrorMacro("ConvertToGridTransform failed: cannot allocate displacement grid");
+    return false;
+    }
+
+  vtkOrientedBSplineTransformSampleGridFunctor functor(this, gridExtent, gridIndexToOutput->Element, displacements);
+  vtkSMPTools::For(0, gridExtent[5] - gridExtent[4] + 1, functor);
+
+  if (gridDirectionMatrix != NULL)
+    {
+    vtkNew<vtkMatrix4x4> gridDirectionMatrixCopy;
+    gridDirectionMatrixCopy->DeepCopy(gridDirectionMatrix);
+    gridTransform->SetGridDirectionMatrix(gridDirectionMatrixCopy.GetPointer());
+    }
+  else
+    {
+    gridTransform->SetGridDirectionMatrix(NULL);
+    }
+  gridTransform->SetInterpolationModeToCubic();
+  gridTransform->SetDisplacementScale(1.0);
+  gridTransform->SetDisplacementShift(0.0);
+  gridTransform->SetDisplacementGridData(displacementGrid.GetPointer());
+  return true;
+}
+
 //----------------------------------------------------------------------------
 vtkAbstractTransform *vtkOrientedBSplineTransform::MakeTransform()
 {
@@ -31,6 +31,9 @@
 
 #include "vtkBSplineTransform.h"
 
+class vtkOrientedGridTransform;
+class vtkPoints;
+
 class VTK_ADDON_EXPORT vtkOrientedBSplineTransform : public vtkBSplineTransform
 {
 public:
@@ -56,6 +59,25 @@ public:
   virtual void SetBulkTransformMatrix(vtkMatrix4x4*);
   vtkGetObjectMacro(BulkTransformMatrix,vtkMatrix4x4);
 
+  // Description:
+  // Apply the transformation to a series of points, and append the
+  // results to outPts. Points are transformed in parallel (using vtkSMPTools),
+  // which makes warping of large models significantly faster.
+  void TransformPoints(vtkPoints *inPts, vtkPoints *outPts) VTK_OVERRIDE;
+
+  // Description:
+  // Sample the transform over a regular grid and store the result in
+  // a displacement field (grid) transform. The bulk transform component
+  // and the inverse flag are taken into account, therefore the grid transform
+  // approximates the complete transform within the sampled region.
+  // Sampling is performed in parallel (using vtkSMPTools).
+  // If gridDirectionMatrix is NULL then the grid axes are aligned with the
+  // coordinate system axes.
+  // Returns false if the displacement field could not be computed.
+  bool ConvertToGridTransform(vtkOrientedGridTransform* gridTransform,
+    const int gridExtent[6], const double gridOrigin[3], const double gridSpacing[3],
+    vtkMatrix4x4* gridDirectionMatrix=NULL);
+
 protected:
   vtkOrientedBSplineTransform();
   ~vtkOrientedBSplineTransform();
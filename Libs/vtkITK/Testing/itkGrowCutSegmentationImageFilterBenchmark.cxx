@@ -0,0 +1,163 @@
+// vtkITK includes
+#include <itkGrowCutSegmentationImageFilter.h>
+
+// ITK includes
+#include <itkImage.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkMultiThreader.h>
+#include <itkTimeProbe.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+typedef itk::Image<short, 3> ImageType;
+typedef itk::Image<float, 3> WeightImageType;
+typedef itk::GrowCutSegmentationImageFilter<ImageType, ImageType> FilterType;
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Noisy sphere in the middle of the image. The object is seeded at its
+// center and the background at the corners.
+void CreateImages(int size, ImageType::Pointer image,
+                  ImageType::Pointer labels, WeightImageType::Pointer strengths)
+{
+  ImageType::RegionType region;
+  region.SetSize(0, size);
+  region.SetSize(1, size);
+  region.SetSize(2, size);
+
+  image->SetRegions(region);
+  image->Allocate();
+  labels->SetRegions(region);
+  labels->Allocate();
+  strengths->SetRegions(region);
+  strengths->Allocate();
+
+  const double center = (size - 1) / 2.0;
+  const double radius = size / 4.0;
+  unsigned int seed = 1;
+  itk::ImageRegionIteratorWithIndex<ImageType> imageIt(image, region);
+  itk::ImageRegionIteratorWithIndex<ImageType> labelIt(labels, region);
+  itk::ImageRegionIteratorWithIndex<WeightImageType> strengthIt(strengths, region);
+  for (; !imageIt.IsAtEnd(); ++imageIt, ++labelIt, ++strengthIt)
+    {
+    const ImageType::IndexType index = imageIt.GetIndex();
+    double distance2 = 0.;
+    bool corner = true;
+    for (int d = 0; d < 3; ++d)
+      {
+      distance2 += (index[d] - center) * (index[d] - center);
+      corner = corner && (index[d] < 3 || index[d] >= size - 3);
+      }
+    // deterministic noise
+    seed = seed * 1103515245 + 12345;
+    const short noise = static_cast<short>((seed >> 16) % 3);
+    imageIt.Set((distance2 < radius * radius ? 100 : 20) + noise);
+
+    short label = 0;
+    if (distance2 < 4.)
+      {
+      label = 2;
+      }
+    else if (corner)
+      {
+      label = 1;
+      }
+    labelIt.Set(label);
+    strengthIt.Set(label ? 1.f : 0.f);
+    }
+}
+
+//----------------------------------------------------------------------------
+ImageType::Pointer RunGrowCut(ImageType::Pointer image, ImageType::Pointer labels,
+                              WeightImageType::Pointer strengths, int numberOfThreads,
+                              double& time)
+{
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInputImage(image);
+  filter->SetLabelImage(labels);
+  filter->SetStrengthImage(strengths);
+  filter->SetObjectRadius(image->GetLargestPossibleRegion().GetSize(0));
+  filter->SetNumberOfThreads(numberOfThreads);
+
+  itk::TimeProbe probe;
+  probe.Start();
+  filter->Update();
+  probe.Stop();
+  time = probe.GetTotal();
+
+  ImageType::Pointer output = filter->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+// Compare the single-threaded and multithreaded execution times of the
+// filter and check that they give the same segmentation.
+int main(int argc, char* argv[])
+{
+  const int size = argc > 1 ? atoi(argv[1]) : 96;
+  if (size < 16)
+    {
+    std::cerr << "Usage: " << argv[0] << " [image size, at least 16]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ImageType::Pointer image = ImageType::New();
+  ImageType::Pointer labels = ImageType::New();
+  WeightImageType::Pointer strengths = WeightImageType::New();
+  CreateImages(size, image, labels, strengths);
+
+  const int numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  double singleThreadTime = 0.;
+  double multiThreadTime = 0.;
+  ImageType::Pointer singleThreadOutput =
+    RunGrowCut(image, labels, strengths, 1, singleThreadTime);
+  ImageType::Pointer multiThreadOutput =
+    RunGrowCut(image, labels, strengths, numberOfThreads, multiThreadTime);
+
+  std::cout << "Image size: " << size << "^3" << std::endl;
+  std::cout << "1 thread: " << singleThreadTime << "s" << std::endl;
+  std::cout << numberOfThreads << " threads: " << multiThreadTime << "s" << std::endl;
+  if (multiThreadTime > 0.)
+    {
+    std::cout << "Speedup: " << singleThreadTime / multiThreadTime << std::endl;
+    }
+
+  // The result must not depend on the number of threads
+  itk::ImageRegionConstIteratorWithIndex<ImageType> singleIt(
+    singleThreadOutput, singleThreadOutput->GetBufferedRegion());
+  itk::ImageRegionConstIteratorWithIndex<ImageType> multiIt(
+    multiThreadOutput, multiThreadOutput->GetBufferedRegion());
+  for (; !singleIt.IsAtEnd(); ++singleIt, ++multiIt)
+    {
+    if (singleIt.Get() != multiIt.Get())
+      {
+      std::cerr << "Segmentation differs at " << singleIt.GetIndex() << ": "
+                << singleIt.Get() << " != " << multiIt.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The sphere is segmented as object, the rest as background
+  ImageType::IndexType inside;
+  inside.Fill(size / 2 + size / 8);
+  ImageType::IndexType outside;
+  outside.Fill(size / 2);
+  outside[0] = size / 8;
+  if (multiThreadOutput->GetPixel(inside) != 2
+      || multiThreadOutput->GetPixel(outside) != 1)
+    {
+    std::cerr << "Unexpected segmentation: inside " << multiThreadOutput->GetPixel(inside)
+              << ", outside " << multiThreadOutput->GetPixel(outside) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
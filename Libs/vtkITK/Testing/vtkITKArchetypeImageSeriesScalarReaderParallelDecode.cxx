@@ -0,0 +1,141 @@
+
+#include <vtkITKArchetypeImageSeriesScalarReader.h>
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+// ITK includes
+#include <itkConfigure.h>
+#include <itkFactoryRegistration.h>
+
+// STD includes
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool ReadSeries(const char* archetype, bool parallelDecode,
+                vtkITKArchetypeImageSeriesScalarReader* reader)
+{
+  reader->SetArchetype(archetype);
+  reader->SetOutputScalarTypeToNative();
+  reader->SetDesiredCoordinateOrientationToNative();
+  reader->SetUseNativeOriginOn();
+  reader->SetDICOMImageIOApproachToGDCM();
+  reader->SetParallelDecode(parallelDecode);
+  try
+    {
+    reader->Update();
+    }
+  catch (itk::ExceptionObject err)
+    {
+    std::cout << "Unable to read file '" << archetype << "', err = \n" << err << std::endl;
+    return false;
+    }
+  if (reader->GetErrorCode() != 0 || !reader->GetOutput()
+      || !reader->GetOutput()->GetPointData()->GetScalars())
+    {
+    std::cout << "ERROR: failed to read '" << archetype << "' with ParallelDecode "
+              << (parallelDecode ? "on" : "off") << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool Equal(const double* values1, const double* values2, int numberOfValues, const char* name)
+{
+  for (int i = 0; i < numberOfValues; ++i)
+    {
+    if (std::fabs(values1[i] - values2[i]) > 1e-6)
+      {
+      std::cout << "ERROR: " << name << " differs: " << values1[i]
+                << " != " << values2[i] << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+// Read a DICOM series with and without decoding the slices concurrently,
+// and check that both images have the same voxels and geometry.
+int main(int argc, char *argv[])
+{
+  itk::itkFactoryRegistration();
+
+  if (argc < 2)
+    {
+    std::cout << "ERROR: need to specify a file of a DICOM series on the command line." << std::endl;
+    return 1;
+    }
+
+  vtkNew<vtkITKArchetypeImageSeriesScalarReader> parallelReader;
+  vtkNew<vtkITKArchetypeImageSeriesScalarReader> serialReader;
+  if (!ReadSeries(argv[1], true, parallelReader.GetPointer())
+      || !ReadSeries(argv[1], false, serialReader.GetPointer()))
+    {
+    return 1;
+    }
+  vtkImageData* parallelImage = parallelReader->GetOutput();
+  vtkImageData* serialImage = serialReader->GetOutput();
+
+  int parallelDimensions[3] = {0, 0, 0};
+  int serialDimensions[3] = {0, 0, 0};
+  parallelImage->GetDimensions(parallelDimensions);
+  serialImage->GetDimensions(serialDimensions);
+  for (int i = 0; i < 3; ++i)
+    {
+    if (parallelDimensions[i] != serialDimensions[i])
+      {
+      std::cout << "ERROR: dimensions differ: " << parallelDimensions[i]
+                << " != " << serialDimensions[i] << std::endl;
+      return 1;
+      }
+    }
+  if (serialDimensions[2] < 2)
+    {
+    std::cout << "ERROR: expected a series of several slices, got "
+              << serialDimensions[2] << std::endl;
+    return 1;
+    }
+  if (!Equal(parallelImage->GetSpacing(), serialImage->GetSpacing(), 3, "Spacing")
+      || !Equal(parallelImage->GetOrigin(), serialImage->GetOrigin(), 3, "Origin")
+      || !Equal(&parallelReader->GetRasToIjkMatrix()->Element[0][0],
+                &serialReader->GetRasToIjkMatrix()->Element[0][0], 16, "RAS to IJK matrix"))
+    {
+    return 1;
+    }
+
+  vtkDataArray* parallelScalars = parallelImage->GetPointData()->GetScalars();
+  vtkDataArray* serialScalars = serialImage->GetPointData()->GetScalars();
+  if (parallelScalars->GetDataType() != serialScalars->GetDataType()
+      || parallelScalars->GetNumberOfTuples() != serialScalars->GetNumberOfTuples()
+      || parallelScalars->GetNumberOfComponents() != serialScalars->GetNumberOfComponents())
+    {
+    std::cout << "ERROR: scalar arrays differ" << std::endl;
+    return 1;
+    }
+  int numberOfComponents = parallelScalars->GetNumberOfComponents();
+  for (vtkIdType i = 0; i < parallelScalars->GetNumberOfTuples(); ++i)
+    {
+    for (int c = 0; c < numberOfComponents; ++c)
+      {
+      if (parallelScalars->GetComponent(i, c) != serialScalars->GetComponent(i, c))
+        {
+        std::cout << "ERROR: voxel " << i << " differs: " << parallelScalars->GetComponent(i, c)
+                  << " != " << serialScalars->GetComponent(i, c) << std::endl;
+        return 1;
+        }
+      }
+    }
+
+  return 0;
+}
@@ -47,6 +47,19 @@ namespace itk
  * This algorithm is implemented scalar images. Vector Images are not
  * supported.
  *
+ * Each iteration of the cellular automaton is multithreaded: the image
+ * is split in regions processed by ThreadedGenerateData(). Labels and
+ * strengths are double-buffered, cells are updated from the state of
+ * the previous iteration only, therefore the result does not depend on
+ * the number of threads. Image lines (rows along the first dimension)
+ * are only processed if a cell of a neighboring line changed in the
+ * previous iteration, converged regions are skipped. The filter runs
+ * until no cell changes or MaxIterations is reached. Previous versions
+ * stopped as soon as 96% of the cells were saturated, the segmentation
+ * can therefore differ from theirs near the boundaries of the labels.
+ *
+ * The state image (if set) is updated with the state of each cell after
+ * the last iteration. The max saturation image is deprecated and ignored.
  *
 **/
 
@@ -168,6 +181,8 @@ template<class TInputImage,
   void SetDistancesImage( const WeightImageType *d);
   const WeightImagePointer GetDistancesImage();
 
+  /** \deprecated The max saturation image is ignored, a warning is
+   * reported if it is set. GetMaxSaturationImage() returns a null pointer. */
   void SetMaxSaturationImage( const WeightImageType *w);
   const WeightImagePointer GetMaxSaturationImage();
 
@@ -254,11 +269,10 @@ template<class TInputImage,
   itkGetConstMacro(SetStateImage, bool);
   itkBooleanMacro(SetStateImage);
 
-  /**Set/Get whether the maxSaturationImage has already been set for the filter.
-  * Default setting is off in which case the filter automatically initializes
-  * the maxSaturationImage image.
+  /**\deprecated Set/Get whether the maxSaturationImage has already been set
+  * for the filter. Ignored, a warning is reported if it is turned on.
   **/
-  itkSetMacro(SetMaxSaturationImage, bool);
+  virtual void SetSetMaxSaturationImage(bool);
   itkGetConstMacro(SetMaxSaturationImage, bool);
   itkBooleanMacro(SetMaxSaturationImage);
 
@@ -275,30 +289,32 @@ template<class TInputImage,
 
   void GenerateData() ITK_OVERRIDE;
 
+  /** Run one iteration of the automaton on a region: read the labels
+   * and strengths of the current buffers, write the next buffers. */
   void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread ,
                              ThreadIdType threadId ) ITK_OVERRIDE;
 
+  /** Sum the number of labeled and saturated cells of the threads. */
   void AfterThreadedGenerateData() ITK_OVERRIDE;
 
   void Initialize(OutputImageType* output);
 
   void PrintSelf ( std::ostream& os, Indent indent ) const ITK_OVERRIDE;
 
-  void GrowCutSlowROI( TOutputImage *);
-
 
  private:
 
   GrowCutSegmentationImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&); // purposely not implemented
 
-  bool InitializeStateImage( OutputImageType *state );
+  /** Set the ROI to the bounding box of the labels expanded by
+   * ObjectRadius. Returns true if there is no label. */
+  bool ComputeRegionOfInterest();
 
   void InitializeDistancesImage(TInputImage *input,WeightImageType *distance);
 
-  void GetRegionOfInterest();
-
-  void ComputeLabelVolumes(TOutputImage *outputImage, std::vector< unsigned > &volumes, std::vector< unsigned > &phyVolumes);
+  /** Run one multithreaded iteration and swap the buffers. */
+  void RunIteration();
 
   void MaskSegmentedImageByWeight(float upperThresh);
 
@@ -327,6 +343,19 @@ template<class TInputImage,
   OutputIndexType                            m_RoiStart;
   OutputIndexType                            m_RoiEnd;
 
+  // Buffers of the current iteration (read) and of the next one (written)
+  OutputImagePointer                         m_NextLabelImage;
+  WeightImagePointer                         m_NextWeightImage;
+  WeightImagePointer                         m_DistancesImage;
+  // One flag per image line, set if a cell of the line changed
+  std::vector<unsigned char>                 m_ActiveLines;
+  std::vector<unsigned char>                 m_NextActiveLines;
+
+  // Cell counts of each thread for the current iteration
+  std::vector<SizeValueType>                 m_ThreadLabeled;
+  std::vector<SizeValueType>                 m_ThreadLocallySaturated;
+  std::vector<SizeValueType>                 m_ThreadSaturated;
+
 };
 
 } // namespace itk
@@ -6,37 +6,20 @@
 
 
 #include "itkConstNeighborhoodIterator.h"
-#include "itkNeighborhoodIterator.h"
-#include "itkNeighborhoodAlgorithm.h"
+#include "itkImageAlgorithm.h"
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionConstIterator.h"
-#include "itkConstantBoundaryCondition.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkNumericTraits.h"
-#include "itkImageFileWriter.h"
-#include "itkLabelMap.h"
-#include "itkShapeLabelObject.h"
-#include "itkLabelImageToShapeLabelMapFilter.h"
 
-#include "itkProgressReporter.h"
-# include "itkIterationReporter.h"
+#include "itkIterationReporter.h"
 
-#include <map>
-#include <string>
 #include <cmath>
 #include <vcl_compiler.h>
 #include <iostream>
 #include <algorithm>
 #include <utility>
 
-#include <iostream>
-#include <ctime>
-
-
-// #define LOG_OUTPUT
-// #define DEBUG_LEVEL_0
-
-#define USE_LABELSHAPEFILTER
-
 namespace itk
 {
 
@@ -70,6 +53,13 @@ GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
   m_UnknownLabel = static_cast<OutputPixelType>( NumericTraits<OutputPixelType>::ZeroValue() );
 
   m_Radius.Fill(1);
+
+  m_RoiStart.Fill(0);
+  m_RoiEnd.Fill(0);
+
+  m_Labeled = 0;
+  m_LocallySaturated = 0;
+  m_Saturated = 0;
 }
 
 
@@ -159,11 +149,10 @@ void
 GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
 ::SetMaxSaturationImage( const WeightImageType* s)
 {
-  this->ProcessObject::SetNthInput(5, const_cast< WeightImageType *>(s));
-
-  this->SetMaxSaturationImageOn();
-  //m_SetMaxSaturationImage = true;
-  //m_MaxSaturationImage = static_cast< WeightImageType *>(this->ProcessObject::GetInput(5));
+  if (s)
+    {
+    this->SetMaxSaturationImageOn();
+    }
 }
 
 
@@ -172,10 +161,25 @@ const typename GrowCutSegmentationImageFilter< TInputImage, TOutputImage, TWeigh
 GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
 ::GetMaxSaturationImage()
 {
-  typename WeightImageType::Pointer maxSaturationImage = WeightImageType::New();
-  maxSaturationImage->Graft(static_cast< WeightImageType*>(this->ProcessObject::GetInput(5)));
-  return maxSaturationImage;
-  //return const_cast< WeightImageType*> (this->ProcessObject::GetInput(5));
+  return WeightImagePointer();
+}
+
+
+template <class TInputImage, class TOutputImage, class TWeightPixelType>
+void
+GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
+::SetSetMaxSaturationImage(bool set)
+{
+  if (set)
+    {
+    itkWarningMacro(<< "The max saturation image is deprecated and ignored: "
+                    << "iterations run until no cell changes.");
+    }
+  if (m_SetMaxSaturationImage != set)
+    {
+    m_SetMaxSaturationImage = set;
+    this->Modified();
+    }
 }
 
 template< class TInputImage, class TOutputImage, class TWeightPixelType >
@@ -223,187 +227,77 @@ void
 GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
 ::Initialize( OutputImageType *output)
 {
+  // Allocate the current and next buffers with the geometry of the output
+  const OutputImageRegionType region = output->GetRequestedRegion();
 
-  // is the output allocated already
-  if(output->GetBufferedRegion().GetNumberOfPixels() == 0)
-    {
-    // allocate memory for the output buffer
-    output->SetBufferedRegion( this->GetOutput()->GetRequestedRegion() );
-    output->Allocate();
-    output->FillBuffer ( m_UnknownLabel );
-    }
-
-
-  if(m_LabelImage->GetBufferedRegion().GetNumberOfPixels() == 0)
-    {
-    m_LabelImage->CopyInformation( output );
-    m_LabelImage->SetBufferedRegion( output->GetBufferedRegion() );
-    m_LabelImage->Allocate();
-    m_LabelImage->FillBuffer( m_UnknownLabel );
-    }
+  m_LabelImage = OutputImageType::New();
+  m_LabelImage->CopyInformation( output );
+  m_LabelImage->SetRegions( region );
+  m_LabelImage->Allocate();
 
+  m_NextLabelImage = OutputImageType::New();
+  m_NextLabelImage->CopyInformation( output );
+  m_NextLabelImage->SetRegions( region );
+  m_NextLabelImage->Allocate();
 
-  if( m_WeightImage->GetBufferedRegion().GetNumberOfPixels() == 0)
-    {
-    m_WeightImage->CopyInformation( output );
-    m_WeightImage->SetBufferedRegion( output->GetBufferedRegion() );
-    m_WeightImage->Allocate();
-    m_WeightImage->FillBuffer( 0.0 );
-    }
-
+  m_WeightImage = WeightImageType::New();
+  m_WeightImage->CopyInformation( output );
+  m_WeightImage->SetRegions( region );
+  m_WeightImage->Allocate();
+
+  m_NextWeightImage = WeightImageType::New();
+  m_NextWeightImage->CopyInformation( output );
+  m_NextWeightImage->SetRegions( region );
+  m_NextWeightImage->Allocate();
 }
 
 template<class TInputImage, class TOutputImage, class TWeightPixelType>
-void GrowCutSegmentationImageFilter< TInputImage, TOutputImage, TWeightPixelType>::
-ComputeLabelVolumes(TOutputImage *outputImage, std::vector< unsigned > &volumes,
-                    std::vector< unsigned > &physicalVolumes)
+bool GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>::
+ComputeRegionOfInterest()
 {
-  //volumes.resize(3);
+  const OutputImageType* labelImage =
+    static_cast< const OutputImageType*> (this->ProcessObject::GetInput(1));
+  const OutputImageRegionType region = labelImage->GetBufferedRegion();
 
-#ifndef USE_LABELSHAPEFILTER
-
-  std::map<unsigned short, unsigned int>labelMap;
-  std::vector< unsigned short > labels;
-  unsigned int index = 0;
-  ImageRegionConstIteratorWithIndex< OutputImageType > label( outputImage,
-                                                              outputImage->GetBufferedRegion());
-
-  for(label.GoToBegin(); !label.IsAtEnd(); ++label)
+  bool foundLabels = false;
+  ImageRegionConstIteratorWithIndex< OutputImageType > label( labelImage, region );
+  for (label.GoToBegin(); !label.IsAtEnd(); ++label)
     {
-
-    unsigned short pix = static_cast<unsigned short>(label.Get());
-    std::map<unsigned short, unsigned int>::iterator it = labelMap.find(pix);
-    if(it == labelMap.end())
+    if(label.Get() == m_UnknownLabel)
       {
-      labelMap.insert(std::pair<unsigned short, unsigned int>(pix, index));
-      volumes.push_back(1);
-      labels.push_back(pix);
-      ++index;
+      continue;
       }
-    else
+    const OutputIndexType idx = label.GetIndex();
+    if(!foundLabels)
       {
-      int i = it->second;
-      ++volumes[i];
+      m_RoiStart = idx;
+      m_RoiEnd = idx;
+      foundLabels = true;
+      continue;
       }
-    }
-  // std::cout<<" label \t "<<" volume "<<std::endl;
-  // for (unsigned int i = 0; i < index; i++)
-  //   {
-  //   std::map<unsigned short, unsigned int>::iterator it = labelMap.find(labels[i]);
-  //   std::cout<<labels[i]<<"\t"<<volumes[it->second]<<std::endl;
-  //   }
-
-#else
-  typedef LabelImageToShapeLabelMapFilter< OutputImageType > LabelFilterType;
-  typename LabelFilterType::Pointer labelFilter = LabelFilterType::New();
-
-  labelFilter->SetInput(outputImage);
-  labelFilter->SetBackgroundValue(0);
-  labelFilter->Update();
-
-  unsigned long numObjects = labelFilter->GetOutput()->GetNumberOfLabelObjects();
-  volumes.resize((const int)numObjects);
-  physicalVolumes.resize((const int)numObjects);
-  for (unsigned n = 0; n < numObjects; n++)
-    {
-    volumes[n] = labelFilter->GetOutput()->
-      GetNthLabelObject(n)->GetNumberOfPixels();
-    physicalVolumes[n] = (unsigned int)
-      (labelFilter->GetOutput()->
-       GetNthLabelObject(n)->GetNumberOfPixels()/1000.0);
-    }
-#endif
-}
-
-
-template<class TInputImage, class TOutputImage, class TWeightPixelType>
-bool GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>::
-InitializeStateImage( OutputImageType *stateImage)
-{
-  bool setStart = false;
-  //  bool setEnd = false;
-
-  typename OutputImageType::Pointer labelImage = OutputImageType::New();
-  labelImage->Graft(static_cast< OutputImageType*> (this->ProcessObject::GetInput(1)));
-
-  typename OutputImageType::SizeType lsize =
-    labelImage->GetBufferedRegion().GetSize();
-
-  ImageRegionConstIteratorWithIndex< OutputImageType > label( labelImage,
-                                                              labelImage->GetBufferedRegion());
-  ImageRegionIterator< OutputImageType > state( stateImage,
-                                                stateImage->GetBufferedRegion());
-
-  for (unsigned i = 0; i < labelImage->GetImageDimension(); i++){
-  m_RoiStart[i] = 0;
-  m_RoiEnd[i] = 0;
-  }
-
-  bool foundLabels = false;
-
-  for (label.GoToBegin(), state.GoToBegin(); !label.IsAtEnd();
-       ++label, ++state)
-    {
-    if(label.Get() != m_UnknownLabel)
+    for (unsigned i = 0; i < OutputImageDimension; i++)
       {
-      foundLabels = true;
-      OutputIndexType idx = label.GetIndex();
-
-      if(!setStart)
-        {
-        m_RoiStart = idx;
-        m_RoiEnd = idx;
-        setStart = true;
-        }
-      else
-        {
-        for (unsigned i = 0; i < labelImage->GetImageDimension(); i++)
-          {
-          if(idx[i] <= m_RoiStart[i])
-            {
-            m_RoiStart[i] = idx[i];
-            }
-          if(idx[i] >= m_RoiEnd[i])
-            {
-            m_RoiEnd[i] = idx[i];
-            }
-          }
-        }
-
-      state.Set(static_cast< OutputPixelType>(LABELED));
+      m_RoiStart[i] = std::min(m_RoiStart[i], idx[i]);
+      m_RoiEnd[i] = std::max(m_RoiEnd[i], idx[i]);
       }
     }
 
-  for (unsigned i = 0; i < labelImage->GetImageDimension(); i++)
-    {
-    /* m_roiStart[i] = (midROI[i]-m_ObjectRadius >=0 && midROI[i]-m_ObjectRadius <= m_roiStart[i]) ?
-   (midROI[i]-m_ObjectRadius) : 0; //m_roiStart[i];
-   m_roiEnd[i] = (midROI[i]+m_ObjectRadius < (unsigned)lsize[i] && midROI[i]+m_ObjectRadius >= m_roiEnd[i]) ?
-   (midROI[i]+m_ObjectRadius) : lsize[i]-1; //m_roiEnd[i];
-      */
-
-    m_RoiStart[i] = (m_RoiStart[i] - m_ObjectRadius >= 0)? (m_RoiStart[i] - m_ObjectRadius) : 0;
-    m_RoiEnd[i] = (static_cast<unsigned int>(m_RoiEnd[i] + m_ObjectRadius) < lsize[i]) ?
-      (m_RoiEnd[i] + m_ObjectRadius) : lsize[i]-1;
-    }
-
   if(!foundLabels)
+    {
+    m_RoiStart = region.GetIndex();
+    m_RoiEnd = region.GetIndex();
     return true;
+    }
 
-  // std::cout<< " ROI start ";
-  // for (unsigned int i = 0; i < labelImage->GetImageDimension(); i++)
-  //   {
-  //   std::cout<<m_roiStart[i]<<" ";
-  //   }
-  // std::cout<<" ROI end ";
-  // for (unsigned int i = 0; i < labelImage->GetImageDimension(); i++)
-  //   {
-  //   std::cout<<m_roiEnd[i]<<" ";
-  //   }
-  // std::cout<<std::endl;
-
+  const IndexValueType radius = static_cast< IndexValueType >(m_ObjectRadius);
+  for (unsigned i = 0; i < OutputImageDimension; i++)
+    {
+    const IndexValueType first = region.GetIndex(i);
+    const IndexValueType last = first + static_cast< IndexValueType >(region.GetSize(i)) - 1;
+    m_RoiStart[i] = std::max(first, m_RoiStart[i] - radius);
+    m_RoiEnd[i] = std::min(last, m_RoiEnd[i] + radius);
+    }
   return false;
-
 }
 
 template<class TInputImage, class TOutputImage, class TWeightPixelType>
@@ -486,566 +380,344 @@ GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
 {
   IterationReporter iterate(this, 0, 1);
 
-  // if the filter is configured to run a single iteration, use the superclass
-  // GenerateData. This will engage the multi-threaded version of the GenerateData
-
   typename OutputImageType::Pointer output = this->GetOutput();
-  this->Initialize(output);
-
-  if(m_RunOneIteration)
-    {
-    Superclass::GenerateData();
-    iterate.CompletedStep();
-
-    m_LabelImage = this->GetOutput();
-    return;
-    }
-
-
-  unsigned int ndims = static_cast< unsigned int>(output->GetImageDimension());
-
-  typename InputImageType::Pointer inputImage = InputImageType::New();
-  inputImage->Graft( static_cast< InputImageType*>(this->ProcessObject::GetInput(0)));
-
-  typename OutputImageType::Pointer pixelStateImage = OutputImageType::New();
-  typename WeightImageType::Pointer maxDistancesImage = WeightImageType::New();
-  typename WeightImageType::Pointer maxSaturationImage = WeightImageType::New();
-
-
-  bool converged = false;
-
-  // Initialize the state image
-  if( !m_SetStateImage)
+  const OutputImageRegionType region = output->GetRequestedRegion();
+
+  const InputImageType* inputImage = this->GetInput();
+  const OutputImageType* labelInput =
+    static_cast< const OutputImageType*> (this->ProcessObject::GetInput(1));
+  const WeightImageType* strengthInput =
+    static_cast< const WeightImageType*> (this->ProcessObject::GetInput(2));
+  if (inputImage->GetBufferedRegion() != region
+    || labelInput->GetBufferedRegion() != region
+    || strengthInput->GetBufferedRegion() != region)
     {
-
-    pixelStateImage->CopyInformation( this->GetLabelImage() );
-    pixelStateImage->SetBufferedRegion( this->GetLabelImage()->GetBufferedRegion() );
-    pixelStateImage->Allocate();
-    pixelStateImage->FillBuffer(UNLABELED);
-
-    converged = this->InitializeStateImage(pixelStateImage);
+    itkExceptionMacro(<< "Input, label and strength images must have the same region");
     }
 
+  this->Initialize(output);
+  ImageAlgorithm::Copy(labelInput, m_LabelImage.GetPointer(), region, region);
+  ImageAlgorithm::Copy(strengthInput, m_WeightImage.GetPointer(), region, region);
 
   // Initialize the max distance for each pixel in the image
-  if( !m_SetDistancesImage)
-    {
-
-    maxDistancesImage->CopyInformation(this->GetStrengthImage());
-    maxDistancesImage->SetBufferedRegion( this->GetStrengthImage()->GetBufferedRegion() );
-    maxDistancesImage->Allocate();
-    maxDistancesImage->FillBuffer(UNLABELED);
-    this->InitializeDistancesImage(inputImage, maxDistancesImage);
-    }
-
-
-  if( !m_SetMaxSaturationImage )
-    {
-    maxSaturationImage->CopyInformation( inputImage );
-    maxSaturationImage->SetBufferedRegion( inputImage->GetBufferedRegion() );
-    maxSaturationImage->Allocate();
-    maxSaturationImage->FillBuffer( 0 );
-    }
-
-  /////////////////////////////////////////////////////////////////
-
-  // Filter was configured to run until convergence. We need to delegate a different instance of the filter to run on each iteration.
-  // std::cout<<" Running filter until convergence .... "<<std::endl;
-
-  typename GrowCutSegmentationImageFilter< TInputImage, TOutputImage, TWeightPixelType >::Pointer
-    singleIteration =
-    GrowCutSegmentationImageFilter< TInputImage, TOutputImage, TWeightPixelType>::New();
-  // set up the singleIteration Filter.
-  singleIteration->RunOneIterationOn();
-  singleIteration->SetInputImage( this->GetInputImage());
-  singleIteration->SetLabelImage( this->GetLabelImage() );
-  singleIteration->SetStrengthImage (this->GetStrengthImage() );
-
-  if(m_SetStateImage)
+  if( m_SetDistancesImage)
     {
-    singleIteration->SetStateImage( this->GetStateImage() );
+    m_DistancesImage = static_cast< WeightImageType*> (this->ProcessObject::GetInput(4));
     }
   else
     {
-    singleIteration->SetStateImage(pixelStateImage);
+    m_DistancesImage = WeightImageType::New();
+    m_DistancesImage->CopyInformation( strengthInput );
+    m_DistancesImage->SetRegions( region );
+    m_DistancesImage->Allocate();
+    this->InitializeDistancesImage(const_cast< InputImageType*> (inputImage), m_DistancesImage);
     }
 
-  if(m_SetDistancesImage)
-    {
-    singleIteration->SetDistancesImage( this->GetDistancesImage() );
-    }
-  else
-    {
-    singleIteration->SetDistancesImage(maxDistancesImage);
-    }
-  if(m_SetMaxSaturationImage)
-    {
-    singleIteration->SetMaxSaturationImage( this->GetMaxSaturationImage() );
-    }
-  else
+  bool converged = false;
+  if( !m_SetStateImage)
     {
-    singleIteration->SetMaxSaturationImage(maxSaturationImage);
+    converged = this->ComputeRegionOfInterest();
     }
 
-  // std::cout<<" Setting other filter parameters ... "<<std::endl;
-  singleIteration->SetSeedStrength( this->GetSeedStrength());
-  singleIteration->SetMaxIterations( this->GetMaxIterations());
-  singleIteration->SetObjectRadius(this->GetObjectRadius() );
-
-  singleIteration->SetROIStart( this->GetROIStart() );
-  singleIteration->SetROIEnd( this->GetROIEnd() );
-
-  singleIteration->GetOutput()->SetBufferedRegion(
-    this->GetOutput()->GetBufferedRegion() );
-
-  // Create Progress Accumulator for tracking the progress
-  //ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-  //progress->SetMiniPipelineFilter( this );
-  //progress->RegisterInternalFilter( singleIterationFilter, 1.0f );
-
-  // run until convergence
-
-  unsigned int iter = 0;
-  //time_t startTime;
-  //time_t endTime;
-  time_t start;
-  time_t end;
-
-  unsigned int maxRadius = 0;
-
-  unsigned totalROIVolume = 1;
-
-  for (unsigned n = 0; n < ndims; n++)
+  // Lines are active in the first iteration if they contain labeled cells.
+  // When resuming from a given state image, the history is unknown, all
+  // lines are processed.
+  const SizeValueType lineLength = region.GetSize(0);
+  const SizeValueType numberOfLines = region.GetNumberOfPixels() / lineLength;
+  m_ActiveLines.assign(numberOfLines, 0);
+  m_NextActiveLines.assign(numberOfLines, 0);
+  const WeightPixelType* weights = m_WeightImage->GetBufferPointer();
+  for (SizeValueType line = 0; line < numberOfLines; ++line)
     {
-    //prevUnlabeledPix *= (m_roiEnd[n]-m_roiStart[n]);
-    totalROIVolume *= (m_RoiEnd[n]-m_RoiStart[n]);
-
-    if(n == 0)
+    if (m_SetStateImage)
       {
-      maxRadius = m_RoiEnd[n]-m_RoiStart[n];
+      m_ActiveLines[line] = 1;
+      continue;
       }
-    else if(maxRadius < (m_RoiEnd[n]-m_RoiStart[n]))
+    for (SizeValueType x = 0; x < lineLength; ++x)
       {
-      maxRadius = m_RoiEnd[n]-m_RoiStart[n];
+      if (weights[line * lineLength + x] > 0)
+        {
+        m_ActiveLines[line] = 1;
+        break;
+        }
       }
     }
 
-  maxRadius = static_cast< unsigned int>(std::ceil(maxRadius*0.5));
-
-  // float threshSaturation = .96; //.999; // Determine the saturation according to the size of the object
-  // float threshUnchanged = 0.05;
-  // float threshUnlabeledLimit = 0;
-
-  unsigned threshSaturation = 96; // .96*100
-  unsigned threshUnchanged = 5;
-
-  time(&start);
-
-  // set up the grow cut update filter here...
+  SizeValueType roiVolume = 1;
+  for (unsigned n = 0; n < OutputImageDimension; n++)
+    {
+    roiVolume *= static_cast< SizeValueType >(m_RoiEnd[n] - m_RoiStart[n] + 1);
+    }
 
-  unsigned prevModifiedPix = 0;
-  while (iter < m_MaxIterations && !converged)
+  // Run until no cell changes
+  const unsigned int maxIterations = m_RunOneIteration ? 1 : m_MaxIterations;
+  m_Labeled = 0;
+  m_LocallySaturated = 0;
+  m_Saturated = 0;
+  for (unsigned int iter = 0; iter < maxIterations && !converged; ++iter)
     {
-    //std::cout<<" running iteration ...... "<<iter<<std::endl;
-    singleIteration->Update();
-    //std::cout<<" DONE"<<std::endl;
+    this->RunIteration();
     iterate.CompletedStep();
 
-    // Check for convergence
-    //pixelStateImage = singleIteration->GetStateImage();
-
-    unsigned changeablePix =
-      singleIteration->GetLabeled();//updateFilter->GetNumLabeledPixels();
-    unsigned currLocallySaturatedPix =
-      singleIteration->GetLocallySaturated();//updateFilter->GetNumLocallySaturatedPixels();
-    unsigned currSaturatedPix =
-      singleIteration->GetSaturated();//updateFilter->GetNumSaturatedPixels();
-
-    unsigned unlabeled = (changeablePix + currLocallySaturatedPix + currSaturatedPix <= totalROIVolume) ?
-      (static_cast<unsigned > (totalROIVolume) -(currLocallySaturatedPix +
-                                                 currSaturatedPix + changeablePix)) : 0;
-
-    unsigned currModified = currLocallySaturatedPix + currSaturatedPix;
-
-    unsigned relUnlabeled = (unlabeled*100)/totalROIVolume;
-    unsigned relSaturated = ((currSaturatedPix+currLocallySaturatedPix)*100)/totalROIVolume;
-
-    // unsigned permodified = (currModified > prevModifiedPix) ?
-    //  ((currModified-prevModifiedPix)*100)/(std::max(static_cast<unsigned int>(1), std::max(currModified, prevModifiedPix))) :
-    //  ((prevModifiedPix - currModified)*100)/(std::max(static_cast<unsigned int>(1), std::max(currModified, prevModifiedPix)));
-
-    converged = (prevModifiedPix == currModified) ||
-      (relUnlabeled < threshUnchanged && relSaturated > threshSaturation);
-
-    // if((iter % 10 == 0) || converged)
-    //   {
-      // std::cout<<" ITER "<<iter<<std::endl;
-      // std::cout<<" saturated Pixels "<<currSaturatedPix<<"( "<<
-      //   totalROIVolume<<") %"<<currSaturatedPix/(float)totalROIVolume<<std::endl;
-      // std::cout<<" locally saturated Pixels "<<currLocallySaturatedPix<<" %"<<
-      //   currLocallySaturatedPix/(float)totalROIVolume<<std::endl;
-      // std::cout<<"Number of Labeled Pixels "<<changeablePix<<" %"<<
-      //   changeablePix/(float)totalROIVolume<<std::endl;
-      // std::cout<<"Curr Saturated "<<relSaturated<<" %"<<std::endl;
-      // std::cout<<" Prev Modified "<<prevModifiedPix<<" Curr Modified "<<currModified<<std::endl;
-      // std::cout<<"Unlabeled pixels "<<unlabeled<<" %"<<
-      //   relUnlabeled<<" Per modified "<<permodified<<std::endl;
-      // if(converged)
-      //   std::cout<<" converged...."<<std::endl;
-      // }
-
-    prevModifiedPix = currModified;
-    ++iter;
-    m_WeightImage = singleIteration->GetUpdatedStrengthImage();
-
-    if(!converged)
+    converged = (m_Labeled == 0);
+
+    const SizeValueType labeledCells = m_Labeled + m_LocallySaturated + m_Saturated;
+    this->UpdateProgress(std::min(1.0f, labeledCells / static_cast< float >(roiVolume)));
+    if (this->GetAbortGenerateData())
       {
-      // assign the old output as input
-      m_WeightImage->DisconnectPipeline();
-      //m_LabelImage->DisconnectPipeline();
-
-      singleIteration->SetStrengthImage(m_WeightImage);
-      //singleIteration->SetLabelImage(m_LabelImage);
-      singleIteration->GetOutput()->
-        SetBufferedRegion(output->GetBufferedRegion() );
+      break;
       }
-
-    this->UpdateProgress((currSaturatedPix+currLocallySaturatedPix)/(float)totalROIVolume);
     }
-
-
   this->UpdateProgress(1.0);
-  m_WeightImage = singleIteration->GetUpdatedStrengthImage();
-  m_LabelImage = singleIteration->GetOutput();
 
-  this->MaskSegmentedImageByWeight(m_ConfThresh);
+  // The distance image is large, keep it only if it is an input
+  m_DistancesImage = 0;
+  m_NextLabelImage = 0;
+  m_NextWeightImage = 0;
+  m_ActiveLines.clear();
+  m_NextActiveLines.clear();
 
-  this->GraftOutput(m_LabelImage);
-
-  time(&end);
-
-  std::vector< unsigned > labelVolumes;
-  std::vector< unsigned > physicalVolumes;
-
-  this->ComputeLabelVolumes(m_LabelImage, labelVolumes, physicalVolumes);
-
-  // std::cout<<"...................................................."<<std::endl;
-  // for (unsigned n = 0; n < labelVolumes.size(); n++)
-  //   {
-  //   std::cout<<" Object "<<n<<" volume "<<labelVolumes[n]<<" Physical Volume "<<
-  //     physicalVolumes[n]<<std::endl;
-  //   }
-
-  /*
-  typedef ImageFileWriter < OutputImageType > WriterType;
-  typename WriterType::Pointer writer = WriterType::New();
-
-  std::string outfilename = "segmented_img.mhd";
-  writer->SetFileName(outfilename.c_str());
-  writer->SetInput(m_LabelImage);
-  writer->Update();
-  */
-  // std::cout<<" Time taken for segmentation "<<iter<<
-  //   " : "<<difftime(end, start)<<" secs"<<std::endl;
+  if (!m_RunOneIteration)
+    {
+    this->MaskSegmentedImageByWeight(m_ConfThresh);
+    }
 
+  this->GraftOutput(m_LabelImage);
 }
 
+template <class TInputImage, class TOutputImage, class TWeightPixelType>
+void
+GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
+::RunIteration()
+{
+  const ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  m_ThreadLabeled.assign(numberOfThreads, 0);
+  m_ThreadLocallySaturated.assign(numberOfThreads, 0);
+  m_ThreadSaturated.assign(numberOfThreads, 0);
+
+  // Same as ImageSource::GenerateData without the reallocation of the output
+  typename Superclass::ThreadStruct str;
+  str.Filter = this;
+  this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  this->AfterThreadedGenerateData();
+
+  // The next buffers become the current ones
+  std::swap(m_LabelImage, m_NextLabelImage);
+  std::swap(m_WeightImage, m_NextWeightImage);
+  m_ActiveLines.swap(m_NextActiveLines);
+}
 
 template <class TInputImage, class TOutputImage, class TWeightPixelType>
 void GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
   ::ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread,
-                          ThreadIdType itkNotUsed(threadId))
+                          ThreadIdType threadId)
 {
-  // make a shallow copy of the image to break the pipeline from re-executing in each thread
-  typename InputImageType::Pointer inputImage = InputImageType::New();
-  inputImage->Graft( static_cast< InputImageType*>(this->ProcessObject::GetInput(0)));
-
-  typename OutputImageType::Pointer labelImage = OutputImageType::New();
-  labelImage->Graft(static_cast< OutputImageType*>(this->ProcessObject::GetInput(1)) );
-
-  typename WeightImageType::Pointer weightImage = WeightImageType::New();
-  weightImage->Graft(static_cast< WeightImageType*>(this->ProcessObject::GetInput(2)) );
-
-  typename OutputImageType::Pointer stateImage = OutputImageType::New();
-  stateImage->Graft(static_cast< OutputImageType*>(this->ProcessObject::GetInput(3)) );
-
-  typename WeightImageType::Pointer distanceImage = WeightImageType::New();
-  distanceImage->Graft(static_cast< WeightImageType*>(this->ProcessObject::GetInput(4)) );
-
-  typename WeightImageType::Pointer maxSaturationImage = WeightImageType::New();
-  maxSaturationImage->Graft(static_cast< WeightImageType*>(this->ProcessObject::GetInput(5)) );
-  //maxSaturationImage->Graft(m_MaxSaturationImage );
-
-  typename OutputImageType::Pointer outputImage = OutputImageType::New();
-  outputImage->Graft(this->GetOutput() );
-
-
-  //ProgressReporter progress(this, threadID, outputRegionForThread.GetNumberOfPixels());
-
-  //////////////////////////////////////////////////////////////////
-
-  typename OutputImageType::IndexType regionStart = outputRegionForThread.GetIndex();
-  typename OutputImageType::SizeType regionSize = outputRegionForThread.GetSize();
+  const unsigned int Dimension = OutputImageDimension;
 
-  //std::cout<<" region "<<regionStart[0]<<" "<<regionStart[1]<<" "<<regionStart[2]<<" "<<threadId<<std::endl;
-  //std::cout<<" region size "<<regionSize[0]<<" "<<regionSize[1]<<" "<<regionSize[2]<<" "<<threadId<<std::endl;
+  const OutputImageRegionType bufferedRegion = m_LabelImage->GetBufferedRegion();
+  const OutputIndexType bufferStart = bufferedRegion.GetIndex();
+  const OutputSizeType bufferSize = bufferedRegion.GetSize();
 
-  unsigned int Dimension = inputImage->GetImageDimension();
+  const InputPixelType* intensities = this->GetInput()->GetBufferPointer();
+  const WeightPixelType* distances = m_DistancesImage->GetBufferPointer();
+  const OutputPixelType* labels = m_LabelImage->GetBufferPointer();
+  const WeightPixelType* weights = m_WeightImage->GetBufferPointer();
+  OutputPixelType* nextLabels = m_NextLabelImage->GetBufferPointer();
+  WeightPixelType* nextWeights = m_NextWeightImage->GetBufferPointer();
 
-  // Extract the image regions corresponding to the seed and ROI defined by the radius
-  typename InputImageType::IndexType iIndex;
-  typename InputImageType::SizeType iSize;
-
-
-  for (unsigned d = 0; d < Dimension; d++)
+  OutputPixelType* states = 0;
+  if (m_SetStateImage)
     {
-    unsigned long int x = m_RoiEnd[d]-m_RoiStart[d]+1; // > 0 ? m_roiEnd[d]-m_roiStart[d] : 0;
-    iIndex[d] = m_RoiStart[d] > regionStart[d] ? m_RoiStart[d] : regionStart[d];
-    iSize[d] = x < regionSize[d] ? (x > 0 ? x : 1) : regionSize[d];
-
+    states = static_cast< OutputImageType*> (this->ProcessObject::GetInput(3))->GetBufferPointer();
     }
 
-  typedef typename InputImageType::RegionType  InputRegionType;
-  typedef typename OutputImageType::RegionType OutputRegionType;
-  typedef typename WeightImageType::RegionType WeightRegionType;
-
-  InputRegionType input;
-  input.SetIndex( iIndex );
-  input.SetSize( iSize );
-
-  OutputRegionType label;
-  label.SetIndex( iIndex);
-  label.SetSize( iSize);
-
-  WeightRegionType weight;
-  weight.SetIndex( iIndex);
-  weight.SetSize( iSize);
-
-  typedef ConstNeighborhoodIterator<InputImageType> InputIteratorType;
-  typedef typename InputIteratorType::RadiusType    InputRadiusType;
-
-  typedef NeighborhoodIterator<OutputImageType>  LabelIteratorType;
-  typedef typename LabelIteratorType::RadiusType LabelRadiusType;
-
-  typedef NeighborhoodIterator<WeightImageType>   WeightIteratorType;
-  typedef typename WeightIteratorType::RadiusType WeightRadiusType;
-
-
-  InputRadiusType radiusIn; //= static_cast< InputRadiusType >(m_Radius);
-  WeightRadiusType radiusWt; //= static_cast< WeightRadiusType >(m_Radius);
-  LabelRadiusType radiusLab; //= static_cast< LabelRadiusType >(m_Radius);
-  radiusIn.Fill(1);
-  radiusWt.Fill(1);
-  radiusLab.Fill(1);
-
-  ConstantBoundaryCondition<InputImageType> cbci;
-  cbci.SetConstant( NumericTraits< InputPixelType >::min(InputPixelType()) );
-
-  ConstantBoundaryCondition<OutputImageType> cbcl;
-  cbcl.SetConstant( NumericTraits< OutputPixelType >::min(OutputPixelType()) );
-
-  ConstantBoundaryCondition<WeightImageType> cbcw;
-  cbcw.SetConstant( NumericTraits< WeightPixelType >::min(WeightPixelType()) );
-
-
-  InputPixelType minI = NumericTraits< InputPixelType > ::min(InputPixelType());
-  WeightPixelType minW = NumericTraits< WeightPixelType > ::min(WeightPixelType());
-
-  /////////////////////////////////////////////////////////////////////////////////////////
-
-  // Boundary Faces Calculator
-  typedef typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< InputImageType > FaceCalculatorType;
-  FaceCalculatorType faceCalculator;
-  typename FaceCalculatorType::FaceListType faceList;
-
-  faceList = faceCalculator( inputImage, input, radiusIn);
-
-  // FaceList Iterators
-  typename FaceCalculatorType::FaceListType::iterator fitIn;
-
-  //std::cout<<" number faces "<<faceList.size()<<std::endl;
-  //bool first = true;
-  for( fitIn = faceList.begin(); fitIn != faceList.end(); ++fitIn)
+  // Strides of the dimensions in pixels and in lines
+  OffsetValueType pixelStrides[Dimension];
+  OffsetValueType lineStrides[Dimension];
+  pixelStrides[0] = 1;
+  lineStrides[0] = 0;
+  for (unsigned int d = 1; d < Dimension; ++d)
     {
+    pixelStrides[d] = pixelStrides[d - 1] * static_cast< OffsetValueType >(bufferSize[d - 1]);
+    lineStrides[d] = pixelStrides[d] / static_cast< OffsetValueType >(bufferSize[0]);
+    }
 
-    //fitIn->Print(std::cout);
-    //first = true;
-
-    InputIteratorType inputIt; //(radiusIn, inputImage,input);
-
-    LabelIteratorType oldLabelIt; //(radiusLab, labelImage, label);
-
-    typedef ImageRegionIterator< OutputImageType > IteratorOut; // newLabelIt(this->GetOutput(), label);
-
-    IteratorOut newLabelIt;
-
-    WeightIteratorType oldWeightIt; //(radiusWt, weightImage, weight);
-
-    typedef ImageRegionIterator< WeightImageType > IteratorWeight; //newWeightIt(m_WeightImage, weight);
-
-    IteratorWeight newWeightIt;
-    IteratorWeight distancesIt;
-
-    WeightIteratorType maxSatIt;
-    LabelIteratorType stateIt;
-
-
-    inputIt = InputIteratorType(radiusIn, inputImage, *fitIn);
-
-    //oldLabelIt = LabelIteratorType(radiusLab, labelImage, *fitIn);
-
-    oldLabelIt = LabelIteratorType(radiusLab, m_LabelImage, *fitIn);
-
-    oldWeightIt = WeightIteratorType(radiusWt, weightImage, *fitIn);
-
-    maxSatIt = WeightIteratorType(radiusWt, maxSaturationImage, *fitIn);
-
-    stateIt = LabelIteratorType(radiusLab, stateImage, *fitIn);
-
-
-    inputIt.OverrideBoundaryCondition( &cbci );
-    oldLabelIt.OverrideBoundaryCondition( &cbcl );
-    stateIt.OverrideBoundaryCondition( &cbcl );
-    oldWeightIt.OverrideBoundaryCondition( &cbcw );
-    maxSatIt.OverrideBoundaryCondition( &cbcw );
-
-    newLabelIt = IteratorOut(outputImage, *fitIn);
-    newWeightIt = IteratorWeight(m_WeightImage, *fitIn);
-    distancesIt = IteratorWeight(distanceImage, *fitIn);
-
-
-    inputIt.GoToBegin(); oldLabelIt.GoToBegin(); newLabelIt.GoToBegin();
-    oldWeightIt.GoToBegin(); newWeightIt.GoToBegin(); stateIt.GoToBegin();
-    //newstateIt.GoToBegin();
-    distancesIt.GoToBegin(); maxSatIt.GoToBegin();
-
-    for (; !inputIt.IsAtEnd(); ++inputIt, ++oldLabelIt,
-           ++newLabelIt, ++oldWeightIt, ++newWeightIt,
-           ++stateIt, ++distancesIt, ++maxSatIt) // ++newstateIt;
+  // All the offsets of the 3x3x... neighborhood except the center
+  std::vector< Offset<Dimension> > neighborhood;
+  Offset<Dimension> offset;
+  offset.Fill(-1);
+  for (;;)
+    {
+    bool isCenter = true;
+    for (unsigned int d = 0; d < Dimension; ++d)
       {
+      isCenter = isCenter && offset[d] == 0;
+      }
+    if (!isCenter)
+      {
+      neighborhood.push_back(offset);
+      }
+    unsigned int d = 0;
+    for (; d < Dimension && ++offset[d] > 1; ++d)
+      {
+      offset[d] = -1;
+      }
+    if (d == Dimension)
+      {
+      break;
+      }
+    }
 
-      OutputPixelType s_center = stateIt.GetCenterPixel();
-      OutputPixelType l_center = oldLabelIt.GetCenterPixel();
-      WeightPixelType w_center = oldWeightIt.GetCenterPixel();
-
-      if(s_center == SATURATED)
+  // Neighbors of the cells of the current line, with their shift along the
+  // line to check the line bounds
+  std::vector< std::pair< OffsetValueType, OffsetValueType > > neighbors;
+  neighbors.reserve(neighborhood.size());
+
+  const IndexValueType bufferFirstX = bufferStart[0];
+  const IndexValueType bufferLastX = bufferStart[0] + static_cast< IndexValueType >(bufferSize[0]) - 1;
+  const IndexValueType regionFirstX = outputRegionForThread.GetIndex(0);
+  const SizeValueType lineLength = outputRegionForThread.GetSize(0);
+  const IndexValueType roiFirstX = std::max(regionFirstX, m_RoiStart[0]);
+  const IndexValueType roiLastX = std::min(
+    regionFirstX + static_cast< IndexValueType >(lineLength) - 1, m_RoiEnd[0]);
+
+  SizeValueType labeled = 0;
+  SizeValueType locallySaturated = 0;
+  SizeValueType saturated = 0;
+
+  OutputIndexType index = outputRegionForThread.GetIndex();
+  const SizeValueType numberOfLines = outputRegionForThread.GetNumberOfPixels() / lineLength;
+  for (SizeValueType line = 0; line < numberOfLines; ++line)
+    {
+    OffsetValueType lineIndex = 0;
+    bool insideROI = true;
+    for (unsigned int d = 1; d < Dimension; ++d)
+      {
+      lineIndex += (index[d] - bufferStart[d]) * lineStrides[d];
+      insideROI = insideROI && index[d] >= m_RoiStart[d] && index[d] <= m_RoiEnd[d];
+      }
+    const OffsetValueType lineStart =
+      lineIndex * static_cast< OffsetValueType >(bufferSize[0]) + (regionFirstX - bufferFirstX);
+
+    // Find the neighbors that are in the image, and whether one of the
+    // neighboring lines changed in the previous iteration
+    bool active = insideROI && m_ActiveLines[lineIndex];
+    neighbors.clear();
+    for (typename std::vector< Offset<Dimension> >::const_iterator it = neighborhood.begin();
+         insideROI && it != neighborhood.end(); ++it)
+      {
+      bool inside = true;
+      OffsetValueType neighborLine = lineIndex;
+      OffsetValueType neighborOffset = (*it)[0];
+      for (unsigned int d = 1; d < Dimension && inside; ++d)
+        {
+        const IndexValueType neighborIndex = index[d] + (*it)[d];
+        inside = neighborIndex >= bufferStart[d]
+          && neighborIndex < bufferStart[d] + static_cast< IndexValueType >(bufferSize[d]);
+        neighborLine += (*it)[d] * lineStrides[d];
+        neighborOffset += (*it)[d] * pixelStrides[d];
+        }
+      if (!inside)
         {
-        //newstateIt.Set(s_center);
-        newLabelIt.Set(l_center);
-        newWeightIt.Set(w_center);
         continue;
         }
+      neighbors.push_back(std::make_pair((*it)[0], neighborOffset));
+      active = active || m_ActiveLines[neighborLine];
+      }
 
-      InputPixelType f_center = inputIt.GetCenterPixel();
-
-      OutputPixelType winnerLabel = l_center;
-      WeightPixelType winnerWeight = w_center;
-
-      WeightPixelType maxDist = distancesIt.Get();
-
-      unsigned int countSaturatedLinks = 0;
-      unsigned int countLocalSaturatedLinks = 0;
-
-      bool modified = false;
-      WeightPixelType maxWt = 0.0;
-
-      unsigned int nlinks = 0;
+    bool lineChanged = false;
+    for (SizeValueType i = 0; i < lineLength; ++i)
+      {
+      const OffsetValueType p = lineStart + static_cast< OffsetValueType >(i);
+      const IndexValueType x = regionFirstX + static_cast< IndexValueType >(i);
+      const OutputPixelType label = labels[p];
+      const WeightPixelType weight = weights[p];
 
-      for (unsigned k = 0; k < inputIt.Size(); k++)
+      if (!active || x < roiFirstX || x > roiLastX)
         {
-
-        InputPixelType f = inputIt.GetPixel(k);
-        WeightPixelType w = oldWeightIt.GetPixel(k);
-
-
-        if(f == minI && w == minW)
-          {
-          continue;
-          }
-
-        OutputPixelType s = stateIt.GetPixel(k);
-        OutputPixelType l = oldLabelIt.GetPixel(k);
-
-
-        ++nlinks;
-
-        WeightPixelType attackWeight = (f_center - f)*(f_center - f);
-        attackWeight = (maxDist > 0) ? (1.0 - attackWeight/maxDist) : 1.0;
-
-
-        WeightPixelType maxAttackWeight = 0.0; // attackWeight*maxSatIt.GetPixel(k);
-        WeightPixelType msat = maxSatIt.GetPixel(k);
-
-        maxAttackWeight = (s == UNLABELED) ? 0.0 :
-          ((msat == 0.0) ? (attackWeight * this->GetSeedStrength()) :
-           ((s == SATURATED) ? attackWeight * w : attackWeight*msat ) );
-
-        attackWeight *= w;
-
-        maxWt = (maxWt < maxAttackWeight) ? maxAttackWeight : maxWt;
-
-
-        if(s_center != UNLABELED)
+        // converged or outside of the ROI, keep the cell as is
+        nextLabels[p] = label;
+        nextWeights[p] = weight;
+        if (weight > 0)
           {
-          countSaturatedLinks += (maxAttackWeight <= w_center) ? 1 : 0;
-          countLocalSaturatedLinks += (attackWeight <= w_center) ? 1 : 0;
+          ++saturated;
           }
-
-        if(s != UNLABELED && attackWeight > winnerWeight)
+        if (states)
           {
-
-          winnerWeight = attackWeight;
-          winnerLabel = l;
-          modified = true;
-
-          stateIt.SetCenterPixel(LABELED);
-          //newstateIt.Set(LABELED);
+          states[p] = static_cast< OutputPixelType >(weight > 0 ? SATURATED : UNLABELED);
           }
+        continue;
         }
 
-      if(nlinks > 0)
+      const WeightPixelType center = static_cast< WeightPixelType >(intensities[p]);
+      const WeightPixelType maxDistance = distances[p];
+      OutputPixelType winnerLabel = label;
+      WeightPixelType winnerWeight = weight;
+      for (typename std::vector< std::pair< OffsetValueType, OffsetValueType > >::const_iterator
+           it = neighbors.begin(); it != neighbors.end(); ++it)
         {
-        if(countSaturatedLinks == nlinks && winnerLabel != m_UnknownLabel)
+        const IndexValueType neighborX = x + it->first;
+        if (neighborX < bufferFirstX || neighborX > bufferLastX)
           {
-          stateIt.SetCenterPixel(SATURATED);
+          continue;
           }
-        else{
-        if (countLocalSaturatedLinks == nlinks && winnerLabel != m_UnknownLabel)
+        const OffsetValueType q = p + it->second;
+        const WeightPixelType neighborWeight = weights[q];
+        // the attack is at most as strong as the attacker
+        if (neighborWeight <= winnerWeight)
           {
-          stateIt.SetCenterPixel(LOCALLY_SATURATED);
+          continue;
           }
-        else if (stateIt.GetCenterPixel() != UNLABELED && !modified)
+        const WeightPixelType difference = center - static_cast< WeightPixelType >(intensities[q]);
+        const WeightPixelType attackWeight = neighborWeight *
+          ((maxDistance > 0) ? (1.0 - difference * difference / maxDistance) : 1.0);
+        if (attackWeight > winnerWeight)
           {
-          stateIt.SetCenterPixel(LOCALLY_SATURATED);
+          winnerWeight = attackWeight;
+          winnerLabel = labels[q];
           }
         }
+
+      nextLabels[p] = winnerLabel;
+      nextWeights[p] = winnerWeight;
+      PixelState state = UNLABELED;
+      if (winnerWeight != weight)
+        {
+        lineChanged = true;
+        ++labeled;
+        state = LABELED;
+        }
+      else if (weight > 0)
+        {
+        ++locallySaturated;
+        state = LOCALLY_SATURATED;
+        }
+      if (states)
+        {
+        states[p] = static_cast< OutputPixelType >(state);
         }
+      }
+    m_NextActiveLines[lineIndex] = lineChanged ? 1 : 0;
 
-      //if(nlinks > 0 && countSaturatedLinks == nlinks && winnerLabel != m_UnknownLabel)
-      // {
-      //   stateIt.SetCenterPixel(SATURATED);
-      //   //newstateIt.Set(SATURATED);
-      // }
-      //else if((winnerLabel != m_UnknownLabel) &&
-      //    ((nlinks > 0) &&
-//       (countLocalSaturatedLinks == nlinks)) ||
-//      ((stateIt.GetCenterPixel() != UNLABELED) &&
-//       !modified))
-//      {
-//        stateIt.SetCenterPixel(LOCALLY_SATURATED);
-//        //newstateIt.Set(LOCALLY_SATURATED);
-//      }
-
-      maxSatIt.SetCenterPixel(maxWt);
-      newLabelIt.Set(winnerLabel);
-      newWeightIt.Set(winnerWeight);
+    // Next line of the region
+    for (unsigned int d = 1; d < Dimension; ++d)
+      {
+      if (++index[d] < outputRegionForThread.GetIndex(d)
+          + static_cast< IndexValueType >(outputRegionForThread.GetSize(d)))
+        {
+        break;
+        }
+      index[d] = outputRegionForThread.GetIndex(d);
       }
     }
 
-  //std::cout<<" done in thread "<<threadId<<std::endl;
-  //time(&end);
-  //std::cout<<" time for grow cut update "<<difftime(end,start)<<std::endl;
-
+  m_ThreadLabeled[threadId] = labeled;
+  m_ThreadLocallySaturated[threadId] = locallySaturated;
+  m_ThreadSaturated[threadId] = saturated;
 }
 
 
@@ -1057,29 +729,11 @@ GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
   m_Labeled = 0;
   m_LocallySaturated = 0;
   m_Saturated = 0;
-
-  typename OutputImageType::Pointer stateImage = OutputImageType::New();
-  stateImage->Graft(static_cast< OutputImageType*>(this->ProcessObject::GetInput(3)) );
-
-  ImageRegionIterator< OutputImageType > state(stateImage, stateImage->GetBufferedRegion());
-  ImageRegionIterator< WeightImageType > weight(m_WeightImage, m_WeightImage->GetBufferedRegion());
-
-
-  for(state.GoToBegin(), weight.GoToBegin(); !state.IsAtEnd(); ++state, ++weight)
+  for (size_t threadId = 0; threadId < m_ThreadLabeled.size(); ++threadId)
     {
-    if(state.Get() == LABELED)
-      {
-      ++m_Labeled;
-      }
-    if(state.Get() == LOCALLY_SATURATED && weight.Get() >= m_ConfThresh)
-      {
-      ++m_LocallySaturated;
-      }
-    if(state.Get() == SATURATED && weight.Get() > m_ConfThresh)
-      {
-      ++m_Saturated;
-      }
-
+    m_Labeled += m_ThreadLabeled[threadId];
+    m_LocallySaturated += m_ThreadLocallySaturated[threadId];
+    m_Saturated += m_ThreadSaturated[threadId];
     }
 }
 
@@ -72,6 +72,7 @@ vtkITKArchetypeImageSeriesReader::vtkITKArchetypeImageSeriesReader()
 #ifdef VTKITK_BUILD_DICOM_SUPPORT
   this->SetDICOMImageIOApproachToGDCM();
 #endif
+  this->ParallelDecode = true;
 
   this->OutputScalarType = VTK_FLOAT;
   this->NumberOfComponents = 0;
@@ -179,6 +180,8 @@ void vtkITKArchetypeImageSeriesReader::PrintSelf(ostream& os, vtkIndent indent)
 #else
   os << indent << "DICOMImageIOApproach: " << "NA";
 #endif
+  os << "\n";
+  os << indent << "ParallelDecode: " << this->ParallelDecode << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -246,6 +246,17 @@ public:
   vtkSetMacro(AnalyzeHeader, bool);
   vtkGetMacro(AnalyzeHeader, bool);
 
+  ///
+  /// Whether the files of a DICOM series (one slice per file) are read and
+  /// decoded concurrently, directly into the output buffer. Decoding of
+  /// compressed slices (JPEG, JPEG2000, JPEG-LS...) then no longer limits
+  /// the loading time of large series. Only supported by the GDCM image IO,
+  /// series that can't be read this way are read slice by slice.
+  /// On by default.
+  vtkSetMacro(ParallelDecode, bool);
+  vtkGetMacro(ParallelDecode, bool);
+  vtkBooleanMacro(ParallelDecode, bool);
+
   ///
   /// Whether to use orientation from file
   vtkSetMacro(UseOrientationFromFile, int);
@@ -837,6 +848,7 @@ protected:
   bool UseNativeOrigin;
 
   int DICOMImageIOApproach;
+  bool ParallelDecode;
 
   bool GroupingByTags;
   int SelectedUID;
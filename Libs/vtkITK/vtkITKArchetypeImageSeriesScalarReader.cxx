@@ -28,13 +28,21 @@
 #include <vtkVersion.h>
 
 // ITK includes
-#include <itkOrientImageFilter.h>
+#include <itkImageFileReader.h>
 #include <itkImageSeriesReader.h>
+#include <itkMultiThreader.h>
+#include <itkOrientImageFilter.h>
+#include <itkSimpleFastMutexLock.h>
 #ifdef VTKITK_BUILD_DICOM_SUPPORT
 #include <itkDCMTKImageIO.h>
 #include <itkGDCMImageIO.h>
 #endif
 
+// STD includes
+#include <algorithm>
+#include <string>
+#include <vector>
+
 vtkStandardNewMacro(vtkITKArchetypeImageSeriesScalarReader);
 
 namespace {
@@ -45,6 +53,158 @@ vtkAOSDataArrayTemplate<T>* DownCast(vtkAbstractArray* a)
   return vtkAOSDataArrayTemplate<T>::FastDownCast(a);
 }
 
+//----------------------------------------------------------------------------
+// State shared by the threads decoding the slices of a series
+template <class TImage>
+struct ParallelDecodeInfo
+{
+  vtkAlgorithm* Algorithm;
+  const std::vector<std::string>* FileNames;
+  itk::ImageIOBase* ImageIO;
+  TImage* Image;
+  itk::SimpleFastMutexLock Lock;
+  itk::SizeValueType NextSlice;
+  itk::SizeValueType NumberOfDecodedSlices;
+  std::string ErrorMessage;
+};
+
+//----------------------------------------------------------------------------
+// Threads pick the next slice to decode until all slices are decoded, so that
+// files are read roughly in order and slow slices don't stall other threads.
+template <class TImage>
+ITK_THREAD_RETURN_TYPE DecodeSlicesThreaderCallback(void* arg)
+{
+  itk::MultiThreader::ThreadInfoStruct* threadInfo =
+    static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+  ParallelDecodeInfo<TImage>* info =
+    static_cast<ParallelDecodeInfo<TImage>*>(threadInfo->UserData);
+
+  // Image IOs keep the state of the file being read, each thread needs its own
+  itk::ImageIOBase::Pointer imageIO =
+    dynamic_cast<itk::ImageIOBase*>(info->ImageIO->CreateAnother().GetPointer());
+  typename TImage::SizeType size = info->Image->GetLargestPossibleRegion().GetSize();
+  itk::SizeValueType sliceSize = size[0] * size[1];
+
+  while (imageIO)
+    {
+    info->Lock.Lock();
+    bool failed = !info->ErrorMessage.empty();
+    itk::SizeValueType slice = info->NextSlice++;
+    info->Lock.Unlock();
+    if (failed || slice >= size[2])
+      {
+      break;
+      }
+    try
+      {
+      typename itk::ImageFileReader<TImage>::Pointer sliceReader =
+        itk::ImageFileReader<TImage>::New();
+      sliceReader->SetImageIO(imageIO);
+      sliceReader->SetFileName((*info->FileNames)[slice]);
+      sliceReader->Update();
+      TImage* sliceImage = sliceReader->GetOutput();
+      typename TImage::SizeType sliceImageSize = sliceImage->GetBufferedRegion().GetSize();
+      if (sliceImageSize[0] != size[0] || sliceImageSize[1] != size[1] || sliceImageSize[2] != 1)
+        {
+        itkGenericExceptionMacro(<< "Size of " << (*info->FileNames)[slice]
+                                 << " doesn't match the size of the series");
+        }
+      std::copy(sliceImage->GetBufferPointer(), sliceImage->GetBufferPointer() + sliceSize,
+                info->Image->GetBufferPointer() + slice * sliceSize);
+      }
+    catch (itk::ExceptionObject& e)
+      {
+      info->Lock.Lock();
+      if (info->ErrorMessage.empty())
+        {
+        info->ErrorMessage = e.what();
+        }
+      info->Lock.Unlock();
+      break;
+      }
+    // Exceptions must not escape the thread, that would terminate the application
+    catch (std::exception& e)
+      {
+      info->Lock.Lock();
+      if (info->ErrorMessage.empty())
+        {
+        info->ErrorMessage = e.what();
+        }
+      info->Lock.Unlock();
+      break;
+      }
+    catch (...)
+      {
+      info->Lock.Lock();
+      if (info->ErrorMessage.empty())
+        {
+        info->ErrorMessage = "Unknown error while reading " + (*info->FileNames)[slice];
+        }
+      info->Lock.Unlock();
+      break;
+      }
+    info->Lock.Lock();
+    itk::SizeValueType numberOfDecodedSlices = ++info->NumberOfDecodedSlices;
+    info->Lock.Unlock();
+    // Thread 0 is the calling thread, the only one allowed to invoke events
+    if (threadInfo->ThreadID == 0)
+      {
+      info->Algorithm->UpdateProgress(
+        static_cast<double>(numberOfDecodedSlices) / size[2]);
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// Read the files of a series concurrently into a preallocated image.
+// The geometry of the image is computed from the file headers by the series
+// reader. Returns a null pointer if the series doesn't have one slice per
+// file (e.g. multi-frame files), in which case the series reader must be used.
+template <class TImage>
+typename TImage::Pointer ReadSeriesInParallel(vtkAlgorithm* algorithm,
+                                              itk::ImageSeriesReader<TImage>* seriesReader,
+                                              itk::ImageIOBase* imageIO)
+{
+  seriesReader->UpdateOutputInformation();
+  TImage* seriesImage = seriesReader->GetOutput();
+  const std::vector<std::string>& fileNames = seriesReader->GetFileNames();
+  if (seriesImage->GetLargestPossibleRegion().GetSize()[2] != fileNames.size())
+    {
+    return 0;
+    }
+
+  typename TImage::Pointer image = TImage::New();
+  image->CopyInformation(seriesImage);
+  image->SetRegions(seriesImage->GetLargestPossibleRegion());
+  image->Allocate();
+
+  ParallelDecodeInfo<TImage> info;
+  info.Algorithm = algorithm;
+  info.FileNames = &fileNames;
+  info.ImageIO = imageIO;
+  info.Image = image;
+  info.NextSlice = 0;
+  info.NumberOfDecodedSlices = 0;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(static_cast<itk::ThreadIdType>(std::min<size_t>(
+    threader->GetNumberOfThreads(), fileNames.size())));
+  threader->SetSingleMethod(&DecodeSlicesThreaderCallback<TImage>, &info);
+  threader->SingleMethodExecute();
+  if (!info.ErrorMessage.empty())
+    {
+    itkGenericExceptionMacro(<< info.ErrorMessage);
+    }
+  if (info.NumberOfDecodedSlices != fileNames.size())
+    {
+    itkGenericExceptionMacro(<< "Failed to decode " << fileNames.size() - info.NumberOfDecodedSlices
+                             << " slices of the series");
+    }
+  algorithm->UpdateProgress(1.0);
+  return image;
+}
+
 };
 
 //----------------------------------------------------------------------------
@@ -136,23 +296,44 @@ int vtkITKArchetypeImageSeriesScalarReader::RequestData(
       reader##typeN->AddObserver(itk::ProgressEvent(),pcl); \
       reader##typeN->SetFileNames(this->FileNames); \
       reader##typeN->ReleaseDataFlagOn(); \
+      image##typeN::Pointer decoded##typeN; \
+      if (this->ParallelDecode && this->ArchetypeIsDICOM && imageIO.IsNotNull() && \
+          this->DICOMImageIOApproach == vtkITKArchetypeImageSeriesReader::GDCM) \
+        { \
+        decoded##typeN = ReadSeriesInParallel<image##typeN>(this, reader##typeN, imageIO); \
+        } \
+      image##typeN::Pointer output##typeN = decoded##typeN; \
       if (this->UseNativeCoordinateOrientation) \
         { \
-        filter = reader##typeN; \
+        if (decoded##typeN.IsNull()) \
+          { \
+          filter = reader##typeN; \
+          } \
         } \
       else \
         { \
         itk::OrientImageFilter<image##typeN,image##typeN>::Pointer orient##typeN = \
             itk::OrientImageFilter<image##typeN,image##typeN>::New(); \
         if (this->Debug) {orient##typeN->DebugOn();} \
-        orient##typeN->SetInput(reader##typeN->GetOutput()); \
+        if (decoded##typeN.IsNotNull()) \
+          { \
+          orient##typeN->SetInput(decoded##typeN); \
+          } \
+        else \
+          { \
+          orient##typeN->SetInput(reader##typeN->GetOutput()); \
+          } \
         orient##typeN->UseImageDirectionOn(); \
         orient##typeN->SetDesiredCoordinateOrientation(this->DesiredCoordinateOrientation); \
         filter = orient##typeN; \
         }\
-      filter->UpdateLargestPossibleRegion(); \
+      if (filter.IsNotNull()) \
+        { \
+        filter->UpdateLargestPossibleRegion(); \
+        output##typeN = filter->GetOutput(); \
+        } \
       itk::ImportImageContainer<itk::SizeValueType, type>::Pointer PixelContainer##typeN;\
-      PixelContainer##typeN = filter->GetOutput()->GetPixelContainer();\
+      PixelContainer##typeN = output##typeN->GetPixelContainer();\
       void *ptr = static_cast<void *> (PixelContainer##typeN->GetBufferPointer());\
       DownCast<type>(data->GetPointData()->GetScalars())                \
         ->SetVoidArray(ptr, PixelContainer##typeN->Size(), 0,\
@@ -1,4 +1,7 @@
+#include "itkBSplineControlPointImageFilter.h"
 #include "itkConstantPadImageFilter.h"
+#include "itkDivideImageFilter.h"
+#include "itkExpImageFilter.h"
 #include "itkExtractImageFilter.h"
 #include "itkImageFileWriter.h"
 #include "itkN4BiasFieldCorrectionImageFilter.h"
@@ -6,6 +9,7 @@
 #include "itkShrinkImageFilter.h"
 
 #include "N4ITKBiasFieldCorrectionCLP.h"
+#include "itkPluginPartialOutputWriter.h"
 #include "itkPluginUtilities.h"
 
 namespace
@@ -14,6 +18,7 @@ namespace
 typedef float RealType;
 const int ImageDimension = 3;
 typedef itk::Image<RealType, ImageDimension> ImageType;
+typedef itk::PluginPartialOutputWriter<ImageType> PartialOutputWriterType;
 
 template <class TFilter>
 class CommandIterationUpdate : public itk::Command
@@ -26,9 +31,17 @@ public:
 protected:
   CommandIterationUpdate()
   {
+    this->m_PartialOutputWriter = 0;
   };
 public:
 
+  /** Publish the image corrected with the current bias field estimate
+   * after each iteration. */
+  void SetPartialOutputWriter(PartialOutputWriterType* writer)
+  {
+    this->m_PartialOutputWriter = writer;
+  }
+
   void Execute(itk::Object *caller, const itk::EventObject & event) ITK_OVERRIDE
   {
     Execute( (const itk::Object *) caller, event);
@@ -44,8 +57,62 @@ public:
       return;
       }
     std::cout << "Progress: " << filter->GetProgress() << std::endl;
+
+    if( this->m_PartialOutputWriter && this->m_PartialOutputWriter->IsReady() )
+      {
+      this->m_PartialOutputWriter->Write( CorrectImage( filter ) );
+      }
+  }
+
+protected:
+  /** Divide the (shrunk) input of the filter by the bias field
+   * estimated so far. */
+  static ImageType::Pointer CorrectImage(const TFilter * filter)
+  {
+    const ImageType * input = filter->GetInput();
+    if( !input || !filter->GetLogBiasFieldControlPointLattice() )
+      {
+      return NULL;
+      }
+
+    typedef itk::BSplineControlPointImageFilter<
+      typename TFilter::BiasFieldControlPointLatticeType,
+      typename TFilter::ScalarImageType> BSplinerType;
+    typename BSplinerType::Pointer bspliner = BSplinerType::New();
+    bspliner->SetInput( filter->GetLogBiasFieldControlPointLattice() );
+    bspliner->SetSplineOrder( filter->GetSplineOrder() );
+    bspliner->SetSize( input->GetLargestPossibleRegion().GetSize() );
+    bspliner->SetOrigin( input->GetOrigin() );
+    bspliner->SetDirection( input->GetDirection() );
+    bspliner->SetSpacing( input->GetSpacing() );
+    bspliner->Update();
+
+    ImageType::Pointer logField = ImageType::New();
+    logField->CopyInformation( input );
+    logField->SetRegions( input->GetLargestPossibleRegion() );
+    logField->Allocate();
+    itk::ImageRegionIterator<typename TFilter::ScalarImageType> IB(
+      bspliner->GetOutput(), bspliner->GetOutput()->GetLargestPossibleRegion() );
+    itk::ImageRegionIterator<ImageType> IF( logField,
+                                            logField->GetLargestPossibleRegion() );
+    for( IB.GoToBegin(), IF.GoToBegin(); !IB.IsAtEnd(); ++IB, ++IF )
+      {
+      IF.Set( IB.Get()[0] );
+      }
+
+    typedef itk::ExpImageFilter<ImageType, ImageType> ExpFilterType;
+    ExpFilterType::Pointer expFilter = ExpFilterType::New();
+    expFilter->SetInput( logField );
+
+    typedef itk::DivideImageFilter<ImageType, ImageType, ImageType> DividerType;
+    DividerType::Pointer divider = DividerType::New();
+    divider->SetInput1( input );
+    divider->SetInput2( expFilter->GetOutput() );
+    divider->Update();
+    return divider->GetOutput();
   }
 
+  PartialOutputWriterType* m_PartialOutputWriter;
 };
 
 int SaveIt(ImageType::Pointer img, const char* fname)
@@ -274,6 +341,10 @@ int main(int argc, char* * argv)
   CommandType::Pointer observer = CommandType::New();
   correcter->AddObserver( itk::IterationEvent(), observer );
 
+  // Show the image corrected at the shrunk resolution while iterating
+  PartialOutputWriterType partialOutputWriter( outputImageName, CLPProcessInformation );
+  observer->SetPartialOutputWriter( &partialOutputWriter );
+
   /**
    * histogram sharpening options
    */
@@ -108,6 +108,8 @@ void qSlicerDataModuleWidget::enter()
 {
   Q_D(qSlicerDataModuleWidget);
 
+  this->updateSubjectHierarchyTreeModel();
+
   // Trigger showing the subject hierarchy context menu hint
   this->onCurrentTabChanged(d->ViewTabWidget->currentIndex());
 
@@ -263,12 +265,29 @@ void qSlicerDataModuleWidget::setMRMLScene(vtkMRMLScene* scene)
 {
   Q_D(qSlicerDataModuleWidget);
 
+  this->qvtkReconnect(this->mrmlScene(), scene, vtkMRMLScene::EndImportEvent,
+                      this, SLOT(updateSubjectHierarchyTreeModel()));
+  this->qvtkReconnect(this->mrmlScene(), scene, vtkMRMLScene::EndCloseEvent,
+                      this, SLOT(updateSubjectHierarchyTreeModel()));
+
   Superclass::setMRMLScene(scene);
 
   this->setMRMLIDsVisible(d->SubjectHierarchyDisplayDataNodeIDsCheckBox->isChecked());
   this->setTransformsVisible(d->SubjectHierarchyDisplayTransformsCheckBox->isChecked());
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerDataModuleWidget::updateSubjectHierarchyTreeModel()
+{
+  Q_D(qSlicerDataModuleWidget);
+
+  // The name filter, drag&drop and transform editing are not available in the lazy tree
+  vtkMRMLSubjectHierarchyNode* shNode = d->SubjectHierarchyTreeView->subjectHierarchyNode();
+  int threshold = qSlicerSubjectHierarchyPluginHandler::instance()->lazyModelItemCountThreshold();
+  d->SubjectHierarchyTreeView->setUseLazyModel(
+    shNode && threshold > 0 && shNode->GetNumberOfItems() > threshold );
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerDataModuleWidget::setMRMLIDsVisible(bool visible)
 {
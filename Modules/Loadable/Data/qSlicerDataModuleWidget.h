@@ -81,6 +81,10 @@ protected slots:
   void onCurrentTabChanged(int tabIndex);
   void onHelpButtonClicked();
 
+  /// Populate the subject hierarchy tree lazily if the hierarchy has more items than
+  /// \sa qSlicerSubjectHierarchyPluginHandler::lazyModelItemCountThreshold
+  void updateSubjectHierarchyTreeModel();
+
   void showContextMenuHint();
 
 protected:
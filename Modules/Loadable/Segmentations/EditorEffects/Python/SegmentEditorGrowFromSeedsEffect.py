@@ -41,11 +41,57 @@ Paint or other effects and add more seeds in the misclassified region. Full segm
 updated automatically within a few seconds</li>
 <li>Click <dfn>Apply</dfn> to update segmentation with the previewed result.</li>
 </ul><p>
+Enable <dfn>Crop to seeds</dfn> to only segment the region around the seeds, which is faster on large volumes.
+Voxels farther from the seeds than the margin are left empty.<p>
 Masking settings are bypassed. If segments overlap, segment higher in the segments table will have priority.
 The effect uses <a href="https://www.spl.harvard.edu/publications/item/view/2761">fast grow-cut method</a>.
 <p></html>"""
 
 
+  def setupOptionsFrame(self):
+    self.cropToSeedsCheckBox = qt.QCheckBox("Crop to seeds")
+    self.cropToSeedsCheckBox.setToolTip("Only segment the bounding box of the seeds expanded by the margin."
+      " Voxels outside of it are not segmented.")
+
+    self.seedMarginSpinBox = qt.QSpinBox()
+    self.seedMarginSpinBox.setToolTip("Margin added around the seeds bounding box, in voxels.")
+    self.seedMarginSpinBox.minimum = 1
+    self.seedMarginSpinBox.maximum = 1000
+    self.seedMarginSpinBox.suffix = " voxels"
+
+    cropFrame = qt.QHBoxLayout()
+    cropFrame.addWidget(self.cropToSeedsCheckBox)
+    cropFrame.addWidget(self.seedMarginSpinBox)
+    self.scriptedEffect.addLabeledOptionsWidget("Region:", cropFrame)
+
+    AbstractScriptedSegmentEditorAutoCompleteEffect.setupOptionsFrame(self)
+
+    self.cropToSeedsCheckBox.connect("stateChanged(int)", self.updateMRMLFromGUI)
+    self.seedMarginSpinBox.connect("valueChanged(int)", self.updateMRMLFromGUI)
+
+  def setMRMLDefaults(self):
+    AbstractScriptedSegmentEditorAutoCompleteEffect.setMRMLDefaults(self)
+    self.scriptedEffect.setParameterDefault("CropToSeeds", "0")
+    self.scriptedEffect.setParameterDefault("SeedMarginVoxels", "10")
+
+  def updateGUIFromMRML(self):
+    AbstractScriptedSegmentEditorAutoCompleteEffect.updateGUIFromMRML(self)
+
+    cropToSeeds = self.scriptedEffect.integerParameter("CropToSeeds") != 0
+    wasBlocked = self.cropToSeedsCheckBox.blockSignals(True)
+    self.cropToSeedsCheckBox.setChecked(cropToSeeds)
+    self.cropToSeedsCheckBox.blockSignals(wasBlocked)
+
+    wasBlocked = self.seedMarginSpinBox.blockSignals(True)
+    self.seedMarginSpinBox.value = self.scriptedEffect.integerParameter("SeedMarginVoxels")
+    self.seedMarginSpinBox.blockSignals(wasBlocked)
+    self.seedMarginSpinBox.setEnabled(cropToSeeds)
+
+  def updateMRMLFromGUI(self):
+    AbstractScriptedSegmentEditorAutoCompleteEffect.updateMRMLFromGUI(self)
+    self.scriptedEffect.setParameter("CropToSeeds", 1 if self.cropToSeedsCheckBox.isChecked() else 0)
+    self.scriptedEffect.setParameter("SeedMarginVoxels", self.seedMarginSpinBox.value)
+
   def reset(self):
     self.growCutFilter = None
     AbstractScriptedSegmentEditorAutoCompleteEffect.reset(self)
@@ -58,6 +104,8 @@ The effect uses <a href="https://www.spl.harvard.edu/publications/item/view/2761
       self.growCutFilter = vtkSlicerSegmentationsModuleLogic.vtkImageGrowCutSegment()
       self.growCutFilter.SetIntensityVolume(self.clippedMasterImageData)
 
+    self.growCutFilter.SetCropToSeedBoundingBox(self.scriptedEffect.integerParameter("CropToSeeds") != 0)
+    self.growCutFilter.SetSeedBoundingBoxMargin(self.scriptedEffect.integerParameter("SeedMarginVoxels"))
     self.growCutFilter.SetSeedLabelVolume(mergedImage)
     self.growCutFilter.Update()
 
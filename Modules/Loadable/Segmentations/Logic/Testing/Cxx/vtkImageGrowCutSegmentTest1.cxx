@@ -0,0 +1,196 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Segmentations includes
+#include "vtkImageGrowCutSegment.h"
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <cstring>
+
+namespace
+{
+
+const int Size = 24;
+
+//----------------------------------------------------------------------------
+void AllocateVolume(vtkImageData* volume, int scalarType)
+{
+  volume->SetDimensions(Size, Size, Size);
+  volume->AllocateScalars(scalarType, 1);
+}
+
+//----------------------------------------------------------------------------
+// Two regions of different intensity (left and right halves), with noise so
+// that paths of the same length are unlikely.
+void CreateIntensityVolume(vtkImageData* intensityVolume)
+{
+  AllocateVolume(intensityVolume, VTK_FLOAT);
+  float* intensity = static_cast<float*>(intensityVolume->GetScalarPointer());
+  unsigned int random = 1;
+  for (int i = 0; i < Size * Size * Size; ++i)
+    {
+    random = random * 1103515245u + 12345u;
+    intensity[i] = (i % Size < Size / 2 ? 0.f : 100.f) + ((random >> 16) % 10000) / 1000.f;
+    }
+}
+
+//----------------------------------------------------------------------------
+void SetSeed(vtkImageData* seedLabelVolume, int x, int y, int z, short label)
+{
+  *static_cast<short*>(seedLabelVolume->GetScalarPointer(x, y, z)) = label;
+  seedLabelVolume->Modified();
+}
+
+//----------------------------------------------------------------------------
+short GetLabel(vtkImageData* labelVolume, int x, int y, int z)
+{
+  return *static_cast<short*>(labelVolume->GetScalarPointer(x, y, z));
+}
+
+//----------------------------------------------------------------------------
+int CountLabel(vtkImageData* labelVolume, short label)
+{
+  short* labels = static_cast<short*>(labelVolume->GetScalarPointer());
+  int count = 0;
+  for (vtkIdType i = 0; i < labelVolume->GetNumberOfPoints(); ++i)
+    {
+    count += (labels[i] == label ? 1 : 0);
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+// Check that the result of an incremental update matches a full computation
+int CheckSameAsFullComputation(vtkImageGrowCutSegment* filter,
+                               vtkImageData* intensityVolume, vtkImageData* seedLabelVolume)
+{
+  filter->Update();
+  vtkImageData* result = filter->GetOutput();
+
+  vtkNew<vtkImageGrowCutSegment> fullFilter;
+  fullFilter->SetIntensityVolume(intensityVolume);
+  fullFilter->SetSeedLabelVolume(seedLabelVolume);
+  fullFilter->Update();
+  vtkImageData* expectedResult = fullFilter->GetOutput();
+
+  CHECK_INT(result->GetNumberOfPoints(), expectedResult->GetNumberOfPoints());
+  short* labels = static_cast<short*>(result->GetScalarPointer());
+  short* expectedLabels = static_cast<short*>(expectedResult->GetScalarPointer());
+  int numberOfDifferences = 0;
+  for (vtkIdType i = 0; i < result->GetNumberOfPoints(); ++i)
+    {
+    numberOfDifferences += (labels[i] != expectedLabels[i] ? 1 : 0);
+    }
+  CHECK_INT(numberOfDifferences, 0);
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestIncrementalUpdate(vtkImageData* intensityVolume)
+{
+  vtkNew<vtkImageData> seedLabelVolume;
+  AllocateVolume(seedLabelVolume.GetPointer(), VTK_SHORT);
+  memset(seedLabelVolume->GetScalarPointer(), 0, Size * Size * Size * sizeof(short));
+  SetSeed(seedLabelVolume.GetPointer(), 3, 5, 5, 1);
+  SetSeed(seedLabelVolume.GetPointer(), 20, 5, 5, 2);
+  SetSeed(seedLabelVolume.GetPointer(), 4, 15, 15, 1);
+  SetSeed(seedLabelVolume.GetPointer(), 18, 15, 15, 2);
+
+  vtkNew<vtkImageGrowCutSegment> filter;
+  filter->SetIntensityVolume(intensityVolume);
+  filter->SetSeedLabelVolume(seedLabelVolume.GetPointer());
+  filter->Update();
+  CHECK_INT(GetLabel(filter->GetOutput(), 5, 15, 15), 1);
+
+  // A seed that keeps its position but changes label relabels the region
+  // that was reached from it
+  SetSeed(seedLabelVolume.GetPointer(), 4, 15, 15, 3);
+  CHECK_EXIT_SUCCESS(CheckSameAsFullComputation(filter.GetPointer(), intensityVolume, seedLabelVolume.GetPointer()));
+  CHECK_INT(GetLabel(filter->GetOutput(), 4, 15, 15), 3);
+  CHECK_BOOL(CountLabel(filter->GetOutput(), 3) > 1, true);
+
+  // Added seeds
+  SetSeed(seedLabelVolume.GetPointer(), 10, 10, 10, 2);
+  SetSeed(seedLabelVolume.GetPointer(), 12, 2, 20, 4);
+  CHECK_EXIT_SUCCESS(CheckSameAsFullComputation(filter.GetPointer(), intensityVolume, seedLabelVolume.GetPointer()));
+
+  // Seed relabeled back, on the edge of the volume
+  SetSeed(seedLabelVolume.GetPointer(), 4, 15, 15, 1);
+  SetSeed(seedLabelVolume.GetPointer(), 0, 0, 0, 2);
+  filter->Update();
+  SetSeed(seedLabelVolume.GetPointer(), 0, 0, 0, 1);
+  CHECK_EXIT_SUCCESS(CheckSameAsFullComputation(filter.GetPointer(), intensityVolume, seedLabelVolume.GetPointer()));
+  CHECK_INT(CountLabel(filter->GetOutput(), 3), 0);
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestCropToSeedBoundingBox(vtkImageData* intensityVolume)
+{
+  vtkNew<vtkImageData> seedLabelVolume;
+  AllocateVolume(seedLabelVolume.GetPointer(), VTK_SHORT);
+  memset(seedLabelVolume->GetScalarPointer(), 0, Size * Size * Size * sizeof(short));
+  SetSeed(seedLabelVolume.GetPointer(), 8, 8, 8, 1);
+  SetSeed(seedLabelVolume.GetPointer(), 14, 12, 10, 2);
+
+  vtkNew<vtkImageGrowCutSegment> filter;
+  filter->SetIntensityVolume(intensityVolume);
+  filter->SetSeedLabelVolume(seedLabelVolume.GetPointer());
+  filter->CropToSeedBoundingBoxOn();
+  filter->SetSeedBoundingBoxMargin(2);
+  filter->Update();
+
+  // Output has the geometry of the input, only the seeds bounding box
+  // expanded by the margin is labeled
+  vtkImageData* result = filter->GetOutput();
+  CHECK_INT(result->GetNumberOfPoints(), Size * Size * Size);
+  CHECK_INT(GetLabel(result, 8, 8, 8), 1);
+  CHECK_INT(GetLabel(result, 14, 12, 10), 2);
+  CHECK_BOOL(GetLabel(result, 6, 6, 6) != 0, true);
+  CHECK_BOOL(GetLabel(result, 16, 14, 12) != 0, true);
+  CHECK_INT(GetLabel(result, 5, 8, 8), 0);
+  CHECK_INT(GetLabel(result, 17, 12, 10), 0);
+  CHECK_INT(GetLabel(result, 10, 10, 13), 0);
+  CHECK_INT(CountLabel(result, 0), Size * Size * Size - 11 * 9 * 7);
+
+  // Without cropping, all the voxels are labeled
+  filter->CropToSeedBoundingBoxOff();
+  filter->Update();
+  CHECK_INT(CountLabel(filter->GetOutput(), 0), 0);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageGrowCutSegmentTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkImageData> intensityVolume;
+  CreateIntensityVolume(intensityVolume.GetPointer());
+
+  CHECK_EXIT_SUCCESS(TestIncrementalUpdate(intensityVolume.GetPointer()));
+  CHECK_EXIT_SUCCESS(TestCropToSeedBoundingBox(intensityVolume.GetPointer()));
+  return EXIT_SUCCESS;
+}
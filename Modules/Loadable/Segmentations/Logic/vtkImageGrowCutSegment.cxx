@@ -1,6 +1,10 @@
 #include "vtkImageGrowCutSegment.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 #include <vtkInformation.h>
@@ -12,8 +16,6 @@
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkTimerLog.h>
 
-#include "FibHeap.h"
-
 vtkStandardNewMacro(vtkImageGrowCutSegment);
 
 //----------------------------------------------------------------------------
@@ -23,58 +25,115 @@ const DistancePixelType DIST_INF = std::numeric_limits<DistancePixelType>::max()
 const DistancePixelType DIST_EPSILON = 1e-3;
 
 //----------------------------------------------------------------------------
-class HeapNode : public FibHeapNode
+// Binary min-heap of voxels ordered by distance, stored in a flat array.
+// Instead of decreasing the key of a voxel already in the heap, the voxel
+// is pushed again with its new distance: entries whose distance is larger
+// than the current distance of their voxel are outdated and are skipped
+// when popped. Only the front of the propagation is stored in the heap.
+class DistanceHeap
 {
 public:
-  HeapNode()
-  : FibHeapNode()
-  , m_Key(0)
-  , m_Index(-1)
+  struct Entry
   {
-  }
+    DistancePixelType Distance;
+    long Index;
+  };
+
+  bool IsEmpty() const { return m_Entries.empty(); }
 
-  virtual void operator =(FibHeapNode& RHS)
+  void Push(DistancePixelType distance, long index)
   {
-    FHN_Assign(RHS);
-    m_Key = ((HeapNode&)RHS).m_Key;
+    Entry entry = { distance, index };
+    m_Entries.push_back(entry);
+    std::push_heap(m_Entries.begin(), m_Entries.end(), GreaterDistance);
   }
 
-  virtual int operator ==(FibHeapNode& RHS)
+  Entry Pop()
   {
-    if (FHN_Cmp(RHS))
-      {
-      return 0;
-      }
-    return m_Key == ((HeapNode&)RHS).m_Key ? 1 : 0;
+    std::pop_heap(m_Entries.begin(), m_Entries.end(), GreaterDistance);
+    Entry entry = m_Entries.back();
+    m_Entries.pop_back();
+    return entry;
   }
 
-  virtual int operator <(FibHeapNode& RHS)
+  // Remove all entries and release memory
+  void Clear()
   {
-    int x = FHN_Cmp(RHS);
-    if (x != 0)
-      {
-      return x < 0 ? 1 : 0;
-      }
-    return m_Key < ((HeapNode&)RHS).m_Key ? 1 : 0;
+    std::vector<Entry>().swap(m_Entries);
   }
 
-  virtual void operator =(DistancePixelType newKeyVal)
+protected:
+  static bool GreaterDistance(const Entry& a, const Entry& b)
   {
-    HeapNode tmp;
-    tmp.m_Key = m_Key = newKeyVal;
-    FHN_Assign(tmp);
+    return a.Distance > b.Distance;
   }
 
-  inline DistancePixelType GetKeyValue() { return m_Key; }
-  inline void SetKeyValue(DistancePixelType keyValue) { m_Key = keyValue; }
-  inline long int GetIndexValue() { return m_Index; }
-  inline void SetIndexValue(long int indexValue) { m_Index = indexValue; }
-
-protected:
-  DistancePixelType m_Key;
-  long m_Index;
+  std::vector<Entry> m_Entries;
 };
 
+//----------------------------------------------------------------------------
+namespace
+{
+
+// Copy the voxels of extent from source to target, both images must contain
+// the extent and have the same scalar type and number of components.
+void CopyImageRegion(vtkImageData* source, vtkImageData* target, int extent[6])
+{
+  size_t rowSize = static_cast<size_t>(extent[1] - extent[0] + 1)
+    * source->GetScalarSize() * source->GetNumberOfScalarComponents();
+  for (int z = extent[4]; z <= extent[5]; z++)
+    {
+    for (int y = extent[2]; y <= extent[3]; y++)
+      {
+      memcpy(target->GetScalarPointer(extent[0], y, z),
+        source->GetScalarPointer(extent[0], y, z), rowSize);
+      }
+    }
+}
+
+// Compute the extent of the non-zero voxels of the seed volume, expanded by
+// margin voxels and clipped to the seed volume extent.
+// Returns false if there are no seeds.
+template<typename LabelPixelType>
+bool GetSeedExtent(vtkImageData* seedLabelVolume, int margin, int seedExtent[6])
+{
+  int* extent = seedLabelVolume->GetExtent();
+  seedExtent[0] = extent[1]; seedExtent[1] = extent[0];
+  seedExtent[2] = extent[3]; seedExtent[3] = extent[2];
+  seedExtent[4] = extent[5]; seedExtent[5] = extent[4];
+  LabelPixelType* seedLabelVolumePtr = static_cast<LabelPixelType*>(seedLabelVolume->GetScalarPointer());
+  bool seedFound = false;
+  for (int z = extent[4]; z <= extent[5]; z++)
+    {
+    for (int y = extent[2]; y <= extent[3]; y++)
+      {
+      for (int x = extent[0]; x <= extent[1]; x++, seedLabelVolumePtr++)
+        {
+        if (*seedLabelVolumePtr == 0)
+          {
+          continue;
+          }
+        seedFound = true;
+        seedExtent[0] = std::min(seedExtent[0], x); seedExtent[1] = std::max(seedExtent[1], x);
+        seedExtent[2] = std::min(seedExtent[2], y); seedExtent[3] = std::max(seedExtent[3], y);
+        seedExtent[4] = std::min(seedExtent[4], z); seedExtent[5] = std::max(seedExtent[5], z);
+        }
+      }
+    }
+  if (!seedFound)
+    {
+    return false;
+    }
+  for (int i = 0; i < 3; i++)
+    {
+    seedExtent[i * 2] = std::max(extent[i * 2], seedExtent[i * 2] - margin);
+    seedExtent[i * 2 + 1] = std::min(extent[i * 2 + 1], seedExtent[i * 2 + 1] + margin);
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 class vtkImageGrowCutSegment::vtkInternal
 {
@@ -90,6 +149,10 @@ public:
   template<typename IntensityPixelType, typename LabelPixelType>
   void DijkstraBasedClassificationAHP(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume);
 
+  template<typename IntensityPixelType, typename LabelPixelType>
+  void InvalidateReachedRegion(long seedIndex, IntensityPixelType* imSrc, LabelPixelType* seedLabelVolumePtr,
+    std::vector<long>& invalidatedIndices);
+
   template <class SourceVolType>
   bool ExecuteGrowCut(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *resultLabelVolume);
 
@@ -97,9 +160,7 @@ public:
   bool ExecuteGrowCut2(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume);
 
   vtkSmartPointer<vtkImageData> m_DistanceVolume;
-  vtkSmartPointer<vtkImageData> m_DistanceVolumePre;
   vtkSmartPointer<vtkImageData> m_ResultLabelVolume;
-  vtkSmartPointer<vtkImageData> m_ResultLabelVolumePre;
 
   long m_DimX;
   long m_DimY;
@@ -107,21 +168,16 @@ public:
   std::vector<long> m_NeighborIndexOffsets;
   std::vector<unsigned char> m_NumberOfNeighbors;
 
-  FibHeap *m_Heap;
-  HeapNode *m_HeapNodes;
+  DistanceHeap m_Heap;
   bool m_bSegInitialized;
 };
 
 //-----------------------------------------------------------------------------
 vtkImageGrowCutSegment::vtkInternal::vtkInternal()
 {
-  m_Heap = NULL;
-  m_HeapNodes = NULL;
   m_bSegInitialized = false;
   m_DistanceVolume = vtkSmartPointer<vtkImageData>::New();
-  m_DistanceVolumePre = vtkSmartPointer<vtkImageData>::New();
   m_ResultLabelVolume = vtkSmartPointer<vtkImageData>::New();
-  m_ResultLabelVolumePre = vtkSmartPointer<vtkImageData>::New();
 };
 
 //-----------------------------------------------------------------------------
@@ -133,36 +189,19 @@ vtkImageGrowCutSegment::vtkInternal::~vtkInternal()
 //-----------------------------------------------------------------------------
 void vtkImageGrowCutSegment::vtkInternal::Reset()
 {
-  if (m_Heap != NULL)
-    {
-    delete m_Heap;
-    m_Heap = NULL;
-    }
-  if (m_HeapNodes != NULL)
-    {
-    delete[]m_HeapNodes;
-    m_HeapNodes = NULL;
-    }
+  m_Heap.Clear();
   m_bSegInitialized = false;
   m_DistanceVolume->Initialize();
-  m_DistanceVolumePre->Initialize();
   m_ResultLabelVolume->Initialize();
-  m_ResultLabelVolumePre->Initialize();
 }
 
 //-----------------------------------------------------------------------------
 template<typename IntensityPixelType, typename LabelPixelType>
 bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
-    vtkImageData *vtkNotUsed(intensityVolume),
+    vtkImageData *intensityVolume,
     vtkImageData *seedLabelVolume)
 {
-  m_Heap = new FibHeap;
   long dimXYZ = m_DimX * m_DimY * m_DimZ;
-  if ((m_HeapNodes = new HeapNode[dimXYZ + 1]) == NULL)
-    {
-    vtkGenericWarningMacro("Memory allocation failed. Dimensions: " << m_DimX << "x" << m_DimY << "x" << m_DimZ);
-    return false;
-    }
   LabelPixelType* seedLabelVolumePtr = static_cast<LabelPixelType*>(seedLabelVolume->GetScalarPointer());
 
   if (!m_bSegInitialized)
@@ -175,12 +214,14 @@ bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
     m_DistanceVolume->SetSpacing(seedLabelVolume->GetSpacing());
     m_DistanceVolume->SetExtent(seedLabelVolume->GetExtent());
     m_DistanceVolume->AllocateScalars(DistancePixelTypeID, 1);
-    m_ResultLabelVolumePre->SetExtent(0, -1, 0, -1, 0, -1);
-    m_ResultLabelVolumePre->AllocateScalars(seedLabelVolume->GetScalarType(), 1);
-    m_DistanceVolumePre->SetExtent(0, -1, 0, -1, 0, -1);
-    m_DistanceVolumePre->AllocateScalars(DistancePixelTypeID, 1);
     LabelPixelType* resultLabelVolumePtr = static_cast<LabelPixelType*>(m_ResultLabelVolume->GetScalarPointer());
     DistancePixelType* distanceVolumePtr = static_cast<DistancePixelType*>(m_DistanceVolume->GetScalarPointer());
+    if (resultLabelVolumePtr == NULL || distanceVolumePtr == NULL)
+      {
+      vtkGenericWarningMacro("Memory allocation failed. Dimensions: " << m_DimX << "x" << m_DimY << "x" << m_DimZ);
+      this->Reset();
+      return false;
+      }
 
     // Compute index offset
     m_NeighborIndexOffsets.clear();
@@ -227,55 +268,140 @@ bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
         }
       }
 
+    // Only seeds are put in the heap, the other voxels are added when they are
+    // reached by the propagation. All seeds have the same distance, therefore
+    // pushing them does not reorder the heap.
     for (long index = 0; index < dimXYZ; index++)
       {
       LabelPixelType seedValue = seedLabelVolumePtr[index];
       resultLabelVolumePtr[index] = seedValue;
       if (seedValue == 0)
         {
-        m_HeapNodes[index] = DIST_INF;
         distanceVolumePtr[index] = DIST_INF;
         }
       else
         {
-        m_HeapNodes[index] = DIST_EPSILON;
         distanceVolumePtr[index] = DIST_EPSILON;
+        m_Heap.Push(DIST_EPSILON, index);
         }
-      m_Heap->Insert(&m_HeapNodes[index]);
-      m_HeapNodes[index].SetIndexValue(index);
       }
     }
   else
     {
-    // Already initialized
+    // Already initialized: the distance map and labels of the previous run are
+    // kept and only the new/changed seeds are propagated. New seeds can only
+    // decrease the distance of the voxels, therefore the propagation stops
+    // where the previous distance is shorter.
     LabelPixelType* resultLabelVolumePtr = static_cast<LabelPixelType*>(m_ResultLabelVolume->GetScalarPointer());
     DistancePixelType* distanceVolumePtr = static_cast<DistancePixelType*>(m_DistanceVolume->GetScalarPointer());
+    IntensityPixelType* imSrc = static_cast<IntensityPixelType*>(intensityVolume->GetScalarPointer());
+
+    // A seed whose label changed leaves the voxels reached from it with its
+    // previous label and a distance that the new label can't improve.
+    // These voxels are invalidated and computed again. Voxels that were not
+    // seeds are farther from the seeds than a new seed, the propagation
+    // from the new seed relabels the voxels reached from them.
+    std::vector<long> invalidatedIndices;
+    for (long index = 0; index < dimXYZ; index++)
+      {
+      LabelPixelType seedValue = seedLabelVolumePtr[index];
+      if (seedValue != 0 && resultLabelVolumePtr[index] != 0 && resultLabelVolumePtr[index] != seedValue
+        && distanceVolumePtr[index] <= DIST_EPSILON)
+        {
+        this->InvalidateReachedRegion<IntensityPixelType, LabelPixelType>(
+          index, imSrc, seedLabelVolumePtr, invalidatedIndices);
+        }
+      }
 
     for (long index = 0; index < dimXYZ; index++)
       {
-      if (seedLabelVolumePtr[index] != 0)
+      LabelPixelType seedValue = seedLabelVolumePtr[index];
+      if (seedValue != 0
+        && (resultLabelVolumePtr[index] != seedValue || distanceVolumePtr[index] > DIST_EPSILON))
         {
-        // Only grow from new/changed seeds
-        if (resultLabelVolumePtr[index] != seedLabelVolumePtr[index])
+        distanceVolumePtr[index] = DIST_EPSILON;
+        resultLabelVolumePtr[index] = seedValue;
+        m_Heap.Push(DIST_EPSILON, index);
+        }
+      }
+
+    // Propagate again from the valid voxels bordering the invalidated region
+    for (std::vector<long>::const_iterator it = invalidatedIndices.begin(); it != invalidatedIndices.end(); ++it)
+      {
+      long x = *it % m_DimX;
+      long y = (*it / m_DimX) % m_DimY;
+      long z = *it / (m_DimX * m_DimY);
+      for (long iz = std::max(z - 1, 0L); iz <= std::min(z + 1, m_DimZ - 1); iz++)
+        {
+        for (long iy = std::max(y - 1, 0L); iy <= std::min(y + 1, m_DimY - 1); iy++)
           {
-          m_HeapNodes[index] = DIST_EPSILON;
-          distanceVolumePtr[index] = DIST_EPSILON;
-          resultLabelVolumePtr[index] = seedLabelVolumePtr[index];
-          m_Heap->Insert(&m_HeapNodes[index]);
-          m_HeapNodes[index].SetIndexValue(index);
+          for (long ix = std::max(x - 1, 0L); ix <= std::min(x + 1, m_DimX - 1); ix++)
+            {
+            long indexNgbh = ix + m_DimX * (iy + m_DimY * iz);
+            if (distanceVolumePtr[indexNgbh] != DIST_INF && m_NumberOfNeighbors[indexNgbh] > 0)
+              {
+              m_Heap.Push(distanceVolumePtr[indexNgbh], indexNgbh);
+              }
+            }
           }
         }
-      else
+      }
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Reset the distance and label of the voxels whose shortest path of the
+// previous run goes through seedIndex. A voxel is considered reached through
+// one of its neighbors if it has the same label and its distance is the
+// distance of the neighbor plus the cost between them. Voxels that were
+// reached through another path of the same length are invalidated too, they
+// are computed again anyway. Other seeds are kept. The invalidated voxels
+// are appended to invalidatedIndices.
+template<typename IntensityPixelType, typename LabelPixelType>
+void vtkImageGrowCutSegment::vtkInternal::InvalidateReachedRegion(
+    long seedIndex, IntensityPixelType* imSrc, LabelPixelType* seedLabelVolumePtr,
+    std::vector<long>& invalidatedIndices)
+{
+  LabelPixelType* resultLabelVolumePtr = static_cast<LabelPixelType*>(m_ResultLabelVolume->GetScalarPointer());
+  DistancePixelType* distanceVolumePtr = static_cast<DistancePixelType*>(m_DistanceVolume->GetScalarPointer());
+  const LabelPixelType previousLabel = resultLabelVolumePtr[seedIndex];
+
+  // Voxels to visit with their distance before invalidation
+  std::vector<DistanceHeap::Entry> front;
+  DistanceHeap::Entry seedEntry = { distanceVolumePtr[seedIndex], seedIndex };
+  front.push_back(seedEntry);
+  invalidatedIndices.push_back(seedIndex);
+  distanceVolumePtr[seedIndex] = DIST_INF;
+  resultLabelVolumePtr[seedIndex] = 0;
+  while (!front.empty())
+    {
+    DistanceHeap::Entry entry = front.back();
+    front.pop_back();
+    DistancePixelType pixCenter = imSrc[entry.Index];
+    unsigned char nbSize = m_NumberOfNeighbors[entry.Index];
+    for (unsigned char i = 0; i < nbSize; i++)
+      {
+      long indexNgbh = entry.Index + m_NeighborIndexOffsets[i];
+      if (resultLabelVolumePtr[indexNgbh] != previousLabel
+        || seedLabelVolumePtr[indexNgbh] != 0
+        || distanceVolumePtr[indexNgbh] == DIST_INF)
         {
-        m_HeapNodes[index] = DIST_INF;
-        distanceVolumePtr[index] = DIST_INF;
-        resultLabelVolumePtr[index] = 0;
-        m_Heap->Insert(&m_HeapNodes[index]);
-        m_HeapNodes[index].SetIndexValue(index);
+        continue;
         }
+      DistancePixelType distanceThroughCenter = fabs(pixCenter - imSrc[indexNgbh]) + entry.Distance;
+      // relative tolerance: invalidating too many voxels is harmless
+      if (distanceVolumePtr[indexNgbh] < distanceThroughCenter * (1 - 1e-5))
+        {
+        continue;
+        }
+      DistanceHeap::Entry neighborEntry = { distanceVolumePtr[indexNgbh], indexNgbh };
+      front.push_back(neighborEntry);
+      invalidatedIndices.push_back(indexNgbh);
+      distanceVolumePtr[indexNgbh] = DIST_INF;
+      resultLabelVolumePtr[indexNgbh] = 0;
       }
     }
-  return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -285,130 +411,44 @@ void vtkImageGrowCutSegment::vtkInternal::DijkstraBasedClassificationAHP(
     vtkImageData *vtkNotUsed(seedLabelVolume))
 {
   LabelPixelType* resultLabelVolumePtr = static_cast<LabelPixelType*>(m_ResultLabelVolume->GetScalarPointer());
+  DistancePixelType* distanceVolumePtr = static_cast<DistancePixelType*>(m_DistanceVolume->GetScalarPointer());
   IntensityPixelType* imSrc = static_cast<IntensityPixelType*>(intensityVolume->GetScalarPointer());
+  const long* neighborIndexOffsets = &(m_NeighborIndexOffsets[0]);
 
-  // Insert 0 then extract it, which will balance heap
-  HeapNode hnZero;
-  m_Heap->Insert(&hnZero);
-  m_Heap->ExtractMin();
-
-  if (!m_bSegInitialized)
+  // Dijkstra. Used both for the full computation and for the quick update
+  // (where the distance map already contains the result of the previous run).
+  while (!m_Heap.IsEmpty())
     {
-    // Full computation
-    DistancePixelType* distanceVolumePtr = static_cast<DistancePixelType*>(m_DistanceVolume->GetScalarPointer());
-    LabelPixelType* resultLabelVolumePtr = static_cast<LabelPixelType*>(m_ResultLabelVolume->GetScalarPointer());
-
-    // Normal Dijkstra (to be used in initializing the segmenter for the current image)
-    HeapNode hnTmp;
-    while (!m_Heap->IsEmpty())
+    DistanceHeap::Entry entry = m_Heap.Pop();
+    long index = entry.Index;
+    DistancePixelType currentDistance = entry.Distance;
+    if (currentDistance > distanceVolumePtr[index])
       {
-      HeapNode* hnMin = (HeapNode *)m_Heap->ExtractMin();
-      long index = hnMin->GetIndexValue();
-      DistancePixelType currentDistance = hnMin->GetKeyValue();
-      LabelPixelType currentLabel = resultLabelVolumePtr[index];
-      distanceVolumePtr[index] = currentDistance;
-
-      // Update neighbors
-      DistancePixelType pixCenter = imSrc[index];
-      unsigned char nbSize = m_NumberOfNeighbors[index];
-      for (unsigned char i = 0; i < nbSize; i++)
-        {
-        long indexNgbh = index + m_NeighborIndexOffsets[i];
-        DistancePixelType neighborCurrentDistance = distanceVolumePtr[indexNgbh];
-        DistancePixelType neighborNewDistance = fabs(pixCenter - imSrc[indexNgbh]) + currentDistance;
-        if (neighborCurrentDistance > neighborNewDistance)
-          {
-          distanceVolumePtr[indexNgbh] = neighborNewDistance;
-          resultLabelVolumePtr[indexNgbh] = currentLabel;
-
-          hnTmp = m_HeapNodes[indexNgbh];
-          hnTmp.SetKeyValue(neighborNewDistance);
-          m_Heap->DecreaseKey(&m_HeapNodes[indexNgbh], hnTmp);
-          }
-        }
+      // outdated entry, the voxel has been reached by a shorter path since then
+      continue;
       }
-    }
-  else
-    {
-    // Quick update
-
-    LabelPixelType* resultLabelVolumePrePtr = static_cast<LabelPixelType*>(m_ResultLabelVolumePre->GetScalarPointer());
+    LabelPixelType currentLabel = resultLabelVolumePtr[index];
 
-    // Adaptive Dijkstra
-    HeapNode hnTmp;
-    long dimXYZ = m_DimX * m_DimY * m_DimZ;
-    while (!m_Heap->IsEmpty())
+    // Update neighbors
+    DistancePixelType pixCenter = imSrc[index];
+    unsigned char nbSize = m_NumberOfNeighbors[index];
+    for (unsigned char i = 0; i < nbSize; i++)
       {
-      DistancePixelType* distanceVolumePrePtr = static_cast<DistancePixelType*>(m_DistanceVolumePre->GetScalarPointer());
-      DistancePixelType* distanceVolumePtr = static_cast<DistancePixelType*>(m_DistanceVolume->GetScalarPointer());
-
-      HeapNode* hnMin = (HeapNode *)m_Heap->ExtractMin();
-      DistancePixelType currentDistance = hnMin->GetKeyValue();
-
-      // Stop of minimum value is infinite
-      if (currentDistance == DIST_INF)
-        {
-        for (long index = 0; index < dimXYZ; index++)
-          {
-          if (resultLabelVolumePtr[index] == 0)
-            {
-            resultLabelVolumePtr[index] = resultLabelVolumePrePtr[index];
-            distanceVolumePtr[index] = distanceVolumePrePtr[index];
-            }
-          }
-        break;
-        }
-
-      // Stop propagation when the new distance is larger than the previous one
-      long index = hnMin->GetIndexValue();
-      if (currentDistance > distanceVolumePrePtr[index])
+      long indexNgbh = index + neighborIndexOffsets[i];
+      DistancePixelType neighborNewDistance = fabs(pixCenter - imSrc[indexNgbh]) + currentDistance;
+      if (distanceVolumePtr[indexNgbh] > neighborNewDistance)
         {
-        distanceVolumePtr[index] = distanceVolumePrePtr[index];
-        resultLabelVolumePtr[index] = resultLabelVolumePrePtr[index];
-        continue;
-        }
-
-      LabelPixelType currentLabel = resultLabelVolumePtr[index];
-      distanceVolumePtr[index] = currentDistance;
-
-      // Update neighbors
-      DistancePixelType pixCenter = imSrc[index];
-      unsigned char nbSize = m_NumberOfNeighbors[index];
-      for (unsigned char i = 0; i < nbSize; i++)
-        {
-        long indexNgbh = index + m_NeighborIndexOffsets[i];
-        DistancePixelType neighborCurrentDistance = distanceVolumePtr[indexNgbh];
-        DistancePixelType neighborNewDistance = fabs(pixCenter - imSrc[indexNgbh]) + currentDistance;
-        if (neighborCurrentDistance > neighborNewDistance)
-          {
-          distanceVolumePtr[indexNgbh] = neighborNewDistance;
-          resultLabelVolumePtr[indexNgbh] = currentLabel;
-
-          hnTmp = m_HeapNodes[indexNgbh];
-          hnTmp.SetKeyValue(neighborNewDistance);
-          m_Heap->DecreaseKey(&m_HeapNodes[indexNgbh], hnTmp);
-          }
+        distanceVolumePtr[indexNgbh] = neighborNewDistance;
+        resultLabelVolumePtr[indexNgbh] = currentLabel;
+        m_Heap.Push(neighborNewDistance, indexNgbh);
         }
       }
     }
 
-  // Update previous labels and distance information
-  m_ResultLabelVolumePre->DeepCopy(m_ResultLabelVolume);
-  m_DistanceVolumePre->DeepCopy(m_DistanceVolume);
   m_bSegInitialized = true;
 
   // Release memory
-  if (m_Heap != NULL)
-    {
-    delete m_Heap;
-    m_Heap = NULL;
-    }
-  //m_HeapNodes.clear();
-  if (m_HeapNodes != NULL)
-    {
-    delete[] m_HeapNodes;
-    m_HeapNodes = NULL;
-    }
+  m_Heap.Clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -507,6 +547,8 @@ bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut(vtkImageData *intensity
 vtkImageGrowCutSegment::vtkImageGrowCutSegment()
 {
   this->Internal = new vtkInternal();
+  this->CropToSeedBoundingBox = false;
+  this->SeedBoundingBoxMargin = 10;
   this->SetNumberOfInputPorts(2);
   this->SetNumberOfOutputPorts(1);
 }
@@ -528,10 +570,76 @@ void vtkImageGrowCutSegment::ExecuteDataWithInformation(
   vtkNew<vtkTimerLog> logger;
   logger->StartTimer();
 
-  switch (intensityVolume->GetScalarType())
+  int* extent = intensityVolume->GetExtent();
+  int* seedExtent = seedLabelVolume->GetExtent();
+  bool sameExtent = true;
+  for (int i = 0; i < 6; i++)
+    {
+    sameExtent = sameExtent && (extent[i] == seedExtent[i]);
+    }
+
+  int cropExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  bool crop = false;
+  // Geometry mismatch is reported by the uncropped computation
+  if (this->CropToSeedBoundingBox && sameExtent)
     {
-    vtkTemplateMacro(this->Internal->ExecuteGrowCut<VTK_TT>(intensityVolume, seedLabelVolume, resultLabelVolume));
-    break;
+    bool seedFound = false;
+    switch (seedLabelVolume->GetScalarType())
+      {
+      vtkTemplateMacro(seedFound = GetSeedExtent<VTK_TT>(seedLabelVolume, std::max(this->SeedBoundingBoxMargin, 1), cropExtent));
+      }
+    crop = seedFound;
+    for (int i = 0; i < 6; i += 2)
+      {
+      // At least one voxel padding around the cropped region is needed,
+      // use the whole volume if it is not possible.
+      crop = crop && (cropExtent[i + 1] - cropExtent[i] > 1);
+      }
+    }
+
+  if (crop)
+    {
+    vtkNew<vtkImageData> croppedIntensityVolume;
+    croppedIntensityVolume->SetOrigin(intensityVolume->GetOrigin());
+    croppedIntensityVolume->SetSpacing(intensityVolume->GetSpacing());
+    croppedIntensityVolume->SetExtent(cropExtent);
+    croppedIntensityVolume->AllocateScalars(intensityVolume->GetScalarType(), intensityVolume->GetNumberOfScalarComponents());
+    CopyImageRegion(intensityVolume, croppedIntensityVolume.GetPointer(), cropExtent);
+
+    vtkNew<vtkImageData> croppedSeedLabelVolume;
+    croppedSeedLabelVolume->SetOrigin(seedLabelVolume->GetOrigin());
+    croppedSeedLabelVolume->SetSpacing(seedLabelVolume->GetSpacing());
+    croppedSeedLabelVolume->SetExtent(cropExtent);
+    croppedSeedLabelVolume->AllocateScalars(seedLabelVolume->GetScalarType(), 1);
+    CopyImageRegion(seedLabelVolume, croppedSeedLabelVolume.GetPointer(), cropExtent);
+
+    vtkNew<vtkImageData> croppedResultLabelVolume;
+    bool success = false;
+    switch (intensityVolume->GetScalarType())
+      {
+      vtkTemplateMacro(success = this->Internal->ExecuteGrowCut<VTK_TT>(
+        croppedIntensityVolume.GetPointer(), croppedSeedLabelVolume.GetPointer(), croppedResultLabelVolume.GetPointer()));
+      }
+
+    // Voxels outside the seed bounding box are not labeled
+    resultLabelVolume->SetOrigin(seedLabelVolume->GetOrigin());
+    resultLabelVolume->SetSpacing(seedLabelVolume->GetSpacing());
+    resultLabelVolume->SetExtent(seedLabelVolume->GetExtent());
+    resultLabelVolume->AllocateScalars(seedLabelVolume->GetScalarType(), 1);
+    memset(resultLabelVolume->GetScalarPointer(), 0,
+      resultLabelVolume->GetScalarSize() * resultLabelVolume->GetNumberOfPoints());
+    if (success)
+      {
+      CopyImageRegion(croppedResultLabelVolume.GetPointer(), resultLabelVolume, cropExtent);
+      }
+    }
+  else
+    {
+    switch (intensityVolume->GetScalarType())
+      {
+      vtkTemplateMacro(this->Internal->ExecuteGrowCut<VTK_TT>(intensityVolume, seedLabelVolume, resultLabelVolume));
+      break;
+      }
     }
   logger->StopTimer();
   vtkDebugMacro(<< "vtkImageGrowCutSegment execution time: " << logger->GetElapsedTime());
@@ -561,6 +669,7 @@ void vtkImageGrowCutSegment::Reset()
 //-----------------------------------------------------------------------------
 void vtkImageGrowCutSegment::PrintSelf(ostream &os, vtkIndent indent)
 {
-  // XXX Implement this function
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "CropToSeedBoundingBox: " << (this->CropToSeedBoundingBox ? "On" : "Off") << "\n";
+  os << indent << "SeedBoundingBoxMargin: " << this->SeedBoundingBoxMargin << "\n";
 }
@@ -21,8 +21,24 @@ public:
 
   // Reset to initial state. This forces full recomputation of the result label volume.
   // This method has to be called if intensity volume changes or if seeds are deleted after initial computation.
+  // If seeds are only added or relabeled, the distance map of the previous computation is reused and
+  // only the region where the new seeds are closer than the previous ones, or that was reached
+  // from the relabeled seeds, is updated.
   void Reset();
 
+  // If enabled, the computation is restricted to the bounding box of the seeds expanded
+  // by SeedBoundingBoxMargin voxels, voxels outside of it are not labeled.
+  // Adding seeds outside of the current bounding box forces a full recomputation.
+  // Disabled by default.
+  vtkSetMacro(CropToSeedBoundingBox, bool);
+  vtkGetMacro(CropToSeedBoundingBox, bool);
+  vtkBooleanMacro(CropToSeedBoundingBox, bool);
+
+  // Margin (in voxels) added around the seeds bounding box when CropToSeedBoundingBox is enabled.
+  // Default is 10.
+  vtkSetMacro(SeedBoundingBoxMargin, int);
+  vtkGetMacro(SeedBoundingBoxMargin, int);
+
 protected:
   vtkImageGrowCutSegment();
   virtual ~vtkImageGrowCutSegment();
@@ -30,6 +46,9 @@ protected:
   virtual void ExecuteDataWithInformation(vtkDataObject *outData, vtkInformation *outInfo) VTK_OVERRIDE;
   virtual int RequestInformation(vtkInformation *, vtkInformationVector **, vtkInformationVector *) VTK_OVERRIDE;
 
+  bool CropToSeedBoundingBox;
+  int SeedBoundingBoxMargin;
+
 private:
   class vtkInternal;
   vtkInternal * Internal;
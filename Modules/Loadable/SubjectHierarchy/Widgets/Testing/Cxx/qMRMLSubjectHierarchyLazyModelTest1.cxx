@@ -0,0 +1,156 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QApplication>
+
+// CTK includes
+#include <ctkModelTester.h>
+
+// SubjectHierarchy includes
+#include "qMRMLSubjectHierarchyLazyModel.h"
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSubjectHierarchyNode.h>
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// Check that the exposed children of an item are in the subject hierarchy order,
+// and that their indices point back to their rows
+int CheckRows(qMRMLSubjectHierarchyLazyModel& model, vtkIdType parentItemID)
+{
+  vtkMRMLSubjectHierarchyNode* shNode = model.subjectHierarchyNode();
+  QModelIndex parentIndex = model.indexFromSubjectHierarchyItem(parentItemID);
+  CHECK_BOOL(parentIndex.isValid(), true);
+  for (int row=0; row<model.rowCount(parentIndex); ++row)
+    {
+    vtkIdType itemID = model.subjectHierarchyItemFromIndex(model.index(row, 0, parentIndex));
+    CHECK_BOOL(shNode->GetItemParent(itemID) == parentItemID, true);
+    CHECK_INT(shNode->GetItemPositionUnderParent(itemID), row);
+    QModelIndex itemIndex = model.indexFromSubjectHierarchyItem(itemID);
+    CHECK_INT(itemIndex.row(), row);
+    CHECK_BOOL(model.parent(itemIndex) == parentIndex, true);
+    }
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestRows()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSubjectHierarchyNode* shNode = vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(scene.GetPointer());
+  CHECK_NOT_NULL(shNode);
+  vtkIdType sceneItemID = shNode->GetSceneItemID();
+
+  std::vector<vtkIdType> folderItemIDs;
+  for (int i=0; i<10; ++i)
+    {
+    std::stringstream name;
+    name << "Folder" << i;
+    folderItemIDs.push_back(shNode->CreateFolderItem(sceneItemID, name.str()));
+    }
+  for (int i=0; i<3; ++i)
+    {
+    shNode->CreateFolderItem(folderItemIDs[0], "Subfolder");
+    }
+
+  qMRMLSubjectHierarchyLazyModel model;
+  ctkModelTester tester(&model);
+  tester.setTestDataEnabled(false);
+  model.setFetchBatchSize(4);
+  model.setMRMLScene(scene.GetPointer());
+
+  // Only the scene is exposed initially
+  CHECK_INT(model.rowCount(), 1);
+  QModelIndex sceneIndex = model.subjectHierarchySceneIndex();
+  CHECK_BOOL(model.subjectHierarchyItemFromIndex(sceneIndex) == sceneItemID, true);
+  CHECK_INT(model.rowCount(sceneIndex), 0);
+  CHECK_BOOL(model.hasChildren(sceneIndex), true);
+
+  // Children are fetched in batches
+  CHECK_BOOL(model.canFetchMore(sceneIndex), true);
+  model.fetchMore(sceneIndex);
+  CHECK_INT(model.rowCount(sceneIndex), 4);
+  CHECK_BOOL(model.indexFromSubjectHierarchyItem(folderItemIDs[4]).isValid(), false);
+  CHECK_EXIT_SUCCESS(CheckRows(model, sceneItemID));
+  model.fetchMore(sceneIndex);
+  model.fetchMore(sceneIndex);
+  CHECK_INT(model.rowCount(sceneIndex), 10);
+  CHECK_BOOL(model.canFetchMore(sceneIndex), false);
+  CHECK_EXIT_SUCCESS(CheckRows(model, sceneItemID));
+
+  // New item under a fetched parent
+  vtkIdType newItemID = shNode->CreateFolderItem(sceneItemID, "NewFolder");
+  CHECK_INT(model.rowCount(sceneIndex), 11);
+  CHECK_INT(model.indexFromSubjectHierarchyItem(newItemID).row(), 10);
+  CHECK_EXIT_SUCCESS(CheckRows(model, sceneItemID));
+
+  // Items moved up and down under their parent
+  CHECK_BOOL(shNode->MoveItem(newItemID, folderItemIDs[2]), true);
+  CHECK_INT(model.indexFromSubjectHierarchyItem(newItemID).row(), 2);
+  CHECK_EXIT_SUCCESS(CheckRows(model, sceneItemID));
+  CHECK_BOOL(shNode->MoveItem(folderItemIDs[0], folderItemIDs[5]), true);
+  CHECK_EXIT_SUCCESS(CheckRows(model, sceneItemID));
+
+  // Removed item
+  CHECK_BOOL(shNode->RemoveItem(folderItemIDs[1]), true);
+  CHECK_INT(model.rowCount(sceneIndex), 10);
+  CHECK_EXIT_SUCCESS(CheckRows(model, sceneItemID));
+
+  // Item reparented under a parent whose children have not been fetched
+  shNode->SetItemParent(folderItemIDs[3], folderItemIDs[0]);
+  CHECK_INT(model.rowCount(sceneIndex), 9);
+  CHECK_BOOL(model.indexFromSubjectHierarchyItem(folderItemIDs[3]).isValid(), false);
+  CHECK_EXIT_SUCCESS(CheckRows(model, sceneItemID));
+  QModelIndex folderIndex = model.indexFromSubjectHierarchyItem(folderItemIDs[0]);
+  CHECK_BOOL(model.canFetchMore(folderIndex), true);
+  model.fetchMore(folderIndex);
+  CHECK_INT(model.rowCount(folderIndex), 4);
+  CHECK_INT(model.indexFromSubjectHierarchyItem(folderItemIDs[3]).row(), 3);
+  CHECK_EXIT_SUCCESS(CheckRows(model, folderItemIDs[0]));
+
+  // Item reparented back under a fetched parent
+  shNode->SetItemParent(folderItemIDs[3], sceneItemID);
+  CHECK_INT(model.rowCount(folderIndex), 3);
+  CHECK_INT(model.indexFromSubjectHierarchyItem(folderItemIDs[3]).row(), 9);
+  CHECK_EXIT_SUCCESS(CheckRows(model, sceneItemID));
+  CHECK_EXIT_SUCCESS(CheckRows(model, folderItemIDs[0]));
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int qMRMLSubjectHierarchyLazyModelTest1(int argc, char * argv [])
+{
+  QApplication app(argc, argv);
+  CHECK_EXIT_SUCCESS(TestRows());
+  return EXIT_SUCCESS;
+}
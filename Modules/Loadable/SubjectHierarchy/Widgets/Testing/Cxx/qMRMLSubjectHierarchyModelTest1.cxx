@@ -0,0 +1,158 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QApplication>
+
+// CTK includes
+#include <ctkModelTester.h>
+
+// SubjectHierarchy includes
+#include "qMRMLSubjectHierarchyModel.h"
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSubjectHierarchyNode.h>
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// Check that the incrementally updated model finds every subject hierarchy item
+// at the same place as a model built from scratch from the same hierarchy
+int CompareWithRebuiltModel(qMRMLSubjectHierarchyModel& model, vtkMRMLScene* scene)
+{
+  QApplication::processEvents();
+
+  qMRMLSubjectHierarchyModel rebuiltModel;
+  rebuiltModel.setMRMLScene(scene);
+
+  vtkMRMLSubjectHierarchyNode* shNode = model.subjectHierarchyNode();
+  vtkIdType sceneItemID = shNode->GetSceneItemID();
+  std::vector<vtkIdType> itemIDs;
+  shNode->GetItemChildren(sceneItemID, itemIDs, true);
+  itemIDs.push_back(sceneItemID);
+  for (std::vector<vtkIdType>::iterator itemIt = itemIDs.begin(); itemIt != itemIDs.end(); ++itemIt)
+    {
+    QModelIndex index = model.indexFromSubjectHierarchyItem(*itemIt);
+    QModelIndex rebuiltIndex = rebuiltModel.indexFromSubjectHierarchyItem(*itemIt);
+    CHECK_BOOL(index.isValid(), true);
+    CHECK_BOOL(rebuiltIndex.isValid(), true);
+    CHECK_BOOL(model.subjectHierarchyItemFromIndex(index) == *itemIt, true);
+    CHECK_INT(index.row(), rebuiltIndex.row());
+    CHECK_BOOL(model.subjectHierarchyItemFromIndex(index.parent())
+      == rebuiltModel.subjectHierarchyItemFromIndex(rebuiltIndex.parent()), true);
+    CHECK_INT(model.rowCount(index), rebuiltModel.rowCount(rebuiltIndex));
+    if (*itemIt != sceneItemID)
+      {
+      CHECK_INT(index.row(), shNode->GetItemPositionUnderParent(*itemIt));
+      }
+    }
+  CHECK_INT(model.rowCount(), rebuiltModel.rowCount());
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<vtkIdType> CreateFolders(vtkMRMLSubjectHierarchyNode* shNode, vtkIdType parentItemID,
+                                     const std::string& prefix, int count)
+{
+  std::vector<vtkIdType> folderItemIDs;
+  for (int i=0; i<count; ++i)
+    {
+    std::stringstream name;
+    name << prefix << i;
+    folderItemIDs.push_back(shNode->CreateFolderItem(parentItemID, name.str()));
+    }
+  return folderItemIDs;
+}
+
+//-----------------------------------------------------------------------------
+int TestIncrementalUpdate()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSubjectHierarchyNode* shNode = vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(scene.GetPointer());
+  CHECK_NOT_NULL(shNode);
+  vtkIdType sceneItemID = shNode->GetSceneItemID();
+
+  std::vector<vtkIdType> folderItemIDs = CreateFolders(shNode, sceneItemID, "Folder", 5);
+  std::vector<vtkIdType> subfolderItemIDs = CreateFolders(shNode, folderItemIDs[0], "Subfolder", 3);
+
+  qMRMLSubjectHierarchyModel model;
+  ctkModelTester tester(&model);
+  tester.setTestDataEnabled(false);
+  model.setMRMLScene(scene.GetPointer());
+  CHECK_EXIT_SUCCESS(CompareWithRebuiltModel(model, scene.GetPointer()));
+
+  // Inserted items
+  vtkIdType newFolderItemID = shNode->CreateFolderItem(sceneItemID, "NewFolder");
+  CHECK_EXIT_SUCCESS(CompareWithRebuiltModel(model, scene.GetPointer()));
+  vtkIdType newSubfolderItemID = shNode->CreateFolderItem(folderItemIDs[2], "NewSubfolder");
+  CHECK_EXIT_SUCCESS(CompareWithRebuiltModel(model, scene.GetPointer()));
+
+  // Reparented items, with their children
+  shNode->SetItemParent(folderItemIDs[0], folderItemIDs[3]);
+  CHECK_EXIT_SUCCESS(CompareWithRebuiltModel(model, scene.GetPointer()));
+  shNode->SetItemParent(subfolderItemIDs[1], sceneItemID);
+  CHECK_EXIT_SUCCESS(CompareWithRebuiltModel(model, scene.GetPointer()));
+  shNode->SetItemParent(newSubfolderItemID, subfolderItemIDs[1]);
+  CHECK_EXIT_SUCCESS(CompareWithRebuiltModel(model, scene.GetPointer()));
+  shNode->SetItemParent(folderItemIDs[0], sceneItemID);
+  CHECK_EXIT_SUCCESS(CompareWithRebuiltModel(model, scene.GetPointer()));
+
+  // Items moved under their parent
+  CHECK_BOOL(shNode->MoveItem(newFolderItemID, folderItemIDs[1]), true);
+  CHECK_EXIT_SUCCESS(CompareWithRebuiltModel(model, scene.GetPointer()));
+  CHECK_BOOL(shNode->MoveItem(folderItemIDs[1], folderItemIDs[4]), true);
+  CHECK_EXIT_SUCCESS(CompareWithRebuiltModel(model, scene.GetPointer()));
+
+  // Items added and reparented during batch processing are applied at the end
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  std::vector<vtkIdType> batchFolderItemIDs = CreateFolders(shNode, sceneItemID, "BatchFolder", 4);
+  CreateFolders(shNode, batchFolderItemIDs[1], "BatchSubfolder", 3);
+  shNode->SetItemParent(folderItemIDs[2], batchFolderItemIDs[3]);
+  shNode->SetItemParent(batchFolderItemIDs[0], folderItemIDs[4]);
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+  CHECK_EXIT_SUCCESS(CompareWithRebuiltModel(model, scene.GetPointer()));
+
+  // Items removed during batch processing
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  CHECK_BOOL(shNode->RemoveItem(batchFolderItemIDs[1]), true);
+  shNode->CreateFolderItem(folderItemIDs[4], "BatchFolderAfterRemoval");
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+  CHECK_EXIT_SUCCESS(CompareWithRebuiltModel(model, scene.GetPointer()));
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int qMRMLSubjectHierarchyModelTest1(int argc, char * argv [])
+{
+  QApplication app(argc, argv);
+  CHECK_EXIT_SUCCESS(TestIncrementalUpdate());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,1015 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDebug>
+#include <QHash>
+#include <QIcon>
+#include <QList>
+
+// SubjectHierarchy includes
+#include "qMRMLSubjectHierarchyLazyModel.h"
+#include "qMRMLSubjectHierarchyModel.h"
+#include "qSlicerSubjectHierarchyPluginHandler.h"
+#include "qSlicerSubjectHierarchyAbstractPlugin.h"
+
+// MRML includes
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSubjectHierarchyNode.h>
+#include <vtkMRMLTransformableNode.h>
+#include <vtkMRMLTransformNode.h>
+
+// VTK includes
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <vector>
+
+namespace
+{
+//------------------------------------------------------------------------------
+vtkIdType itemIDFromCallData(void* callData)
+{
+  vtkIdType* itemIdPtr = reinterpret_cast<vtkIdType*>(callData);
+  return itemIdPtr ? *itemIdPtr : vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID;
+}
+}
+
+//------------------------------------------------------------------------------
+/// \ingroup Slicer_QtModules_SubjectHierarchy
+class qMRMLSubjectHierarchyLazyModelPrivate
+{
+  Q_DECLARE_PUBLIC(qMRMLSubjectHierarchyLazyModel);
+
+protected:
+  qMRMLSubjectHierarchyLazyModel* const q_ptr;
+
+public:
+  qMRMLSubjectHierarchyLazyModelPrivate(qMRMLSubjectHierarchyLazyModel& object);
+
+  /// Row of an exposed item under its parent, -1 if the item is not exposed
+  int exposedRow(vtkIdType itemID)const;
+  /// Update the rows of the exposed children of an item, from the given row to the last one
+  void updateExposedRows(vtkIdType parentItemID, int firstRow);
+  /// Forget an item and all its exposed descendants
+  void forgetItem(vtkIdType itemID);
+  /// Returns true if the model is not updated during the current scene operation
+  bool isUpdateDeferred()const;
+
+public:
+  int NameColumn;
+  int IDColumn;
+  int VisibilityColumn;
+  int TransformColumn;
+  int FetchBatchSize;
+
+  QIcon UnknownIcon;
+  QIcon WarningIcon;
+
+  vtkWeakPointer<vtkMRMLSubjectHierarchyNode> SubjectHierarchyNode;
+  vtkWeakPointer<vtkMRMLScene> MRMLScene;
+
+  /// Children exposed in the model, for each item whose children have been fetched.
+  /// Items that are not in the map have no rows.
+  QHash<vtkIdType, QList<vtkIdType> > ExposedChildren;
+  /// Parent of each exposed item (the scene item has an invalid parent)
+  QHash<vtkIdType, vtkIdType> ExposedParents;
+  /// Row of each exposed item under its parent, so that the index of an item can be
+  /// created without searching the children of its parent
+  QHash<vtkIdType, int> ExposedRows;
+  /// Parent of the exposed item being removed, so that its children can be exposed after removal
+  vtkIdType RemovedItemParentID;
+  /// Set if the subject hierarchy changed during batch processing
+  bool ResetPending;
+};
+
+//------------------------------------------------------------------------------
+qMRMLSubjectHierarchyLazyModelPrivate::qMRMLSubjectHierarchyLazyModelPrivate(qMRMLSubjectHierarchyLazyModel& object)
+  : q_ptr(&object)
+  , NameColumn(0)
+  , IDColumn(3)
+  , VisibilityColumn(1)
+  , TransformColumn(2)
+  , FetchBatchSize(256)
+  , SubjectHierarchyNode(NULL)
+  , MRMLScene(NULL)
+  , RemovedItemParentID(vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+  , ResetPending(false)
+{
+  this->UnknownIcon = QIcon(":Icons/Unknown.png");
+  this->WarningIcon = QIcon(":Icons/Warning.png");
+}
+
+//------------------------------------------------------------------------------
+int qMRMLSubjectHierarchyLazyModelPrivate::exposedRow(vtkIdType itemID)const
+{
+  return this->ExposedRows.value(itemID, -1);
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModelPrivate::updateExposedRows(vtkIdType parentItemID, int firstRow)
+{
+  QHash<vtkIdType, QList<vtkIdType> >::const_iterator childrenIt = this->ExposedChildren.find(parentItemID);
+  if (childrenIt == this->ExposedChildren.end())
+    {
+    return;
+    }
+  const QList<vtkIdType>& childIDs = childrenIt.value();
+  for (int row=qMax(firstRow, 0); row<childIDs.size(); ++row)
+    {
+    this->ExposedRows[childIDs[row]] = row;
+    }
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModelPrivate::forgetItem(vtkIdType itemID)
+{
+  QHash<vtkIdType, QList<vtkIdType> >::iterator childrenIt = this->ExposedChildren.find(itemID);
+  if (childrenIt != this->ExposedChildren.end())
+    {
+    QList<vtkIdType> childIDs = childrenIt.value();
+    this->ExposedChildren.erase(childrenIt);
+    foreach (vtkIdType childID, childIDs)
+      {
+      this->forgetItem(childID);
+      }
+    }
+  this->ExposedParents.remove(itemID);
+  this->ExposedRows.remove(itemID);
+}
+
+//------------------------------------------------------------------------------
+bool qMRMLSubjectHierarchyLazyModelPrivate::isUpdateDeferred()const
+{
+  return this->MRMLScene && (this->MRMLScene->IsClosing() || this->MRMLScene->IsBatchProcessing());
+}
+
+//------------------------------------------------------------------------------
+// qMRMLSubjectHierarchyLazyModel
+//------------------------------------------------------------------------------
+qMRMLSubjectHierarchyLazyModel::qMRMLSubjectHierarchyLazyModel(QObject *_parent)
+  : QAbstractItemModel(_parent)
+  , d_ptr(new qMRMLSubjectHierarchyLazyModelPrivate(*this))
+{
+}
+
+//------------------------------------------------------------------------------
+qMRMLSubjectHierarchyLazyModel::~qMRMLSubjectHierarchyLazyModel()
+{
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::setMRMLScene(vtkMRMLScene* scene)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  if (scene == d->MRMLScene)
+    {
+    return;
+    }
+
+  qvtkReconnect( d->MRMLScene, scene, vtkMRMLScene::EndBatchProcessEvent, this, SLOT( onMRMLSceneEndBatchProcess(vtkObject*) ) );
+  qvtkReconnect( d->MRMLScene, scene, vtkMRMLScene::EndCloseEvent, this, SLOT( onMRMLSceneCloseEnded(vtkObject*) ) );
+  qvtkReconnect( d->MRMLScene, scene, vtkMRMLScene::NodeRemovedEvent, this, SLOT( onMRMLNodeRemoved(vtkObject*,vtkObject*) ) );
+
+  d->MRMLScene = scene;
+  this->setSubjectHierarchyNode(vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(scene));
+}
+
+//------------------------------------------------------------------------------
+vtkMRMLScene* qMRMLSubjectHierarchyLazyModel::mrmlScene()const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  return d->MRMLScene;
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::setSubjectHierarchyNode(vtkMRMLSubjectHierarchyNode* shNode)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  if (shNode == d->SubjectHierarchyNode)
+    {
+    return;
+    }
+
+  // Using priority value of -10 in certain observations results in those callbacks being called after
+  // those with neutral priorities, so that the plugin handler deals with new items first (see qMRMLSubjectHierarchyModel)
+  qvtkReconnect( d->SubjectHierarchyNode, shNode, vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAddedEvent,
+                 this, SLOT( onSubjectHierarchyItemAdded(vtkObject*,void*) ), -10.0 );
+  qvtkReconnect( d->SubjectHierarchyNode, shNode, vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAboutToBeRemovedEvent,
+                 this, SLOT( onSubjectHierarchyItemAboutToBeRemoved(vtkObject*,void*) ), +10.0 );
+  qvtkReconnect( d->SubjectHierarchyNode, shNode, vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemRemovedEvent,
+                 this, SLOT( onSubjectHierarchyItemRemoved(vtkObject*,void*) ), -10.0 );
+  qvtkReconnect( d->SubjectHierarchyNode, shNode, vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemModifiedEvent,
+                 this, SLOT( onSubjectHierarchyItemModified(vtkObject*,void*) ), -10.0 );
+
+  d->SubjectHierarchyNode = shNode;
+  this->resetExposedItems();
+}
+
+//------------------------------------------------------------------------------
+vtkMRMLSubjectHierarchyNode* qMRMLSubjectHierarchyLazyModel::subjectHierarchyNode()const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  return d->SubjectHierarchyNode;
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::resetExposedItems()
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+
+  this->beginResetModel();
+  d->ExposedChildren.clear();
+  d->ExposedParents.clear();
+  d->ExposedRows.clear();
+  d->ResetPending = false;
+  if (d->SubjectHierarchyNode)
+    {
+    // The scene item is always exposed, as the only top-level row
+    d->ExposedParents[d->SubjectHierarchyNode->GetSceneItemID()] = vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID;
+    d->ExposedRows[d->SubjectHierarchyNode->GetSceneItemID()] = 0;
+    }
+  this->endResetModel();
+
+  if (d->SubjectHierarchyNode && d->SubjectHierarchyNode->GetItemExpanded(d->SubjectHierarchyNode->GetSceneItemID()))
+    {
+    emit requestExpandItem(d->SubjectHierarchyNode->GetSceneItemID());
+    }
+}
+
+//------------------------------------------------------------------------------
+QModelIndex qMRMLSubjectHierarchyLazyModel::createItemIndex(vtkIdType itemID, int row, int column)const
+{
+#if (QT_VERSION < QT_VERSION_CHECK(5, 0, 0))
+  return this->createIndex(row, column, static_cast<quint32>(itemID));
+#else
+  return this->createIndex(row, column, static_cast<quintptr>(itemID));
+#endif
+}
+
+//------------------------------------------------------------------------------
+QModelIndex qMRMLSubjectHierarchyLazyModel::subjectHierarchySceneIndex()const
+{
+  return this->index(0, 0);
+}
+
+//------------------------------------------------------------------------------
+vtkIdType qMRMLSubjectHierarchyLazyModel::subjectHierarchyItemFromIndex(const QModelIndex &index)const
+{
+  if (!index.isValid() || index.model() != this)
+    {
+    return vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID;
+    }
+  return static_cast<vtkIdType>(index.internalId());
+}
+
+//------------------------------------------------------------------------------
+QModelIndex qMRMLSubjectHierarchyLazyModel::indexFromSubjectHierarchyItem(vtkIdType itemID, int column/*=0*/)const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  int row = d->exposedRow(itemID);
+  if (row < 0 || column < 0 || column >= this->columnCount())
+    {
+    return QModelIndex();
+    }
+  return this->createItemIndex(itemID, row, column);
+}
+
+//------------------------------------------------------------------------------
+QModelIndex qMRMLSubjectHierarchyLazyModel::index(int row, int column, const QModelIndex& parent/*=QModelIndex()*/)const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  if (!d->SubjectHierarchyNode || row < 0 || column < 0 || column >= this->columnCount())
+    {
+    return QModelIndex();
+    }
+  if (!parent.isValid())
+    {
+    // The only top-level item is the scene
+    return (row == 0 ? this->createItemIndex(d->SubjectHierarchyNode->GetSceneItemID(), 0, column) : QModelIndex());
+    }
+  if (parent.column() != 0)
+    {
+    return QModelIndex();
+    }
+  QHash<vtkIdType, QList<vtkIdType> >::const_iterator childrenIt =
+    d->ExposedChildren.find(this->subjectHierarchyItemFromIndex(parent));
+  if (childrenIt == d->ExposedChildren.end() || row >= childrenIt.value().size())
+    {
+    return QModelIndex();
+    }
+  return this->createItemIndex(childrenIt.value()[row], row, column);
+}
+
+//------------------------------------------------------------------------------
+QModelIndex qMRMLSubjectHierarchyLazyModel::parent(const QModelIndex& index)const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  vtkIdType parentItemID = d->ExposedParents.value(
+    this->subjectHierarchyItemFromIndex(index), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID );
+  if (parentItemID == vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+    {
+    return QModelIndex();
+    }
+  return this->indexFromSubjectHierarchyItem(parentItemID);
+}
+
+//------------------------------------------------------------------------------
+int qMRMLSubjectHierarchyLazyModel::rowCount(const QModelIndex& parent/*=QModelIndex()*/)const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  if (!d->SubjectHierarchyNode)
+    {
+    return 0;
+    }
+  if (!parent.isValid())
+    {
+    return 1;
+    }
+  if (parent.column() != 0)
+    {
+    return 0;
+    }
+  // Only the fetched children are counted
+  return d->ExposedChildren.value(this->subjectHierarchyItemFromIndex(parent)).size();
+}
+
+//------------------------------------------------------------------------------
+int qMRMLSubjectHierarchyLazyModel::columnCount(const QModelIndex& parent/*=QModelIndex()*/)const
+{
+  Q_UNUSED(parent);
+  return this->maxColumnId() + 1;
+}
+
+//------------------------------------------------------------------------------
+bool qMRMLSubjectHierarchyLazyModel::hasChildren(const QModelIndex& parent/*=QModelIndex()*/)const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  if (!d->SubjectHierarchyNode)
+    {
+    return false;
+    }
+  if (!parent.isValid())
+    {
+    return true;
+    }
+  if (parent.column() != 0)
+    {
+    return false;
+    }
+  // Children that are not fetched yet also count, so that the item can be expanded
+  return d->SubjectHierarchyNode->GetNumberOfItemChildren(this->subjectHierarchyItemFromIndex(parent)) > 0;
+}
+
+//------------------------------------------------------------------------------
+bool qMRMLSubjectHierarchyLazyModel::canFetchMore(const QModelIndex& parent)const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  if (!d->SubjectHierarchyNode || !parent.isValid() || parent.column() != 0)
+    {
+    return false;
+    }
+  vtkIdType parentItemID = this->subjectHierarchyItemFromIndex(parent);
+  return d->ExposedChildren.value(parentItemID).size() < d->SubjectHierarchyNode->GetNumberOfItemChildren(parentItemID);
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::fetchMore(const QModelIndex& parent)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  if (!d->SubjectHierarchyNode || !parent.isValid() || parent.column() != 0)
+    {
+    return;
+    }
+  vtkIdType parentItemID = this->subjectHierarchyItemFromIndex(parent);
+
+  // Collect the next batch of children that are not exposed yet
+  std::vector<vtkIdType> childIDs;
+  d->SubjectHierarchyNode->GetItemChildren(parentItemID, childIDs, false);
+  QList<vtkIdType> newChildIDs;
+  for (std::vector<vtkIdType>::iterator childIt=childIDs.begin(); childIt!=childIDs.end(); ++childIt)
+    {
+    if (d->ExposedParents.contains(*childIt))
+      {
+      continue;
+      }
+    newChildIDs << (*childIt);
+    if (newChildIDs.size() >= d->FetchBatchSize)
+      {
+      break;
+      }
+    }
+  if (newChildIDs.isEmpty())
+    {
+    return;
+    }
+
+  int firstRow = d->ExposedChildren.value(parentItemID).size();
+  this->beginInsertRows(parent, firstRow, firstRow + newChildIDs.size() - 1);
+  d->ExposedChildren[parentItemID].append(newChildIDs);
+  foreach (vtkIdType childID, newChildIDs)
+    {
+    d->ExposedParents[childID] = parentItemID;
+    }
+  d->updateExposedRows(parentItemID, firstRow);
+  this->endInsertRows();
+
+  // Restore expanded states stored in the subject hierarchy
+  foreach (vtkIdType childID, newChildIDs)
+    {
+    if (d->SubjectHierarchyNode->GetItemExpanded(childID) && d->SubjectHierarchyNode->GetNumberOfItemChildren(childID) > 0)
+      {
+      emit requestExpandItem(childID);
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+QVariant qMRMLSubjectHierarchyLazyModel::data(const QModelIndex& index, int role/*=Qt::DisplayRole*/)const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  vtkIdType itemID = this->subjectHierarchyItemFromIndex(index);
+  if (!d->SubjectHierarchyNode || itemID == vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+    {
+    return QVariant();
+    }
+  if (role == qMRMLSubjectHierarchyModel::SubjectHierarchyItemIDRole)
+    {
+    return QVariant(qlonglong(itemID));
+    }
+
+  int column = index.column();
+  if (itemID == d->SubjectHierarchyNode->GetSceneItemID())
+    {
+    return (column == this->nameColumn() && role == Qt::DisplayRole ? QVariant("Scene") : QVariant());
+    }
+
+  qSlicerSubjectHierarchyAbstractPlugin* ownerPlugin = NULL;
+  bool hasOwnerPluginName = !d->SubjectHierarchyNode->GetItemOwnerPluginName(itemID).empty();
+  if (hasOwnerPluginName)
+    {
+    ownerPlugin = qSlicerSubjectHierarchyPluginHandler::instance()->getOwnerPluginForSubjectHierarchyItem(itemID);
+    }
+
+  // Name column
+  if (column == this->nameColumn())
+    {
+    if (role == Qt::DisplayRole || role == Qt::EditRole)
+      {
+      return (ownerPlugin ? ownerPlugin->displayedItemName(itemID)
+                          : QString(d->SubjectHierarchyNode->GetItemName(itemID).c_str()));
+      }
+    if (role == Qt::ToolTipRole)
+      {
+      if (ownerPlugin)
+        {
+        return ownerPlugin->tooltip(itemID);
+        }
+      return (hasOwnerPluginName ? tr("No subject hierarchy role assigned! Please report error") : QVariant());
+      }
+    if (role == Qt::DecorationRole)
+      {
+      if (!ownerPlugin)
+        {
+        return (hasOwnerPluginName ? d->WarningIcon : d->UnknownIcon);
+        }
+      QIcon icon = ownerPlugin->icon(itemID);
+      return (icon.isNull() ? d->UnknownIcon : icon);
+      }
+    }
+  // ID column
+  else if (column == this->idColumn())
+    {
+    vtkMRMLNode* dataNode = d->SubjectHierarchyNode->GetItemDataNode(itemID);
+    if (role == Qt::DisplayRole && dataNode)
+      {
+      return QString(dataNode->GetID());
+      }
+    }
+  // Visibility column
+  else if (column == this->visibilityColumn())
+    {
+    if (ownerPlugin && (role == Qt::DecorationRole || role == qMRMLSubjectHierarchyModel::VisibilityRole))
+      {
+      int visible = ownerPlugin->getDisplayVisibility(itemID);
+      if (role == qMRMLSubjectHierarchyModel::VisibilityRole)
+        {
+        return visible;
+        }
+      QIcon visibilityIcon = ownerPlugin->visibilityIcon(visible);
+      return (visibilityIcon.isNull() ? QVariant() : QVariant(visibilityIcon));
+      }
+    }
+  // Transform column
+  else if (column == this->transformColumn())
+    {
+    if (role == Qt::WhatsThisRole)
+      {
+      return QString("Transform");
+      }
+    vtkMRMLTransformableNode* transformableNode = vtkMRMLTransformableNode::SafeDownCast(
+      d->SubjectHierarchyNode->GetItemDataNode(itemID) );
+    if (!transformableNode)
+      {
+      return (role == Qt::ToolTipRole ? tr("No transform can be directly applied on non-transformable nodes,\n"
+        "however a transform can be chosen to apply it on all the children") : QVariant());
+      }
+    vtkMRMLTransformNode* parentTransformNode = transformableNode->GetParentTransformNode();
+    if (!parentTransformNode)
+      {
+      return QVariant();
+      }
+    if (role == Qt::DisplayRole)
+      {
+      return QString(parentTransformNode->GetName());
+      }
+    if (role == qMRMLSubjectHierarchyModel::TransformIDRole)
+      {
+      return QString(parentTransformNode->GetID());
+      }
+    if (role == Qt::ToolTipRole)
+      {
+      return tr("%1 (%2)").arg(parentTransformNode->GetName()).arg(parentTransformNode->GetID());
+      }
+    }
+
+  return QVariant();
+}
+
+//------------------------------------------------------------------------------
+bool qMRMLSubjectHierarchyLazyModel::setData(const QModelIndex& index, const QVariant& value, int role/*=Qt::EditRole*/)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  vtkIdType itemID = this->subjectHierarchyItemFromIndex(index);
+  if (!d->SubjectHierarchyNode || itemID == vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID
+    || itemID == d->SubjectHierarchyNode->GetSceneItemID())
+    {
+    return false;
+    }
+
+  // The views are updated through the item modified event
+  if (index.column() == this->nameColumn() && role == Qt::EditRole)
+    {
+    // This call renames associated data node if any
+    d->SubjectHierarchyNode->SetItemName(itemID, value.toString().toLatin1().constData());
+    return true;
+    }
+  if (index.column() == this->visibilityColumn() && role == qMRMLSubjectHierarchyModel::VisibilityRole)
+    {
+    qSlicerSubjectHierarchyAbstractPlugin* ownerPlugin =
+      qSlicerSubjectHierarchyPluginHandler::instance()->getOwnerPluginForSubjectHierarchyItem(itemID);
+    int visible = value.toInt();
+    if (!ownerPlugin || visible < 0)
+      {
+      return false;
+      }
+    if (visible != ownerPlugin->getDisplayVisibility(itemID))
+      {
+      ownerPlugin->setDisplayVisibility(itemID, visible);
+      }
+    return true;
+    }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+Qt::ItemFlags qMRMLSubjectHierarchyLazyModel::flags(const QModelIndex& index)const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  vtkIdType itemID = this->subjectHierarchyItemFromIndex(index);
+  if (!d->SubjectHierarchyNode || itemID == vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+    {
+    return Qt::NoItemFlags;
+    }
+  if (itemID == d->SubjectHierarchyNode->GetSceneItemID())
+    {
+    return Qt::ItemIsEnabled;
+    }
+  Qt::ItemFlags itemFlags = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+  if (index.column() == this->nameColumn())
+    {
+    itemFlags |= Qt::ItemIsEditable;
+    }
+  return itemFlags;
+}
+
+//------------------------------------------------------------------------------
+QVariant qMRMLSubjectHierarchyLazyModel::headerData(int section, Qt::Orientation orientation, int role/*=Qt::DisplayRole*/)const
+{
+  if (orientation != Qt::Horizontal)
+    {
+    return QVariant();
+    }
+  if (section == this->nameColumn())
+    {
+    if (role == Qt::DisplayRole)
+      {
+      return tr("Node");
+      }
+    if (role == Qt::ToolTipRole)
+      {
+      return tr("Node name and type");
+      }
+    }
+  else if (section == this->visibilityColumn())
+    {
+    if (role == Qt::DecorationRole)
+      {
+      return QIcon(":/Icons/Small/SlicerVisibleInvisible.png");
+      }
+    if (role == Qt::ToolTipRole)
+      {
+      return tr("Show/hide branch or node");
+      }
+    }
+  else if (section == this->transformColumn())
+    {
+    if (role == Qt::DecorationRole)
+      {
+      return QIcon(":/Icons/Transform.png");
+      }
+    if (role == Qt::ToolTipRole)
+      {
+      return tr("Applied transform");
+      }
+    }
+  else if (section == this->idColumn())
+    {
+    if (role == Qt::DisplayRole)
+      {
+      return tr("IDs");
+      }
+    if (role == Qt::ToolTipRole)
+      {
+      return tr("Node ID");
+      }
+    }
+  return QVariant();
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::insertItemRow(vtkIdType itemID)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  vtkIdType parentItemID = d->SubjectHierarchyNode->GetItemParent(itemID);
+  if (!d->ExposedParents.contains(parentItemID))
+    {
+    // Parent is not exposed, the item is fetched when the parent is
+    return;
+    }
+  QHash<vtkIdType, QList<vtkIdType> >::iterator childrenIt = d->ExposedChildren.find(parentItemID);
+  if (childrenIt == d->ExposedChildren.end() && d->SubjectHierarchyNode->GetNumberOfItemChildren(parentItemID) > 1)
+    {
+    // Children of the parent have not been fetched yet
+    return;
+    }
+  int row = d->SubjectHierarchyNode->GetItemPositionUnderParent(itemID);
+  int exposedChildCount = (childrenIt == d->ExposedChildren.end() ? 0 : childrenIt.value().size());
+  if (row > exposedChildCount)
+    {
+    // Preceding siblings are not fetched yet, the item is fetched with them
+    return;
+    }
+
+  this->beginInsertRows(this->indexFromSubjectHierarchyItem(parentItemID), row, row);
+  d->ExposedChildren[parentItemID].insert(row, itemID);
+  d->ExposedParents[itemID] = parentItemID;
+  d->updateExposedRows(parentItemID, row);
+  this->endInsertRows();
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::removeItemRow(vtkIdType itemID)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  vtkIdType parentItemID = d->ExposedParents.value(itemID, vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  int row = d->exposedRow(itemID);
+  if (parentItemID == vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID || row < 0)
+    {
+    return;
+    }
+
+  this->beginRemoveRows(this->indexFromSubjectHierarchyItem(parentItemID), row, row);
+  d->ExposedChildren[parentItemID].removeAt(row);
+  d->forgetItem(itemID);
+  d->updateExposedRows(parentItemID, row);
+  this->endRemoveRows();
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::moveItemRowIfNeeded(vtkIdType itemID)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  vtkIdType parentItemID = d->ExposedParents.value(itemID, vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  if (parentItemID == vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+    {
+    return;
+    }
+  QList<vtkIdType>& siblingIDs = d->ExposedChildren[parentItemID];
+  int oldRow = d->exposedRow(itemID);
+
+  // Quick check: the item is in place if it is between its exposed neighbors in the subject hierarchy
+  int position = d->SubjectHierarchyNode->GetItemPositionUnderParent(itemID);
+  if ( (oldRow == 0 || d->SubjectHierarchyNode->GetItemPositionUnderParent(siblingIDs[oldRow-1]) < position)
+    && (oldRow == siblingIDs.size()-1 || d->SubjectHierarchyNode->GetItemPositionUnderParent(siblingIDs[oldRow+1]) > position) )
+    {
+    return;
+    }
+
+  // Find new row: after all the exposed siblings that precede the item in the subject hierarchy
+  std::vector<vtkIdType> childIDs;
+  d->SubjectHierarchyNode->GetItemChildren(parentItemID, childIDs, false);
+  QHash<vtkIdType, int> positions;
+  for (int childIndex=0; childIndex<static_cast<int>(childIDs.size()); ++childIndex)
+    {
+    positions[childIDs[childIndex]] = childIndex;
+    }
+  int newRow = 0;
+  foreach (vtkIdType siblingID, siblingIDs)
+    {
+    // Siblings being reparented are not under the parent anymore
+    int siblingPosition = positions.value(siblingID, -1);
+    if (siblingID != itemID && siblingPosition >= 0 && siblingPosition < position)
+      {
+      ++newRow;
+      }
+    }
+  if (newRow == oldRow)
+    {
+    return;
+    }
+
+  QModelIndex parentIndex = this->indexFromSubjectHierarchyItem(parentItemID);
+  // When moving down, the destination row is given as the row before which the item is inserted
+  if (this->beginMoveRows(parentIndex, oldRow, oldRow, parentIndex, (newRow > oldRow ? newRow+1 : newRow)))
+    {
+    siblingIDs.move(oldRow, newRow);
+    d->updateExposedRows(parentItemID, qMin(oldRow, newRow));
+    this->endMoveRows();
+    }
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::sortChildRowsIfNeeded(vtkIdType parentItemID)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  QHash<vtkIdType, QList<vtkIdType> >::iterator childrenIt = d->ExposedChildren.find(parentItemID);
+  if (childrenIt == d->ExposedChildren.end())
+    {
+    return;
+    }
+
+  // Exposed children in their order in the subject hierarchy
+  std::vector<vtkIdType> childIDs;
+  d->SubjectHierarchyNode->GetItemChildren(parentItemID, childIDs, false);
+  QList<vtkIdType> orderedChildIDs;
+  for (std::vector<vtkIdType>::iterator childIt=childIDs.begin(); childIt!=childIDs.end(); ++childIt)
+    {
+    if (d->ExposedParents.value(*childIt, vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID) == parentItemID)
+      {
+      orderedChildIDs << (*childIt);
+      }
+    }
+  QList<vtkIdType>& exposedChildIDs = childrenIt.value();
+  if (orderedChildIDs.size() != exposedChildIDs.size())
+    {
+    // A child is being reparented, its row is updated when the child itself is modified
+    return;
+    }
+
+  QModelIndex parentIndex = this->indexFromSubjectHierarchyItem(parentItemID);
+  for (int row=0; row<orderedChildIDs.size(); ++row)
+    {
+    if (exposedChildIDs[row] == orderedChildIDs[row])
+      {
+      continue;
+      }
+    // Move the expected child up from its current row
+    int oldRow = d->exposedRow(orderedChildIDs[row]);
+    if (this->beginMoveRows(parentIndex, oldRow, oldRow, parentIndex, row))
+      {
+      exposedChildIDs.move(oldRow, row);
+      d->updateExposedRows(parentItemID, row);
+      this->endMoveRows();
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::onSubjectHierarchyItemAdded(vtkObject* caller, void* callData)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  Q_UNUSED(caller);
+  if (d->isUpdateDeferred())
+    {
+    d->ResetPending = true;
+    return;
+    }
+  this->insertItemRow(itemIDFromCallData(callData));
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::onSubjectHierarchyItemAboutToBeRemoved(vtkObject* caller, void* callData)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  Q_UNUSED(caller);
+  if (d->isUpdateDeferred())
+    {
+    d->ResetPending = true;
+    return;
+    }
+  vtkIdType itemID = itemIDFromCallData(callData);
+  d->RemovedItemParentID = d->ExposedParents.value(itemID, vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  this->removeItemRow(itemID);
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::onSubjectHierarchyItemRemoved(vtkObject* caller, void* callData)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  Q_UNUSED(caller);
+  Q_UNUSED(callData);
+  vtkIdType parentItemID = d->RemovedItemParentID;
+  d->RemovedItemParentID = vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID;
+  if (d->isUpdateDeferred() || !d->ExposedChildren.contains(parentItemID))
+    {
+    return;
+    }
+  // The children of the removed item have been moved under its parent
+  QModelIndex parentIndex = this->indexFromSubjectHierarchyItem(parentItemID);
+  if (this->canFetchMore(parentIndex))
+    {
+    this->fetchMore(parentIndex);
+    }
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::onSubjectHierarchyItemModified(vtkObject* caller, void* callData)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  Q_UNUSED(caller);
+  if (d->isUpdateDeferred())
+    {
+    d->ResetPending = true;
+    return;
+    }
+  vtkIdType itemID = itemIDFromCallData(callData);
+  if (!d->SubjectHierarchyNode || itemID == vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+    {
+    return;
+    }
+  if (!d->ExposedParents.contains(itemID))
+    {
+    // The item may have been moved under an exposed parent
+    this->insertItemRow(itemID);
+    return;
+    }
+  if (itemID != d->SubjectHierarchyNode->GetSceneItemID())
+    {
+    if (d->SubjectHierarchyNode->GetItemParent(itemID) != d->ExposedParents[itemID])
+      {
+      // Reparented
+      this->removeItemRow(itemID);
+      this->insertItemRow(itemID);
+      return;
+      }
+    this->moveItemRowIfNeeded(itemID);
+    }
+  this->sortChildRowsIfNeeded(itemID);
+
+  int row = d->exposedRow(itemID);
+  emit dataChanged(this->createItemIndex(itemID, row, 0), this->createItemIndex(itemID, row, this->columnCount()-1));
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::onMRMLSceneEndBatchProcess(vtkObject* scene)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  Q_UNUSED(scene);
+  if (d->ResetPending)
+    {
+    // Resetting is cheap, as only the items that the view needs are fetched again
+    this->resetExposedItems();
+    }
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::onMRMLSceneCloseEnded(vtkObject* scene)
+{
+  // Make sure there is one subject hierarchy node in the scene, and it is used by the model
+  this->setSubjectHierarchyNode(vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(vtkMRMLScene::SafeDownCast(scene)));
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::onMRMLNodeRemoved(vtkObject* scene, vtkObject* node)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  Q_UNUSED(scene);
+  if (!d->MRMLScene || d->MRMLScene->IsClosing() || !node || !node->IsA("vtkMRMLSubjectHierarchyNode"))
+    {
+    return;
+    }
+  // Make sure there is one subject hierarchy node in the scene, and it is used by the model
+  this->setSubjectHierarchyNode(vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(d->MRMLScene));
+}
+
+//------------------------------------------------------------------------------
+int qMRMLSubjectHierarchyLazyModel::nameColumn()const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  return d->NameColumn;
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::setNameColumn(int column)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  d->NameColumn = column;
+  this->resetExposedItems();
+}
+
+//------------------------------------------------------------------------------
+int qMRMLSubjectHierarchyLazyModel::idColumn()const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  return d->IDColumn;
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::setIDColumn(int column)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  d->IDColumn = column;
+  this->resetExposedItems();
+}
+
+//------------------------------------------------------------------------------
+int qMRMLSubjectHierarchyLazyModel::visibilityColumn()const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  return d->VisibilityColumn;
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::setVisibilityColumn(int column)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  d->VisibilityColumn = column;
+  this->resetExposedItems();
+}
+
+//------------------------------------------------------------------------------
+int qMRMLSubjectHierarchyLazyModel::transformColumn()const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  return d->TransformColumn;
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::setTransformColumn(int column)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  d->TransformColumn = column;
+  this->resetExposedItems();
+}
+
+//------------------------------------------------------------------------------
+int qMRMLSubjectHierarchyLazyModel::fetchBatchSize()const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  return d->FetchBatchSize;
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyLazyModel::setFetchBatchSize(int size)
+{
+  Q_D(qMRMLSubjectHierarchyLazyModel);
+  d->FetchBatchSize = qMax(1, size);
+}
+
+//------------------------------------------------------------------------------
+int qMRMLSubjectHierarchyLazyModel::maxColumnId()const
+{
+  Q_D(const qMRMLSubjectHierarchyLazyModel);
+  int maxId = 0;
+  maxId = qMax(maxId, d->NameColumn);
+  maxId = qMax(maxId, d->IDColumn);
+  maxId = qMax(maxId, d->VisibilityColumn);
+  maxId = qMax(maxId, d->TransformColumn);
+  return maxId;
+}
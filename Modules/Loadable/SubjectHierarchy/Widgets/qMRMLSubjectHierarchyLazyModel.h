@@ -0,0 +1,155 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qMRMLSubjectHierarchyLazyModel_h
+#define __qMRMLSubjectHierarchyLazyModel_h
+
+// Qt includes
+#include <QAbstractItemModel>
+
+// CTK includes
+#include <ctkPimpl.h>
+#include <ctkVTKObject.h>
+
+// SubjectHierarchy includes
+#include "qSlicerSubjectHierarchyModuleWidgetsExport.h"
+
+class qMRMLSubjectHierarchyLazyModelPrivate;
+class vtkMRMLSubjectHierarchyNode;
+class vtkMRMLScene;
+class vtkObject;
+
+/// \brief Lazily populated item model for subject hierarchy
+///
+/// As opposed to \sa qMRMLSubjectHierarchyModel, that creates model items for all the columns of
+/// every subject hierarchy item upfront, this model does not store any item data. The children of an
+/// item are only exposed when the view fetches them (typically when the item is expanded, see
+/// \sa canFetchMore and \sa fetchMore), in batches of \sa fetchBatchSize rows. Names, icons, tooltips
+/// and visibility are queried from the owner plugins when the view requests them, i.e. only for the
+/// visible rows. It is meant for hierarchies with a very large number of items (e.g. patient databases).
+///
+/// The same item data roles are used as in \sa qMRMLSubjectHierarchyModel.
+/// Drag&drop and transform editing are not supported.
+///
+class Q_SLICER_MODULE_SUBJECTHIERARCHY_WIDGETS_EXPORT qMRMLSubjectHierarchyLazyModel : public QAbstractItemModel
+{
+  Q_OBJECT
+  QVTK_OBJECT
+
+  /// Column of the data MRML node names (or subject hierarchy item names if there is no data node)
+  /// and the icons provided by the owner plugins. A value of -1 hides it. First column (0) by default.
+  Q_PROPERTY (int nameColumn READ nameColumn WRITE setNameColumn)
+  /// Column of the visibility icons. A value of -1 hides it. Second column (1) by default.
+  Q_PROPERTY (int visibilityColumn READ visibilityColumn WRITE setVisibilityColumn)
+  /// Column of the parent transform names. A value of -1 hides it. Third column (2) by default.
+  Q_PROPERTY (int transformColumn READ transformColumn WRITE setTransformColumn)
+  /// Column of the data MRML node IDs. A value of -1 hides it. Fourth column (3) by default.
+  Q_PROPERTY (int idColumn READ idColumn WRITE setIDColumn)
+  /// Maximum number of children exposed by one call of \sa fetchMore. 256 by default.
+  Q_PROPERTY (int fetchBatchSize READ fetchBatchSize WRITE setFetchBatchSize)
+
+public:
+  typedef QAbstractItemModel Superclass;
+  qMRMLSubjectHierarchyLazyModel(QObject *parent=0);
+  virtual ~qMRMLSubjectHierarchyLazyModel();
+
+  int nameColumn()const;
+  void setNameColumn(int column);
+
+  int visibilityColumn()const;
+  void setVisibilityColumn(int column);
+
+  int transformColumn()const;
+  void setTransformColumn(int column);
+
+  int idColumn()const;
+  void setIDColumn(int column);
+
+  int fetchBatchSize()const;
+  void setFetchBatchSize(int size);
+
+  Q_INVOKABLE virtual void setMRMLScene(vtkMRMLScene* scene);
+  Q_INVOKABLE vtkMRMLScene* mrmlScene()const;
+
+  vtkMRMLSubjectHierarchyNode* subjectHierarchyNode()const;
+
+  /// Invalid until a valid scene is set
+  QModelIndex subjectHierarchySceneIndex()const;
+
+  vtkIdType subjectHierarchyItemFromIndex(const QModelIndex &index)const;
+  /// Returns an invalid index if the item has not been fetched yet (if its parent has not been expanded)
+  QModelIndex indexFromSubjectHierarchyItem(vtkIdType itemID, int column=0)const;
+
+  virtual QModelIndex index(int row, int column, const QModelIndex& parent=QModelIndex())const;
+  virtual QModelIndex parent(const QModelIndex& index)const;
+  virtual int rowCount(const QModelIndex& parent=QModelIndex())const;
+  virtual int columnCount(const QModelIndex& parent=QModelIndex())const;
+  virtual bool hasChildren(const QModelIndex& parent=QModelIndex())const;
+  virtual bool canFetchMore(const QModelIndex& parent)const;
+  virtual void fetchMore(const QModelIndex& parent);
+
+  virtual QVariant data(const QModelIndex& index, int role=Qt::DisplayRole)const;
+  virtual bool setData(const QModelIndex& index, const QVariant& value, int role=Qt::EditRole);
+  virtual Qt::ItemFlags flags(const QModelIndex& index)const;
+  virtual QVariant headerData(int section, Qt::Orientation orientation, int role=Qt::DisplayRole)const;
+
+signals:
+  /// Emitted when an item that is expanded in the subject hierarchy is fetched,
+  /// so that the view can restore its expanded state
+  void requestExpandItem(vtkIdType itemID);
+
+protected slots:
+  void onSubjectHierarchyItemAdded(vtkObject* caller, void* callData);
+  void onSubjectHierarchyItemAboutToBeRemoved(vtkObject* caller, void* callData);
+  void onSubjectHierarchyItemRemoved(vtkObject* caller, void* callData);
+  void onSubjectHierarchyItemModified(vtkObject* caller, void* callData);
+
+  void onMRMLSceneEndBatchProcess(vtkObject* scene);
+  void onMRMLSceneCloseEnded(vtkObject* scene);
+  void onMRMLNodeRemoved(vtkObject* scene, vtkObject* node);
+
+protected:
+  /// Set the subject hierarchy node found in the given scene. Called only internally.
+  virtual void setSubjectHierarchyNode(vtkMRMLSubjectHierarchyNode* shNode);
+
+  /// Forget all the exposed items. They are fetched again when the view needs them.
+  void resetExposedItems();
+
+  /// Insert the row of an item that is not exposed yet, if its parent has already been fetched
+  void insertItemRow(vtkIdType itemID);
+  /// Remove the row of an exposed item and forget about its exposed children
+  void removeItemRow(vtkIdType itemID);
+  /// Move the row of an exposed item if it was moved under its parent in the subject hierarchy
+  void moveItemRowIfNeeded(vtkIdType itemID);
+  /// Reorder the exposed child rows of an item if its children were moved in the subject hierarchy
+  /// (moving an item only modifies its parent)
+  void sortChildRowsIfNeeded(vtkIdType parentItemID);
+
+  QModelIndex createItemIndex(vtkIdType itemID, int row, int column)const;
+
+  int maxColumnId()const;
+
+protected:
+  QScopedPointer<qMRMLSubjectHierarchyLazyModelPrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(qMRMLSubjectHierarchyLazyModel);
+  Q_DISABLE_COPY(qMRMLSubjectHierarchyLazyModel);
+};
+
+#endif
@@ -64,6 +64,7 @@ qMRMLSubjectHierarchyModelPrivate::qMRMLSubjectHierarchyModelPrivate(qMRMLSubjec
   this->WarningIcon = QIcon(":Icons/Warning.png");
 
   this->DelayedItemChangedInvoked = false;
+  this->PendingFullUpdate = false;
 
   qRegisterMetaType<QStandardItem*>("QStandardItem*");
 }
@@ -89,6 +90,8 @@ void qMRMLSubjectHierarchyModelPrivate::init()
   this->CallBack->SetCallback(qMRMLSubjectHierarchyModel::onEvent);
 
   QObject::connect(q, SIGNAL(itemChanged(QStandardItem*)), q, SLOT(onItemChanged(QStandardItem*)));
+  // Connected before any view or proxy model so that the index cache is updated before they get notified
+  QObject::connect(q, SIGNAL(rowsInserted(QModelIndex,int,int)), q, SLOT(onRowsInserted(QModelIndex,int,int)));
 
   q->setNameColumn(0);
   q->setVisibilityColumn(1);
@@ -122,6 +125,32 @@ QString qMRMLSubjectHierarchyModelPrivate::subjectHierarchyItemName(vtkIdType it
   return QString(this->SubjectHierarchyNode->GetItemName(itemID).c_str());
 }
 
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyModelPrivate::cacheItemIndexes(QStandardItem* item)
+{
+  Q_Q(qMRMLSubjectHierarchyModel);
+  if (!item)
+    {
+    return;
+    }
+  vtkIdType itemID = q->subjectHierarchyItemFromItem(item);
+  if (itemID != vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+    {
+    this->RowCache[itemID] = item->index();
+    }
+  // Children of moved items also get new indexes
+  for (int row=0; row<item->rowCount(); ++row)
+    {
+    this->cacheItemIndexes(item->child(row));
+    }
+}
+
+//------------------------------------------------------------------------------
+bool qMRMLSubjectHierarchyModelPrivate::hasPendingChanges()const
+{
+  return this->PendingFullUpdate || !this->PendingAddedItems.isEmpty() || !this->PendingModifiedItems.isEmpty();
+}
+
 //------------------------------------------------------------------------------
 QStandardItem* qMRMLSubjectHierarchyModelPrivate::insertSubjectHierarchyItem(vtkIdType itemID, int index)
 {
@@ -340,41 +369,23 @@ QModelIndex qMRMLSubjectHierarchyModel::indexFromSubjectHierarchyItem(vtkIdType
     return itemIndex;
     }
 
-  // Try to find the nodeIndex in the cache first
+  // The cache contains all the items in the model
   QMap<vtkIdType,QPersistentModelIndex>::iterator rowCacheIt = d->RowCache.find(itemID);
   if (rowCacheIt==d->RowCache.end())
     {
     // Not found in cache, therefore it cannot be in the model
     return itemIndex;
     }
-  if (rowCacheIt.value().isValid())
+  if (!rowCacheIt.value().isValid())
     {
-    // An entry found in the cache. If the item at the cached index matches the requested item ID then we use it.
-    QStandardItem* item = this->itemFromIndex(rowCacheIt.value());
-    if (item && item->data(qMRMLSubjectHierarchyModel::SubjectHierarchyItemIDRole).toLongLong() == itemID)
-      {
-      // ID matched
-      itemIndex = rowCacheIt.value();
-      }
-    }
-
-  // The cache was not up-to-date. Do a slow linear search.
-  if (!itemIndex.isValid())
-    {
-    // QAbstractItemModel::match doesn't browse through columns, we need to do it manually
-    QModelIndexList itemIndexes = this->match(
-      this->subjectHierarchySceneIndex(), SubjectHierarchyItemIDRole, itemID, 1, Qt::MatchExactly | Qt::MatchRecursive);
-    if (itemIndexes.size() == 0)
-      {
-      d->RowCache.remove(itemID);
-      return QModelIndex();
-      }
-    itemIndex = itemIndexes[0];
-    d->RowCache[itemID] = itemIndex;
+    // The row of the item has been removed from the model
+    d->RowCache.erase(rowCacheIt);
+    return itemIndex;
     }
+  itemIndex = rowCacheIt.value();
   if (column == 0)
     {
-    // QAbstractItemModel::match only search through the first column
+    // The cache only contains the indexes of the first column
     return itemIndex;
     }
   // Add the QModelIndexes from the other columns
@@ -391,18 +402,13 @@ QModelIndex qMRMLSubjectHierarchyModel::indexFromSubjectHierarchyItem(vtkIdType
 //------------------------------------------------------------------------------
 QModelIndexList qMRMLSubjectHierarchyModel::indexes(vtkIdType itemID)const
 {
-  QModelIndex scene = this->subjectHierarchySceneIndex();
-  if (scene == QModelIndex())
+  QModelIndex shItemIndex = this->indexFromSubjectHierarchyItem(itemID);
+  if (!shItemIndex.isValid())
     {
     return QModelIndexList();
     }
-  // QAbstractItemModel::match doesn't browse through columns, we need to do it manually
-  QModelIndexList shItemIndexes = this->match(
-    scene, qMRMLSubjectHierarchyModel::SubjectHierarchyItemIDRole, QVariant(qlonglong(itemID)), 1, Qt::MatchExactly | Qt::MatchRecursive);
-  if (shItemIndexes.size() != 1)
-    {
-    return QModelIndexList(); // If 0 it's empty, if >1 it's invalid (one item for each UID)
-    }
+  QModelIndexList shItemIndexes;
+  shItemIndexes << shItemIndex;
   // Add the QModelIndexes from the other columns
   const int row = shItemIndexes[0].row();
   QModelIndex shItemParentIndex = shItemIndexes[0].parent();
@@ -646,6 +652,10 @@ void qMRMLSubjectHierarchyModel::updateFromSubjectHierarchy()
   Q_D(qMRMLSubjectHierarchyModel);
 
   d->RowCache.clear();
+  // All the pending changes are applied by the full update
+  d->PendingAddedItems.clear();
+  d->PendingModifiedItems.clear();
+  d->PendingFullUpdate = false;
 
   // Enabled so it can be interacted with
   this->invisibleRootItem()->setFlags(Qt::ItemIsEnabled);
@@ -677,9 +687,8 @@ void qMRMLSubjectHierarchyModel::updateFromSubjectHierarchy()
       }
     sceneItem->setColumnCount(this->columnCount());
 
-    d->RowCache[sceneItemID] = QModelIndex(); // Insert invalid item in cache to indicate that item is in the model but its index is unknown
+    // The row cache is updated in onRowsInserted
     this->insertRow(0, sceneItems);
-    d->RowCache[sceneItemID] = sceneItem->index();
     }
   else
     {
@@ -721,6 +730,61 @@ void qMRMLSubjectHierarchyModel::updateFromSubjectHierarchy()
   emit subjectHierarchyUpdated();
 }
 
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyModel::updateFromPendingChanges()
+{
+  Q_D(qMRMLSubjectHierarchyModel);
+  if (!d->hasPendingChanges())
+    {
+    return;
+    }
+  if (d->PendingFullUpdate || !d->SubjectHierarchyNode || !this->subjectHierarchySceneItem())
+    {
+    this->updateFromSubjectHierarchy();
+    return;
+    }
+
+  QSet<vtkIdType> addedItemIDs = d->PendingAddedItems;
+  QSet<vtkIdType> modifiedItemIDs = d->PendingModifiedItems;
+  d->PendingAddedItems.clear();
+  d->PendingModifiedItems.clear();
+
+  // Insert added items in the order of the hierarchy, so that the parent and the preceding
+  // siblings of each item are already in the model when it is inserted
+  std::vector<vtkIdType> allItemIDs;
+  d->SubjectHierarchyNode->GetItemChildren(d->SubjectHierarchyNode->GetSceneItemID(), allItemIDs, true);
+  QList<vtkIdType> insertedItemIDs;
+  for (std::vector<vtkIdType>::iterator itemIt=allItemIDs.begin(); itemIt!=allItemIDs.end(); ++itemIt)
+    {
+    vtkIdType itemID = (*itemIt);
+    if (!addedItemIDs.contains(itemID) || this->indexFromSubjectHierarchyItem(itemID).isValid())
+      {
+      continue;
+      }
+    int index = d->SubjectHierarchyNode->GetItemPositionUnderParent(itemID);
+    d->insertSubjectHierarchyItem(itemID, index);
+    insertedItemIDs << itemID;
+    }
+
+  // Update expanded states of the inserted items (see updateFromSubjectHierarchy)
+  foreach (vtkIdType itemID, insertedItemIDs)
+    {
+    QStandardItem* item = this->itemFromSubjectHierarchyItem(itemID, this->nameColumn());
+    this->updateItemDataFromSubjectHierarchyItem(item, itemID, this->nameColumn());
+    }
+
+  // Update the items that were already in the model
+  foreach (vtkIdType itemID, modifiedItemIDs)
+    {
+    if (!addedItemIDs.contains(itemID))
+      {
+      this->updateModelItems(itemID);
+      }
+    }
+
+  emit subjectHierarchyUpdated();
+}
+
 //------------------------------------------------------------------------------
 QStandardItem* qMRMLSubjectHierarchyModel::insertSubjectHierarchyItem(vtkIdType itemID)
 {
@@ -748,12 +812,9 @@ QStandardItem* qMRMLSubjectHierarchyModel::insertSubjectHierarchyItem(vtkIdType
     items.append(newItem);
     }
 
-  // Insert an invalid item in the cache to indicate that the subject hierarchy item is in the
-  // model but we don't know its index yet. This is needed because a custom widget may be notified
-  // abot row insertion before insertRow() returns (and the RowCache entry is added).
-  d->RowCache[itemID] = QModelIndex();
+  // The row cache is updated in onRowsInserted, which is called before any other object
+  // is notified about the insertion (e.g. a custom widget that looks up the item)
   parent->insertRow(row, items);
-  d->RowCache[itemID] = items[0]->index();
 
   return items[0];
 }
@@ -1138,6 +1199,8 @@ void qMRMLSubjectHierarchyModel::updateModelItems(vtkIdType itemID)
   Q_D(qMRMLSubjectHierarchyModel);
   if (d->MRMLScene->IsClosing() || d->MRMLScene->IsBatchProcessing())
     {
+    // Update the item when batch processing ends
+    d->PendingModifiedItems.insert(itemID);
     return;
     }
 
@@ -1241,6 +1304,22 @@ void qMRMLSubjectHierarchyModel::onEvent(
 //------------------------------------------------------------------------------
 void qMRMLSubjectHierarchyModel::onSubjectHierarchyItemAdded(vtkIdType itemID)
 {
+  Q_D(qMRMLSubjectHierarchyModel);
+  if (d->MRMLScene && d->MRMLScene->IsBatchProcessing())
+    {
+    // Insert the item when batch processing ends
+    d->PendingAddedItems.insert(itemID);
+    return;
+    }
+  if (d->hasPendingChanges())
+    {
+    // The preceding siblings of the item may not be in the model yet
+    // (e.g. item added in a callback of the end import event)
+    d->PendingAddedItems.insert(itemID);
+    this->updateFromPendingChanges();
+    return;
+    }
+
   this->insertSubjectHierarchyItem(itemID);
 }
 
@@ -1250,14 +1329,16 @@ void qMRMLSubjectHierarchyModel::onSubjectHierarchyItemAboutToBeRemoved(vtkIdTyp
   Q_D(qMRMLSubjectHierarchyModel);
   if (d->MRMLScene->IsClosing() || d->MRMLScene->IsBatchProcessing())
     {
+    // Removed items cannot be looked up later, so the whole model is updated when batch processing ends
+    d->PendingFullUpdate = true;
     return;
     }
 
-  QModelIndexList itemIndexes = this->match(
-    this->subjectHierarchySceneIndex(), SubjectHierarchyItemIDRole, itemID, 1, Qt::MatchExactly | Qt::MatchRecursive );
-  if (itemIndexes.count() > 0)
+  QModelIndex itemIndex = this->indexFromSubjectHierarchyItem(itemID);
+  d->RowCache.remove(itemID);
+  if (itemIndex.isValid())
     {
-    QStandardItem* item = this->itemFromIndex(itemIndexes[0].sibling(itemIndexes[0].row(),0));
+    QStandardItem* item = this->itemFromIndex(itemIndex);
     // The children may be lost if not reparented, we ensure they got reparented.
     while (item->rowCount())
       {
@@ -1272,7 +1353,7 @@ void qMRMLSubjectHierarchyModel::onSubjectHierarchyItemAboutToBeRemoved(vtkIdTyp
         d->Orphans.removeAll(orphans);
         }
       }
-    this->removeRow(itemIndexes[0].row(), itemIndexes[0].parent());
+    this->removeRow(itemIndex.row(), itemIndex.parent());
     }
 }
 
@@ -1319,7 +1400,8 @@ void qMRMLSubjectHierarchyModel::onSubjectHierarchyItemModified(vtkIdType itemID
 void qMRMLSubjectHierarchyModel::onMRMLSceneImported(vtkMRMLScene* scene)
 {
   Q_UNUSED(scene);
-  this->updateFromSubjectHierarchy();
+  // Import is a batch process, the items added during import are inserted in one step
+  this->updateFromPendingChanges();
 }
 
 //------------------------------------------------------------------------------
@@ -1346,7 +1428,7 @@ void qMRMLSubjectHierarchyModel::onMRMLSceneStartBatchProcess(vtkMRMLScene* scen
 void qMRMLSubjectHierarchyModel::onMRMLSceneEndBatchProcess(vtkMRMLScene* scene)
 {
   Q_UNUSED(scene);
-  this->updateFromSubjectHierarchy();
+  this->updateFromPendingChanges();
 }
 
 //------------------------------------------------------------------------------
@@ -1375,6 +1457,17 @@ void qMRMLSubjectHierarchyModel::onMRMLNodeRemoved(vtkMRMLNode* node)
 void qMRMLSubjectHierarchyModel::onItemChanged(QStandardItem* item)
 {
   Q_D(qMRMLSubjectHierarchyModel);
+  // Dropped items are set into empty rows inserted beforehand, so the rows inserted signal
+  // does not find them. Cache their index when they are set.
+  if (item->column() == 0 && item->index().isValid())
+    {
+    QMap<vtkIdType,QPersistentModelIndex>::iterator rowCacheIt = d->RowCache.find(this->subjectHierarchyItemFromItem(item));
+    if (rowCacheIt == d->RowCache.end() || rowCacheIt.value() != item->index())
+      {
+      d->cacheItemIndexes(item);
+      }
+    }
+
   if (d->PendingItemModified >= 0)
     {
     ++d->PendingItemModified;
@@ -1417,6 +1510,21 @@ void qMRMLSubjectHierarchyModel::delayedItemChanged()
   d->DelayedItemChangedInvoked = false;
 }
 
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyModel::onRowsInserted(const QModelIndex& parent, int start, int end)
+{
+  Q_D(qMRMLSubjectHierarchyModel);
+  QStandardItem* parentItem = (parent.isValid() ? this->itemFromIndex(parent) : this->invisibleRootItem());
+  if (!parentItem)
+    {
+    return;
+    }
+  for (int row=start; row<=end; ++row)
+    {
+    d->cacheItemIndexes(parentItem->child(row));
+    }
+}
+
 //------------------------------------------------------------------------------
 Qt::DropActions qMRMLSubjectHierarchyModel::supportedDropActions()const
 {
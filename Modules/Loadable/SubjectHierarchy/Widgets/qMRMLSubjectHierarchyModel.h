@@ -42,9 +42,10 @@ class vtkMRMLScene;
 ///
 /// It is associated to the pseudo-singleton subject hierarchy node, and it creates one model item
 /// for each subject hierarchy item. It handles reparenting, reordering, etc.
-/// The whole model is regenerated when the Modified event is invoked on the subject hierarchy node,
-/// but only the individual items are updated when per-item events are invoked (such as
-/// vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemModifiedEvent)
+/// Model items are inserted, removed and moved individually when per-item events are invoked (such as
+/// vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAddedEvent). During scene batch processing
+/// (e.g. import) the changes are collected and applied once when the batch processing ends.
+/// The whole model is only regenerated if items were removed during batch processing.
 ///
 class Q_SLICER_MODULE_SUBJECTHIERARCHY_WIDGETS_EXPORT qMRMLSubjectHierarchyModel : public QStandardItemModel
 {
@@ -180,6 +181,9 @@ protected slots:
   virtual void onItemChanged(QStandardItem* item);
   virtual void delayedItemChanged();
 
+  /// Keep item index cache up-to-date when rows are inserted or moved
+  void onRowsInserted(const QModelIndex& parent, int start, int end);
+
   /// Recompute the number of columns in the model. Called when a [some]Column property is set.
   /// Needs maxColumnId() to be reimplemented in subclasses
   void updateColumnCount();
@@ -191,6 +195,10 @@ protected:
   virtual void setSubjectHierarchyNode(vtkMRMLSubjectHierarchyNode* shNode);
 
   virtual void updateFromSubjectHierarchy();
+  /// Apply the subject hierarchy changes collected during batch processing.
+  /// Added items are inserted and modified items are updated, the whole model is only
+  /// regenerated (\sa updateFromSubjectHierarchy) if items were removed.
+  virtual void updateFromPendingChanges();
   virtual QStandardItem* insertSubjectHierarchyItem(vtkIdType itemID);
   virtual QStandardItem* insertSubjectHierarchyItem(vtkIdType itemID, QStandardItem* parent, int row=-1);
 
@@ -38,6 +38,7 @@
 class QStandardItemModel;
 #include <QFlags>
 #include <QMap>
+#include <QSet>
 
 // SubjectHierarchy includes
 #include "qSlicerSubjectHierarchyModuleWidgetsExport.h"
@@ -74,6 +75,13 @@ public:
   /// Convenience function to get name for subject hierarchy item
   QString subjectHierarchyItemName(vtkIdType itemID);
 
+  /// Store the index of the model item and all its children in \sa RowCache.
+  /// Called for every row inserted in the model
+  void cacheItemIndexes(QStandardItem* item);
+
+  /// Returns true if the model needs to be updated with changes that happened during batch processing
+  bool hasPendingChanges()const;
+
 public:
   vtkSmartPointer<vtkCallbackCommand> CallBack;
   int PendingItemModified;
@@ -103,10 +111,17 @@ public:
   QList<QList<QStandardItem*> > Orphans;
 
   // Map from subject hierarchy item to row.
-  // It just stores the result of the latest lookup by \sa indexFromSubjectHierarchyItem,
-  // not guaranteed to contain up-to-date information, should be just used as a search hint.
-  // If the item cannot be found at the given index then we need to browse through all model items.
+  // It is updated every time rows are inserted in the model (including reparenting and drag&drop,
+  // which take and re-insert rows), so subject hierarchy items that are not in the map or whose
+  // index is invalid are not in the model.
   mutable QMap<vtkIdType, QPersistentModelIndex> RowCache;
+
+  // Subject hierarchy changes during batch processing are not applied immediately, but they are
+  // collected and the model is updated once when the batch processing ends.
+  // If items are removed then the whole model is rebuilt.
+  QSet<vtkIdType> PendingAddedItems;
+  QSet<vtkIdType> PendingModifiedItems;
+  bool PendingFullUpdate;
 };
 
 #endif
@@ -37,6 +37,7 @@
 // SubjectHierarchy includes
 #include "qMRMLSubjectHierarchyTreeView.h"
 
+#include "qMRMLSubjectHierarchyLazyModel.h"
 #include "qMRMLSubjectHierarchyModel.h"
 #include "qMRMLSortFilterSubjectHierarchyProxyModel.h"
 #include "qMRMLTransformItemDelegate.h"
@@ -73,10 +74,23 @@ public:
 
   /// Setup all actions for tree view
   void setupActions();
+  /// Set the resize mode of the header sections of the shown model
+  void setupHeaderSections();
+
+  /// Index of a subject hierarchy item in the shown model (sort filter proxy or lazy model)
+  QModelIndex indexFromItem(vtkIdType itemID, int column=0)const;
+  /// Subject hierarchy item of an index of the shown model (sort filter proxy or lazy model)
+  vtkIdType itemFromIndex(const QModelIndex& index)const;
+  int nameColumn()const;
+  int visibilityColumn()const;
+  /// Set the scene to the shown model. The other model is emptied so that it is not kept up to date.
+  void setModelsScene(vtkMRMLScene* scene);
 
 public:
   qMRMLSubjectHierarchyModel* Model;
   qMRMLSortFilterSubjectHierarchyProxyModel* SortFilterModel;
+  qMRMLSubjectHierarchyLazyModel* LazyModel;
+  bool UseLazyModel;
 
   bool ShowRootItem;
   vtkIdType RootItemID;
@@ -120,6 +134,8 @@ qMRMLSubjectHierarchyTreeViewPrivate::qMRMLSubjectHierarchyTreeViewPrivate(qMRML
   : q_ptr(&object)
   , Model(NULL)
   , SortFilterModel(NULL)
+  , LazyModel(NULL)
+  , UseLazyModel(false)
   , ShowRootItem(false)
   , RootItemID(vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
   , ContextMenuEnabled(true)
@@ -159,17 +175,7 @@ void qMRMLSubjectHierarchyTreeViewPrivate::init()
 
   // Set up headers
   q->header()->setStretchLastSection(false);
-#if (QT_VERSION < QT_VERSION_CHECK(5, 0, 0))
-  q->header()->setResizeMode(this->Model->nameColumn(), QHeaderView::Stretch);
-  q->header()->setResizeMode(this->Model->visibilityColumn(), QHeaderView::ResizeToContents);
-  q->header()->setResizeMode(this->Model->transformColumn(), QHeaderView::Interactive);
-  q->header()->setResizeMode(this->Model->idColumn(), QHeaderView::ResizeToContents);
-#else
-  q->header()->setSectionResizeMode(this->Model->nameColumn(), QHeaderView::Stretch);
-  q->header()->setSectionResizeMode(this->Model->visibilityColumn(), QHeaderView::ResizeToContents);
-  q->header()->setSectionResizeMode(this->Model->transformColumn(), QHeaderView::Interactive);
-  q->header()->setSectionResizeMode(this->Model->idColumn(), QHeaderView::ResizeToContents);
-#endif
+  this->setupHeaderSections();
 
   // Set generic MRML item delegate
   q->setItemDelegate(new qMRMLItemDelegate(q));
@@ -287,6 +293,67 @@ void qMRMLSubjectHierarchyTreeViewPrivate::setupActions()
   QObject::connect( this->SelectPluginSubMenu, SIGNAL(aboutToShow()), q, SLOT(updateSelectPluginActions()) );
 }
 
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyTreeViewPrivate::setupHeaderSections()
+{
+  Q_Q(qMRMLSubjectHierarchyTreeView);
+  int transformColumn = (this->UseLazyModel ? this->LazyModel->transformColumn() : this->Model->transformColumn());
+  int idColumn = (this->UseLazyModel ? this->LazyModel->idColumn() : this->Model->idColumn());
+#if (QT_VERSION < QT_VERSION_CHECK(5, 0, 0))
+  q->header()->setResizeMode(this->nameColumn(), QHeaderView::Stretch);
+  q->header()->setResizeMode(this->visibilityColumn(), QHeaderView::ResizeToContents);
+  q->header()->setResizeMode(transformColumn, QHeaderView::Interactive);
+  q->header()->setResizeMode(idColumn, QHeaderView::ResizeToContents);
+#else
+  q->header()->setSectionResizeMode(this->nameColumn(), QHeaderView::Stretch);
+  q->header()->setSectionResizeMode(this->visibilityColumn(), QHeaderView::ResizeToContents);
+  q->header()->setSectionResizeMode(transformColumn, QHeaderView::Interactive);
+  q->header()->setSectionResizeMode(idColumn, QHeaderView::ResizeToContents);
+#endif
+}
+
+//------------------------------------------------------------------------------
+QModelIndex qMRMLSubjectHierarchyTreeViewPrivate::indexFromItem(vtkIdType itemID, int column/*=0*/)const
+{
+  if (this->UseLazyModel)
+    {
+    return this->LazyModel->indexFromSubjectHierarchyItem(itemID, column);
+    }
+  return this->SortFilterModel->indexFromSubjectHierarchyItem(itemID, column);
+}
+
+//------------------------------------------------------------------------------
+vtkIdType qMRMLSubjectHierarchyTreeViewPrivate::itemFromIndex(const QModelIndex& index)const
+{
+  if (this->UseLazyModel)
+    {
+    return this->LazyModel->subjectHierarchyItemFromIndex(index);
+    }
+  return this->SortFilterModel->subjectHierarchyItemFromIndex(index);
+}
+
+//------------------------------------------------------------------------------
+int qMRMLSubjectHierarchyTreeViewPrivate::nameColumn()const
+{
+  return (this->UseLazyModel ? this->LazyModel->nameColumn() : this->Model->nameColumn());
+}
+
+//------------------------------------------------------------------------------
+int qMRMLSubjectHierarchyTreeViewPrivate::visibilityColumn()const
+{
+  return (this->UseLazyModel ? this->LazyModel->visibilityColumn() : this->Model->visibilityColumn());
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyTreeViewPrivate::setModelsScene(vtkMRMLScene* scene)
+{
+  this->Model->setMRMLScene(this->UseLazyModel ? NULL : scene);
+  if (this->LazyModel)
+    {
+    this->LazyModel->setMRMLScene(this->UseLazyModel ? scene : NULL);
+    }
+}
+
 
 //------------------------------------------------------------------------------
 // qMRMLSubjectHierarchyTreeView
@@ -316,7 +383,7 @@ void qMRMLSubjectHierarchyTreeView::setSubjectHierarchyNode(vtkMRMLSubjectHierar
 
   if (!shNode)
     {
-    d->Model->setMRMLScene(NULL);
+    d->setModelsScene(NULL);
     d->TransformItemDelegate->setMRMLScene(NULL);
     return;
     }
@@ -327,10 +394,15 @@ void qMRMLSubjectHierarchyTreeView::setSubjectHierarchyNode(vtkMRMLSubjectHierar
     qCritical() << Q_FUNC_INFO << ": Given subject hierarchy node is not in a MRML scene";
     }
 
-  d->Model->setMRMLScene(scene);
+  d->setModelsScene(scene);
   d->TransformItemDelegate->setMRMLScene(scene);
   this->setRootItem(shNode->GetSceneItemID());
-  this->expandToDepth(4);
+  if (!d->UseLazyModel)
+    {
+    // The lazy model requests expanding the items that are expanded in the subject hierarchy,
+    // expanding more would fetch all their children
+    this->expandToDepth(4);
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -344,6 +416,10 @@ vtkMRMLSubjectHierarchyNode* qMRMLSubjectHierarchyTreeView::subjectHierarchyNode
 vtkMRMLScene* qMRMLSubjectHierarchyTreeView::mrmlScene()const
 {
   Q_D(const qMRMLSubjectHierarchyTreeView);
+  if (d->UseLazyModel)
+    {
+    return d->LazyModel->mrmlScene();
+    }
   return d->Model ? d->Model->mrmlScene() : NULL;
 }
 
@@ -380,7 +456,7 @@ void qMRMLSubjectHierarchyTreeView::setCurrentItem(vtkIdType itemID)
     return;
     }
 
-  QModelIndex itemIndex = d->SortFilterModel->indexFromSubjectHierarchyItem(itemID);
+  QModelIndex itemIndex = d->indexFromItem(itemID);
   this->selectionModel()->select(itemIndex, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
 }
 
@@ -422,7 +498,7 @@ void qMRMLSubjectHierarchyTreeView::setCurrentItems(QList<vtkIdType> items)
 
   foreach (long itemID, items)
     {
-    QModelIndex itemIndex = d->SortFilterModel->indexFromSubjectHierarchyItem(vtkIdType(itemID));
+    QModelIndex itemIndex = d->indexFromItem(vtkIdType(itemID));
     if (itemIndex.isValid())
       {
       this->selectionModel()->select(itemIndex, QItemSelectionModel::Select | QItemSelectionModel::Rows);
@@ -450,7 +526,7 @@ void qMRMLSubjectHierarchyTreeView::setCurrentItems(vtkIdList* items)
 
   for (int index=0; index<items->GetNumberOfIds(); ++index)
     {
-    QModelIndex itemIndex = d->SortFilterModel->indexFromSubjectHierarchyItem(items->GetId(index));
+    QModelIndex itemIndex = d->indexFromItem(items->GetId(index));
     if (itemIndex.isValid())
       {
       this->selectionModel()->select(itemIndex, QItemSelectionModel::Select | QItemSelectionModel::Rows);
@@ -480,11 +556,83 @@ qMRMLSubjectHierarchyModel* qMRMLSubjectHierarchyTreeView::model()const
   return d->Model;
 }
 
+//--------------------------------------------------------------------------
+qMRMLSubjectHierarchyLazyModel* qMRMLSubjectHierarchyTreeView::lazyModel()const
+{
+  Q_D(const qMRMLSubjectHierarchyTreeView);
+  return d->LazyModel;
+}
+
+//--------------------------------------------------------------------------
+bool qMRMLSubjectHierarchyTreeView::useLazyModel()const
+{
+  Q_D(const qMRMLSubjectHierarchyTreeView);
+  return d->UseLazyModel;
+}
+
+//--------------------------------------------------------------------------
+void qMRMLSubjectHierarchyTreeView::setUseLazyModel(bool use)
+{
+  Q_D(qMRMLSubjectHierarchyTreeView);
+  if (d->UseLazyModel == use)
+    {
+    return;
+    }
+  if (!d->LazyModel)
+    {
+    d->LazyModel = new qMRMLSubjectHierarchyLazyModel(this);
+    QObject::connect( d->LazyModel, SIGNAL(requestExpandItem(vtkIdType)), this, SLOT(expandItem(vtkIdType)) );
+    }
+
+  vtkMRMLScene* scene = this->mrmlScene();
+  d->UseLazyModel = use;
+
+  // The view creates a new selection model for the new model
+  QItemSelectionModel* oldSelectionModel = this->selectionModel();
+  if (use)
+    {
+    this->QTreeView::setModel(d->LazyModel);
+    }
+  else
+    {
+    this->QTreeView::setModel(d->SortFilterModel);
+    }
+  delete oldSelectionModel;
+  QObject::connect( this->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)),
+                    this, SLOT(onSelectionChanged(QItemSelection,QItemSelection)) );
+  d->setupHeaderSections();
+
+  // Populate the shown model once it is in the view, so that it can request expanding items
+  d->setModelsScene(scene);
+  if (d->SubjectHierarchyNode)
+    {
+    this->setRootItem(d->RootItemID ? d->RootItemID : d->SubjectHierarchyNode->GetSceneItemID());
+    if (!use)
+      {
+      this->expandToDepth(4);
+      }
+    }
+}
+
 //--------------------------------------------------------------------------
 int qMRMLSubjectHierarchyTreeView::displayedItemCount()const
 {
   Q_D(const qMRMLSubjectHierarchyTreeView);
-  int count = this->sortFilterProxyModel()->acceptedItemCount(this->rootItem());
+  int count = 0;
+  if (d->UseLazyModel)
+    {
+    // Items are not filtered, all the items of the branch can be shown
+    if (d->SubjectHierarchyNode)
+      {
+      std::vector<vtkIdType> childItemIDs;
+      d->SubjectHierarchyNode->GetItemChildren(this->rootItem(), childItemIDs, true);
+      count = static_cast<int>(childItemIDs.size());
+      }
+    }
+  else
+    {
+    count = this->sortFilterProxyModel()->acceptedItemCount(this->rootItem());
+    }
   if (d->ShowRootItem)
     {
     count++;
@@ -521,6 +669,25 @@ void qMRMLSubjectHierarchyTreeView::setRootItem(vtkIdType rootItemID)
     return;
     }
 
+  if (d->UseLazyModel)
+    {
+    // The lazy model has the scene as only top-level item, and can't hide the siblings of the root item.
+    // If the root item has not been fetched yet, then the whole tree is shown.
+    QModelIndex treeRootIndex;
+    if (rootItemID && (rootItemID != d->SubjectHierarchyNode->GetSceneItemID() || !d->ShowRootItem))
+      {
+      treeRootIndex = d->LazyModel->indexFromSubjectHierarchyItem(rootItemID);
+      if (d->ShowRootItem && treeRootIndex.isValid())
+        {
+        treeRootIndex = treeRootIndex.parent();
+        rootItemID = d->LazyModel->subjectHierarchyItemFromIndex(treeRootIndex);
+        }
+      }
+    d->RootItemID = rootItemID;
+    this->setRootIndex(treeRootIndex);
+    return;
+    }
+
   qMRMLSubjectHierarchyModel* sceneModel = qobject_cast<qMRMLSubjectHierarchyModel*>(this->model());
 
   // Reset item in unaffiliated filter (that hides all siblings and their children)
@@ -573,7 +740,7 @@ vtkIdType qMRMLSubjectHierarchyTreeView::rootItem()const
     return vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID;
     }
 
-  vtkIdType treeRootItemID = this->sortFilterProxyModel()->subjectHierarchyItemFromIndex(this->rootIndex());
+  vtkIdType treeRootItemID = d->itemFromIndex(this->rootIndex());
   if (d->ShowRootItem)
     {
     if (d->RootItemID == d->SubjectHierarchyNode->GetSceneItemID())
@@ -582,7 +749,7 @@ vtkIdType qMRMLSubjectHierarchyTreeView::rootItem()const
       // So in that case no checks are performed
       return d->RootItemID;
       }
-    else if (this->sortFilterProxyModel()->hideItemsUnaffiliatedWithItemID())
+    else if (!d->UseLazyModel && this->sortFilterProxyModel()->hideItemsUnaffiliatedWithItemID())
       {
       treeRootItemID = this->sortFilterProxyModel()->hideItemsUnaffiliatedWithItemID();
       }
@@ -731,7 +898,7 @@ bool qMRMLSubjectHierarchyTreeView::clickDecoration(QMouseEvent* e)
     return false;
     }
 
-  QModelIndex sourceIndex = this->sortFilterProxyModel()->mapToSource(index);
+  QModelIndex sourceIndex = (d->UseLazyModel ? index : this->sortFilterProxyModel()->mapToSource(index));
   if (!(sourceIndex.flags() & Qt::ItemIsEnabled))
     {
     // Item is disabled
@@ -739,9 +906,9 @@ bool qMRMLSubjectHierarchyTreeView::clickDecoration(QMouseEvent* e)
     }
 
   // Visibility column
-  if (sourceIndex.column() == this->model()->visibilityColumn())
+  if (sourceIndex.column() == d->visibilityColumn())
     {
-    vtkIdType itemID = d->SortFilterModel->subjectHierarchyItemFromIndex(index);
+    vtkIdType itemID = d->itemFromIndex(index);
     if (!itemID)
       {
       // Valid item is needed for visibility actions
@@ -802,7 +969,7 @@ void qMRMLSubjectHierarchyTreeView::mousePressEvent(QMouseEvent* e)
 
     // Get subject hierarchy item at mouse click position
     QModelIndex index = this->indexAt(e->pos());
-    vtkIdType itemID = this->sortFilterProxyModel()->subjectHierarchyItemFromIndex(index);
+    vtkIdType itemID = d->itemFromIndex(index);
 
     // Populate context menu for the current item
     this->populateContextMenuForItem(itemID);
@@ -842,7 +1009,7 @@ void qMRMLSubjectHierarchyTreeView::onSelectionChanged(const QItemSelection& sel
   Q_UNUSED(selected);
   Q_UNUSED(deselected);
   Q_D(qMRMLSubjectHierarchyTreeView);
-  if (!d->SortFilterModel || !d->SubjectHierarchyNode || this->mrmlScene()->IsBatchProcessing())
+  if (!d->SortFilterModel || !d->SubjectHierarchyNode || !this->mrmlScene() || this->mrmlScene()->IsBatchProcessing())
     {
     return;
     }
@@ -857,7 +1024,7 @@ void qMRMLSubjectHierarchyTreeView::onSelectionChanged(const QItemSelection& sel
       {
       continue;
       }
-    vtkIdType itemID = this->sortFilterProxyModel()->subjectHierarchyItemFromIndex(index);
+    vtkIdType itemID = d->itemFromIndex(index);
     if (itemID)
       {
       selectedShItems << itemID;
@@ -888,7 +1055,7 @@ void qMRMLSubjectHierarchyTreeView::onSelectionChanged(const QItemSelection& sel
   vtkIdType newCurrentItemID = vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID;
   if (selectedIndices.count() > 0)
     {
-    newCurrentItemID = d->SortFilterModel->subjectHierarchyItemFromIndex(selectedIndices[0]);
+    newCurrentItemID = d->itemFromIndex(selectedIndices[0]);
     }
   emit currentItemChanged(newCurrentItemID);
 }
@@ -902,7 +1069,7 @@ void qMRMLSubjectHierarchyTreeView::onItemExpanded(const QModelIndex &expandedIt
     return;
     }
 
-  vtkIdType expandedShItemID = d->SortFilterModel->subjectHierarchyItemFromIndex(expandedItemIndex);
+  vtkIdType expandedShItemID = d->itemFromIndex(expandedItemIndex);
   if (expandedShItemID)
     {
     d->SubjectHierarchyNode->SetItemExpanded(expandedShItemID, true);
@@ -918,7 +1085,7 @@ void qMRMLSubjectHierarchyTreeView::onItemCollapsed(const QModelIndex &collapsed
     return;
     }
 
-  vtkIdType collapsedShItemID = d->SortFilterModel->subjectHierarchyItemFromIndex(collapsedItemIndex);
+  vtkIdType collapsedShItemID = d->itemFromIndex(collapsedItemIndex);
   if (collapsedShItemID)
     {
     d->SubjectHierarchyNode->SetItemExpanded(collapsedShItemID, false);
@@ -1017,7 +1184,7 @@ void qMRMLSubjectHierarchyTreeView::expandItem(vtkIdType itemID)
   Q_D(qMRMLSubjectHierarchyTreeView);
   if (itemID)
     {
-    QModelIndex itemIndex = d->SortFilterModel->indexFromSubjectHierarchyItem(itemID);
+    QModelIndex itemIndex = d->indexFromItem(itemID);
     if (itemIndex.isValid())
       {
       this->expand(itemIndex);
@@ -1031,7 +1198,7 @@ void qMRMLSubjectHierarchyTreeView::collapseItem(vtkIdType itemID)
   Q_D(qMRMLSubjectHierarchyTreeView);
   if (itemID)
     {
-    QModelIndex itemIndex = d->SortFilterModel->indexFromSubjectHierarchyItem(itemID);
+    QModelIndex itemIndex = d->indexFromItem(itemID);
     if (itemIndex.isValid())
       {
       this->collapse(itemIndex);
@@ -1239,6 +1406,11 @@ void qMRMLSubjectHierarchyTreeView::applyReferenceHighlightForItems(QList<vtkIdT
     qCritical() << Q_FUNC_INFO << ": Invalid subject hierarchy";
     return;
     }
+  if (d->UseLazyModel)
+    {
+    // The lazy model does not store item backgrounds
+    return;
+    }
 
   // Get scene model and column to highlight
   qMRMLSubjectHierarchyModel* sceneModel = qobject_cast<qMRMLSubjectHierarchyModel*>(this->model());
@@ -1493,8 +1665,7 @@ bool qMRMLSubjectHierarchyTreeView::showContextMenuHint(bool visibility/*=false*
   if (!visibility)
     {
     // Get name cell position
-    QModelIndex nameIndex = this->sortFilterProxyModel()->indexFromSubjectHierarchyItem(
-      itemID, this->model()->nameColumn() );
+    QModelIndex nameIndex = d->indexFromItem(itemID, d->nameColumn());
     QRect nameRect = this->visualRect(nameIndex);
 
     // Show name tooltip
@@ -1508,8 +1679,7 @@ bool qMRMLSubjectHierarchyTreeView::showContextMenuHint(bool visibility/*=false*
   else
     {
     // Get visibility cell position
-    QModelIndex visibilityIndex = this->sortFilterProxyModel()->indexFromSubjectHierarchyItem(
-      itemID, this->model()->visibilityColumn() );
+    QModelIndex visibilityIndex = d->indexFromItem(itemID, d->visibilityColumn());
     QRect visibilityRect = this->visualRect(visibilityIndex);
 
     // Show visibility tooltip
@@ -34,6 +34,7 @@
 
 class qMRMLSubjectHierarchyTreeViewPrivate;
 class qMRMLSortFilterSubjectHierarchyProxyModel;
+class qMRMLSubjectHierarchyLazyModel;
 class qMRMLSubjectHierarchyModel;
 class vtkMRMLSubjectHierarchyNode;
 class vtkMRMLScene;
@@ -60,6 +61,13 @@ class Q_SLICER_MODULE_SUBJECTHIERARCHY_WIDGETS_EXPORT qMRMLSubjectHierarchyTreeV
   Q_PROPERTY(bool editMenuActionVisible READ editMenuActionVisible WRITE setEditMenuActionVisible)
   /// Flag determining whether multiple items can be selected
   Q_PROPERTY(bool multiSelection READ multiSelection WRITE setMultiSelection)
+  /// Show the subject hierarchy through \sa lazyModel instead of \sa model, for very large hierarchies.
+  /// Only the items of the expanded branches are added to the tree, and the expanded state of the items
+  /// is restored from the subject hierarchy. Attribute, level and name filters, hiding the siblings of
+  /// a shown root item, referenced item highlighting, drag&drop and transform editing are not available.
+  /// Off by default. The Data module turns it on when the hierarchy has more items than
+  /// qSlicerSubjectHierarchyPluginHandler::lazyModelItemCountThreshold.
+  Q_PROPERTY(bool useLazyModel READ useLazyModel WRITE setUseLazyModel)
 
 public:
   typedef QTreeView Superclass;
@@ -101,6 +109,8 @@ public:
 
   Q_INVOKABLE qMRMLSortFilterSubjectHierarchyProxyModel* sortFilterProxyModel()const;
   Q_INVOKABLE qMRMLSubjectHierarchyModel* model()const;
+  /// Model shown instead of the sort filter proxy model if \sa useLazyModel is on. NULL until then.
+  Q_INVOKABLE qMRMLSubjectHierarchyLazyModel* lazyModel()const;
 
   /// Determine the number of shown items
   Q_INVOKABLE int displayedItemCount()const;
@@ -108,6 +118,7 @@ public:
   bool highlightReferencedItems()const;
   bool contextMenuEnabled()const;
   bool editMenuActionVisible()const;
+  bool useLazyModel()const;
 
 public slots:
   /// Set MRML scene
@@ -157,6 +168,7 @@ public slots:
   void setHighlightReferencedItems(bool highlightOn);
   void setContextMenuEnabled(bool enabled);
   void setEditMenuActionVisible(bool visible);
+  void setUseLazyModel(bool use);
 
 signals:
   void currentItemChanged(vtkIdType);
@@ -588,6 +588,25 @@ void qSlicerSubjectHierarchyPluginHandler::setDisplayStudyDateInSubjectHierarchy
   settings->setValue("SubjectHierarchy/DisplayStudyDateInSubjectHierarchyItemName", on);
 }
 
+//-----------------------------------------------------------------------------
+int qSlicerSubjectHierarchyPluginHandler::lazyModelItemCountThreshold()const
+{
+  QSettings* settings = qSlicerApplication::application()->settingsDialog()->settings();
+  if (settings->contains("SubjectHierarchy/LazyModelItemCountThreshold"))
+    {
+    return settings->value("SubjectHierarchy/LazyModelItemCountThreshold").toInt();
+    }
+
+  return 10000; // Default value
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerSubjectHierarchyPluginHandler::setLazyModelItemCountThreshold(int count)
+{
+  QSettings* settings = qSlicerApplication::application()->settingsDialog()->settings();
+  settings->setValue("SubjectHierarchy/LazyModelItemCountThreshold", count);
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerSubjectHierarchyPluginHandler::onSubjectHierarchyNodeEvent(
   vtkObject* caller, unsigned long event, void* clientData, void* callData )
@@ -76,6 +76,10 @@ class Q_SLICER_MODULE_SUBJECTHIERARCHY_WIDGETS_EXPORT qSlicerSubjectHierarchyPlu
   /// subject hierarchy item name after loading from DICOM.
   /// True by default
   Q_PROPERTY (bool displayStudyDateInSubjectHierarchyItemName READ displayStudyDateInSubjectHierarchyItemName WRITE setDisplayStudyDateInSubjectHierarchyItemName)
+  /// Number of subject hierarchy items above which the subject hierarchy tree of the Data module
+  /// is populated lazily (see qMRMLSubjectHierarchyTreeView::useLazyModel). 0 means never.
+  /// 10000 by default
+  Q_PROPERTY (int lazyModelItemCountThreshold READ lazyModelItemCountThreshold WRITE setLazyModelItemCountThreshold)
 
 public:
   /// Instance getter for the singleton class
@@ -132,6 +136,8 @@ public:
   Q_INVOKABLE void setDisplayStudyIDInSubjectHierarchyItemName(bool on);
   Q_INVOKABLE bool displayStudyDateInSubjectHierarchyItemName()const;
   Q_INVOKABLE void setDisplayStudyDateInSubjectHierarchyItemName(bool on);
+  Q_INVOKABLE int lazyModelItemCountThreshold()const;
+  Q_INVOKABLE void setLazyModelItemCountThreshold(int count);
 
 public:
   /// Register a plugin
@@ -62,6 +62,7 @@ void qSlicerSubjectHierarchySettingsPanelPrivate::init()
 
   // Default values
   this->AutoDeleteSubjectHierarchyChildrenEnabledCheckBox->setChecked(false);
+  this->LazyModelItemCountThresholdSpinBox->setValue(10000);
 
   this->PatientIDTagCheckBox->setChecked(true);
   this->PatientBirthDateTagCheckBox->setChecked(false);
@@ -72,6 +73,9 @@ void qSlicerSubjectHierarchySettingsPanelPrivate::init()
   q->registerProperty("SubjectHierarchy/AutoDeleteSubjectHierarchyChildren", this->AutoDeleteSubjectHierarchyChildrenEnabledCheckBox,
                       "checked", SIGNAL(toggled(bool)),
                       "Enable/disable automatic subject hierarchy children deletion", ctkSettingsPanel::OptionNone);
+  q->registerProperty("SubjectHierarchy/LazyModelItemCountThreshold", this->LazyModelItemCountThresholdSpinBox,
+                      "value", SIGNAL(valueChanged(int)),
+                      "Number of items above which the subject hierarchy tree is populated lazily", ctkSettingsPanel::OptionNone);
 
   q->registerProperty("SubjectHierarchy/DisplayPatientIDInSubjectHierarchyItemName", this->PatientIDTagCheckBox,
                       "checked", SIGNAL(toggled(bool)),
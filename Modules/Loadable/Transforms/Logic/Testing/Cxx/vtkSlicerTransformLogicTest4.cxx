@@ -0,0 +1,119 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Logic includes
+#include "vtkSlicerTransformLogic.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLTransformDisplayNode.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+void SetTranslation(vtkMRMLLinearTransformNode* transformNode, double translationX)
+{
+  vtkNew<vtkMatrix4x4> matrix;
+  matrix->SetElement(0, 3, translationX);
+  transformNode->SetMatrixTransformToParent(matrix.GetPointer());
+}
+
+//-----------------------------------------------------------------------------
+int CheckGlyphDisplacement(vtkMRMLTransformDisplayNode* displayNode, int roiSize[3], double expectedDisplacement)
+{
+  vtkNew<vtkMatrix4x4> roiToRAS;
+  vtkNew<vtkPolyData> visualization;
+  CHECK_BOOL(vtkSlicerTransformLogic::GetVisualization3d(visualization.GetPointer(), displayNode,
+    roiToRAS.GetPointer(), roiSize), true);
+  vtkDataArray* magnitudes = visualization->GetPointData()->GetArray(
+    vtkSlicerTransformLogic::GetVisualizationDisplacementMagnitudeScalarName());
+  CHECK_NOT_NULL(magnitudes);
+  double range[2] = { 0.0, 0.0 };
+  magnitudes->GetRange(range);
+  CHECK_DOUBLE_TOLERANCE(range[0], expectedDisplacement, 1e-6);
+  CHECK_DOUBLE_TOLERANCE(range[1], expectedDisplacement, 1e-6);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+// Check that transform samples used for visualization are reused from the cache
+// and that they are discarded when the transform is modified or deleted.
+int vtkSlicerTransformLogicTest4(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkSmartPointer<vtkMRMLLinearTransformNode> transformNode = vtkSmartPointer<vtkMRMLLinearTransformNode>::New();
+  scene->AddNode(transformNode);
+  SetTranslation(transformNode, 5.0);
+  vtkNew<vtkMRMLTransformDisplayNode> displayNode;
+  displayNode->SetVisualizationMode(vtkMRMLTransformDisplayNode::VIS_MODE_GLYPH);
+  scene->AddNode(displayNode.GetPointer());
+  transformNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+
+  vtkSlicerTransformLogic::ClearVisualizationCache();
+  CHECK_INT(vtkSlicerTransformLogic::GetNumberOfVisualizationCacheEntries(), 0);
+
+  int roiSize[3] = { 40, 40, 40 };
+  int otherRoiSize[3] = { 60, 40, 40 };
+
+  // Each sampling geometry is stored in a new entry
+  CHECK_EXIT_SUCCESS(CheckGlyphDisplacement(displayNode.GetPointer(), roiSize, 5.0));
+  CHECK_INT(vtkSlicerTransformLogic::GetNumberOfVisualizationCacheEntries(), 1);
+  CHECK_EXIT_SUCCESS(CheckGlyphDisplacement(displayNode.GetPointer(), otherRoiSize, 5.0));
+  CHECK_INT(vtkSlicerTransformLogic::GetNumberOfVisualizationCacheEntries(), 2);
+
+  // Cache hit: no new entry is added
+  CHECK_EXIT_SUCCESS(CheckGlyphDisplacement(displayNode.GetPointer(), roiSize, 5.0));
+  CHECK_INT(vtkSlicerTransformLogic::GetNumberOfVisualizationCacheEntries(), 2);
+
+  // Modified transform: obsolete samples are replaced
+  SetTranslation(transformNode, 10.0);
+  CHECK_EXIT_SUCCESS(CheckGlyphDisplacement(displayNode.GetPointer(), roiSize, 10.0));
+  CHECK_INT(vtkSlicerTransformLogic::GetNumberOfVisualizationCacheEntries(), 2);
+
+  // Modified parent transform: obsolete samples are replaced
+  vtkNew<vtkMRMLLinearTransformNode> parentTransformNode;
+  scene->AddNode(parentTransformNode.GetPointer());
+  SetTranslation(parentTransformNode.GetPointer(), 2.0);
+  transformNode->SetAndObserveTransformNodeID(parentTransformNode->GetID());
+  CHECK_EXIT_SUCCESS(CheckGlyphDisplacement(displayNode.GetPointer(), roiSize, 12.0));
+  CHECK_INT(vtkSlicerTransformLogic::GetNumberOfVisualizationCacheEntries(), 2);
+
+  // Deleted transform: all its samples are discarded
+  scene->RemoveNode(transformNode);
+  transformNode = NULL;
+  CHECK_INT(vtkSlicerTransformLogic::GetNumberOfVisualizationCacheEntries(), 0);
+
+  // Scene close does not leave samples behind for new nodes
+  transformNode = vtkSmartPointer<vtkMRMLLinearTransformNode>::New();
+  scene->AddNode(transformNode);
+  SetTranslation(transformNode, 3.0);
+  transformNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  CHECK_EXIT_SUCCESS(CheckGlyphDisplacement(displayNode.GetPointer(), roiSize, 3.0));
+  CHECK_INT(vtkSlicerTransformLogic::GetNumberOfVisualizationCacheEntries(), 1);
+  scene->Clear(1);
+  transformNode = NULL;
+  CHECK_INT(vtkSlicerTransformLogic::GetNumberOfVisualizationCacheEntries(), 0);
+
+  return EXIT_SUCCESS;
+}
@@ -52,14 +52,15 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #include <vtkPoints.h>
 #include <vtkPointSet.h>
 #include <vtkPointData.h>
+#include <vtkSMPTools.h>
 #include <vtkSphereSource.h>
 #include <vtkThinPlateSplineTransform.h>
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
 #include <vtkTubeFilter.h>
 #include <vtkUnstructuredGrid.h>
-#include <vtkVectorNorm.h>
 #include <vtkWarpVector.h>
+#include <vtkWeakPointer.h>
 
 // ITK includes
 #include "itkBSplineDeformableTransform.h"
@@ -77,8 +78,360 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #include "itkTranslationTransform.h"
 #include "itkTransformFactory.h"
 
+// STD includes
+#include <algorithm>
+#include <list>
+
 vtkStandardNewMacro(vtkSlicerTransformLogic);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Computes displacement vectors for a list of points.
+// The transform must be up-to-date (Update() called) before the functor is executed,
+// as InternalTransformPoint is used, which does not update the transform.
+class vtkTransformPointListSamplerFunctor
+{
+public:
+  vtkTransformPointListSamplerFunctor(vtkAbstractTransform* transform, vtkPoints* points, double* displacements)
+    : Transform(transform), Points(points), Displacements(displacements)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    double point_RAS[3] = { 0, 0, 0 };
+    double transformedPoint_RAS[3] = { 0, 0, 0 };
+    double* displacement = this->Displacements + begin * 3;
+    for (vtkIdType sampleIndex = begin; sampleIndex < end; sampleIndex++)
+      {
+      this->Points->GetPoint(sampleIndex, point_RAS);
+      this->Transform->InternalTransformPoint(point_RAS, transformedPoint_RAS);
+      *(displacement++) = transformedPoint_RAS[0] - point_RAS[0];
+      *(displacement++) = transformedPoint_RAS[1] - point_RAS[1];
+      *(displacement++) = transformedPoint_RAS[2] - point_RAS[2];
+      }
+  }
+
+private:
+  vtkAbstractTransform* Transform;
+  vtkPoints* Points;
+  double* Displacements;
+};
+
+//----------------------------------------------------------------------------
+// Computes displacement vectors on a regular grid, one slice (k index) per work item.
+// Output is stored in a 3-component buffer, with i index changing fastest.
+// The transform must be up-to-date (Update() called) before the functor is executed.
+template <class T>
+class vtkTransformGridSamplerFunctor
+{
+public:
+  vtkTransformGridSamplerFunctor(vtkAbstractTransform* transform, vtkMatrix4x4* ijkToRAS, const int extent[6], T* displacements)
+    : Transform(transform), Displacements(displacements)
+  {
+    for (int i = 0; i < 6; i++)
+      {
+      this->Extent[i] = extent[i];
+      }
+    for (int row = 0; row < 4; row++)
+      {
+      for (int col = 0; col < 4; col++)
+        {
+        this->IJKToRAS[row][col] = ijkToRAS->GetElement(row, col);
+        }
+      }
+  }
+
+  void operator()(vtkIdType beginSlice, vtkIdType endSlice) const
+  {
+    const vtkIdType numberOfSamplesPerSlice = static_cast<vtkIdType>(this->Extent[1] - this->Extent[0] + 1)
+      * (this->Extent[3] - this->Extent[2] + 1);
+    double point_RAS[3] = { 0, 0, 0 };
+    double transformedPoint_RAS[3] = { 0, 0, 0 };
+    for (vtkIdType sliceIndex = beginSlice; sliceIndex < endSlice; sliceIndex++)
+      {
+      T* displacement = this->Displacements + sliceIndex * numberOfSamplesPerSlice * 3;
+      double k = this->Extent[4] + sliceIndex;
+      for (int j = this->Extent[2]; j <= this->Extent[3]; j++)
+        {
+        for (int i = this->Extent[0]; i <= this->Extent[1]; i++)
+          {
+          for (int row = 0; row < 3; row++)
+            {
+            point_RAS[row] = this->IJKToRAS[row][0] * i + this->IJKToRAS[row][1] * j
+              + this->IJKToRAS[row][2] * k + this->IJKToRAS[row][3];
+            }
+          this->Transform->InternalTransformPoint(point_RAS, transformedPoint_RAS);
+          *(displacement++) = static_cast<T>(transformedPoint_RAS[0] - point_RAS[0]);
+          *(displacement++) = static_cast<T>(transformedPoint_RAS[1] - point_RAS[1]);
+          *(displacement++) = static_cast<T>(transformedPoint_RAS[2] - point_RAS[2]);
+          }
+        }
+      }
+  }
+
+private:
+  vtkAbstractTransform* Transform;
+  double IJKToRAS[4][4];
+  int Extent[6];
+  T* Displacements;
+};
+
+//----------------------------------------------------------------------------
+// Computes displacement magnitude from displacement vectors.
+template <class TInput, class TOutput>
+class vtkDisplacementMagnitudeFunctor
+{
+public:
+  vtkDisplacementMagnitudeFunctor(const TInput* displacements, TOutput* magnitudes)
+    : Displacements(displacements), Magnitudes(magnitudes)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    const TInput* displacement = this->Displacements + begin * 3;
+    for (vtkIdType sampleIndex = begin; sampleIndex < end; sampleIndex++, displacement += 3)
+      {
+      this->Magnitudes[sampleIndex] = static_cast<TOutput>(sqrt(
+        displacement[0] * displacement[0] + displacement[1] * displacement[1] + displacement[2] * displacement[2]));
+      }
+  }
+
+private:
+  const TInput* Displacements;
+  TOutput* Magnitudes;
+};
+
+//----------------------------------------------------------------------------
+// Sample the transform on a regular grid and store the displacement vectors in a buffer.
+template <class T>
+bool SampleTransformOnGrid(vtkMRMLTransformNode* inputTransformNode, vtkMatrix4x4* ijkToRAS, const int extent[6],
+  bool transformToWorld, T* displacements)
+{
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+    {
+    // empty grid
+    return true;
+    }
+  vtkNew<vtkGeneralTransform> inputTransform;
+  if (transformToWorld)
+    {
+    inputTransformNode->GetTransformToWorld(inputTransform.GetPointer());
+    }
+  else
+    {
+    inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
+    }
+  // Update must be called before InternalTransformPoint is called from multiple threads
+  inputTransform->Update();
+  vtkTransformGridSamplerFunctor<T> functor(inputTransform.GetPointer(), ijkToRAS, extent, displacements);
+  vtkSMPTools::For(0, extent[5] - extent[4] + 1, functor);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Cache of displacement vectors sampled on a regular grid for transform visualization.
+// Displayable managers of each view request the visualization independently and
+// all the visualization modes sample the transform on a grid, therefore the same
+// samples are often requested many times (for example, the same region node is used
+// in all 3D views). Samples are recomputed only if the transform or
+// the sampling geometry changes.
+// Samples are stored in STL containers (not VTK objects) to allow using a static
+// cache without being reported as leaked VTK objects. Transform nodes are only
+// weakly referenced: entries of deleted nodes are discarded, so that a new node
+// that is allocated at the same address cannot get samples of a deleted node.
+class vtkTransformVisualizationSampleCache
+{
+public:
+  struct CacheEntry
+  {
+    vtkWeakPointer<vtkMRMLTransformNode> TransformNode;
+    vtkMTimeType TransformMTime;
+    bool TransformToWorld;
+    int Extent[6];
+    double IJKToRAS[16];
+    std::vector<double> Displacements;
+  };
+
+  static vtkTransformVisualizationSampleCache* GetInstance()
+    {
+    static vtkTransformVisualizationSampleCache instance;
+    return &instance;
+    }
+
+  /// Returns displacement vectors sampled on the specified grid.
+  /// The returned reference is valid until the next GetDisplacements or Clear call.
+  const std::vector<double>& GetDisplacements(vtkMRMLTransformNode* transformNode, vtkMatrix4x4* ijkToRAS,
+    const int extent[6], bool transformToWorld)
+    {
+    this->RemoveDeletedEntries();
+    vtkMTimeType transformMTime = GetTransformChainMTime(transformNode);
+    for (std::list<CacheEntry>::iterator entryIt = this->Entries.begin(); entryIt != this->Entries.end(); ++entryIt)
+      {
+      if (entryIt->TransformNode.GetPointer() != transformNode || entryIt->TransformToWorld != transformToWorld)
+        {
+        continue;
+        }
+      if (!IsSameGeometry(*entryIt, ijkToRAS, extent))
+        {
+        continue;
+        }
+      if (entryIt->TransformMTime != transformMTime)
+        {
+        // transform has changed, this entry is obsolete
+        this->Entries.erase(entryIt);
+        break;
+        }
+      // found a valid entry, move it to the front (most recently used)
+      this->Entries.splice(this->Entries.begin(), this->Entries, entryIt);
+      return this->Entries.front().Displacements;
+      }
+
+    // Not found in the cache, compute now
+    this->Entries.push_front(CacheEntry());
+    CacheEntry& entry = this->Entries.front();
+    entry.TransformNode = transformNode;
+    entry.TransformMTime = transformMTime;
+    entry.TransformToWorld = transformToWorld;
+    for (int i = 0; i < 6; i++)
+      {
+      entry.Extent[i] = extent[i];
+      }
+    for (int i = 0; i < 16; i++)
+      {
+      entry.IJKToRAS[i] = ijkToRAS->GetElement(i / 4, i % 4);
+      }
+    vtkIdType numberOfSamples = 0;
+    if (extent[0] <= extent[1] && extent[2] <= extent[3] && extent[4] <= extent[5])
+      {
+      numberOfSamples = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * (extent[3] - extent[2] + 1) * (extent[5] - extent[4] + 1);
+      }
+    entry.Displacements.resize(numberOfSamples * 3);
+    if (numberOfSamples > 0)
+      {
+      SampleTransformOnGrid<double>(transformNode, ijkToRAS, extent, transformToWorld, &(entry.Displacements[0]));
+      }
+
+    while (this->Entries.size() > MaximumNumberOfEntries)
+      {
+      this->Entries.pop_back();
+      }
+    return this->Entries.front().Displacements;
+    }
+
+  void Clear()
+    {
+    this->Entries.clear();
+    }
+
+  int GetNumberOfEntries()
+    {
+    this->RemoveDeletedEntries();
+    return static_cast<int>(this->Entries.size());
+    }
+
+protected:
+  void RemoveDeletedEntries()
+    {
+    std::list<CacheEntry>::iterator entryIt = this->Entries.begin();
+    while (entryIt != this->Entries.end())
+      {
+      if (entryIt->TransformNode.GetPointer() == NULL)
+        {
+        entryIt = this->Entries.erase(entryIt);
+        }
+      else
+        {
+        ++entryIt;
+        }
+      }
+    }
+
+  static const size_t MaximumNumberOfEntries = 8;
+
+  /// Get latest modification time of the transforms and of the transform nodes
+  /// (to detect changes in the parent transform node) up to the world.
+  static vtkMTimeType GetTransformChainMTime(vtkMRMLTransformNode* transformNode)
+    {
+    vtkMTimeType latestMTime = transformNode->GetTransformToWorldMTime();
+    for (vtkMRMLTransformNode* node = transformNode; node != NULL; node = node->GetParentTransformNode())
+      {
+      if (node->GetMTime() > latestMTime)
+        {
+        latestMTime = node->GetMTime();
+        }
+      }
+    return latestMTime;
+    }
+
+  static bool IsSameGeometry(const CacheEntry& entry, vtkMatrix4x4* ijkToRAS, const int extent[6])
+    {
+    for (int i = 0; i < 6; i++)
+      {
+      if (entry.Extent[i] != extent[i])
+        {
+        return false;
+        }
+      }
+    for (int i = 0; i < 16; i++)
+      {
+      if (entry.IJKToRAS[i] != ijkToRAS->GetElement(i / 4, i % 4))
+        {
+        return false;
+        }
+      }
+    return true;
+    }
+
+  std::list<CacheEntry> Entries;
+};
+
+//----------------------------------------------------------------------------
+// Fill magnitude image using cached displacement samples.
+// The extents of the output image must be set before calling this method.
+void GetCachedDisplacementMagnitudeImage(vtkImageData* magnitudeImage, vtkMRMLTransformNode* inputTransformNode,
+  vtkMatrix4x4* ijkToRAS)
+{
+  magnitudeImage->AllocateScalars(VTK_FLOAT, 1);
+  vtkIdType numberOfVoxels = magnitudeImage->GetNumberOfPoints();
+  if (!inputTransformNode || numberOfVoxels == 0)
+    {
+    return;
+    }
+  const std::vector<double>& displacements = vtkTransformVisualizationSampleCache::GetInstance()->GetDisplacements(
+    inputTransformNode, ijkToRAS, magnitudeImage->GetExtent(), true);
+  vtkDisplacementMagnitudeFunctor<double, float> magnitudeFunctor(&(displacements[0]),
+    static_cast<float*>(magnitudeImage->GetScalarPointer()));
+  vtkSMPTools::For(0, numberOfVoxels, magnitudeFunctor);
+}
+
+//----------------------------------------------------------------------------
+// Set displacement vectors and magnitude as point data
+void SetDisplacementPointData(vtkPointSet* outputPointSet, vtkPoints* samplePositions_RAS, vtkDoubleArray* sampleVectors_RAS)
+{
+  outputPointSet->SetPoints(samplePositions_RAS);
+  vtkPointData* pointData = outputPointSet->GetPointData();
+  pointData->SetVectors(sampleVectors_RAS);
+
+  // Compute vector magnitude and add to the data set
+  vtkIdType numOfSamples = sampleVectors_RAS->GetNumberOfTuples();
+  vtkNew<vtkDoubleArray> vectorMagnitude;
+  vectorMagnitude->SetName(vtkSlicerTransformLogic::GetVisualizationDisplacementMagnitudeScalarName());
+  vectorMagnitude->SetNumberOfTuples(numOfSamples);
+  if (numOfSamples > 0)
+    {
+    vtkDisplacementMagnitudeFunctor<double, double> magnitudeFunctor(sampleVectors_RAS->GetPointer(0), vectorMagnitude->GetPointer(0));
+    vtkSMPTools::For(0, numOfSamples, magnitudeFunctor);
+    }
+  int idx = pointData->AddArray(vectorMagnitude.GetPointer());
+  pointData->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkSlicerTransformLogic::vtkSlicerTransformLogic()
 {
@@ -205,26 +558,33 @@ const char* vtkSlicerTransformLogic::GetVisualizationDisplacementMagnitudeScalar
   return "DisplacementMagnitude";
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerTransformLogic::ClearVisualizationCache()
+{
+  vtkTransformVisualizationSampleCache::GetInstance()->Clear();
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerTransformLogic::GetNumberOfVisualizationCacheEntries()
+{
+  return vtkTransformVisualizationSampleCache::GetInstance()->GetNumberOfEntries();
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerTransformLogic::GetTransformedPointSamples(vtkPointSet* outputPointSet,
   vtkMRMLTransformNode* inputTransformNode, vtkMatrix4x4* gridToRAS, int* gridSize,
   bool transformToWorld /* = true */)
 {
-  vtkNew<vtkGeneralTransform> inputTransform;
-  if (transformToWorld)
-  {
-    inputTransformNode->GetTransformToWorld(inputTransform.GetPointer());
-  }
-  else
-  {
-    inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
-  }
+  if (!inputTransformNode)
+    {
+    return;
+    }
+
   // Generate sample point set on a grid
   vtkNew<vtkPoints> samplePositions_RAS;
   int numOfSamples = gridSize[0] * gridSize[1] * gridSize[2];
   samplePositions_RAS->SetNumberOfPoints(numOfSamples);
   double point_RAS[4] = { 0, 0, 0, 1 };
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
   double point_Grid[4] = { 0, 0, 0, 1 };
   int sampleIndex = 0;
   for (point_Grid[2] = 0; point_Grid[2]<gridSize[2]; point_Grid[2]++)
@@ -234,14 +594,28 @@ void vtkSlicerTransformLogic::GetTransformedPointSamples(vtkPointSet* outputPoin
       for (point_Grid[0] = 0; point_Grid[0]<gridSize[0]; point_Grid[0]++)
         {
         gridToRAS->MultiplyPoint(point_Grid, point_RAS);
-        inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
         samplePositions_RAS->SetPoint(sampleIndex, point_RAS[0], point_RAS[1], point_RAS[2]);
         sampleIndex++;
         }
       }
    }
 
-  vtkSlicerTransformLogic::GetTransformedPointSamples(outputPointSet, inputTransformNode, samplePositions_RAS.GetPointer(), transformToWorld);
+  // Get displacements (from the cache, if the same grid has been already sampled)
+  int gridExtent[6] = { 0, gridSize[0] - 1, 0, gridSize[1] - 1, 0, gridSize[2] - 1 };
+  const std::vector<double>& displacements = vtkTransformVisualizationSampleCache::GetInstance()->GetDisplacements(
+    inputTransformNode, gridToRAS, gridExtent, transformToWorld);
+
+  // Displacement vectors are copied, as they may be modified (for example, projected to a slice)
+  vtkNew<vtkDoubleArray> sampleVectors_RAS;
+  sampleVectors_RAS->SetNumberOfComponents(3);
+  sampleVectors_RAS->SetNumberOfTuples(numOfSamples);
+  sampleVectors_RAS->SetName("DisplacementVector");
+  if (numOfSamples > 0)
+    {
+    std::copy(displacements.begin(), displacements.end(), sampleVectors_RAS->GetPointer(0));
+    }
+
+  SetDisplacementPointData(outputPointSet, samplePositions_RAS.GetPointer(), sampleVectors_RAS.GetPointer());
 }
 
 //----------------------------------------------------------------------------
@@ -262,43 +636,24 @@ void vtkSlicerTransformLogic::GetTransformedPointSamples(vtkPointSet* outputPoin
   sampleVectors_RAS->SetNumberOfTuples(numOfSamples);
   sampleVectors_RAS->SetName("DisplacementVector");
 
-  vtkNew<vtkGeneralTransform> inputTransform;
-  if (transformToWorld)
-    {
-    inputTransformNode->GetTransformToWorld(inputTransform.GetPointer());
-    }
-  else
+  if (numOfSamples > 0)
     {
-    inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
-    }
-
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
-  double pointDislocationVector_RAS[4] = { 0, 0, 0, 1 };
-  for (int sampleIndex = 0; sampleIndex < numOfSamples; sampleIndex++)
-    {
-    double* point_RAS = samplePositions_RAS->GetPoint(sampleIndex);
-
-    inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
-
-    pointDislocationVector_RAS[0] = transformedPoint_RAS[0] - point_RAS[0];
-    pointDislocationVector_RAS[1] = transformedPoint_RAS[1] - point_RAS[1];
-    pointDislocationVector_RAS[2] = transformedPoint_RAS[2] - point_RAS[2];
-
-    sampleVectors_RAS->SetTuple3(sampleIndex, pointDislocationVector_RAS[0], pointDislocationVector_RAS[1], pointDislocationVector_RAS[2]);
+    vtkNew<vtkGeneralTransform> inputTransform;
+    if (transformToWorld)
+      {
+      inputTransformNode->GetTransformToWorld(inputTransform.GetPointer());
+      }
+    else
+      {
+      inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
+      }
+    // Update must be called before InternalTransformPoint is called from multiple threads
+    inputTransform->Update();
+    vtkTransformPointListSamplerFunctor functor(inputTransform.GetPointer(), samplePositions_RAS, sampleVectors_RAS->GetPointer(0));
+    vtkSMPTools::For(0, numOfSamples, functor);
     }
 
-  outputPointSet->SetPoints(samplePositions_RAS);
-  vtkPointData* pointData = outputPointSet->GetPointData();
-  pointData->SetVectors(sampleVectors_RAS.GetPointer());
-
-  // Compute vector magnitude and add to the data set
-  vtkNew<vtkVectorNorm> norm;
-  norm->SetInputData(outputPointSet);
-  norm->Update();
-  vtkDataArray* vectorMagnitude = norm->GetOutput()->GetPointData()->GetScalars();
-  vectorMagnitude->SetName(GetVisualizationDisplacementMagnitudeScalarName());
-  int idx = pointData->AddArray(vectorMagnitude);
-  pointData->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
+  SetDisplacementPointData(outputPointSet, samplePositions_RAS, sampleVectors_RAS.GetPointer());
 }
 
 /// Takes samples from the displacement field specified by the transformation on a slice
@@ -394,50 +749,24 @@ bool vtkSlicerTransformLogic::GetTransformedPointSamplesAsMagnitudeImage(vtkImag
     return false;
   }
 
-  vtkNew<vtkGeneralTransform> inputTransform;
-  if (transformToWorld)
-  {
-    inputTransformNode->GetTransformToWorld(inputTransform.GetPointer());
-  }
-  else
-  {
-    inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
-  }
 
   // The orientation of the volume cannot be set in the image
   // therefore the volume will not appear in the correct position
   // if the direction matrix is not identity.
   magnitudeImage->AllocateScalars(VTK_FLOAT, 1);
 
-  double point_RAS[4] = { 0, 0, 0, 1 };
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
-  double pointDislocationVector_RAS[4] = { 0, 0, 0, 1 };
-  double point_IJK[4] = { 0, 0, 0, 1 };
-  float* voxelPtr = static_cast<float*>(magnitudeImage->GetScalarPointer());
+  // Sample the displacement vectors in parallel, then compute the magnitudes
   int* extent = magnitudeImage->GetExtent();
-  for (point_IJK[2] = extent[4]; point_IJK[2] <= extent[5]; point_IJK[2]++)
+  vtkIdType numberOfVoxels = magnitudeImage->GetNumberOfPoints();
+  if (numberOfVoxels == 0)
   {
-    for (point_IJK[1] = extent[2]; point_IJK[1] <= extent[3]; point_IJK[1]++)
-    {
-      for (point_IJK[0] = extent[0]; point_IJK[0] <= extent[1]; point_IJK[0]++)
-      {
-        ijkToRAS->MultiplyPoint(point_IJK, point_RAS);
-
-        inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
-
-        pointDislocationVector_RAS[0] = transformedPoint_RAS[0] - point_RAS[0];
-        pointDislocationVector_RAS[1] = transformedPoint_RAS[1] - point_RAS[1];
-        pointDislocationVector_RAS[2] = transformedPoint_RAS[2] - point_RAS[2];
-
-        float mag = sqrt(
-          pointDislocationVector_RAS[0] * pointDislocationVector_RAS[0] +
-          pointDislocationVector_RAS[1] * pointDislocationVector_RAS[1] +
-          pointDislocationVector_RAS[2] * pointDislocationVector_RAS[2]);
-
-        *(voxelPtr++) = mag;
-      }
-    }
+    return true;
   }
+  std::vector<float> displacements(numberOfVoxels * 3);
+  SampleTransformOnGrid<float>(inputTransformNode, ijkToRAS, extent, transformToWorld, &(displacements[0]));
+  vtkDisplacementMagnitudeFunctor<float, float> magnitudeFunctor(&(displacements[0]),
+    static_cast<float*>(magnitudeImage->GetScalarPointer()));
+  vtkSMPTools::For(0, numberOfVoxels, magnitudeFunctor);
 
   return true;
 }
@@ -688,43 +1017,16 @@ bool vtkSlicerTransformLogic::GetTransformedPointSamplesAsVectorImage(vtkImageDa
     vtkGenericWarningMacro("vtkSlicerTransformLogic::GetTransformedPointSamplesAsVectorImage failed: invalid input");
     return false;
   }
-  vtkNew<vtkGeneralTransform> inputTransform;
-  if (transformToWorld)
-  {
-    inputTransformNode->GetTransformToWorld(inputTransform.GetPointer());
-  }
-  else
-  {
-    inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
-  }
 
   // The orientation of the volume cannot be set in the image
   // therefore the volume will not appear in the correct position
   // if the direction matrix is not identity.
   vectorImage->AllocateScalars(VTK_FLOAT, 3);
 
-  double point_RAS[4] = { 0, 0, 0, 1 };
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
-  double point_IJK[4] = { 0, 0, 0, 1 };
-  float* voxelPtr = static_cast<float*>(vectorImage->GetScalarPointer());
+  // Sample in parallel, directly into the image buffer
   int* extent = vectorImage->GetExtent();
-  for (point_IJK[2] = extent[4]; point_IJK[2] <= extent[5]; point_IJK[2]++)
-  {
-    for (point_IJK[1] = extent[2]; point_IJK[1] <= extent[3]; point_IJK[1]++)
-    {
-      for (point_IJK[0] = extent[0]; point_IJK[0] <= extent[1]; point_IJK[0]++)
-      {
-        ijkToRAS->MultiplyPoint(point_IJK, point_RAS);
-
-        inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
-
-        // store the pointDislocationVector_RAS components in the image
-        *(voxelPtr++) = static_cast<float>(transformedPoint_RAS[0] - point_RAS[0]);
-        *(voxelPtr++) = static_cast<float>(transformedPoint_RAS[1] - point_RAS[1]);
-        *(voxelPtr++) = static_cast<float>(transformedPoint_RAS[2] - point_RAS[2]);
-      }
-    }
-  }
+  SampleTransformOnGrid<float>(inputTransformNode, ijkToRAS, extent, transformToWorld,
+    static_cast<float*>(vectorImage->GetScalarPointer()));
 
   return true;
 }
@@ -1122,7 +1424,7 @@ void vtkSlicerTransformLogic::GetContourVisualization2d(vtkPolyData* output,
 
   vtkMRMLTransformNode* inputTransformNode = vtkMRMLTransformNode::SafeDownCast(displayNode->GetDisplayableNode());
   magnitudeImage->SetExtent(0, imageSize[0] - 1, 0, imageSize[1] - 1, 0, imageSize[2] - 1);
-  GetTransformedPointSamplesAsMagnitudeImage(magnitudeImage.GetPointer(), inputTransformNode, ijkToRAS.GetPointer());
+  GetCachedDisplacementMagnitudeImage(magnitudeImage.GetPointer(), inputTransformNode, ijkToRAS.GetPointer());
 
   vtkNew<vtkContourFilter> contourFilter;
   double* levels = displayNode->GetContourLevelsMm();
@@ -1188,7 +1490,7 @@ void vtkSlicerTransformLogic::GetContourVisualization3d(vtkPolyData* output, vtk
   int imageSize[3] = { numOfPointsX, numOfPointsY, numOfPointsZ };
   vtkMRMLTransformNode* transformNode = vtkMRMLTransformNode::SafeDownCast(displayNode->GetDisplayableNode());
   magnitudeImage->SetExtent(0, imageSize[0] - 1, 0, imageSize[1] - 1, 0, imageSize[2] - 1);
-  GetTransformedPointSamplesAsMagnitudeImage(magnitudeImage.GetPointer(), transformNode, ijkToRAS.GetPointer());
+  GetCachedDisplacementMagnitudeImage(magnitudeImage.GetPointer(), transformNode, ijkToRAS.GetPointer());
 
   // Contput contours
   vtkNew<vtkContourFilter> contourFilter;
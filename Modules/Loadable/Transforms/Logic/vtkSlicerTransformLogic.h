@@ -94,6 +94,17 @@ class VTK_SLICER_TRANSFORMS_MODULE_LOGIC_EXPORT vtkSlicerTransformLogic : public
   /// Return true on success.
   static bool GetVisualization3d(vtkPolyData* output_RAS, vtkMRMLTransformDisplayNode* displayNode, vtkMRMLNode* regionNode);
 
+  /// Remove all transform samples that are cached for transform visualization.
+  /// Displacement samples used by GetVisualization2d and GetVisualization3d are
+  /// cached and reused until the transform or the sampling geometry is changed,
+  /// therefore the same samples are computed only once for multiple views and
+  /// visualization modes.
+  static void ClearVisualizationCache();
+
+  /// Get the number of sampling results that are stored in the visualization cache.
+  /// Samples of deleted transform nodes are not counted (they are discarded).
+  static int GetNumberOfVisualizationCacheEntries();
+
   /// Name of the scalar array that stores the displacement magnitude values
   /// in polydata returned by GetVisualization2d and GetVisualization3d.
   static const char* GetVisualizationDisplacementMagnitudeScalarName();
@@ -34,6 +34,8 @@ vtkMRMLNodeNewMacro(vtkMRMLCPURayCastVolumeRenderingDisplayNode);
 vtkMRMLCPURayCastVolumeRenderingDisplayNode::vtkMRMLCPURayCastVolumeRenderingDisplayNode()
 {
   this->RaycastTechnique = vtkMRMLCPURayCastVolumeRenderingDisplayNode::Composite;
+  this->NumberOfThreads = 0;
+  this->InteractiveImageSampleDistance = 4.;
 }
 
 //----------------------------------------------------------------------------
@@ -59,6 +61,20 @@ void vtkMRMLCPURayCastVolumeRenderingDisplayNode::ReadXMLAttributes(const char**
       ss >> this->RaycastTechnique;
       continue;
       }
+    if (!strcmp(attName,"numberOfThreads"))
+      {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->NumberOfThreads;
+      continue;
+      }
+    if (!strcmp(attName,"interactiveImageSampleDistance"))
+      {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->InteractiveImageSampleDistance;
+      continue;
+      }
     }
 }
 
@@ -68,6 +84,8 @@ void vtkMRMLCPURayCastVolumeRenderingDisplayNode::WriteXML(ostream& of, int nInd
   this->Superclass::WriteXML(of, nIndent);
 
   of << " raycastTechnique=\"" << this->RaycastTechnique << "\"";
+  of << " numberOfThreads=\"" << this->NumberOfThreads << "\"";
+  of << " interactiveImageSampleDistance=\"" << this->InteractiveImageSampleDistance << "\"";
 }
 
 //----------------------------------------------------------------------------
@@ -78,6 +96,8 @@ void vtkMRMLCPURayCastVolumeRenderingDisplayNode::Copy(vtkMRMLNode *anode)
   vtkMRMLCPURayCastVolumeRenderingDisplayNode *node = vtkMRMLCPURayCastVolumeRenderingDisplayNode::SafeDownCast(anode);
 
   this->SetRaycastTechnique(node->GetRaycastTechnique());
+  this->SetNumberOfThreads(node->GetNumberOfThreads());
+  this->SetInteractiveImageSampleDistance(node->GetInteractiveImageSampleDistance());
 
   this->EndModify(wasModifying);
 }
@@ -88,4 +108,6 @@ void vtkMRMLCPURayCastVolumeRenderingDisplayNode::PrintSelf(ostream& os, vtkInde
   this->Superclass::PrintSelf(os,indent);
 
   os << "RaycastTechnique: " << this->RaycastTechnique << "\n";
+  os << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << "InteractiveImageSampleDistance: " << this->InteractiveImageSampleDistance << "\n";
 }
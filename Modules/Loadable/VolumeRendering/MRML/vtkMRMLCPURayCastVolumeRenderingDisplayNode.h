@@ -56,6 +56,19 @@ public:
   vtkGetMacro (RaycastTechnique, int);
   vtkSetMacro (RaycastTechnique, int);
 
+  // Description:
+  // Number of threads used to cast the rays.
+  // 0 (default) uses the number of processors of the machine.
+  vtkGetMacro (NumberOfThreads, int);
+  vtkSetClampMacro (NumberOfThreads, int, 0, VTK_INT_MAX);
+
+  // Description:
+  // Largest image sample distance (in pixels) used to keep the expected
+  // frame rate while the view or the volume property is interacted with.
+  // The full resolution (1 pixel) is used for still renders. 4 by default.
+  vtkGetMacro (InteractiveImageSampleDistance, double);
+  vtkSetClampMacro (InteractiveImageSampleDistance, double, 1., 16.);
+
 protected:
   vtkMRMLCPURayCastVolumeRenderingDisplayNode();
   ~vtkMRMLCPURayCastVolumeRenderingDisplayNode();
@@ -71,6 +84,9 @@ protected:
    * 5: Illustrative Context Preserving Exploration
    * */
   int RaycastTechnique;
+
+  int NumberOfThreads;
+  double InteractiveImageSampleDistance;
 };
 
 #endif
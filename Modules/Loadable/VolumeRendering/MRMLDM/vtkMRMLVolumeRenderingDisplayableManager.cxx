@@ -47,9 +47,11 @@
 #include "vtkFixedPointVolumeRayCastMapper.h"
 #include "vtkGPUVolumeRayCastMapper.h"
 #include "vtkImageData.h"
+#include <vtkImageShrink3D.h>
 #include "vtkInteractorStyle.h"
 #include "vtkLookupTable.h"
 #include "vtkMatrix4x4.h"
+#include <vtkMultiThreader.h>
 #include <vtkNew.h>
 #include "vtkObjectFactory.h"
 #include "vtkPlane.h"
@@ -62,11 +64,13 @@
 #include "vtkVolume.h"
 #include "vtkVolumeProperty.h"
 #include <vtkVersion.h>
+#include <vtkWeakPointer.h>
 
 // STD includes
 #include <cassert>
 #include <cmath>
 #include <algorithm> // for std::min
+#include <map>
 
 //---------------------------------------------------------------------------
 vtkStandardNewMacro (vtkMRMLVolumeRenderingDisplayableManager);
@@ -74,6 +78,49 @@ vtkStandardNewMacro (vtkMRMLVolumeRenderingDisplayableManager);
 //---------------------------------------------------------------------------
 bool vtkMRMLVolumeRenderingDisplayableManager::First = true;
 int vtkMRMLVolumeRenderingDisplayableManager::DefaultGPUMemorySize = 256;
+int vtkMRMLVolumeRenderingDisplayableManager::VolumeMemoryBudget = 1024;
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Objects shared by all the views that render a volume node. They are only
+// weakly referenced: they are owned by the views that use them.
+// Mappers are not shared: they keep the settings and the progress observers
+// of their view.
+struct SharedVolumeObjects
+{
+  vtkWeakPointer<vtkMRMLVolumeNode> VolumeNode;
+  vtkWeakPointer<vtkImageShrink3D> ProxyVolumeFilter;
+};
+
+//---------------------------------------------------------------------------
+SharedVolumeObjects& GetSharedVolumeObjects(vtkMRMLVolumeNode* volumeNode)
+{
+  typedef std::map<vtkMRMLVolumeNode*, SharedVolumeObjects> SharedVolumeObjectsType;
+  static SharedVolumeObjectsType sharedVolumeObjects;
+
+  // Forget about the objects that are not used anymore
+  for (SharedVolumeObjectsType::iterator it = sharedVolumeObjects.begin();
+       it != sharedVolumeObjects.end();)
+    {
+    if (it->second.VolumeNode.GetPointer() == NULL ||
+        it->second.ProxyVolumeFilter.GetPointer() == NULL)
+      {
+      sharedVolumeObjects.erase(it++);
+      }
+    else
+      {
+      ++it;
+      }
+    }
+
+  SharedVolumeObjects& sharedObjects = sharedVolumeObjects[volumeNode];
+  sharedObjects.VolumeNode = volumeNode;
+  return sharedObjects;
+}
+
+} // end of anonymous namespace
 
 //---------------------------------------------------------------------------
 vtkMRMLVolumeRenderingDisplayableManager::vtkMRMLVolumeRenderingDisplayableManager()
@@ -81,6 +128,7 @@ vtkMRMLVolumeRenderingDisplayableManager::vtkMRMLVolumeRenderingDisplayableManag
   this->MapperRaycast = NULL;
   this->MapperGPURaycast3 = NULL;
   this->Volume = NULL;
+  this->ProxyVolume = NULL;
   //this->Histograms = vtkKWHistogramSet::New();
   //this->HistogramsFg = vtkKWHistogramSet::New();
   //this->VolumePropertyGPURaycast3 = NULL;
@@ -101,6 +149,7 @@ vtkMRMLVolumeRenderingDisplayableManager::vtkMRMLVolumeRenderingDisplayableManag
   this->DisplayObservedEvents->InsertNextValue(vtkCommand::EndInteractionEvent);
 
   this->Interaction = 0;
+  this->ViewInteraction = false;
   // 0fps is a special value that means it hasn't been set.
   this->OriginalDesiredUpdateRate = 0.;
 
@@ -137,6 +186,7 @@ vtkMRMLVolumeRenderingDisplayableManager::~vtkMRMLVolumeRenderingDisplayableMana
   vtkSetMRMLNodeMacro(this->MapperRaycast, NULL);
   vtkSetMRMLNodeMacro(this->MapperGPURaycast3, NULL);
   vtkSetMRMLNodeMacro(this->Volume, NULL);
+  vtkSetMRMLNodeMacro(this->ProxyVolume, NULL);
   /**
   if(this->Histograms != NULL)
   {
@@ -174,15 +224,32 @@ int vtkMRMLVolumeRenderingDisplayableManager::ActiveInteractionModes()
 //---------------------------------------------------------------------------
 void vtkMRMLVolumeRenderingDisplayableManager::SetGUICallbackCommand(vtkCommand* callback)
 {
+  if (this->GUICallbackCommand)
+    {
+    this->MapperRaycast->RemoveObserver(this->GUICallbackCommand);
+    this->MapperGPURaycast3->RemoveObserver(this->GUICallbackCommand);
+    }
+  // Kept to observe the mappers created by Reset()
+  this->GUICallbackCommand = callback;
+  this->AddGUICallbackCommandObservers();
+
+  //this->GetMRMLNodesCallbackCommand() = callback;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::AddGUICallbackCommandObservers()
+{
+  if (!this->GUICallbackCommand)
+    {
+    return;
+    }
   //cpu ray casting
-  this->MapperRaycast->AddObserver(vtkCommand::VolumeMapperComputeGradientsProgressEvent, callback);
-  this->MapperRaycast->AddObserver(vtkCommand::ProgressEvent,callback);
+  this->MapperRaycast->AddObserver(vtkCommand::VolumeMapperComputeGradientsProgressEvent, this->GUICallbackCommand);
+  this->MapperRaycast->AddObserver(vtkCommand::ProgressEvent, this->GUICallbackCommand);
 
   //hook up the gpu mapper
 
-  this->MapperGPURaycast3->AddObserver(vtkCommand::VolumeMapperComputeGradientsProgressEvent, callback);
-
-  //this->GetMRMLNodesCallbackCommand() = callback;
+  this->MapperGPURaycast3->AddObserver(vtkCommand::VolumeMapperComputeGradientsProgressEvent, this->GUICallbackCommand);
 }
 
 //---------------------------------------------------------------------------
@@ -209,10 +276,19 @@ void vtkMRMLVolumeRenderingDisplayableManager::Reset()
                                       newMapperGPURaycast3.GetPointer(),
                                       mapperEvents.GetPointer());
 
+  // Progress of the new mappers
+  this->AddGUICallbackCommandObservers();
+
   // Volume
   vtkNew<vtkVolume> newVolume;
   vtkSetMRMLNodeMacro(this->Volume, newVolume.GetPointer());
 
+  // Proxy volume, rendered instead of Volume during interaction
+  vtkNew<vtkVolume> newProxyVolume;
+  newProxyVolume->SetVisibility(0);
+  vtkSetMRMLNodeMacro(this->ProxyVolume, newProxyVolume.GetPointer());
+  this->ProxyMapper = 0;
+
   /**
   if(this->Histograms != NULL)
   {
@@ -388,10 +464,33 @@ void vtkMRMLVolumeRenderingDisplayableManager
   this->UpdateMapper(mapper, vspNode);
   const bool highDef = vspNode->GetPerformanceControl() ==
     vtkMRMLVolumeRenderingDisplayNode::MaximumQuality;
-  mapper->SetAutoAdjustSampleDistances( highDef ? 0 : 1);
+  // Empty space skipping (min/max blocks computed once per input and
+  // transfer function) and early ray termination are done by the mapper
+  // itself, on as many threads as requested.
+  mapper->SetNumberOfThreads(vspNode->GetNumberOfThreads() > 0 ?
+    vspNode->GetNumberOfThreads() :
+    vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
   mapper->SetSampleDistance(this->GetSampleDistance(vspNode));
   mapper->SetInteractiveSampleDistance(this->GetSampleDistance(vspNode));
-  mapper->SetImageSampleDistance(highDef ? 0.5 : 1.);
+  const double interactiveImageSampleDistance =
+    highDef ? 1. : vspNode->GetInteractiveImageSampleDistance();
+  if (this->Interaction > 0)
+    {
+    // The display node is being interacted with (e.g. transfer function
+    // edition): the renders are not flagged as interactive by the render
+    // window, so the image sample distance is reduced explicitly.
+    mapper->SetAutoAdjustSampleDistances(0);
+    mapper->SetImageSampleDistance(interactiveImageSampleDistance);
+    }
+  else
+    {
+    // During camera interaction, the mapper increases the image sample
+    // distance up to the maximum to reach the desired update rate.
+    mapper->SetAutoAdjustSampleDistances( highDef ? 0 : 1);
+    mapper->SetImageSampleDistance(highDef ? 0.5 : 1.);
+    mapper->SetMinimumImageSampleDistance(highDef ? 0.5 : 1.);
+    mapper->SetMaximumImageSampleDistance(interactiveImageSampleDistance);
+    }
 
   switch(vspNode->GetRaycastTechnique())
     {
@@ -520,6 +619,106 @@ void vtkMRMLVolumeRenderingDisplayableManager
     }
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager
+::UpdateProxyVolume(vtkMRMLVolumeRenderingDisplayNode* vspNode)
+{
+  vtkMRMLVolumeNode* volumeNode = vspNode ? vspNode->GetVolumeNode() : 0;
+  vtkVolumeMapper* volumeMapper = this->Volume->GetMapper();
+  vtkImageData* imageData = volumeNode ? volumeNode->GetImageData() : 0;
+  int shrinkFactor = 1;
+  if (volumeMapper && imageData)
+    {
+    int dimensions[3] = {0, 0, 0};
+    imageData->GetDimensions(dimensions);
+    shrinkFactor = vtkMRMLVolumeRenderingDisplayableManager::GetProxyShrinkFactor(
+      dimensions, imageData->GetNumberOfScalarComponents() * imageData->GetScalarSize(),
+      vtkMRMLVolumeRenderingDisplayableManager::VolumeMemoryBudget);
+    }
+  if (shrinkFactor <= 1)
+    {
+    this->ProxyVolumeFilter = 0;
+    this->ProxyMapper = 0;
+    this->ProxyVolume->SetMapper(0);
+    this->UpdateProxyVisibility();
+    return;
+    }
+
+  // The volume does not fit in the budget: keep a proxy that is downsampled
+  // by the same integer factor along each axis. Voxels are averaged to avoid
+  // aliasing. The proxy is shared by all the views that render the volume.
+  SharedVolumeObjects& sharedObjects = GetSharedVolumeObjects(volumeNode);
+  this->ProxyVolumeFilter = sharedObjects.ProxyVolumeFilter.GetPointer();
+  if (!this->ProxyVolumeFilter)
+    {
+    this->ProxyVolumeFilter = vtkSmartPointer<vtkImageShrink3D>::New();
+    this->ProxyVolumeFilter->MeanOn();
+    sharedObjects.ProxyVolumeFilter = this->ProxyVolumeFilter.GetPointer();
+    }
+  this->ProxyVolumeFilter->SetInputConnection(volumeNode->GetImageDataConnection());
+  this->ProxyVolumeFilter->SetShrinkFactors(shrinkFactor, shrinkFactor, shrinkFactor);
+  // Compute the proxy now rather than when the interaction starts
+  this->ProxyVolumeFilter->Update();
+  vtkDebugMacro("Volume exceeds the memory budget of "
+                << vtkMRMLVolumeRenderingDisplayableManager::VolumeMemoryBudget
+                << "MB, render it downsampled by " << shrinkFactor
+                << " during interaction");
+
+  // The proxy has its own mapper, of the same type as the full resolution
+  // one, so that the inputs of the mappers never change during interaction
+  // (which would recompute the gradients or upload the textures again).
+  if (!this->ProxyMapper || !this->ProxyMapper->IsA(volumeMapper->GetClassName()))
+    {
+    this->ProxyMapper.TakeReference(volumeMapper->NewInstance());
+    }
+  this->ProxyMapper->SetInputConnection(this->ProxyVolumeFilter->GetOutputPort());
+  this->UpdateMapperFromDisplayNode(this->ProxyMapper, vspNode);
+
+  vtkNew<vtkMatrix4x4> matrix;
+  this->CalculateMatrix(vspNode, matrix.GetPointer());
+  this->ProxyVolume->SetMapper(this->ProxyMapper);
+  this->ProxyVolume->SetProperty(this->Volume->GetProperty());
+  this->ProxyVolume->PokeMatrix(matrix.GetPointer());
+  this->UpdateProxyVisibility();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::UpdateProxyVisibility()
+{
+  const bool useProxy = this->ProxyVolume->GetMapper() != 0 &&
+    (this->Interaction > 0 || this->ViewInteraction);
+  this->Volume->SetVisibility(!useProxy);
+  this->ProxyVolume->SetVisibility(useProxy);
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLVolumeRenderingDisplayableManager
+::GetProxyShrinkFactor(const int dimensions[3], int bytesPerVoxel, int budgetInMB)
+{
+  if (budgetInMB <= 0)
+    {
+    return 1;
+    }
+  const double budgetInBytes = budgetInMB * 1024. * 1024.;
+  // Smallest factor for which the shrunk image fits. The last voxels along an
+  // axis are dropped if the dimension is not a multiple of the factor.
+  int shrinkFactor = 1;
+  int maximumDimension = std::max(dimensions[0], std::max(dimensions[1], dimensions[2]));
+  for (; shrinkFactor < maximumDimension; ++shrinkFactor)
+    {
+    double shrunkSizeInBytes = bytesPerVoxel;
+    for (int i = 0; i < 3; ++i)
+      {
+      shrunkSizeInBytes *= std::max(dimensions[i] / shrinkFactor, 1);
+      }
+    if (shrunkSizeInBytes <= budgetInBytes)
+      {
+      break;
+      }
+    }
+  return shrinkFactor;
+}
+
 /*
  * return values:
  * -1: requested mapper not supported
@@ -554,6 +753,8 @@ int vtkMRMLVolumeRenderingDisplayableManager
   this->CalculateMatrix(vspNode, matrix.GetPointer());
   this->Volume->PokeMatrix(matrix.GetPointer());
 
+  this->UpdateProxyVolume(vspNode);
+
   this->UpdateDesiredUpdateRate(vspNode);
 
   return (volumeMapper != 0 ? 1 : -1);
@@ -563,7 +764,13 @@ int vtkMRMLVolumeRenderingDisplayableManager
 bool vtkMRMLVolumeRenderingDisplayableManager::UpdateMapper(
   vtkMRMLVolumeRenderingDisplayNode* vspNode)
 {
-  vtkVolumeMapper* volumeMapper = this->GetVolumeMapper(vspNode);
+  return this->UpdateMapperFromDisplayNode(this->GetVolumeMapper(vspNode), vspNode);
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLVolumeRenderingDisplayableManager::UpdateMapperFromDisplayNode(
+  vtkVolumeMapper* volumeMapper, vtkMRMLVolumeRenderingDisplayNode* vspNode)
+{
   if (vspNode->IsA("vtkMRMLCPURayCastVolumeRenderingDisplayNode"))
     {
     this->UpdateCPURaycastMapper(vtkFixedPointVolumeRayCastMapper::SafeDownCast(volumeMapper),
@@ -654,6 +861,7 @@ void vtkMRMLVolumeRenderingDisplayableManager::TransformModified(vtkMRMLVolumeRe
   vtkNew<vtkMatrix4x4> matrix;
   this->CalculateMatrix(vspNode, matrix.GetPointer());
   this->Volume->PokeMatrix(matrix.GetPointer());
+  this->ProxyVolume->PokeMatrix(matrix.GetPointer());
 
   this->VolumeRenderingLogic->FitROIToVolume(vspNode);
 }
@@ -856,6 +1064,7 @@ void vtkMRMLVolumeRenderingDisplayableManager
         GetFirstVolumeRenderingDisplayNodeByROINode(roiNode);
 
       this->UpdateClipping(this->GetVolumeMapper(vspNode), vspNode);
+      this->UpdateClipping(this->ProxyMapper, vspNode);
       this->RequestRender();
       }
     else if(vtkMRMLVolumeNode::SafeDownCast(caller))
@@ -882,6 +1091,7 @@ void vtkMRMLVolumeRenderingDisplayableManager
     // so we just start the mode for the first time.
     if (this->Interaction == 1)
       {
+      this->UpdateProxyVisibility();
       vtkInteractorStyle* interactorStyle = vtkInteractorStyle::SafeDownCast(
         this->GetInteractor()->GetInteractorStyle());
       if (interactorStyle->GetState() == VTKIS_NONE)
@@ -896,6 +1106,7 @@ void vtkMRMLVolumeRenderingDisplayableManager
     --this->Interaction;
     if (this->Interaction == 0)
       {
+      this->UpdateProxyVisibility();
       vtkInteractorStyle* interactorStyle = vtkInteractorStyle::SafeDownCast(
         this->GetInteractor()->GetInteractorStyle());
       if (interactorStyle->GetState() == VTKIS_VOLUME_PROPS)
@@ -920,6 +1131,7 @@ void vtkMRMLVolumeRenderingDisplayableManager
   else if (event == vtkMRMLScalarVolumeNode::ImageDataModifiedEvent)
     {
     this->SetupMapperFromVolumeNode(this->DisplayedNode);
+    this->UpdateProxyVolume(this->DisplayedNode);
     this->RequestRender();
     }
   else if (event == vtkMRMLTransformableNode::TransformModifiedEvent)
@@ -1006,10 +1218,13 @@ void vtkMRMLVolumeRenderingDisplayableManager::OnInteractorStyleEvent(int eventi
     {
     case vtkCommand::EndInteractionEvent:
       //this->SetExpectedFPS(0.0001);
-      this->SetupMapperFromParametersNode(this->DisplayedNode);
+      // The view is still: render the full resolution volume
+      this->ViewInteraction = false;
+      this->UpdateProxyVisibility();
       break;
     case vtkCommand::StartInteractionEvent:
-      this->SetupMapperFromParametersNode(this->DisplayedNode);
+      this->ViewInteraction = true;
+      this->UpdateProxyVisibility();
       //this->SetExpectedFPS(
       //  this->DisplayedNode ? this->DisplayedNode->GetExpectedFPS() : 15);
       break;
@@ -1066,6 +1281,7 @@ bool vtkMRMLVolumeRenderingDisplayableManager::AddVolumeToView()
 
   // Only support 1 volume per view, remove any existing volume
   bool needToAddVolume = true;
+  bool needToAddProxyVolume = true;
   vtkNew<vtkVolumeCollection> volumesToRemoveFromRenderer;
 
   vtkVolume *v = NULL;
@@ -1084,6 +1300,10 @@ bool vtkMRMLVolumeRenderingDisplayableManager::AddVolumeToView()
         {
         needToAddVolume = false;
         }
+      else if (v == this->ProxyVolume)
+        {
+        needToAddProxyVolume = false;
+        }
       else
         {
         volumesToRemoveFromRenderer->AddItem(v);
@@ -1105,6 +1325,12 @@ bool vtkMRMLVolumeRenderingDisplayableManager::AddVolumeToView()
     this->GetRenderer()->AddVolume(this->GetVolumeActor());
     modified = true;
     }
+  // and its proxy, only visible during interaction
+  if (needToAddProxyVolume)
+    {
+    this->GetRenderer()->AddVolume(this->ProxyVolume);
+    modified = true;
+    }
 
   return modified;
 }
@@ -1113,6 +1339,7 @@ bool vtkMRMLVolumeRenderingDisplayableManager::AddVolumeToView()
 void vtkMRMLVolumeRenderingDisplayableManager::RemoveVolumeFromView()
 {
   this->RemoveVolumeFromView(this->GetVolumeActor());
+  this->RemoveVolumeFromView(this->ProxyVolume);
 }
 
 //----------------------------------------------------------------------------
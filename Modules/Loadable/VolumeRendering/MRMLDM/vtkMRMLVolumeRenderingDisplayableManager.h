@@ -37,6 +37,9 @@ class vtkVolumeProperty;
 #include <vtkMRMLAbstractThreeDViewDisplayableManager.h>
 
 // VTK includes
+#include <vtkSmartPointer.h>
+class vtkAlgorithmOutput;
+class vtkImageShrink3D;
 class vtkIntArray;
 class vtkMatrix4x4;
 class vtkPlanes;
@@ -58,6 +61,7 @@ public:
 
   virtual void Reset();
 
+  /// Observe the progress of the mappers, including the ones created by Reset()
   void SetGUICallbackCommand(vtkCommand* callback);
 
   virtual void Create() VTK_OVERRIDE;
@@ -70,6 +74,21 @@ public:
   /// Configure mapper with volume nodes
   void SetupMapperFromVolumeNode(vtkMRMLVolumeRenderingDisplayNode* vspNode);
 
+  ///
+  /// Configure the proxy volume rendered instead of the volume actor during
+  /// interaction: if the image of the volume node does not fit in
+  /// \a VolumeMemoryBudget, the proxy renders it downsampled by an integer
+  /// factor (averaging the voxels) with a mapper of its own.
+  /// The proxy is computed when the volume is set up.
+  void UpdateProxyVolume(vtkMRMLVolumeRenderingDisplayNode* vspNode);
+
+  ///
+  /// Return the smallest factor by which an image of the given dimensions and
+  /// voxel size must be shrunk along each axis to fit in \a budgetInMB.
+  /// Return 1 if the image fits or if the budget is 0 (no limit).
+  static int GetProxyShrinkFactor(const int dimensions[3], int bytesPerVoxel,
+                                  int budgetInMB);
+
   ///
   /// Configure mapper with volume node
   void SetupMapperFromVolumeNode(vtkMRMLVolumeNode* volumeNode,
@@ -88,10 +107,18 @@ public:
   // Get Volume Actor
   vtkVolume* GetVolumeActor(){return this->Volume;}
 
+  // Description:
+  // Get the actor of the downsampled proxy, visible during interaction
+  vtkVolume* GetProxyVolumeActor(){return this->ProxyVolume;}
+
   void SetupHistograms(vtkMRMLVolumeRenderingDisplayNode* vspNode);
   //vtkKWHistogramSet* GetHistogramSet(){return this->Histograms;}
 
   virtual bool UpdateMapper(vtkMRMLVolumeRenderingDisplayNode* vspNode);
+  /// Configure \a mapper from the display node, return false if the type of
+  /// the display node is not supported
+  bool UpdateMapperFromDisplayNode(vtkVolumeMapper* mapper,
+                                   vtkMRMLVolumeRenderingDisplayNode* vspNode);
 
   void UpdateMapper(vtkVolumeMapper* mapper,
                     vtkMRMLVolumeRenderingDisplayNode* vspNode);
@@ -108,6 +135,8 @@ public:
   void TransformModified(vtkMRMLVolumeRenderingDisplayNode* vspNode);
 
   void SetVolumeVisibility(int isVisible);
+  /// Show the proxy volume instead of the volume actor during interaction
+  void UpdateProxyVisibility();
 
   //void SetupVolumeRenderingInteractive(vtkMRMLVolumeRenderingDisplayNode* vspNode, int buttonDown);
 
@@ -133,6 +162,11 @@ public:
   void RemoveDisplayNodes();
 
   static int DefaultGPUMemorySize;
+  /// Maximum size (in MB) of the images given to the mappers during
+  /// interaction. Larger volumes are rendered from a downsampled proxy while
+  /// the camera or the display node is interacted with, and at full
+  /// resolution when the view is still. 0 means no limit, 1024 by default.
+  static int VolumeMemoryBudget;
 
 protected:
   vtkMRMLVolumeRenderingDisplayableManager();
@@ -160,12 +194,16 @@ protected:
 
   void OnCreate();
 
+  void AddGUICallbackCommandObservers();
+
   static bool First;
 
   vtkSlicerVolumeRenderingLogic *VolumeRenderingLogic;
 
   // Description:
-  // The software accelerated software mapper
+  // The software accelerated software mapper.
+  // Each view has its own mapper: the gradients and the min/max structure
+  // it computes from the image are not shared with the other views.
   vtkFixedPointVolumeRayCastMapper *MapperRaycast;
 
   // Description:
@@ -176,6 +214,20 @@ protected:
   // Actor used for Volume Rendering
   vtkVolume *Volume;
 
+  // Description:
+  // Observer of the mapper progress, set by SetGUICallbackCommand()
+  vtkSmartPointer<vtkCommand> GUICallbackCommand;
+
+  // Description:
+  // Downsampled proxy of the displayed volume, if it exceeds the memory budget
+  vtkSmartPointer<vtkImageShrink3D> ProxyVolumeFilter;
+
+  // Description:
+  // Actor and mapper rendering the proxy during interaction. The full
+  // resolution mappers keep their input, the actors are swapped by visibility.
+  vtkVolume *ProxyVolume;
+  vtkSmartPointer<vtkVolumeMapper> ProxyMapper;
+
   // Description:
   // internal histogram instance (bg)
   //vtkKWHistogramSet *Histograms;
@@ -197,6 +249,8 @@ protected:
   vtkIntArray* DisplayObservedEvents;
   // When interaction is >0, we are in interactive mode (low LOD)
   int Interaction;
+  /// Set while the interactor style interacts with the view (e.g. rotation)
+  bool ViewInteraction;
   double OriginalDesiredUpdateRate;
 
 protected:
@@ -0,0 +1,183 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VolumeRendering includes
+#include <vtkMRMLCPURayCastVolumeRenderingDisplayNode.h>
+#include <vtkMRMLVolumeRenderingDisplayableManager.h>
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLDisplayableManagerGroup.h>
+
+// MRMLLogic includes
+#include <vtkMRMLApplicationLogic.h>
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLViewNode.h>
+#include <vtkMRMLVolumePropertyNode.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkInteractorObserver.h>
+#include <vtkNew.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkVolume.h>
+#include <vtkVolumeMapper.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+int TestProxyShrinkFactor()
+{
+  // Volumes of more than 1GB are rendered downsampled by default
+  CHECK_INT(vtkMRMLVolumeRenderingDisplayableManager::VolumeMemoryBudget, 1024);
+
+  // 256MB
+  int dimensions[3] = {512, 512, 512};
+  CHECK_INT(vtkMRMLVolumeRenderingDisplayableManager::GetProxyShrinkFactor(dimensions, 2, 0), 1);
+  CHECK_INT(vtkMRMLVolumeRenderingDisplayableManager::GetProxyShrinkFactor(dimensions, 2, 256), 1);
+  CHECK_INT(vtkMRMLVolumeRenderingDisplayableManager::GetProxyShrinkFactor(dimensions, 2, 255), 2);
+  CHECK_INT(vtkMRMLVolumeRenderingDisplayableManager::GetProxyShrinkFactor(dimensions, 2, 32), 2);
+  CHECK_INT(vtkMRMLVolumeRenderingDisplayableManager::GetProxyShrinkFactor(dimensions, 2, 31), 3);
+  // Voxel size
+  CHECK_INT(vtkMRMLVolumeRenderingDisplayableManager::GetProxyShrinkFactor(dimensions, 8, 256), 2);
+
+  // Flat image: the single slice is not shrunk further
+  int sliceDimensions[3] = {1000, 1000, 1};
+  CHECK_INT(vtkMRMLVolumeRenderingDisplayableManager::GetProxyShrinkFactor(sliceDimensions, 4, 4), 1);
+  CHECK_INT(vtkMRMLVolumeRenderingDisplayableManager::GetProxyShrinkFactor(sliceDimensions, 4, 1), 2);
+
+  // Small image
+  int smallDimensions[3] = {10, 20, 5};
+  CHECK_INT(vtkMRMLVolumeRenderingDisplayableManager::GetProxyShrinkFactor(smallDimensions, 1, 1), 1);
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int GetMapperInputDimension(vtkVolumeMapper* mapper)
+{
+  mapper->GetInputAlgorithm()->Update();
+  int dimensions[3] = {0, 0, 0};
+  mapper->GetInput()->GetDimensions(dimensions);
+  return dimensions[0];
+}
+
+//----------------------------------------------------------------------------
+int TestProxyDuringInteraction()
+{
+  vtkNew<vtkRenderer> renderer;
+  vtkNew<vtkRenderWindow> renderWindow;
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindow->AddRenderer(renderer.GetPointer());
+  renderWindow->SetInteractor(renderWindowInteractor.GetPointer());
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLApplicationLogic> applicationLogic;
+  applicationLogic->SetMRMLScene(scene.GetPointer());
+
+  vtkNew<vtkMRMLViewNode> viewNode;
+  scene->AddNode(viewNode.GetPointer());
+  vtkNew<vtkMRMLDisplayableManagerGroup> displayableManagerGroup;
+  displayableManagerGroup->SetRenderer(renderer.GetPointer());
+  displayableManagerGroup->SetMRMLDisplayableNode(viewNode.GetPointer());
+  vtkNew<vtkMRMLVolumeRenderingDisplayableManager> vrDisplayableManager;
+  vrDisplayableManager->SetMRMLApplicationLogic(applicationLogic.GetPointer());
+  displayableManagerGroup->AddDisplayableManager(vrDisplayableManager.GetPointer());
+  displayableManagerGroup->GetInteractor()->Initialize();
+
+  // 2MB volume with a 1MB budget
+  vtkMRMLVolumeRenderingDisplayableManager::VolumeMemoryBudget = 1;
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(128, 128, 128);
+  imageData->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetAndObserveImageData(imageData.GetPointer());
+  scene->AddNode(volumeNode.GetPointer());
+
+  vtkNew<vtkMRMLVolumePropertyNode> volumePropertyNode;
+  scene->AddNode(volumePropertyNode.GetPointer());
+  vtkNew<vtkMRMLCPURayCastVolumeRenderingDisplayNode> vrDisplayNode;
+  vrDisplayNode->SetAndObserveVolumeNodeID(volumeNode->GetID());
+  vrDisplayNode->SetAndObserveVolumePropertyNodeID(volumePropertyNode->GetID());
+  scene->AddNode(vrDisplayNode.GetPointer());
+
+  vtkVolumeMapper* mapper = vrDisplayableManager->GetVolumeMapper(vrDisplayNode.GetPointer());
+  CHECK_NOT_NULL(mapper);
+
+  vtkVolume* volume = vrDisplayableManager->GetVolumeActor();
+  vtkVolume* proxyVolume = vrDisplayableManager->GetProxyVolumeActor();
+  CHECK_POINTER(vtkVolumeMapper::SafeDownCast(volume->GetMapper()), mapper);
+  CHECK_BOOL(renderer->HasViewProp(volume), true);
+  CHECK_BOOL(renderer->HasViewProp(proxyVolume), true);
+
+  // The proxy is rendered by a mapper of its own, of the same type
+  vtkVolumeMapper* proxyMapper = vtkVolumeMapper::SafeDownCast(proxyVolume->GetMapper());
+  CHECK_NOT_NULL(proxyMapper);
+  CHECK_POINTER_DIFFERENT(proxyMapper, mapper);
+  CHECK_STRING(proxyMapper->GetClassName(), mapper->GetClassName());
+  CHECK_INT(GetMapperInputDimension(mapper), 128);
+  CHECK_INT(GetMapperInputDimension(proxyMapper), 64);
+
+  // Full resolution when the view is still, downsampled during interaction.
+  // The inputs of the mappers don't change, only the visible actor does.
+  vtkInteractorObserver* interactorStyle = renderWindowInteractor->GetInteractorStyle();
+  CHECK_INT(volume->GetVisibility(), 1);
+  CHECK_INT(proxyVolume->GetVisibility(), 0);
+  vtkDataObject* input = mapper->GetInputDataObject(0, 0);
+  vtkDataObject* proxyInput = proxyMapper->GetInputDataObject(0, 0);
+  interactorStyle->InvokeEvent(vtkCommand::StartInteractionEvent);
+  CHECK_INT(volume->GetVisibility(), 0);
+  CHECK_INT(proxyVolume->GetVisibility(), 1);
+  CHECK_POINTER(vtkVolumeMapper::SafeDownCast(volume->GetMapper()), mapper);
+  CHECK_POINTER(mapper->GetInputDataObject(0, 0), input);
+  CHECK_POINTER(proxyMapper->GetInputDataObject(0, 0), proxyInput);
+  interactorStyle->InvokeEvent(vtkCommand::EndInteractionEvent);
+  CHECK_INT(volume->GetVisibility(), 1);
+  CHECK_INT(proxyVolume->GetVisibility(), 0);
+  CHECK_POINTER(mapper->GetInputDataObject(0, 0), input);
+
+  // No proxy without budget
+  vtkMRMLVolumeRenderingDisplayableManager::VolumeMemoryBudget = 0;
+  vrDisplayableManager->SetupMapperFromParametersNode(vrDisplayNode.GetPointer());
+  CHECK_NULL(proxyVolume->GetMapper());
+  interactorStyle->InvokeEvent(vtkCommand::StartInteractionEvent);
+  CHECK_INT(volume->GetVisibility(), 1);
+  CHECK_INT(proxyVolume->GetVisibility(), 0);
+  CHECK_INT(GetMapperInputDimension(mapper), 128);
+  interactorStyle->InvokeEvent(vtkCommand::EndInteractionEvent);
+
+  vrDisplayableManager->SetMRMLApplicationLogic(0);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeRenderingMemoryBudgetTest(int vtkNotUsed(argc),
+                                           char* vtkNotUsed(argv)[])
+{
+  CHECK_EXIT_SUCCESS(TestProxyShrinkFactor());
+  int result = TestProxyDuringInteraction();
+  vtkMRMLVolumeRenderingDisplayableManager::VolumeMemoryBudget = 1024;
+  CHECK_EXIT_SUCCESS(result);
+  return EXIT_SUCCESS;
+}
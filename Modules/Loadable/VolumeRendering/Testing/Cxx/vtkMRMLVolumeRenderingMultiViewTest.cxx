@@ -0,0 +1,204 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VolumeRendering includes
+#include <vtkMRMLCPURayCastVolumeRenderingDisplayNode.h>
+#include <vtkMRMLVolumeRenderingDisplayableManager.h>
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLDisplayableManagerGroup.h>
+
+// MRMLLogic includes
+#include <vtkMRMLApplicationLogic.h>
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLViewNode.h>
+#include <vtkMRMLVolumePropertyNode.h>
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkColorTransferFunction.h>
+#include <vtkFixedPointVolumeRayCastMapper.h>
+#include <vtkImageData.h>
+#include <vtkImageDifference.h>
+#include <vtkNew.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkVolumeProperty.h>
+#include <vtkWindowToImageFilter.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct View
+{
+  vtkNew<vtkRenderer> Renderer;
+  vtkNew<vtkRenderWindow> RenderWindow;
+  vtkNew<vtkMRMLViewNode> ViewNode;
+  vtkNew<vtkMRMLDisplayableManagerGroup> DisplayableManagerGroup;
+  vtkNew<vtkMRMLVolumeRenderingDisplayableManager> DisplayableManager;
+};
+
+//----------------------------------------------------------------------------
+void SetupView(View& view, vtkMRMLScene* scene, vtkMRMLApplicationLogic* applicationLogic)
+{
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  view.RenderWindow->SetSize(200, 200);
+  view.RenderWindow->SetMultiSamples(0);
+  view.RenderWindow->AddRenderer(view.Renderer.GetPointer());
+  view.RenderWindow->SetInteractor(renderWindowInteractor.GetPointer());
+
+  scene->AddNode(view.ViewNode.GetPointer());
+  view.DisplayableManagerGroup->SetRenderer(view.Renderer.GetPointer());
+  view.DisplayableManagerGroup->SetMRMLDisplayableNode(view.ViewNode.GetPointer());
+  view.DisplayableManager->SetMRMLApplicationLogic(applicationLogic);
+  view.DisplayableManagerGroup->AddDisplayableManager(view.DisplayableManager.GetPointer());
+  view.DisplayableManagerGroup->GetInteractor()->Initialize();
+}
+
+//----------------------------------------------------------------------------
+void AddDisplayNode(vtkMRMLScene* scene, vtkMRMLScalarVolumeNode* volumeNode,
+                    vtkMRMLViewNode* viewNode, double red, double green,
+                    vtkMRMLCPURayCastVolumeRenderingDisplayNode* displayNode)
+{
+  vtkNew<vtkMRMLVolumePropertyNode> volumePropertyNode;
+  vtkNew<vtkPiecewiseFunction> opacity;
+  opacity->AddPoint(0., 0.);
+  opacity->AddPoint(255., 1.);
+  volumePropertyNode->SetScalarOpacity(opacity.GetPointer());
+  vtkNew<vtkColorTransferFunction> color;
+  color->AddRGBPoint(0., red, green, 0.);
+  color->AddRGBPoint(255., red, green, 0.);
+  volumePropertyNode->SetColor(color.GetPointer());
+  // Gradients are needed for shading
+  volumePropertyNode->GetVolumeProperty()->ShadeOn();
+  scene->AddNode(volumePropertyNode.GetPointer());
+
+  displayNode->SetAndObserveVolumeNodeID(volumeNode->GetID());
+  displayNode->SetAndObserveVolumePropertyNodeID(volumePropertyNode->GetID());
+  displayNode->AddViewNodeID(viewNode->GetID());
+  scene->AddNode(displayNode);
+}
+
+//----------------------------------------------------------------------------
+void Render(View& view, vtkImageData* screenShot)
+{
+  view.RenderWindow->Render();
+  vtkNew<vtkWindowToImageFilter> windowToImageFilter;
+  windowToImageFilter->SetInput(view.RenderWindow.GetPointer());
+  windowToImageFilter->Update();
+  screenShot->DeepCopy(windowToImageFilter->GetOutput());
+}
+
+//----------------------------------------------------------------------------
+double ImageDifference(vtkImageData* image1, vtkImageData* image2)
+{
+  vtkNew<vtkImageDifference> difference;
+  difference->SetInputData(image1);
+  difference->SetImageData(image2);
+  difference->Update();
+  return difference->GetThresholdedError();
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+// Render a volume in two views with different settings, and check that each
+// view keeps its own mapper, settings and progress observers.
+int vtkMRMLVolumeRenderingMultiViewTest(int vtkNotUsed(argc),
+                                        char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLApplicationLogic> applicationLogic;
+  applicationLogic->SetMRMLScene(scene.GetPointer());
+
+  View view1;
+  SetupView(view1, scene.GetPointer(), applicationLogic.GetPointer());
+  View view2;
+  SetupView(view2, scene.GetPointer(), applicationLogic.GetPointer());
+
+  vtkNew<vtkCallbackCommand> progressCallback1;
+  view1.DisplayableManager->SetGUICallbackCommand(progressCallback1.GetPointer());
+  vtkNew<vtkCallbackCommand> progressCallback2;
+  view2.DisplayableManager->SetGUICallbackCommand(progressCallback2.GetPointer());
+
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(10, 10, 10);
+  imageData->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* ptr = static_cast<unsigned char*>(imageData->GetScalarPointer());
+  for (int i = 0; i < 10 * 10 * 10; ++i)
+    {
+    *(ptr++) = static_cast<unsigned char>((i * 7) % 256);
+    }
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetAndObserveImageData(imageData.GetPointer());
+  scene->AddNode(volumeNode.GetPointer());
+
+  // Same volume, rendered red in the first view and green in the second one
+  vtkNew<vtkMRMLCPURayCastVolumeRenderingDisplayNode> displayNode1;
+  AddDisplayNode(scene.GetPointer(), volumeNode.GetPointer(), view1.ViewNode.GetPointer(),
+                 1., 0., displayNode1.GetPointer());
+  vtkNew<vtkMRMLCPURayCastVolumeRenderingDisplayNode> displayNode2;
+  AddDisplayNode(scene.GetPointer(), volumeNode.GetPointer(), view2.ViewNode.GetPointer(),
+                 0., 1., displayNode2.GetPointer());
+  view1.Renderer->ResetCamera();
+  view2.Renderer->ResetCamera();
+
+  vtkFixedPointVolumeRayCastMapper* mapper1 = vtkFixedPointVolumeRayCastMapper::SafeDownCast(
+    view1.DisplayableManager->GetVolumeMapper(displayNode1.GetPointer()));
+  vtkFixedPointVolumeRayCastMapper* mapper2 = vtkFixedPointVolumeRayCastMapper::SafeDownCast(
+    view2.DisplayableManager->GetVolumeMapper(displayNode2.GetPointer()));
+  CHECK_NOT_NULL(mapper1);
+  CHECK_NOT_NULL(mapper2);
+  CHECK_BOOL(mapper1 != mapper2, true);
+  CHECK_BOOL(mapper1->HasObserver(vtkCommand::VolumeMapperComputeGradientsProgressEvent,
+                                  progressCallback1.GetPointer()) != 0, true);
+  CHECK_BOOL(mapper1->HasObserver(vtkCommand::VolumeMapperComputeGradientsProgressEvent,
+                                  progressCallback2.GetPointer()) != 0, false);
+  CHECK_BOOL(mapper2->HasObserver(vtkCommand::VolumeMapperComputeGradientsProgressEvent,
+                                  progressCallback2.GetPointer()) != 0, true);
+
+  // Rendering the second view does not change the rendering of the first one
+  vtkNew<vtkImageData> screenShot1;
+  Render(view1, screenShot1.GetPointer());
+  vtkNew<vtkImageData> screenShot2;
+  Render(view2, screenShot2.GetPointer());
+  vtkNew<vtkImageData> screenShot1Again;
+  Render(view1, screenShot1Again.GetPointer());
+  CHECK_BOOL(ImageDifference(screenShot1.GetPointer(), screenShot2.GetPointer()) > 0., true);
+  CHECK_DOUBLE_TOLERANCE(ImageDifference(screenShot1.GetPointer(), screenShot1Again.GetPointer()), 0., 1e-6);
+
+  // The mappers created when resetting the view are observed too
+  view1.DisplayableManager->Reset();
+  mapper1 = vtkFixedPointVolumeRayCastMapper::SafeDownCast(
+    view1.DisplayableManager->GetVolumeMapper(displayNode1.GetPointer()));
+  CHECK_NOT_NULL(mapper1);
+  CHECK_BOOL(mapper1->HasObserver(vtkCommand::VolumeMapperComputeGradientsProgressEvent,
+                                  progressCallback1.GetPointer()) != 0, true);
+  CHECK_BOOL(mapper1->HasObserver(vtkCommand::ProgressEvent,
+                                  progressCallback1.GetPointer()) != 0, true);
+
+  view1.DisplayableManager->SetMRMLApplicationLogic(0);
+  view2.DisplayableManager->SetMRMLApplicationLogic(0);
+  return EXIT_SUCCESS;
+}
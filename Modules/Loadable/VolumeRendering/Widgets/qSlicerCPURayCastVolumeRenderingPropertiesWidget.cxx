@@ -63,6 +63,10 @@ void qSlicerCPURayCastVolumeRenderingPropertiesWidgetPrivate
   this->populateRenderingTechniqueComboBox();
   QObject::connect(this->RenderingTechniqueComboBox, SIGNAL(currentIndexChanged(int)),
                    widget, SLOT(setRenderingTechnique(int)));
+  QObject::connect(this->NumberOfThreadsSpinBox, SIGNAL(valueChanged(int)),
+                   widget, SLOT(setNumberOfThreads(int)));
+  QObject::connect(this->InteractiveImageSampleDistanceSpinBox, SIGNAL(valueChanged(double)),
+                   widget, SLOT(setInteractiveImageSampleDistance(double)));
 }
 
 // --------------------------------------------------------------------------
@@ -123,6 +127,11 @@ void qSlicerCPURayCastVolumeRenderingPropertiesWidget
     index = 0;
     }
   d->RenderingTechniqueComboBox->setCurrentIndex(index);
+
+  d->NumberOfThreadsSpinBox->setValue(
+    this->mrmlCPURayCastDisplayNode()->GetNumberOfThreads());
+  d->InteractiveImageSampleDistanceSpinBox->setValue(
+    this->mrmlCPURayCastDisplayNode()->GetInteractiveImageSampleDistance());
 }
 
 //-----------------------------------------------------------------------------
@@ -137,3 +146,25 @@ void qSlicerCPURayCastVolumeRenderingPropertiesWidget
   int technique = d->RenderingTechniqueComboBox->itemData(index).toInt();
   this->mrmlCPURayCastDisplayNode()->SetRaycastTechnique(technique);
 }
+
+//-----------------------------------------------------------------------------
+void qSlicerCPURayCastVolumeRenderingPropertiesWidget
+::setNumberOfThreads(int numberOfThreads)
+{
+  if (!this->mrmlCPURayCastDisplayNode())
+    {
+    return;
+    }
+  this->mrmlCPURayCastDisplayNode()->SetNumberOfThreads(numberOfThreads);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCPURayCastVolumeRenderingPropertiesWidget
+::setInteractiveImageSampleDistance(double distance)
+{
+  if (!this->mrmlCPURayCastDisplayNode())
+    {
+    return;
+    }
+  this->mrmlCPURayCastDisplayNode()->SetInteractiveImageSampleDistance(distance);
+}
@@ -40,6 +40,8 @@ public:
 
 public slots:
   void setRenderingTechnique(int index);
+  void setNumberOfThreads(int numberOfThreads);
+  void setInteractiveImageSampleDistance(double distance);
 
 protected slots:
   virtual void updateWidgetFromMRML();
@@ -105,6 +105,12 @@ void qSlicerVolumeRenderingSettingsPanelPrivate::init()
 
   q->registerProperty("VolumeRendering/GPUMemorySize", q, "gpuMemory",
                       SIGNAL(gpuMemoryChanged(int)));
+
+  QObject::connect(this->VolumeMemoryBudgetSpinBox, SIGNAL(valueChanged(int)),
+                   q, SLOT(onVolumeMemoryBudgetChanged()));
+  q->setVolumeMemoryBudget(vtkMRMLVolumeRenderingDisplayableManager::VolumeMemoryBudget);
+  q->registerProperty("VolumeRendering/VolumeMemoryBudget", q, "volumeMemoryBudget",
+                      SIGNAL(volumeMemoryBudgetChanged(int)));
 }
 
 // --------------------------------------------------------------------------
@@ -260,6 +266,30 @@ void qSlicerVolumeRenderingSettingsPanel::onGPUMemoryChanged()
   //  = vtkMRMLThreeDViewDisplayableManagerFactory::GetInstance();
 }
 
+// --------------------------------------------------------------------------
+int qSlicerVolumeRenderingSettingsPanel::volumeMemoryBudget()const
+{
+  Q_D(const qSlicerVolumeRenderingSettingsPanel);
+  return d->VolumeMemoryBudgetSpinBox->value();
+}
+
+// --------------------------------------------------------------------------
+void qSlicerVolumeRenderingSettingsPanel::setVolumeMemoryBudget(int budget)
+{
+  Q_D(qSlicerVolumeRenderingSettingsPanel);
+  d->VolumeMemoryBudgetSpinBox->setValue(budget);
+}
+
+// --------------------------------------------------------------------------
+void qSlicerVolumeRenderingSettingsPanel::onVolumeMemoryBudgetChanged()
+{
+  // Taken into account the next time the views update their mapper input
+  vtkMRMLVolumeRenderingDisplayableManager::VolumeMemoryBudget =
+    this->volumeMemoryBudget();
+
+  emit volumeMemoryBudgetChanged(this->volumeMemoryBudget());
+}
+
 // --------------------------------------------------------------------------
 QString qSlicerVolumeRenderingSettingsPanel
 ::defaultRenderingMethod()const
@@ -36,6 +36,7 @@ class Q_SLICER_QTMODULES_VOLUMERENDERING_EXPORT qSlicerVolumeRenderingSettingsPa
   Q_OBJECT
   QVTK_OBJECT
   Q_PROPERTY(int gpuMemory READ gpuMemory WRITE setGPUMemory NOTIFY gpuMemoryChanged)
+  Q_PROPERTY(int volumeMemoryBudget READ volumeMemoryBudget WRITE setVolumeMemoryBudget NOTIFY volumeMemoryBudgetChanged)
   Q_PROPERTY(QString defaultRenderingMethod READ defaultRenderingMethod WRITE setDefaultRenderingMethod NOTIFY defaultRenderingMethodChanged)
 public:
   /// Superclass typedef
@@ -55,17 +56,25 @@ public:
   int gpuMemory()const;
   void setGPUMemory(int gpuMemory);
 
+  /// Maximum size (in MB) of the volumes given to the renderers.
+  /// Larger volumes are rendered from a downsampled proxy. 0 means no limit.
+  /// \sa vtkMRMLVolumeRenderingDisplayableManager::VolumeMemoryBudget
+  int volumeMemoryBudget()const;
+  void setVolumeMemoryBudget(int budget);
+
   QString defaultRenderingMethod()const;
 public slots:
   void setDefaultRenderingMethod(const QString& method);
 
 signals:
   void gpuMemoryChanged(int);
+  void volumeMemoryBudgetChanged(int);
   void defaultRenderingMethodChanged(const QString&);
 
 protected slots:
   void onVolumeRenderingLogicModified();
   void onGPUMemoryChanged();
+  void onVolumeMemoryBudgetChanged();
   void onDefaultRenderingMethodChanged(int);
   void updateVolumeRenderingLogicDefaultRenderingMethod();
 
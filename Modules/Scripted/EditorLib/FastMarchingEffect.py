@@ -60,6 +60,12 @@ class FastMarchingEffectOptions(Effect.EffectOptions):
     self.widgets.append(self.percentMax)
     self.percentMax.connect('valueChanged(double)', self.percentMaxChanged)
 
+    self.cropToSeedsCheckBox = qt.QCheckBox('Crop to seeds', self.frame)
+    self.cropToSeedsCheckBox.setToolTip('Only process a region around the seeds, sized from the expected volume. Faster and'
+      ' uses less memory on large images, but elongated structures may be cut at the border of the region.')
+    self.frame.layout().addWidget(self.cropToSeedsCheckBox)
+    self.widgets.append(self.cropToSeedsCheckBox)
+
     self.march = qt.QPushButton("March", self.frame)
     self.march.setToolTip("Perform the Marching operation into the current label map")
     self.frame.layout().addWidget(self.march)
@@ -79,9 +85,10 @@ class FastMarchingEffectOptions(Effect.EffectOptions):
     self.widgets.append(self.marcher)
     self.marcher.connect('valueChanged(double)',self.onMarcherChanged)
 
-    HelpButton(self.frame, "To use FastMarching effect, first mark the areas that belong to the structure of interest to initialize the algorithm. Define the expected volume of the structure you are trying to segment, and hit March.\nAfter computation is complete, use the Marcher slider to go over the segmentation history.")
+    HelpButton(self.frame, "To use FastMarching effect, first mark the areas that belong to the structure of interest to initialize the algorithm. Define the expected volume of the structure you are trying to segment, and hit March. Check Crop to seeds to process large images faster, if the structure is not much larger than the expected volume around the seeds.\nAfter computation is complete, use the Marcher slider to go over the segmentation history.")
 
     self.march.connect('clicked()', self.onMarch)
+    self.connections.append( (self.cropToSeedsCheckBox, 'clicked()', self.onCropToSeedsClicked) )
 
     # Add vertical spacer
     self.frame.layout().addStretch(1)
@@ -104,19 +111,28 @@ class FastMarchingEffectOptions(Effect.EffectOptions):
 
   def setMRMLDefaults(self):
     super(FastMarchingEffectOptions,self).setMRMLDefaults()
+    disableState = self.parameterNode.GetDisableModifiedEvent()
+    self.parameterNode.SetDisableModifiedEvent(1)
+    if self.parameterNode.GetParameter("FastMarchingEffect,cropToSeeds") == '':
+      self.parameterNode.SetParameter("FastMarchingEffect,cropToSeeds", "0")
+    self.parameterNode.SetDisableModifiedEvent(disableState)
 
   def updateGUIFromMRML(self,caller,event):
     super(FastMarchingEffectOptions,self).updateGUIFromMRML(caller,event)
+    if self.parameterNode.GetParameter("FastMarchingEffect,cropToSeeds") == '':
+      # don't update if the parameter node has not got all values yet
+      return
     self.disconnectWidgets()
     # TODO: get the march parameter from the node
     # march = float(self.parameterNode.GetParameter
+    self.cropToSeedsCheckBox.checked = self.parameterNode.GetParameter("FastMarchingEffect,cropToSeeds") == "1"
     self.connectWidgets()
 
   def onMarch(self):
     try:
       slicer.util.showStatusMessage('Running FastMarching...', 2000)
       self.logic.undoRedo = self.undoRedo
-      npoints = self.logic.fastMarching(self.percentMax.value)
+      npoints = self.logic.fastMarching(self.percentMax.value, self.cropToSeedsCheckBox.checked)
       slicer.util.showStatusMessage('FastMarching finished', 2000)
       if npoints:
         self.marcher.minimum = 0
@@ -128,6 +144,11 @@ class FastMarchingEffectOptions(Effect.EffectOptions):
       print('No tools available!')
       pass
 
+  def onCropToSeedsClicked(self):
+    if self.updatingGUI:
+      return
+    self.updateMRMLFromGUI()
+
   def onMarcherChanged(self,value):
     self.logic.updateLabel(value/self.marcher.maximum)
 
@@ -148,6 +169,8 @@ class FastMarchingEffectOptions(Effect.EffectOptions):
     disableState = self.parameterNode.GetDisableModifiedEvent()
     self.parameterNode.SetDisableModifiedEvent(1)
     super(FastMarchingEffectOptions,self).updateMRMLFromGUI()
+    cropToSeeds = "1" if self.cropToSeedsCheckBox.checked else "0"
+    self.parameterNode.SetParameter( "FastMarchingEffect,cropToSeeds", cropToSeeds )
     self.parameterNode.SetDisableModifiedEvent(disableState)
     if not disableState:
       self.parameterNode.InvokePendingModifiedEvent()
@@ -200,7 +223,7 @@ class FastMarchingEffectLogic(Effect.EffectLogic):
   def __init__(self,sliceLogic):
     super(FastMarchingEffectLogic,self).__init__(sliceLogic)
 
-  def fastMarching(self,percentMax):
+  def fastMarching(self,percentMax,cropToSeeds=False):
 
     self.fm = None
     # allocate a new filter each time March is hit
@@ -237,6 +260,9 @@ class FastMarchingEffectLogic(Effect.EffectLogic):
 
     print('Input scalar range: '+str(depth))
     self.fm.init(dim[0], dim[1], dim[2], depth, 1, 1, 1)
+    if cropToSeeds:
+      # only allocate and process the region around the seeds
+      self.fm.tweak('cropMarginFactor', 2.)
 
     caster = vtk.vtkImageCast()
     caster.SetOutputScalarTypeToShort()
@@ -279,9 +305,9 @@ class FastMarchingEffectLogic(Effect.EffectLogic):
   def updateLabel(self,value):
     if not self.fm:
       return
+    # show() re-thresholds the arrival order of the last evolution
+    # directly in the output, there is no need to update the filter
     self.fm.show(value)
-    self.fm.Modified()
-    self.fm.Update()
 
     EditUtil.getLabelImage().DeepCopy(self.fm.GetOutput())
     EditUtil.getLabelImage().Modified()
@@ -0,0 +1,146 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// EditorLib includes
+#include "vtkPichonFastMarching.h"
+
+// vtkAddon includes
+#include <vtkAddonTestingMacros.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <algorithm>
+
+namespace
+{
+
+const int Size = 48;
+
+//----------------------------------------------------------------------------
+// Bright ball in the middle of a darker, noisy background
+void CreateInput(vtkImageData* input)
+{
+  input->SetDimensions(Size, Size, Size);
+  input->AllocateScalars(VTK_SHORT, 1);
+  short* inputPtr = static_cast<short*>(input->GetScalarPointer());
+  unsigned int random = 1;
+  double center = Size / 2.;
+  for (int k = 0; k < Size; ++k)
+    {
+    for (int j = 0; j < Size; ++j)
+      {
+      for (int i = 0; i < Size; ++i)
+        {
+        double distance2 = (i - center) * (i - center)
+          + (j - center) * (j - center) + (k - center) * (k - center);
+        random = random * 1103515245 + 12345;
+        *(inputPtr++) = (distance2 < 36. ? 100 : 20) + (random >> 16) % 10;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void CreateSeeds(vtkImageData* seeds)
+{
+  seeds->SetDimensions(Size, Size, Size);
+  seeds->AllocateScalars(VTK_SHORT, 1);
+  short* seedsPtr = static_cast<short*>(seeds->GetScalarPointer());
+  std::fill(seedsPtr, seedsPtr + Size * Size * Size, 0);
+  seedsPtr[Size / 2 + (Size / 2) * Size + (Size / 2) * Size * Size] = 1;
+  seedsPtr[Size / 2 + 1 + (Size / 2) * Size + (Size / 2) * Size * Size] = 1;
+}
+
+//----------------------------------------------------------------------------
+int CountLabel(vtkImageData* output, int label)
+{
+  short* outputPtr = static_cast<short*>(output->GetScalarPointer());
+  int count = 0;
+  for (int i = 0; i < Size * Size * Size; ++i)
+    {
+    count += (outputPtr[i] == label);
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+bool IsSameImage(vtkImageData* image1, vtkImageData* image2)
+{
+  short* ptr1 = static_cast<short*>(image1->GetScalarPointer());
+  short* ptr2 = static_cast<short*>(image2->GetScalarPointer());
+  return std::equal(ptr1, ptr1 + Size * Size * Size, ptr2);
+}
+
+//----------------------------------------------------------------------------
+// Grow the seeds, output the full evolution in fullOutput and half of it
+// in halfOutput.
+void RunFastMarching(vtkImageData* input, vtkImageData* seeds,
+                     double cropMarginFactor, int numberOfPoints,
+                     vtkImageData* fullOutput, vtkImageData* halfOutput)
+{
+  vtkNew<vtkPichonFastMarching> fastMarching;
+  fastMarching->init(Size, Size, Size, 300, 1, 1, 1);
+  if (cropMarginFactor > 0.)
+    {
+    fastMarching->tweak(const_cast<char*>("cropMarginFactor"), cropMarginFactor);
+    }
+  fastMarching->SetInputData(input);
+  fastMarching->setNPointsEvolution(numberOfPoints);
+  fastMarching->setActiveLabel(2);
+  fastMarching->addSeedsFromImage(seeds);
+
+  // The first execution initializes the filter, the second one evolves
+  fastMarching->Update();
+  fastMarching->Modified();
+  fastMarching->Update();
+
+  // show() writes the label in the output directly
+  fastMarching->show(1);
+  fullOutput->DeepCopy(fastMarching->GetOutput());
+  fastMarching->show(0.5);
+  halfOutput->DeepCopy(fastMarching->GetOutput());
+
+  fastMarching->unInit();
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkPichonFastMarchingTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  vtkNew<vtkImageData> input;
+  CreateInput(input.GetPointer());
+  vtkNew<vtkImageData> seeds;
+  CreateSeeds(seeds.GetPointer());
+
+  // The working region is the 38x38x38 voxels around the seeds when cropped
+  const int numberOfPoints = 300;
+  vtkNew<vtkImageData> fullOutput;
+  vtkNew<vtkImageData> halfOutput;
+  RunFastMarching(input.GetPointer(), seeds.GetPointer(), 0., numberOfPoints,
+                  fullOutput.GetPointer(), halfOutput.GetPointer());
+  int fullCount = CountLabel(fullOutput.GetPointer(), 2);
+  int halfCount = CountLabel(halfOutput.GetPointer(), 2);
+  CHECK_BOOL(fullCount > numberOfPoints / 2 && fullCount <= numberOfPoints + 2, true);
+  CHECK_BOOL(halfCount > 0 && halfCount < fullCount, true);
+  CHECK_INT(CountLabel(fullOutput.GetPointer(), 0) + fullCount, Size * Size * Size);
+
+  // Cropping to the seeds does not change the segmentation
+  vtkNew<vtkImageData> croppedFullOutput;
+  vtkNew<vtkImageData> croppedHalfOutput;
+  RunFastMarching(input.GetPointer(), seeds.GetPointer(), 2., numberOfPoints,
+                  croppedFullOutput.GetPointer(), croppedHalfOutput.GetPointer());
+  CHECK_BOOL(IsSameImage(croppedFullOutput.GetPointer(), fullOutput.GetPointer()), true);
+  CHECK_BOOL(IsSameImage(croppedHalfOutput.GetPointer(), halfOutput.GetPointer()), true);
+
+  return EXIT_SUCCESS;
+}
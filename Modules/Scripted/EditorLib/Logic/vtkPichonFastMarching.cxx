@@ -142,7 +142,8 @@ inline void vtkPichonFastMarching::getMedianInhomo( int index, int &med, int &in
   for(int k=0;k<=26;k++)
       tmpNeighborhood[k] = (int)indata[index + arrayShiftNeighbor[k]];
 
-  qsort( (void*)tmpNeighborhood, 27, sizeof(int), &compareInt );
+  // std::sort is inlined, unlike the comparison function of qsort
+  std::sort( tmpNeighborhood, tmpNeighborhood+27 );
 
   inh = inhomo[ index ] = (tmpNeighborhood[21] - tmpNeighborhood[5]);
   med = median[ index ] = tmpNeighborhood[13];
@@ -199,11 +200,11 @@ void vtkPichonFastMarching::initNewExpansion( void )
     for(int j=0;j<dimY;j++)
       for(int i=0;i<dimX;i++)
     {
-      if( (outdata[index]==label) && (node[index].status!=fmsOUT) )
+      if( (outdata[imageIndex(index)]==label) && (node[index].status!=fmsOUT) )
         {
             collectInfoSeed( index );
             for(int n=1;n<nNeighbors;n++)
-            if(outdata[index+shiftNeighbor(n)]==0)
+            if(outdata[imageIndex(index+shiftNeighbor(n))]==0)
               {
                 seedPoints.push_back( index+shiftNeighbor(n) );
                 }
@@ -260,25 +261,35 @@ void vtkPichonFastMarchingExecute(vtkPichonFastMarching *self,
   int n=0;
   int k;
 
-  self->setInData( (short *)inPtr );
+  // the input is copied to the working region when initializing
   self->setOutData( (short *)outPtr );
 
   if( !self->initialized )
     {
+    if( !self->initWorkingRegion( (short *)inPtr ) )
+      {
+      self->somethingReallyWrong = true;
+      return;
+      }
     self->initialized = true;
 
+    // the output has just been allocated, the label is only written by show()
+    std::fill( self->outdata, self->outdata+self->imageDimXY*self->imageDimZ, (short)0 );
+
     int index=0;
     int lastPercentageProgressBarUpdated=-1;
 
 
     for(k=0;k<self->dimZ;k++)
       for(int j=0;j<self->dimY;j++)
+        {
+        int outIndex = self->imageIndex(index);
         for(int i=0;i<self->dimX;i++)
           {
 
           self->node[index].T=(float)INF;
 
-          if(self->outdata[index]==0)
+          if(self->outdata[outIndex++]==0)
             self->node[index].status=fmsFAR;
           else
             self->node[index].status=fmsDONE;
@@ -307,6 +318,13 @@ void vtkPichonFastMarchingExecute(vtkPichonFastMarching *self,
 
           index++;
           }
+        }
+
+    // use the neighbors of the seeds to create statistics, this could not be
+    // done when they were added as the input was not available yet
+    for(k=0;k<(int)self->seedPoints.size();k++)
+      for(n=0;n<=26;n++)
+        self->collectInfoSeed( self->seedPoints[k]+self->shiftNeighbor(n) );
 
     return;
     }
@@ -358,6 +376,7 @@ void vtkPichonFastMarchingExecute(vtkPichonFastMarching *self,
           if( self->node[indexN].status==fmsTRIAL )
             {
             self->node[indexN].T=(float)INF;
+            self->tree[ self->node[indexN].leafIndex ].T=(float)INF;
             self->downTree( self->node[indexN].leafIndex );
             }
           }
@@ -469,15 +488,21 @@ void vtkPichonFastMarching::show(float r)
     for(int index=(oldIndex+1);index<=newIndex;index++)
       {
     if( node[ knownPoints[index] ].status==fmsKNOWN )
-        if(outdata[ knownPoints[index] ]==0)
-          outdata[ knownPoints[index] ]=label;
+        {
+        int outIndex = imageIndex( knownPoints[index] );
+        if(outdata[ outIndex ]==0)
+          outdata[ outIndex ]=label;
+        }
       }
   else if( newIndex < oldIndex )
     for(int index=oldIndex;index>newIndex;index--)
       {
     if(node[ knownPoints[index] ].status==fmsKNOWN )
-        if(outdata[ knownPoints[index] ]==label)
-          outdata[ knownPoints[index] ]=0;
+        {
+        int outIndex = imageIndex( knownPoints[index] );
+        if(outdata[ outIndex ]==label)
+          outdata[ outIndex ]=0;
+        }
       }
 
   nPointsBeforeLeakEvolution=newIndex;
@@ -539,6 +564,13 @@ void vtkPichonFastMarching::PrintSelf(ostream& os, vtkIndent indent)
 {
   vtkImageAlgorithm::PrintSelf(os,indent);
 
+  os << indent << "imageDimX: " << this->imageDimX << "\n";
+  os << indent << "imageDimY: " << this->imageDimY << "\n";
+  os << indent << "imageDimZ: " << this->imageDimZ << "\n";
+  os << indent << "regionX0: " << this->regionX0 << "\n";
+  os << indent << "regionY0: " << this->regionY0 << "\n";
+  os << indent << "regionZ0: " << this->regionZ0 << "\n";
+  os << indent << "cropMarginFactor: " << this->cropMarginFactor << "\n";
   os << indent << "dimX: " << this->dimX << "\n";
   os << indent << "dimY: " << this->dimY << "\n";
   os << indent << "dimZ: " << this->dimZ << "\n";
@@ -555,6 +587,7 @@ void vtkPichonFastMarching::insert(const FMleaf leaf) {
 
   // insert element at the back
   tree.push_back( leaf );
+  tree.back().T=node[ leaf.nodeIndex ].T;
   node[ leaf.nodeIndex ].leafIndex=(int)(tree.size()-1);
 
   // trickle the element up until everything
@@ -578,16 +611,21 @@ bool vtkPichonFastMarching::minHeapIsSorted( void )
     }
   for(k=(N-1);k>=1;k--)
     {
-      if( vtkMath::IsFinite( node[tree[k].nodeIndex].T)==0 )
+      if( vtkMath::IsFinite( tree[k].T)==0 )
+    vtkErrorMacro( "Error in vtkPichonFastMarching::minHeapIsSorted(): "
+               << "NaN or Inf value in minHeap : " << tree[k].T );
+
+      if( tree[k].T!=node[tree[k].nodeIndex].T )
     vtkErrorMacro( "Error in vtkPichonFastMarching::minHeapIsSorted(): "
-               << "NaN or Inf value in minHeap : " << node[tree[k].nodeIndex].T );
+               << "tree[" << k << "].T=" << tree[k].T
+               << "!=node[tree[k].nodeIndex].T=" << node[tree[k].nodeIndex].T );
 
-      if( node[tree[k].nodeIndex].T<node[ (int)(tree[(k-1)/2].nodeIndex) ].T )
+      if( tree[k].T<tree[(k-1)/2].T )
     {
       vtkErrorMacro( "Error in vtkPichonFastMarching::minHeapIsSorted(): "
              << "minHeapIsSorted is false! : size=" << (unsigned int)tree.size() << "at leafIndex=" << k
-             << " node[tree[k].nodeIndex].T=" << node[tree[k].nodeIndex].T
-             << "<node[ (int)(tree[(k-1)/2].nodeIndex) ].T=" << node[ (int)(tree[(k-1)/2].nodeIndex) ].T);
+             << " tree[k].T=" << tree[k].T
+             << "<tree[(k-1)/2].T=" << tree[(k-1)/2].T);
 
       return false;
     }
@@ -627,8 +665,7 @@ void vtkPichonFastMarching::downTree(int index) {
        */
       if (RightChild < (int)tree.size()) {
 
-    if (node[tree[LeftChild].nodeIndex].T>
-        node[tree[RightChild].nodeIndex].T)
+    if (tree[LeftChild].T>tree[RightChild].T)
       MinChild = RightChild;
       }
 
@@ -636,8 +673,7 @@ void vtkPichonFastMarching::downTree(int index) {
        * If the MinChild has smaller T than the current leaf,
        * swap them, and move the current leaf to the MinChild.
        */
-      if (node[tree[MinChild].nodeIndex].T<
-      node[tree[index].nodeIndex].T)
+      if (tree[MinChild].T<tree[index].T)
     {
       FMleaf tmp=tree[index];
       tree[index]=tree[MinChild];
@@ -673,8 +709,7 @@ void vtkPichonFastMarching::upTree(int index) {
     {
       int upIndex = (int) (index-1)/2;
 
-      if( node[tree[index].nodeIndex].T <
-      node[tree[upIndex].nodeIndex].T )
+      if( tree[index].T<tree[upIndex].T )
     {
       // then swap the 2 nodes
 
@@ -724,6 +759,139 @@ vtkPichonFastMarching::vtkPichonFastMarching()
 {
   initialized=false;
   somethingReallyWrong=true;
+  cropMarginFactor=0.0;
+  node=NULL;
+  inhomo=NULL;
+  median=NULL;
+}
+
+bool vtkPichonFastMarching::initWorkingRegion(short* imageData)
+{
+  // the working region is the whole image by default
+  int minIJK[3] = { 0, 0, 0 };
+  int maxIJK[3] = { imageDimX-1, imageDimY-1, imageDimZ-1 };
+
+  // seeds are still image indices at this point
+  if( (cropMarginFactor>0.0) && (seedPoints.size()>0) )
+    {
+      minIJK[0]=imageDimX; minIJK[1]=imageDimY; minIJK[2]=imageDimZ;
+      maxIJK[0]=-1; maxIJK[1]=-1; maxIJK[2]=-1;
+      for(int k=0;k<(int)seedPoints.size();k++)
+    {
+      int seedIJK[3];
+      seedIJK[0] = seedPoints[k] % imageDimX;
+      seedIJK[1] = (seedPoints[k] / imageDimX) % imageDimY;
+      seedIJK[2] = seedPoints[k] / imageDimXY;
+      for(int d=0;d<3;d++)
+        {
+          minIJK[d] = std::min(minIJK[d], seedIJK[d]);
+          maxIJK[d] = std::max(maxIJK[d], seedIJK[d]);
+        }
+    }
+
+      // a ball of nPointsEvolution voxels has a radius of about
+      // 0.62*cbrt(nPointsEvolution), keep enough room for the front to
+      // follow elongated structures. The border of the working region is
+      // never reached by the evolution (fmsOUT band).
+      int margin = BAND_OUT + 1 +
+    (int)ceil( cropMarginFactor * pow( (double)std::max(nPointsEvolution,1), 1.0/3.0 ) );
+      int imageDim[3] = { imageDimX, imageDimY, imageDimZ };
+      for(int d=0;d<3;d++)
+    {
+      minIJK[d] = std::max(0, minIJK[d]-margin);
+      maxIJK[d] = std::min(imageDim[d]-1, maxIJK[d]+margin);
+    }
+    }
+
+  regionX0=minIJK[0];
+  regionY0=minIJK[1];
+  regionZ0=minIJK[2];
+  dimX=maxIJK[0]-minIJK[0]+1;
+  dimY=maxIJK[1]-minIJK[1]+1;
+  dimZ=maxIJK[2]-minIJK[2]+1;
+  dimXY=dimX*dimY;
+  dimXYZ=dimX*dimY*dimZ;
+
+  arrayShiftNeighbor[0] = 0; // neighbor 0 is the node itself
+  arrayShiftNeighbor[1] = -dimX;
+  arrayShiftNeighbor[2] = +1;
+  arrayShiftNeighbor[3] = dimX;
+  arrayShiftNeighbor[4] = -1;
+  arrayShiftNeighbor[5] = -dimXY;
+  arrayShiftNeighbor[6] = dimXY;
+  arrayShiftNeighbor[7] =  -dimX+dimXY;
+  arrayShiftNeighbor[8] =  -dimX-dimXY;
+  arrayShiftNeighbor[9] =   dimX+dimXY;
+  arrayShiftNeighbor[10] =  dimX-dimXY;
+  arrayShiftNeighbor[11] = -1+dimXY;
+  arrayShiftNeighbor[12] = -1-dimXY;
+  arrayShiftNeighbor[13] = +1+dimXY;
+  arrayShiftNeighbor[14] = +1-dimXY;
+  arrayShiftNeighbor[15] = +1-dimX;
+  arrayShiftNeighbor[16] = +1+dimX;
+  arrayShiftNeighbor[17] = -1+dimX;
+  arrayShiftNeighbor[18] = -1-dimX;
+  arrayShiftNeighbor[19] = +1-dimX-dimXY;
+  arrayShiftNeighbor[20] = +1-dimX+dimXY;
+  arrayShiftNeighbor[21] = +1+dimX-dimXY;
+  arrayShiftNeighbor[22] = +1+dimX+dimXY;
+  arrayShiftNeighbor[23] = -1+dimX-dimXY;
+  arrayShiftNeighbor[24] = -1+dimX+dimXY;
+  arrayShiftNeighbor[25] = -1-dimX-dimXY;
+  arrayShiftNeighbor[26] = -1-dimX+dimXY;
+
+  delete [] node;
+  delete [] inhomo;
+  delete [] median;
+
+  node = new FMnode[ dimXYZ ];
+  inhomo = new int[ dimXYZ ];
+  median = new int[ dimXYZ ];
+  if( (node==NULL) || (inhomo==NULL) || (median==NULL) )
+    {
+      vtkErrorMacro("Error in vtkPichonFastMarching::initWorkingRegion(), not enough memory for allocation of the working region");
+      return false;
+    }
+
+  // copy the input in the working region
+  regionIndata.resize( dimXYZ );
+  for(int k=0;k<dimZ;k++)
+    for(int j=0;j<dimY;j++)
+      {
+    short* src = imageData + imageIndex( j*dimX+k*dimXY );
+    std::copy( src, src+dimX, regionIndata.begin()+j*dimX+k*dimXY );
+      }
+  setInData( &regionIndata[0] );
+
+  // convert the seeds to working region indices
+  for(int k=0;k<(int)seedPoints.size();k++)
+    seedPoints[k] = regionIndex( seedPoints[k] % imageDimX,
+                 (seedPoints[k] / imageDimX) % imageDimY,
+                 seedPoints[k] / imageDimXY );
+
+  return true;
+}
+
+int vtkPichonFastMarching::imageIndex(int index)
+{
+  int i = index % dimX;
+  int j = (index / dimX) % dimY;
+  int k = index / dimXY;
+
+  return (i+regionX0) + (j+regionY0)*imageDimX + (k+regionZ0)*imageDimXY;
+}
+
+int vtkPichonFastMarching::regionIndex(int I, int J, int K)
+{
+  int i = I-regionX0;
+  int j = J-regionY0;
+  int k = K-regionZ0;
+
+  // the 26-neighbors must be in the working region too
+  if( (i<1) || (i>=(dimX-1)) || (j<1) || (j>=(dimY-1)) || (k<1) || (k>=(dimZ-1)) )
+    return -1;
+
+  return i + j*dimX + k*dimXY;
 }
 
 void vtkPichonFastMarching::init(int _dimX, int _dimY, int _dimZ, double _depth, double _dx, double _dy, double _dz)
@@ -744,95 +912,61 @@ void vtkPichonFastMarching::init(int _dimX, int _dimY, int _dimZ, double _depth,
 
   nEvolutions=-1;
 
+  this->imageDimX=_dimX;
+  this->imageDimY=_dimY;
+  this->imageDimZ=_dimZ;
+  this->imageDimXY=imageDimX*imageDimY;
+
+  // the working region is the whole image until the seeds are known
+  this->regionX0=0;
+  this->regionY0=0;
+  this->regionZ0=0;
   this->dimX=_dimX;
   this->dimY=_dimY;
   this->dimZ=_dimZ;
   this->dimXY=dimX*dimY;
   this->dimXYZ=dimX*dimY*dimZ;
 
-  arrayShiftNeighbor[0] = 0; // neighbor 0 is the node itself
+  // neighbor 0 is the node itself, neighbor shifts depend on the
+  // working region and are computed by initWorkingRegion()
   arrayDistanceNeighbor[0] = 0.0;
 
-  arrayShiftNeighbor[1] = -dimX;
   arrayDistanceNeighbor[1] = dy;
-  arrayShiftNeighbor[2] = +1;
   arrayDistanceNeighbor[2] = dx;
-  arrayShiftNeighbor[3] = dimX;
   arrayDistanceNeighbor[3] = dy;
-  arrayShiftNeighbor[4] = -1;
   arrayDistanceNeighbor[4] = dx;
-  arrayShiftNeighbor[5] = -dimXY;
   arrayDistanceNeighbor[5] = dz;
-  arrayShiftNeighbor[6] = dimXY;
   arrayDistanceNeighbor[6] = dz;
 
-  arrayShiftNeighbor[7] =  -dimX+dimXY;
   arrayDistanceNeighbor[7] = sqrt( dy*dy + dz*dz );
-  arrayShiftNeighbor[8] =  -dimX-dimXY;
   arrayDistanceNeighbor[8] = sqrt( dy*dy + dz*dz );
-  arrayShiftNeighbor[9] =   dimX+dimXY;
   arrayDistanceNeighbor[9] = sqrt( dy*dy + dz*dz );
-  arrayShiftNeighbor[10] =  dimX-dimXY;
   arrayDistanceNeighbor[10] = sqrt( dy*dy + dz*dz );
-  arrayShiftNeighbor[11] = -1+dimXY;
   arrayDistanceNeighbor[11] = sqrt( dx*dx + dz*dz );
-  arrayShiftNeighbor[12] = -1-dimXY;
   arrayDistanceNeighbor[12] = sqrt( dx*dx + dz*dz );
-  arrayShiftNeighbor[13] = +1+dimXY;
   arrayDistanceNeighbor[13] = sqrt( dx*dx + dz*dz );
-  arrayShiftNeighbor[14] = +1-dimXY;
   arrayDistanceNeighbor[14] = sqrt( dx*dx + dz*dz );
-  arrayShiftNeighbor[15] = +1-dimX;
   arrayDistanceNeighbor[15] = sqrt( dx*dx + dy*dy );
-  arrayShiftNeighbor[16] = +1+dimX;
   arrayDistanceNeighbor[16] = sqrt( dx*dx + dy*dy );
-  arrayShiftNeighbor[17] = -1+dimX;
   arrayDistanceNeighbor[17] = sqrt( dx*dx + dy*dy );
-  arrayShiftNeighbor[18] = -1-dimX;
   arrayDistanceNeighbor[18] = sqrt( dx*dx + dy*dy );
 
-  arrayShiftNeighbor[19] = +1-dimX-dimXY;
   arrayDistanceNeighbor[19] = sqrt( dx*dx + dy*dy + dz*dz );
-  arrayShiftNeighbor[20] = +1-dimX+dimXY;
   arrayDistanceNeighbor[20] = sqrt( dx*dx + dy*dy + dz*dz );
-  arrayShiftNeighbor[21] = +1+dimX-dimXY;
   arrayDistanceNeighbor[21] = sqrt( dx*dx + dy*dy + dz*dz );
-  arrayShiftNeighbor[22] = +1+dimX+dimXY;
   arrayDistanceNeighbor[22] = sqrt( dx*dx + dy*dy + dz*dz );
-  arrayShiftNeighbor[23] = -1+dimX-dimXY;
   arrayDistanceNeighbor[23] = sqrt( dx*dx + dy*dy + dz*dz );
-  arrayShiftNeighbor[24] = -1+dimX+dimXY;
   arrayDistanceNeighbor[24] = sqrt( dx*dx + dy*dy + dz*dz );
-  arrayShiftNeighbor[25] = -1-dimX-dimXY;
   arrayDistanceNeighbor[25] = sqrt( dx*dx + dy*dy + dz*dz );
-  arrayShiftNeighbor[26] = -1-dimX+dimXY;
   arrayDistanceNeighbor[26] = sqrt( dx*dx + dy*dy + dz*dz );
 
   this->depth = (int) _depth;
 
-  node = new FMnode[ dimX*dimY*dimZ ];
-  // assert( node!=NULL );
-  if(!(node!=NULL))
-    {
-      vtkErrorMacro("Error in void vtkPichonFastMarching::init(), not enough memory for allocation of 'node'");
-      return;
-    }
-
-  inhomo = new int[ dimX*dimY*dimZ ];
-  //  assert( inhomo!=NULL );
-  if(!(inhomo!=NULL))
-    {
-      vtkErrorMacro("Error in void vtkPichonFastMarching::init(), not enough memory for allocation of 'inhomo'");
-      return;
-    }
-
-  median = new int[ dimX*dimY*dimZ ];
-  //  assert( median!=NULL );
-  if(!(median!=NULL))
-    {
-      vtkErrorMacro("Error in void vtkPichonFastMarching::init(), not enough memory for allocation of 'median'");
-      return;
-    }
+  // node, inhomo and median are allocated for the working region
+  // by initWorkingRegion()
+  node = NULL;
+  inhomo = NULL;
+  median = NULL;
 
   pdfIntensityIn = new vtkPichonFastMarchingPDF( (int) _depth );
   if(!(pdfIntensityIn!=NULL))
@@ -942,7 +1076,7 @@ float vtkPichonFastMarching::step( void )
 
   min=removeSmallest();
 
-  if( node[min.nodeIndex].T>=INF )
+  if( min.T>=INF )
     {
       vtkErrorMacro( " node[min.nodeIndex].T>=INF " << endl );
 
@@ -995,6 +1129,7 @@ float vtkPichonFastMarching::step( void )
       node[indexN].T=computeT(indexN);
 
       t2 = node[indexN].T;
+      tree[ node[indexN].leafIndex ].T = t2;
 
       if( t2<t1 )
           upTree( node[indexN].leafIndex );
@@ -1172,24 +1307,7 @@ int vtkPichonFastMarching::addSeed( float r, float a, float s )
   J = (int) ( m21*r + m22*a + m23*s + m24*1 );
   K = (int) ( m31*r + m32*a + m33*s + m34*1 );
 
-  if ( (I>=1) && (I<(dimX-1))
-       &&  (J>=1) && (J<(dimY-1))
-       &&  (K>=1) && (K<(dimZ-1)) )
-    {
-      seedPoints.push_back( I+J*dimX+K*dimXY );
-
-      // use neighbors to create statistics
-      for(int n=0;n<=26;n++)
-    collectInfoSeed( I+J*dimX+K*dimXY+shiftNeighbor(n) );
-
-      // note: the neighbors will be put in TRIAL by setseed
-
-      return 1;
-    } else {
-      cout << "Point is outside image volume" << endl;
-    }
-
-  return 0; // we're trying to put a seed outside of the volume
+  return addSeedIJK( I, J, K );
 }
 
 
@@ -1200,15 +1318,30 @@ int vtkPichonFastMarching::addSeedIJK( int I, int J, int K )
     return 0;
   }
 
-  if ( (I>=1) && (I<(dimX-1))
-       &&  (J>=1) && (J<(dimY-1))
-       &&  (K>=1) && (K<(dimZ-1)) )
+  if ( (I>=1) && (I<(imageDimX-1))
+       &&  (J>=1) && (J<(imageDimY-1))
+       &&  (K>=1) && (K<(imageDimZ-1)) )
+    {
+      if(!initialized)
+    {
+      // the working region is not known yet: the seed is converted and
+      // its neighbors are used to create statistics in the first execution
+      seedPoints.push_back( I+J*imageDimX+K*imageDimXY );
+      return 1;
+    }
+
+      int index = regionIndex( I, J, K );
+      if( index<0 )
     {
-      seedPoints.push_back( I+J*dimX+K*dimXY );
+      cout << "Point is outside the working region" << endl;
+      return 0;
+    }
+
+      seedPoints.push_back( index );
 
       // use neighbors to create statistics
       for(int n=0;n<=26;n++)
-        collectInfoSeed( I+J*dimX+K*dimXY+shiftNeighbor(n) );
+        collectInfoSeed( index+shiftNeighbor(n) );
 
       // note: the neighbors will be put in TRIAL by setseed
 
@@ -1274,6 +1407,10 @@ void vtkPichonFastMarching::unInit( void )
   delete [] node;
   delete [] inhomo;
   delete [] median;
+  node = NULL;
+  inhomo = NULL;
+  median = NULL;
+  regionIndata.clear();
 
   // these are VTK objects, they should be destroyed by VTK's
   // garbage collector
@@ -1324,6 +1461,14 @@ void vtkPichonFastMarching::tweak(char *name, double value)
       return;
     }
 
+  if( strcmp( name, "cropMarginFactor" )==0 )
+    {
+      if(initialized)
+    vtkErrorMacro("Error in vtkPichonFastMarching::tweak(...): cropMarginFactor must be set before the first execution");
+      cropMarginFactor=value;
+      return;
+    }
+
 
   vtkErrorMacro("Error in vtkPichonFastMarching::tweak(...): '" << name << "' not recognized !");
 }
@@ -48,8 +48,11 @@ struct FMnode {
   int leafIndex;
 };
 
+/// minheap element, the arrival time is stored with the node index so that
+/// sorting the heap does not need to look up the nodes
 struct FMleaf {
   int nodeIndex;
+  float T;
 };
 
 /// these typedef are for tclwrapper...
@@ -139,14 +142,34 @@ private:
   bool initialized;
   bool firstCall;
 
-  FMnode *node;  /// arrival time and status for all voxels
+  FMnode *node;  /// arrival time and status for all voxels of the working region
   int *inhomo; /// inhomogeneity
   int *median; /// medican intensity
 
   short* outdata; /// output
-  short* indata;  /// input
+  short* indata;  /// input, cropped to the working region
+
+  /// copy of the input in the working region
+  std::vector<short> regionIndata;
+
+  /// size of the input and output images
+  int imageDimX;
+  int imageDimY;
+  int imageDimZ;
+  int imageDimXY; /// imageDimX*imageDimY
 
-  /// size of the indata (=size outdata, node, inhomo)
+  /// origin of the working region in the image
+  int regionX0;
+  int regionY0;
+  int regionZ0;
+
+  /// the working region is the bounding box of the seeds expanded by
+  /// cropMarginFactor * cubic root of nPointsEvolution voxels.
+  /// 0 (default) means the whole image. The front can't leave the working
+  /// region, so cropping may stop elongated structures early.
+  double cropMarginFactor;
+
+  /// size of the working region (=size node, inhomo, median)
   int dimX;
   int dimY;
   int dimZ;
@@ -204,6 +227,14 @@ private:
 
   int indexFather(int index );
 
+  /// compute the working region from the seeds and allocate the voxel
+  /// arrays for it, \a imageData is the full input image
+  bool initWorkingRegion(short* imageData);
+  /// index in the input/output images of a working region index
+  int imageIndex(int index);
+  /// index in the working region of an image voxel, -1 if outside
+  int regionIndex(int I, int J, int K);
+
   void getMedianInhomo(int index, int &median, int &inhomo );
 
   int shiftNeighbor(int n);